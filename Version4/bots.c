@@ -0,0 +1,382 @@
+/**
+ * @file bots.c
+ * @brief Pilotes automatiques fournis avec le jeu.
+ *
+ * @details
+ * - hasard : une direction sans danger immédiat, tirée au hasard.
+ * - glouton : la direction sans danger qui rapproche le plus de la pomme.
+ * - prudent : mesure par parcours en largeur l'espace accessible après
+ *   chaque déplacement et ne va vers la pomme que si le serpent y tient.
+ * - hamilton : suit un cycle hamiltonien du niveau (voir hamilton.c), prévu pour
+ *   des pavés fixes.
+ * - mcts : recherche arborescente Monte-Carlo sur plusieurs threads (voir mcts.c).
+ * - neurone : réseau de neurones entraîné par evolution.c (voir reseau.h), lu
+ *   dans reseau.poids ou $SNAKE_RESEAU ; sans fichier valide, il ne peut pas
+ *   être créé.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include "bots.h"
+#include "reseau.h"
+
+/** Les quatre directions, dans l'ordre où elles sont essayées. */
+static const char DIRECTIONS[4] = {HAUT, DROITE, BAS, GAUCHE};
+
+/** @brief Contexte du pilote « hasard ». */
+typedef struct
+{
+    uint32_t aleatoire;     /**< Générateur propre au pilote. */
+} ContexteHasard;
+
+/** @brief Contexte du pilote « prudent » : tampons du parcours en largeur. */
+typedef struct
+{
+    unsigned int *marque;   /**< Numéro du dernier parcours passé par chaque case. */
+    int *file;              /**< File des cases à visiter (indices). */
+    int *distance;          /**< Distance de chaque case au départ du parcours. */
+    unsigned int parcours;  /**< Numéro du parcours en cours. */
+} ContextePrudent;
+
+static void *creerHasard(const Partie *partie);
+static char choisirHasard(const Partie *partie, void *contexte);
+static char choisirGlouton(const Partie *partie, void *contexte);
+static void *creerPrudent(const Partie *partie);
+static char choisirPrudent(const Partie *partie, void *contexte);
+static void detruirePrudent(void *contexte);
+static void *creerNeurone(const Partie *partie);
+static char choisirNeurone(const Partie *partie, void *contexte);
+static int distancePomme(const Partie *partie, Segment position);
+static int espaceAccessible(const Partie *partie, ContextePrudent *contexte,
+                            Segment depart, int *distance_pomme);
+
+/** Pilotes disponibles. */
+const Strategie STRATEGIES[] =
+{
+    {"hasard", "direction sans danger tirée au hasard", creerHasard, choisirHasard, free},
+    {"glouton", "va droit vers la pomme en évitant les collisions immédiates", NULL, choisirGlouton, NULL},
+    {"prudent", "vers la pomme seulement si l'espace restant suffit", creerPrudent, choisirPrudent, detruirePrudent},
+    {"hamilton", "suit un cycle hamiltonien du niveau, avec raccourcis sans danger", creerHamilton, choisirHamilton, detruireHamilton},
+    {"mcts", "recherche Monte-Carlo en parallèle, réflexion bornée par la durée du tour", creerMcts, choisirMcts, detruireMcts},
+    {"neurone", "réseau de neurones entraîné par neuroévolution (evolution)", creerNeurone, choisirNeurone, free},
+};
+
+/** Nombre de pilotes disponibles. */
+const int NOMBRE_STRATEGIES = sizeof(STRATEGIES) / sizeof(STRATEGIES[0]);
+
+/**
+ * @brief Recherche un pilote par son nom.
+ *
+ * @param nom Nom du pilote.
+ * @return Le pilote, ou NULL s'il n'existe pas.
+ */
+const Strategie *trouverStrategie(const char *nom)
+{
+    for (int i = 0; i < NOMBRE_STRATEGIES; i++)
+    {
+        if (strcmp(STRATEGIES[i].nom, nom) == 0)
+        {
+            return &STRATEGIES[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Crée le contexte du pilote « hasard ».
+ *
+ * @param partie La partie (sa graine initialise le générateur du pilote).
+ * @return Le contexte alloué.
+ */
+static void *creerHasard(const Partie *partie)
+{
+    ContexteHasard *contexte = malloc(sizeof(ContexteHasard));
+
+    if (contexte == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    contexte->aleatoire = partie->aleatoire ^ 0x9E3779B9u;
+    if (contexte->aleatoire == 0)
+    {
+        contexte->aleatoire = 1;
+    }
+    return contexte;
+}
+
+/**
+ * @brief Tire une direction au hasard parmi celles sans danger.
+ *
+ * @param partie La partie.
+ * @param contexte Contexte du pilote.
+ * @return La direction choisie.
+ */
+static char choisirHasard(const Partie *partie, void *contexte)
+{
+    ContexteHasard *hasard = contexte;
+    char possibles[4];
+    int nombre = 0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (directionAutorisee(partie->direction, DIRECTIONS[i]) &&
+            deplacementSansDanger(partie, DIRECTIONS[i]))
+        {
+            possibles[nombre++] = DIRECTIONS[i];
+        }
+    }
+    if (nombre == 0)
+    {
+        return partie->direction;
+    }
+    return possibles[tirerAleatoire(&hasard->aleatoire) % nombre];
+}
+
+/**
+ * @brief Choisit la direction sans danger la plus proche de la pomme.
+ *
+ * @param partie La partie.
+ * @param contexte Inutilisé.
+ * @return La direction choisie.
+ */
+static char choisirGlouton(const Partie *partie, void *contexte)
+{
+    char choix = partie->direction;
+    int meilleure = INT_MAX;
+
+    (void)contexte;
+    for (int i = 0; i < 4; i++)
+    {
+        char direction = DIRECTIONS[i];
+
+        if (directionAutorisee(partie->direction, direction) &&
+            deplacementSansDanger(partie, direction))
+        {
+            Segment arrivee = caseSuivante(partie, teteSerpent(&partie->serpent), direction);
+            int distance = distancePomme(partie, arrivee);
+
+            if (distance < meilleure)
+            {
+                meilleure = distance;
+                choix = direction;
+            }
+        }
+    }
+    return choix;
+}
+
+/**
+ * @brief Crée les tampons du pilote « prudent ».
+ *
+ * @param partie La partie (pour la taille du plateau).
+ * @return Le contexte alloué.
+ */
+static void *creerPrudent(const Partie *partie)
+{
+    size_t cases = (size_t)partie->largeur * partie->hauteur;
+    ContextePrudent *contexte = malloc(sizeof(ContextePrudent));
+
+    if (contexte == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    contexte->marque = calloc(cases, sizeof(unsigned int));
+    contexte->file = malloc(cases * sizeof(int));
+    contexte->distance = malloc(cases * sizeof(int));
+    contexte->parcours = 0;
+    if (contexte->marque == NULL || contexte->file == NULL || contexte->distance == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    return contexte;
+}
+
+/**
+ * @brief Choisit une direction qui laisse assez de place au serpent.
+ *
+ * Parmi les directions sans danger, préfère celles où l'espace accessible
+ * contient au moins autant de cases que le serpent, puis la plus courte
+ * distance réelle jusqu'à la pomme, puis le plus grand espace.
+ *
+ * @param partie La partie.
+ * @param contexte Contexte du pilote.
+ * @return La direction choisie.
+ */
+static char choisirPrudent(const Partie *partie, void *contexte)
+{
+    char choix = partie->direction;
+    bool meilleur_tient = false;
+    int meilleure_distance = INT_MAX;
+    int meilleur_espace = -1;
+
+    for (int i = 0; i < 4; i++)
+    {
+        char direction = DIRECTIONS[i];
+        Segment arrivee;
+        int espace, distance;
+        bool tient;
+
+        if (!directionAutorisee(partie->direction, direction) ||
+            !deplacementSansDanger(partie, direction))
+        {
+            continue;
+        }
+        arrivee = caseSuivante(partie, teteSerpent(&partie->serpent), direction);
+        espace = espaceAccessible(partie, contexte, arrivee, &distance);
+        tient = (espace >= partie->serpent.taille);
+
+        if ((tient && !meilleur_tient) ||
+            (tient == meilleur_tient &&
+             (distance < meilleure_distance ||
+              (distance == meilleure_distance && espace > meilleur_espace))))
+        {
+            choix = direction;
+            meilleur_tient = tient;
+            meilleure_distance = distance;
+            meilleur_espace = espace;
+        }
+    }
+    return choix;
+}
+
+/**
+ * @brief Libère le contexte du pilote « prudent ».
+ *
+ * @param contexte Contexte à libérer.
+ */
+static void detruirePrudent(void *contexte)
+{
+    ContextePrudent *prudent = contexte;
+
+    free(prudent->marque);
+    free(prudent->file);
+    free(prudent->distance);
+    free(prudent);
+}
+
+/**
+ * @brief Lit le meilleur réseau du fichier de poids.
+ *
+ * @param partie Inutilisé.
+ * @return Les poids du réseau, ou NULL (message sur stderr) si le fichier est absent ou invalide.
+ */
+static void *creerNeurone(const Partie *partie)
+{
+    float *poids = malloc(POIDS_RESEAU * sizeof(float));
+    const char *chemin = cheminReseau();
+
+    (void)partie;
+    if (poids == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    if (lireReseaux(chemin, poids, 1) == 0)
+    {
+        fprintf(stderr, "neurone : %s absent ou d'une autre topologie (à entraîner avec evolution)\n", chemin);
+        free(poids);
+        return NULL;
+    }
+    return poids;
+}
+
+/**
+ * @brief Laisse le réseau choisir la direction.
+ *
+ * @param partie La partie.
+ * @param contexte Poids du réseau.
+ * @return La direction choisie.
+ */
+static char choisirNeurone(const Partie *partie, void *contexte)
+{
+    return deciderReseau(contexte, partie);
+}
+
+/**
+ * @brief Distance de Manhattan entre une case et la pomme la plus proche.
+ *
+ * Les pommes sont lues dans la table des objets, sans parcourir le plateau.
+ *
+ * @param partie La partie.
+ * @param position La case.
+ * @return La distance.
+ */
+static int distancePomme(const Partie *partie, Segment position)
+{
+    const Objets *objets = &partie->objets;
+    int distance = INT_MAX;
+
+    for (int i = 0; i < objets->nombre; i++)
+    {
+        const Objet *objet = &objets->objets[i];
+        int d = abs(position.x - objet->position.x) + abs(position.y - objet->position.y);
+
+        if (objet->type == OBJET_POMME && d < distance)
+        {
+            distance = d;
+        }
+    }
+    return distance;
+}
+
+/**
+ * @brief Compte les cases accessibles depuis une case (parcours en largeur).
+ *
+ * Le corps du serpent est considéré comme immobile.
+ *
+ * @param partie La partie.
+ * @param contexte Tampons du parcours.
+ * @param depart Case de départ (libre).
+ * @param distance_pomme Reçoit la distance jusqu'à la pomme la plus proche, ou INT_MAX si aucune n'est accessible.
+ * @return Le nombre de cases accessibles, départ compris.
+ */
+static int espaceAccessible(const Partie *partie, ContextePrudent *contexte,
+                            Segment depart, int *distance_pomme)
+{
+    int debut = 0, fin = 0;
+    unsigned int numero = ++contexte->parcours;
+    int indice_depart = depart.y * partie->largeur + depart.x;
+
+    *distance_pomme = INT_MAX;
+    contexte->marque[indice_depart] = numero;
+    contexte->distance[indice_depart] = 0;
+    contexte->file[fin++] = indice_depart;
+
+    while (debut < fin)
+    {
+        int indice = contexte->file[debut++];
+        Segment position = {indice % partie->largeur, indice / partie->largeur};
+
+        if (CASE(partie, position.x, position.y) == POMME && *distance_pomme == INT_MAX)
+        {
+            *distance_pomme = contexte->distance[indice];
+        }
+        for (int i = 0; i < 4; i++)
+        {
+            Segment voisine = caseSuivante(partie, position, DIRECTIONS[i]);
+            int indice_voisine = voisine.y * partie->largeur + voisine.x;
+
+            if (contexte->marque[indice_voisine] != numero &&
+                CASE(partie, voisine.x, voisine.y) != COTE_BORDURE &&
+                OCCUPATION(partie, voisine.x, voisine.y) == 0)
+            {
+                contexte->marque[indice_voisine] = numero;
+                contexte->distance[indice_voisine] = contexte->distance[indice] + 1;
+                contexte->file[fin++] = indice_voisine;
+            }
+        }
+    }
+    return fin;
+}
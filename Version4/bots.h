@@ -0,0 +1,50 @@
+/**
+ * @file bots.h
+ * @brief Pilotes automatiques du serpent.
+ *
+ * Une stratégie est un petit ensemble de pointeurs de fonction : elle reçoit
+ * l'état de la partie (plateau et serpent) et renvoie une direction. Le
+ * tournoi (tournoi.c) les fait jouer sur les mêmes plateaux pour les comparer.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef BOTS_H
+#define BOTS_H
+
+#include "jeu.h"
+
+/** @brief Pilote automatique. */
+typedef struct
+{
+    const char *nom;            /**< Nom court, utilisé sur la ligne de commande. */
+    const char *description;    /**< Description en une ligne. */
+    /** Prépare le contexte du pilote pour une partie (peut être NULL) ; renvoie NULL si le pilote ne peut pas jouer. */
+    void *(*creer)(const Partie *partie);
+    /** Choisit la direction du prochain tour. */
+    char (*choisir)(const Partie *partie, void *contexte);
+    /** Libère le contexte créé par creer() (peut être NULL). */
+    void (*detruire)(void *contexte);
+} Strategie;
+
+extern const Strategie STRATEGIES[];    /**< Pilotes disponibles. */
+extern const int NOMBRE_STRATEGIES;     /**< Nombre de pilotes disponibles. */
+
+/* Déclaration des fonctions */
+const Strategie *trouverStrategie(const char *nom);
+
+/* Pilote « hamilton » (hamilton.c) */
+void *creerHamilton(const Partie *partie);
+char choisirHamilton(const Partie *partie, void *contexte);
+void detruireHamilton(void *contexte);
+
+/* Pilote « mcts » (mcts.c) */
+void *creerMcts(const Partie *partie);
+char choisirMcts(const Partie *partie, void *contexte);
+void detruireMcts(void *contexte);
+void limiterThreadsMcts(int parties);
+
+#endif
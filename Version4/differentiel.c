@@ -0,0 +1,840 @@
+/**
+ * @file differentiel.c
+ * @brief Test différentiel du moteur contre la version 4 d'origine.
+ *
+ * Le fichier contient une copie fidèle des règles de la version 4 d'origine
+ * (tableaux lesX/lesY, décalage du corps, ordre des tests de collision,
+ * croissance par duplication de la queue). Seul le hasard est remplacé par le
+ * générateur de la partie, pour que les deux moteurs tirent les mêmes nombres.
+ * Les deux moteurs jouent côte à côte des suites de touches aléatoires ; leurs
+ * empreintes d'état sont comparées après chaque tour. L'empreinte de Zobrist
+ * tenue à jour par le moteur est aussi comparée à son recalcul complet.
+ *
+ * @details
+ * Utilisation : differentiel [-n parties] [-g graine] [-j threads] [-m tours_max] [-r graine:touches]
+ * - -n : nombre de parties à jouer (100000 par défaut).
+ * - -g : graine de la première partie (1 par défaut).
+ * - -j : nombre de threads (nombre de cœurs par défaut).
+ * - -m : nombre maximal de tours par partie (100000 par défaut).
+ * - -r : rejoue un cas (tel qu'affiché par l'outil) et détaille chaque tour.
+ *
+ * Toute divergence est réduite à une suite de touches minimale, affichée sous
+ * la forme graine:touches ('.' = aucune touche pendant ce tour).
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "jeu.h"
+
+#define OBJECTIF_REFERENCE 10       /**< Valeur de OBJECTIF_POMMES dans la version d'origine. */
+#define TAILLE_MAX_SERPENT (TAILLE_SERPENT + OBJECTIF_REFERENCE + 1)   /**< Taille des tableaux de la référence. */
+#define DIVERGENCES_AFFICHEES 5     /**< Nombre maximal de divergences réduites et affichées. */
+#define AUCUNE_TOUCHE '.'           /**< Aucune touche pendant un tour (dans les suites de touches). */
+
+/** @brief État de la version 4 d'origine, regroupé pour être joué en parallèle. */
+typedef struct
+{
+    char plateau[HAUTEUR_PLATEAU][LARGEUR_PLATEAU];     /**< Plateau de jeu. */
+    int lesX[TAILLE_MAX_SERPENT];                       /**< Coordonnées X des segments. */
+    int lesY[TAILLE_MAX_SERPENT];                       /**< Coordonnées Y des segments. */
+    int taille_serpent;                                 /**< Taille du serpent. */
+    int vitesse_actuelle;                               /**< Temporisation courante. */
+    int pommes_mangees;                                 /**< Pommes mangées. */
+    char direction;                                     /**< Direction courante. */
+    int pomme_x;                                        /**< Colonne de la pomme (ajoutée pour l'empreinte). */
+    int pomme_y;                                        /**< Ligne de la pomme (ajoutée pour l'empreinte). */
+    uint32_t aleatoire;                                 /**< Générateur (remplace rand()). */
+} Reference;
+
+/** @brief Paramètres et compteurs partagés par les threads. */
+typedef struct
+{
+    long parties;                   /**< Nombre de parties à jouer. */
+    uint32_t graine;                /**< Graine de la première partie. */
+    long tours_max;                 /**< Nombre maximal de tours par partie. */
+    atomic_long prochaine;          /**< Prochaine partie à jouer. */
+    atomic_long tours;              /**< Tours joués au total. */
+    atomic_long divergences;        /**< Parties divergentes. */
+    pthread_mutex_t affichage;      /**< Protège l'affichage des divergences. */
+} Campagne;
+
+static void *travailleur(void *argument);
+static long jouerPartieAleatoire(uint32_t graine, long tours_max, char *touches, long *divergence);
+static long premiereDivergence(uint32_t graine, const char *touches, long longueur, bool details);
+static long minimiser(uint32_t graine, char *touches, long longueur);
+static char choisirTouche(const Reference *reference, uint32_t *aleatoire);
+static bool referenceSansDanger(const Reference *reference, char direction);
+static Issue jouerTourReference(Reference *reference, char touche_taper);
+static Issue jouerTourCandidat(Partie *partie, char touche_taper);
+static uint64_t empreinteReference(const Reference *reference, Issue issue);
+static uint64_t empreinteCandidat(const Partie *partie, Issue issue);
+static bool memesPlateaux(const Reference *reference, const Partie *partie);
+static void creerReference(Reference *reference, uint32_t graine);
+static void progresserReference(Reference *reference, char direction, bool *collision, bool *pomme_mangee);
+static void initPlateauReference(Reference *reference);
+static void placerPavesReference(Reference *reference);
+static void ajouterPommeReference(Reference *reference);
+
+/**
+ * @brief Lit les options puis lance la campagne ou rejoue un cas.
+ *
+ * @param argc Nombre d'arguments.
+ * @param argv Arguments.
+ * @return EXIT_SUCCESS si aucune divergence n'a été trouvée, EXIT_FAILURE sinon.
+ */
+int main(int argc, char *argv[])
+{
+    Campagne campagne;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *cas = NULL;
+    struct timespec debut, fin;
+    pthread_t *travailleurs;
+    double duree;
+    int option;
+
+    campagne.parties = 100000;
+    campagne.graine = 1;
+    campagne.tours_max = 100000;
+
+    while ((option = getopt(argc, argv, "n:g:j:m:r:")) != -1)
+    {
+        switch (option)
+        {
+            case 'n':
+                campagne.parties = atol(optarg);
+                break;
+            case 'g':
+                campagne.graine = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'j':
+                threads = atol(optarg);
+                break;
+            case 'm':
+                campagne.tours_max = atol(optarg);
+                break;
+            case 'r':
+                cas = optarg;
+                break;
+            default:
+                fprintf(stderr, "Utilisation : %s [-n parties] [-g graine] [-j threads] [-m tours_max] [-r graine:touches]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (cas != NULL)
+    {
+        // Rejeu détaillé d'un cas réduit
+        const char *touches = strchr(cas, ':');
+        uint32_t graine = (uint32_t)strtoul(cas, NULL, 10);
+        long longueur = (touches != NULL) ? (long)strlen(touches + 1) : 0;
+        long divergence = premiereDivergence(graine, touches != NULL ? touches + 1 : "", longueur, true);
+
+        if (divergence < 0)
+        {
+            printf("Aucune divergence en %ld tours\n", longueur);
+            return EXIT_SUCCESS;
+        }
+        printf("Divergence au tour %ld\n", divergence);
+        return EXIT_FAILURE;
+    }
+
+    if (campagne.parties <= 0 || threads <= 0 || campagne.tours_max <= 0)
+    {
+        fprintf(stderr, "%s : les nombres doivent être positifs\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    atomic_init(&campagne.prochaine, 0);
+    atomic_init(&campagne.tours, 0);
+    atomic_init(&campagne.divergences, 0);
+    pthread_mutex_init(&campagne.affichage, NULL);
+    travailleurs = malloc(threads * sizeof(pthread_t));
+    if (travailleurs == NULL)
+    {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    for (long i = 0; i < threads; i++)
+    {
+        pthread_create(&travailleurs[i], NULL, travailleur, &campagne);
+    }
+    for (long i = 0; i < threads; i++)
+    {
+        pthread_join(travailleurs[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+    duree = (fin.tv_sec - debut.tv_sec) + (fin.tv_nsec - debut.tv_nsec) / 1e9;
+
+    printf("%ld parties, %ld tours, %ld divergences en %.2f s (%.0f tours/s, %ld threads)\n",
+           campagne.parties, atomic_load(&campagne.tours), atomic_load(&campagne.divergences),
+           duree, atomic_load(&campagne.tours) / duree, threads);
+
+    free(travailleurs);
+    pthread_mutex_destroy(&campagne.affichage);
+    return (atomic_load(&campagne.divergences) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Boucle d'un thread : joue les parties une à une, réduit et affiche les divergences.
+ *
+ * @param argument La campagne.
+ * @return NULL.
+ */
+static void *travailleur(void *argument)
+{
+    Campagne *campagne = argument;
+    char *touches = malloc(campagne->tours_max);
+    long numero;
+
+    if (touches == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    while ((numero = atomic_fetch_add(&campagne->prochaine, 1)) < campagne->parties)
+    {
+        uint32_t graine = campagne->graine + (uint32_t)numero;
+        long divergence;
+        long tours = jouerPartieAleatoire(graine, campagne->tours_max, touches, &divergence);
+
+        atomic_fetch_add(&campagne->tours, tours);
+        if (divergence >= 0 &&
+            atomic_fetch_add(&campagne->divergences, 1) < DIVERGENCES_AFFICHEES)
+        {
+            long longueur = minimiser(graine, touches, divergence + 1);
+
+            pthread_mutex_lock(&campagne->affichage);
+            printf("Divergence (%ld tours, réduite à %ld) : %u:%.*s\n",
+                   divergence + 1, longueur, graine, (int)longueur, touches);
+            pthread_mutex_unlock(&campagne->affichage);
+        }
+    }
+    free(touches);
+    return NULL;
+}
+
+/**
+ * @brief Joue une partie avec des touches aléatoires sur les deux moteurs.
+ *
+ * Les touches sont tirées à partir de l'état de la référence, de façon à
+ * garder le serpent en vie assez longtemps pour manger des pommes, passer
+ * par les issues et grandir. Elles sont enregistrées pour pouvoir être rejouées.
+ *
+ * @param graine Graine de la partie.
+ * @param tours_max Nombre maximal de tours.
+ * @param touches Reçoit les touches jouées (tours_max octets).
+ * @param divergence Reçoit le premier tour divergent, ou -1.
+ * @return Le nombre de tours joués.
+ */
+static long jouerPartieAleatoire(uint32_t graine, long tours_max, char *touches, long *divergence)
+{
+    Reference *reference = malloc(sizeof(Reference));
+    Partie partie;
+    uint32_t aleatoire = graine * 2654435761u ^ 0x5bd1e995u;
+    Issue issue = PARTIE_EN_COURS;
+    long tour = 0;
+
+    if (reference == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    if (aleatoire == 0)
+    {
+        aleatoire = 1;
+    }
+    creerReference(reference, graine);
+    creerPartie(&partie, graine);
+    *divergence = memesPlateaux(reference, &partie) ? -1 : 0;
+
+    while (*divergence < 0 && issue == PARTIE_EN_COURS && tour < tours_max)
+    {
+        char touche = choisirTouche(reference, &aleatoire);
+        Issue issue_reference = jouerTourReference(reference, touche);
+
+        issue = jouerTourCandidat(&partie, touche);
+        touches[tour] = (touche != 0) ? touche : AUCUNE_TOUCHE;
+        if (empreinteReference(reference, issue_reference) != empreinteCandidat(&partie, issue) ||
+            partie.empreinte != calculerEmpreinte(&partie))
+        {
+            *divergence = tour;
+        }
+        tour++;
+    }
+    if (*divergence < 0 && !memesPlateaux(reference, &partie))
+    {
+        *divergence = tour - 1;
+    }
+
+    detruirePartie(&partie);
+    free(reference);
+    return tour;
+}
+
+/**
+ * @brief Rejoue une suite de touches sur les deux moteurs.
+ *
+ * @param graine Graine de la partie.
+ * @param touches Touches à jouer ('.' ou tout autre caractère : aucune direction).
+ * @param longueur Nombre de tours à jouer.
+ * @param details Affiche l'état des deux moteurs à chaque tour.
+ * @return Le premier tour divergent, ou -1.
+ */
+static long premiereDivergence(uint32_t graine, const char *touches, long longueur, bool details)
+{
+    Reference *reference = malloc(sizeof(Reference));
+    Partie partie;
+    Issue issue = PARTIE_EN_COURS;
+    long divergence = -1;
+
+    if (reference == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    creerReference(reference, graine);
+    creerPartie(&partie, graine);
+    if (!memesPlateaux(reference, &partie))
+    {
+        divergence = 0;
+    }
+
+    for (long tour = 0; divergence < 0 && tour < longueur && issue == PARTIE_EN_COURS; tour++)
+    {
+        Issue issue_reference = jouerTourReference(reference, touches[tour]);
+        uint64_t attendue, obtenue;
+
+        issue = jouerTourCandidat(&partie, touches[tour]);
+        attendue = empreinteReference(reference, issue_reference);
+        obtenue = empreinteCandidat(&partie, issue);
+        if (details)
+        {
+            Segment tete = teteSerpent(&partie.serpent);
+            printf("tour %5ld  touche %c  référence (%2d,%2d) taille %2d issue %d %016llx"
+                   "  moteur (%2d,%2d) taille %2ld issue %d %016llx  zobrist %016llx\n",
+                   tour, touches[tour], reference->lesX[0], reference->lesY[0],
+                   reference->taille_serpent, issue_reference, (unsigned long long)attendue,
+                   tete.x, tete.y, partie.serpent.taille, issue, (unsigned long long)obtenue,
+                   (unsigned long long)partie.empreinte);
+        }
+        if (attendue != obtenue || partie.empreinte != calculerEmpreinte(&partie) ||
+            (issue != PARTIE_EN_COURS && !memesPlateaux(reference, &partie)))
+        {
+            divergence = tour;
+        }
+    }
+
+    detruirePartie(&partie);
+    free(reference);
+    return divergence;
+}
+
+/**
+ * @brief Réduit une suite de touches divergente.
+ *
+ * Retire des blocs de tours de plus en plus petits, puis remplace les touches
+ * restantes par « aucune touche », tant que la divergence persiste. La suite
+ * est ensuite coupée juste après le premier tour divergent.
+ *
+ * @param graine Graine de la partie.
+ * @param touches Touches divergentes, réduites sur place.
+ * @param longueur Nombre de touches.
+ * @return La nouvelle longueur.
+ */
+static long minimiser(uint32_t graine, char *touches, long longueur)
+{
+    char *essai = malloc(longueur);
+    bool progres = true;
+
+    if (essai == NULL)
+    {
+        return longueur;
+    }
+    while (progres)
+    {
+        progres = false;
+        for (long bloc = longueur / 2; bloc >= 1; bloc /= 2)
+        {
+            for (long debut = 0; debut + bloc <= longueur; )
+            {
+                long divergence;
+
+                memcpy(essai, touches, debut);
+                memcpy(essai + debut, touches + debut + bloc, longueur - debut - bloc);
+                divergence = premiereDivergence(graine, essai, longueur - bloc, false);
+                if (divergence >= 0)
+                {
+                    longueur = divergence + 1;
+                    memcpy(touches, essai, longueur);
+                    progres = true;
+                }
+                else
+                {
+                    debut += bloc;
+                }
+            }
+        }
+        for (long tour = 0; tour < longueur; tour++)
+        {
+            char touche = touches[tour];
+
+            if (touche == AUCUNE_TOUCHE)
+            {
+                continue;
+            }
+            touches[tour] = AUCUNE_TOUCHE;
+            if (premiereDivergence(graine, touches, longueur, false) >= 0)
+            {
+                progres = true;
+            }
+            else
+            {
+                touches[tour] = touche;
+            }
+        }
+    }
+    free(essai);
+    return longueur;
+}
+
+/**
+ * @brief Tire la touche d'un tour à partir de l'état de la référence.
+ *
+ * Le plus souvent aucune touche ou une direction sans danger vers la pomme ;
+ * parfois une direction sans danger au hasard, parfois n'importe quelle touche.
+ *
+ * @param reference État de la référence.
+ * @param aleatoire Générateur des touches.
+ * @return La touche, ou 0 pour aucune touche.
+ */
+static char choisirTouche(const Reference *reference, uint32_t *aleatoire)
+{
+    static const char TOUCHES[4] = {HAUT, DROITE, BAS, GAUCHE};
+    uint32_t tirage = tirerAleatoire(aleatoire) % 100;
+    char sures[4];
+    int nombre = 0;
+    char vers_pomme = 0;
+    int distance_min = 1 << 30;
+
+    if (tirage < 5)
+    {
+        return TOUCHES[tirerAleatoire(aleatoire) % 4];
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        if (referenceSansDanger(reference, TOUCHES[i]))
+        {
+            int x = reference->lesX[0] + (TOUCHES[i] == DROITE) - (TOUCHES[i] == GAUCHE);
+            int y = reference->lesY[0] + (TOUCHES[i] == BAS) - (TOUCHES[i] == HAUT);
+            int distance = abs(x - reference->pomme_x) + abs(y - reference->pomme_y);
+
+            sures[nombre++] = TOUCHES[i];
+            if (distance < distance_min)
+            {
+                distance_min = distance;
+                vers_pomme = TOUCHES[i];
+            }
+        }
+    }
+    if (tirage < 35 && referenceSansDanger(reference, reference->direction))
+    {
+        return 0;
+    }
+    if (nombre == 0)
+    {
+        return 0;
+    }
+    if (tirage < 85)
+    {
+        return vers_pomme;
+    }
+    return sures[tirerAleatoire(aleatoire) % nombre];
+}
+
+/**
+ * @brief Indique si une direction est jouable sans collision immédiate pour la référence.
+ *
+ * @param reference État de la référence.
+ * @param direction Direction envisagée.
+ * @return true si la direction n'est pas un demi-tour et ne provoque pas de collision.
+ */
+static bool referenceSansDanger(const Reference *reference, char direction)
+{
+    int x = reference->lesX[0], y = reference->lesY[0];
+
+    if (!directionAutorisee(reference->direction, direction))
+    {
+        return false;
+    }
+    x += (direction == DROITE) - (direction == GAUCHE);
+    y += (direction == BAS) - (direction == HAUT);
+    if (x < 0) x = LARGEUR_PLATEAU - 1;
+    if (x >= LARGEUR_PLATEAU) x = 0;
+    if (y < 0) y = HAUTEUR_PLATEAU - 1;
+    if (y >= HAUTEUR_PLATEAU) y = 0;
+
+    if (reference->plateau[y][x] == COTE_BORDURE)
+    {
+        return false;
+    }
+    for (int i = 0; i < reference->taille_serpent - 1; i++)
+    {
+        if (reference->lesX[i] == x && reference->lesY[i] == y)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Un tour de la boucle principale de la version 4 d'origine.
+ *
+ * @param reference État de la référence.
+ * @param touche_taper Touche lue pendant ce tour (0 : aucune).
+ * @return L'issue du tour.
+ */
+static Issue jouerTourReference(Reference *reference, char touche_taper)
+{
+    bool collision = false;
+    bool pomme_mangee = false;
+
+    // Mise à jour de la direction selon l'entrée
+    if ((touche_taper == HAUT) && (reference->direction != BAS))
+    {
+        reference->direction = HAUT;
+    }
+    else if ((touche_taper == DROITE) && (reference->direction != GAUCHE))
+    {
+        reference->direction = DROITE;
+    }
+    else if ((touche_taper == BAS) && (reference->direction != HAUT))
+    {
+        reference->direction = BAS;
+    }
+    else if ((touche_taper == GAUCHE) && (reference->direction != DROITE))
+    {
+        reference->direction = GAUCHE;
+    }
+
+    progresserReference(reference, reference->direction, &collision, &pomme_mangee);
+
+    if (pomme_mangee)
+    {
+        reference->pommes_mangees++;
+        ajouterPommeReference(reference);
+        // Accélération du jeu et croissance du serpent
+        reference->vitesse_actuelle = reference->vitesse_actuelle - (pomme_mangee * ACCELERATION);
+        reference->taille_serpent++;
+
+        if (reference->pommes_mangees >= OBJECTIF_REFERENCE)
+        {
+            return PARTIE_GAGNEE;
+        }
+    }
+
+    if (collision)
+    {
+        return PARTIE_PERDUE;
+    }
+    return PARTIE_EN_COURS;
+}
+
+/**
+ * @brief Un tour du moteur, avec le traitement des touches du jeu interactif.
+ *
+ * @param partie La partie.
+ * @param touche_taper Touche lue pendant ce tour (0 : aucune).
+ * @return L'issue du tour.
+ */
+static Issue jouerTourCandidat(Partie *partie, char touche_taper)
+{
+    char direction = partie->direction;
+    bool pomme_mangee;
+
+    if ((touche_taper == HAUT || touche_taper == DROITE ||
+         touche_taper == BAS || touche_taper == GAUCHE) &&
+        directionAutorisee(direction, touche_taper))
+    {
+        direction = touche_taper;
+    }
+    return jouerTour(partie, direction, &pomme_mangee);
+}
+
+/**
+ * @brief Empreinte FNV-1a d'une suite d'entiers.
+ *
+ * @param empreinte Empreinte en cours.
+ * @param valeur Valeur à ajouter.
+ * @return La nouvelle empreinte.
+ */
+static uint64_t melanger(uint64_t empreinte, int64_t valeur)
+{
+    for (int octet = 0; octet < 8; octet++)
+    {
+        empreinte ^= (uint64_t)(valeur >> (8 * octet)) & 0xFF;
+        empreinte *= 1099511628211ull;
+    }
+    return empreinte;
+}
+
+/**
+ * @brief Empreinte de l'état de la référence après un tour.
+ *
+ * @param reference État de la référence.
+ * @param issue Issue du tour.
+ * @return L'empreinte.
+ */
+static uint64_t empreinteReference(const Reference *reference, Issue issue)
+{
+    // Lors d'un tour de croissance, taille_serpent compte déjà le segment dupliqué sur la queue
+    int segments = reference->taille_serpent;
+    uint64_t empreinte = 14695981039346656037ull;
+
+    empreinte = melanger(empreinte, issue);
+    empreinte = melanger(empreinte, reference->direction);
+    empreinte = melanger(empreinte, reference->vitesse_actuelle);
+    empreinte = melanger(empreinte, reference->pommes_mangees);
+    empreinte = melanger(empreinte, reference->pomme_x);
+    empreinte = melanger(empreinte, reference->pomme_y);
+    empreinte = melanger(empreinte, segments);
+    for (int i = 0; i < segments; i++)
+    {
+        empreinte = melanger(empreinte, reference->lesX[i]);
+        empreinte = melanger(empreinte, reference->lesY[i]);
+    }
+    return empreinte;
+}
+
+/**
+ * @brief Empreinte de l'état du moteur après un tour.
+ *
+ * @param partie La partie.
+ * @param issue Issue du tour.
+ * @return L'empreinte.
+ */
+static uint64_t empreinteCandidat(const Partie *partie, Issue issue)
+{
+    uint64_t empreinte = 14695981039346656037ull;
+    Parcours parcours;
+    Segment segment;
+
+    empreinte = melanger(empreinte, issue);
+    empreinte = melanger(empreinte, partie->direction);
+    empreinte = melanger(empreinte, partie->vitesse_actuelle);
+    empreinte = melanger(empreinte, partie->pommes_mangees);
+    empreinte = melanger(empreinte, partie->pomme.x);
+    empreinte = melanger(empreinte, partie->pomme.y);
+    empreinte = melanger(empreinte, partie->serpent.taille);
+    debutParcours(&partie->serpent, &parcours);
+    while (segmentSuivant(&parcours, &segment))
+    {
+        empreinte = melanger(empreinte, segment.x);
+        empreinte = melanger(empreinte, segment.y);
+    }
+    return empreinte;
+}
+
+/**
+ * @brief Compare les plateaux des deux moteurs, case par case.
+ *
+ * @param reference État de la référence.
+ * @param partie La partie.
+ * @return true si les plateaux sont identiques.
+ */
+static bool memesPlateaux(const Reference *reference, const Partie *partie)
+{
+    return memcmp(reference->plateau, partie->plateau, sizeof(reference->plateau)) == 0;
+}
+
+/**
+ * @brief Prépare la référence comme le faisait main() dans la version d'origine.
+ *
+ * @param reference État à initialiser.
+ * @param graine Graine du générateur.
+ */
+static void creerReference(Reference *reference, uint32_t graine)
+{
+    reference->vitesse_actuelle = VITESSE_JEU;
+    reference->taille_serpent = TAILLE_SERPENT;
+    reference->pommes_mangees = 0;
+    reference->direction = DROITE;
+    // Même remplacement de la graine nulle que creerPartie()
+    reference->aleatoire = (graine != 0) ? graine : 2463534242u;
+
+    // Initialisation du serpent
+    for (int i = 0; i < reference->taille_serpent; i++)
+    {
+        reference->lesX[i] = (COORD_DEPART_X_SERPENT - i);
+        reference->lesY[i] = COORD_DEPART_Y_SERPENT;
+    }
+
+    initPlateauReference(reference);
+    placerPavesReference(reference);
+    ajouterPommeReference(reference);
+}
+
+/**
+ * @brief progresser() de la version 4 d'origine.
+ *
+ * @param reference État de la référence.
+ * @param direction Direction actuelle du serpent.
+ * @param collision Indicateur de collision.
+ * @param pomme_mangee Indicateur de pomme mangée.
+ */
+static void progresserReference(Reference *reference, char direction, bool *collision, bool *pomme_mangee)
+{
+    int *lesX = reference->lesX;
+    int *lesY = reference->lesY;
+    int taille_serpent = reference->taille_serpent;
+
+    *collision = false;
+    *pomme_mangee = false;
+
+    // Mise à jour des positions du corps
+    for (int i = taille_serpent - 1; i > 0; i--)
+    {
+        lesX[i] = lesX[i - 1];
+        lesY[i] = lesY[i - 1];
+    }
+
+    // Mise à jour de la tête selon la direction
+    switch (direction)
+    {
+        case HAUT:
+            lesY[0]--;
+            break;
+        case BAS:
+            lesY[0]++;
+            break;
+        case DROITE:
+            lesX[0]++;
+            break;
+        case GAUCHE:
+            lesX[0]--;
+            break;
+    }
+
+    // Gestion des télétransportations
+    if (lesX[0] < 0) lesX[0] = LARGEUR_PLATEAU - 1;
+    if (lesX[0] >= LARGEUR_PLATEAU) lesX[0] = 0;
+    if (lesY[0] < 0) lesY[0] = HAUTEUR_PLATEAU - 1;
+    if (lesY[0] >= HAUTEUR_PLATEAU) lesY[0] = 0;
+
+    // Collisions avec le corps
+    for (int i = 1; i < taille_serpent; i++)
+    {
+        if (lesX[0] == lesX[i] && lesY[0] == lesY[i])
+        {
+            *collision = true;
+            return;
+        }
+    }
+
+    // Collisions avec les obstacles
+    if (reference->plateau[lesY[0]][lesX[0]] == COTE_BORDURE)
+    {
+        *collision = true;
+        return;
+    }
+
+    // Gestion des pommes
+    if (reference->plateau[lesY[0]][lesX[0]] == POMME)
+    {
+        *pomme_mangee = true;
+        reference->plateau[lesY[0]][lesX[0]] = VIDE;
+
+        // Ajout d'un nouveau segment à la queue du serpent
+        lesX[taille_serpent] = lesX[taille_serpent - 1];
+        lesY[taille_serpent] = lesY[taille_serpent - 1];
+    }
+}
+
+/**
+ * @brief initPlateau() de la version 4 d'origine.
+ *
+ * @param reference État de la référence.
+ */
+static void initPlateauReference(Reference *reference)
+{
+    for (int i = 0; i < HAUTEUR_PLATEAU; i++)
+    {
+        for (int j = 0; j < LARGEUR_PLATEAU; j++)
+        {
+            if (i == 0 || i == HAUTEUR_PLATEAU - 1 || j == 0 || j == LARGEUR_PLATEAU - 1)
+            {
+                reference->plateau[i][j] = COTE_BORDURE;
+            }
+            else
+            {
+                reference->plateau[i][j] = VIDE;
+            }
+        }
+    }
+    // Créer les issues au centre de chaque côté
+    reference->plateau[0][LARGEUR_PLATEAU/2] = VIDE;
+    reference->plateau[HAUTEUR_PLATEAU-1][LARGEUR_PLATEAU/2] = VIDE;
+    reference->plateau[HAUTEUR_PLATEAU/2][0] = VIDE;
+    reference->plateau[HAUTEUR_PLATEAU/2][LARGEUR_PLATEAU-1] = VIDE;
+}
+
+/**
+ * @brief placerPaves() de la version 4 d'origine (sans le srand(time(NULL))).
+ *
+ * @param reference État de la référence.
+ */
+static void placerPavesReference(Reference *reference)
+{
+    for (int p = 0; p < NOMBRES_PAVES; p++)
+    {
+        int x, y;
+        do {
+            x = tirerAleatoire(&reference->aleatoire) % (LARGEUR_PLATEAU - 2 * TAILLE_PAVE -2) + 2;
+            y = tirerAleatoire(&reference->aleatoire) % (HAUTEUR_PLATEAU - 2 * TAILLE_PAVE -2) + 2;
+        } while (reference->plateau[y][x] == COTE_BORDURE ||
+                ((x >= COORD_DEPART_X_SERPENT - 15) &&
+                 (x <= COORD_DEPART_X_SERPENT + 15) &&
+                 (y >= COORD_DEPART_Y_SERPENT - 15) &&
+                 (y <= COORD_DEPART_Y_SERPENT + 15)));
+
+        for (int i = 0; i < TAILLE_PAVE; i++)
+        {
+            for (int j = 0; j < TAILLE_PAVE; j++)
+            {
+                reference->plateau[y + i][x + j] = COTE_BORDURE;
+            }
+        }
+    }
+}
+
+/**
+ * @brief ajouterPomme() de la version 4 d'origine (la position est retenue pour l'empreinte).
+ *
+ * @param reference État de la référence.
+ */
+static void ajouterPommeReference(Reference *reference)
+{
+    int x, y;
+    do {
+        x = tirerAleatoire(&reference->aleatoire) % (LARGEUR_PLATEAU - 2) + 1;
+        y = tirerAleatoire(&reference->aleatoire) % (HAUTEUR_PLATEAU - 2) + 1;
+    } while (reference->plateau[y][x] != VIDE);
+
+    reference->plateau[y][x] = POMME;
+    reference->pomme_x = x;
+    reference->pomme_y = y;
+}
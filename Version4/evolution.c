@@ -0,0 +1,454 @@
+/**
+ * @file evolution.c
+ * @brief Entraînement du pilote « neurone » par neuroévolution (voir reseau.h).
+ *
+ * Une population de réseaux joue, à chaque génération, la même série de
+ * parties : la partie numéro i utilise la graine (graine de base + i), donc
+ * les mêmes pavés et la même suite de pommes pour tous les réseaux et toutes
+ * les générations, et les scores se comparent. Les parties de toute la
+ * population sont réparties sur tous les cœurs.
+ *
+ * @details
+ * Utilisation : evolution [-g generations] [-n population] [-p parties] [-j threads] [-m tours_max] [-s graine] [-e elite] [-r] [fichier]
+ * - -g : nombre de générations (100 par défaut).
+ * - -n : taille de la population (128 par défaut).
+ * - -p : parties jouées par chaque réseau à chaque génération (8 par défaut).
+ * - -j : nombre de threads (nombre de cœurs par défaut).
+ * - -m : nombre maximal de tours par partie (5000 par défaut).
+ * - -s : graine de la première partie et des tirages génétiques (1 par défaut).
+ * - -e : réseaux gardés tels quels d'une génération à l'autre (8 par défaut) ;
+ *   leur score est conservé, ils ne rejouent pas.
+ * - -r : reprend la population enregistrée dans le fichier au lieu de tirer
+ *   des poids au hasard.
+ * - fichier : reçoit l'élite après chaque génération, le meilleur réseau en
+ *   premier (reseau.poids ou $SNAKE_RESEAU par défaut) ; c'est ce fichier que
+ *   lit le pilote « neurone » du jeu et du tournoi.
+ * - Les parties sont sans fin : elles s'arrêtent à la collision, au maximum
+ *   de tours, ou quand le serpent n'a rien mangé depuis trop longtemps.
+ *   Score d'une partie : 1000 par pomme plus un par tour survécu.
+ * - Nouvelle génération : l'élite, puis des enfants de deux parents choisis
+ *   par tournoi à trois, à croisement uniforme et mutation gaussienne.
+ * - Les règles sont lues une fois dans regles.conf ou $SNAKE_REGLES (voir regles.h).
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "jeu.h"
+#include "reseau.h"
+#include "regles.h"
+#include "vivier.h"
+
+#define POINTS_POMME 1000       /**< Score d'une pomme (un tour survécu vaut 1). */
+#define TAUX_MUTATION 0.05      /**< Probabilité de muter chaque poids d'un enfant. */
+#define ECART_MUTATION 0.2      /**< Écart type d'une mutation. */
+#define ECART_INITIAL 0.5       /**< Écart type des poids tirés au hasard. */
+#define TAILLE_SELECTION 3      /**< Candidats d'une sélection par tournoi. */
+
+/** @brief Population et paramètres partagés par les threads. */
+typedef struct
+{
+    float *genomes;             /**< Poids des réseaux, à la suite (population * POIDS_RESEAU). */
+    double *scores;             /**< Score moyen de chaque réseau. */
+    long *points;               /**< Score de chaque partie, réseau par réseau puis partie par partie. */
+    int population;             /**< Nombre de réseaux. */
+    int parties;                /**< Parties par réseau. */
+    int premier;                /**< Premier réseau à évaluer (les précédents gardent leur score). */
+    uint32_t graine;            /**< Graine de la première partie. */
+    long tours_max;             /**< Nombre maximal de tours par partie. */
+    atomic_int prochaine;       /**< Prochaine partie à jouer. */
+    Vivier vivier;              /**< Parties terminées, recommencées pour les suivantes. */
+} Evolution;
+
+static void *travailleur(void *argument);
+static long jouerPartie(Vivier *vivier, const float *poids, uint32_t graine, long tours_max);
+static void evaluerGeneration(Evolution *evolution, pthread_t *travailleurs, long threads);
+static void classerPopulation(Evolution *evolution);
+static void engendrer(Evolution *evolution, int elite, uint32_t *aleatoire);
+static int selectionner(const Evolution *evolution, uint32_t *aleatoire);
+static double tirerUniforme(uint32_t *aleatoire);
+static double tirerGaussienne(uint32_t *aleatoire);
+static double secondes(void);
+
+/**
+ * @brief Lit les options et fait évoluer la population.
+ *
+ * @param argc Nombre d'arguments.
+ * @param argv Arguments.
+ * @return EXIT_SUCCESS, ou EXIT_FAILURE si les arguments ou le fichier sont invalides.
+ */
+int main(int argc, char *argv[])
+{
+    Evolution evolution;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    pthread_t *travailleurs;
+    int generations = 100;
+    int elite = 8;
+    bool reprise = false;
+    const char *fichier;
+    uint32_t aleatoire;
+    int option;
+
+    evolution.population = 128;
+    evolution.parties = 8;
+    evolution.graine = 1;
+    evolution.tours_max = 5000;
+
+    while ((option = getopt(argc, argv, "g:n:p:j:m:s:e:r")) != -1)
+    {
+        switch (option)
+        {
+            case 'g':
+                generations = atoi(optarg);
+                break;
+            case 'n':
+                evolution.population = atoi(optarg);
+                break;
+            case 'p':
+                evolution.parties = atoi(optarg);
+                break;
+            case 'j':
+                threads = atol(optarg);
+                break;
+            case 'm':
+                evolution.tours_max = atol(optarg);
+                break;
+            case 's':
+                evolution.graine = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'e':
+                elite = atoi(optarg);
+                break;
+            case 'r':
+                reprise = true;
+                break;
+            default:
+                fprintf(stderr, "Utilisation : %s [-g generations] [-n population] [-p parties] [-j threads] [-m tours_max] [-s graine] [-e elite] [-r] [fichier]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (generations <= 0 || evolution.population <= 0 || evolution.parties <= 0 ||
+        threads <= 0 || evolution.tours_max <= 0 || elite <= 0 || elite > evolution.population)
+    {
+        fprintf(stderr, "%s : les nombres doivent être positifs, l'élite au plus égale à la population\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    fichier = (optind < argc) ? argv[optind] : cheminReseau();
+
+    evolution.genomes = malloc((size_t)evolution.population * POIDS_RESEAU * sizeof(float));
+    evolution.scores = malloc(evolution.population * sizeof(double));
+    evolution.points = malloc((size_t)evolution.population * evolution.parties * sizeof(long));
+    travailleurs = malloc(threads * sizeof(pthread_t));
+    if (evolution.genomes == NULL || evolution.scores == NULL || evolution.points == NULL || travailleurs == NULL)
+    {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    if (!chargerRegles(cheminRegles()))
+    {
+        return EXIT_FAILURE;
+    }
+    ouvrirVivier(&evolution.vivier);
+
+    // Population de départ : le fichier repris, complété par des poids tirés au hasard
+    aleatoire = evolution.graine ^ 0x9E3779B9u;
+    if (aleatoire == 0)
+    {
+        aleatoire = 1;
+    }
+    evolution.premier = 0;
+    if (reprise)
+    {
+        evolution.premier = lireReseaux(fichier, evolution.genomes, evolution.population);
+        if (evolution.premier == 0)
+        {
+            fprintf(stderr, "%s : aucun réseau à reprendre dans %s\n", argv[0], fichier);
+            return EXIT_FAILURE;
+        }
+    }
+    for (size_t i = (size_t)evolution.premier * POIDS_RESEAU; i < (size_t)evolution.population * POIDS_RESEAU; i++)
+    {
+        evolution.genomes[i] = (float)(ECART_INITIAL * tirerGaussienne(&aleatoire));
+    }
+    evolution.premier = 0;
+
+    printf("%d réseaux de %d poids, %d parties chacun (graines %u à %u), %ld threads\n\n",
+           evolution.population, POIDS_RESEAU, evolution.parties, evolution.graine,
+           evolution.graine + evolution.parties - 1, threads);
+    printf("%10s %14s %14s %10s\n", "Génération", "Meilleur", "Moyenne", "Durée");
+
+    for (int generation = 1; generation <= generations; generation++)
+    {
+        double debut = secondes();
+        double moyenne = 0.0;
+
+        evaluerGeneration(&evolution, travailleurs, threads);
+        classerPopulation(&evolution);
+        for (int i = 0; i < evolution.population; i++)
+        {
+            moyenne += evolution.scores[i];
+        }
+        printf("%10d %14.1f %14.1f %8.2f s\n", generation, evolution.scores[0],
+               moyenne / evolution.population, secondes() - debut);
+        fflush(stdout);
+
+        if (!ecrireReseaux(fichier, evolution.genomes, elite))
+        {
+            return EXIT_FAILURE;
+        }
+        if (generation < generations)
+        {
+            engendrer(&evolution, elite, &aleatoire);
+        }
+    }
+    printf("\nMeilleurs réseaux enregistrés dans %s\n", fichier);
+
+    fermerVivier(&evolution.vivier);
+    free(travailleurs);
+    free(evolution.points);
+    free(evolution.scores);
+    free(evolution.genomes);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Fait jouer les réseaux à évaluer sur tous les threads.
+ *
+ * @param evolution La population ; les scores des réseaux à partir de premier sont recalculés.
+ * @param travailleurs Identifiants des threads.
+ * @param threads Nombre de threads.
+ */
+static void evaluerGeneration(Evolution *evolution, pthread_t *travailleurs, long threads)
+{
+    atomic_init(&evolution->prochaine, evolution->premier * evolution->parties);
+    for (long i = 0; i < threads; i++)
+    {
+        pthread_create(&travailleurs[i], NULL, travailleur, evolution);
+    }
+    for (long i = 0; i < threads; i++)
+    {
+        pthread_join(travailleurs[i], NULL);
+    }
+
+    for (int r = evolution->premier; r < evolution->population; r++)
+    {
+        long total = 0;
+
+        for (int i = 0; i < evolution->parties; i++)
+        {
+            total += evolution->points[(size_t)r * evolution->parties + i];
+        }
+        evolution->scores[r] = (double)total / evolution->parties;
+    }
+}
+
+/**
+ * @brief Boucle d'un thread : prend les parties une à une jusqu'à la dernière.
+ *
+ * @param argument La population.
+ * @return NULL.
+ */
+static void *travailleur(void *argument)
+{
+    Evolution *evolution = argument;
+    int total = evolution->population * evolution->parties;
+    int numero;
+
+    while ((numero = atomic_fetch_add(&evolution->prochaine, 1)) < total)
+    {
+        int reseau = numero / evolution->parties;
+        int partie = numero % evolution->parties;
+
+        evolution->points[numero] = jouerPartie(&evolution->vivier, evolution->genomes + (size_t)reseau * POIDS_RESEAU,
+                                                evolution->graine + partie, evolution->tours_max);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Joue une partie sans fin avec un réseau.
+ *
+ * La partie s'arrête aussi quand aucune pomme n'a été mangée depuis un quart
+ * du nombre de cases (plus cent tours) : un réseau qui tourne en rond ne
+ * gagne rien à survivre.
+ *
+ * @param vivier Vivier d'où vient la partie et où elle retourne.
+ * @param poids Les poids du réseau.
+ * @param graine Graine de la partie->
+ * @param tours_max Nombre maximal de tours.
+ * @return Le score de la partie->
+ */
+static long jouerPartie(Vivier *vivier, const float *poids, uint32_t graine, long tours_max)
+{
+    Partie *partie = prendrePartie(vivier, graine);
+    Issue issue = PARTIE_EN_COURS;
+    bool pomme_mangee;
+    long famine, dernier_repas = 0;
+    long points;
+
+    partie->objectif_pommes = 0;
+    famine = (long)partie->largeur * partie->hauteur / 4 + 100;
+
+    while (issue == PARTIE_EN_COURS && partie->tour < tours_max &&
+           partie->tour - dernier_repas < famine)
+    {
+        issue = jouerTour(partie, deciderReseau(poids, partie), &pomme_mangee);
+        if (pomme_mangee)
+        {
+            dernier_repas = partie->tour;
+        }
+    }
+
+    points = (long)partie->pommes_mangees * POINTS_POMME + partie->tour;
+    rendrePartie(vivier, partie);
+    return points;
+}
+
+/**
+ * @brief Trie les réseaux du meilleur au moins bon score (tri par insertion).
+ *
+ * @param evolution La population évaluée.
+ */
+static void classerPopulation(Evolution *evolution)
+{
+    float *genome = malloc(POIDS_RESEAU * sizeof(float));
+
+    if (genome == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 1; i < evolution->population; i++)
+    {
+        double score = evolution->scores[i];
+        int j = i;
+
+        if (score <= evolution->scores[i - 1])
+        {
+            continue;
+        }
+        memcpy(genome, evolution->genomes + (size_t)i * POIDS_RESEAU, POIDS_RESEAU * sizeof(float));
+        while (j > 0 && evolution->scores[j - 1] < score)
+        {
+            evolution->scores[j] = evolution->scores[j - 1];
+            j--;
+        }
+        memmove(evolution->genomes + (size_t)(j + 1) * POIDS_RESEAU, evolution->genomes + (size_t)j * POIDS_RESEAU,
+                (size_t)(i - j) * POIDS_RESEAU * sizeof(float));
+        evolution->scores[j] = score;
+        memcpy(evolution->genomes + (size_t)j * POIDS_RESEAU, genome, POIDS_RESEAU * sizeof(float));
+    }
+    free(genome);
+}
+
+/**
+ * @brief Remplace les réseaux hors de l'élite par des enfants des réseaux classés.
+ *
+ * Les parents sont tous lus dans l'ancienne population, copiée avant d'écrire les enfants.
+ *
+ * @param evolution La population classée ; premier reçoit elite.
+ * @param elite Nombre de réseaux gardés tels quels.
+ * @param aleatoire Générateur des tirages génétiques.
+ */
+static void engendrer(Evolution *evolution, int elite, uint32_t *aleatoire)
+{
+    size_t taille = (size_t)evolution->population * POIDS_RESEAU * sizeof(float);
+    float *parents = malloc(taille);
+
+    if (parents == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(parents, evolution->genomes, taille);
+    for (int r = elite; r < evolution->population; r++)
+    {
+        const float *pere = parents + (size_t)selectionner(evolution, aleatoire) * POIDS_RESEAU;
+        const float *mere = parents + (size_t)selectionner(evolution, aleatoire) * POIDS_RESEAU;
+        float *enfant = evolution->genomes + (size_t)r * POIDS_RESEAU;
+
+        for (int i = 0; i < POIDS_RESEAU; i++)
+        {
+            enfant[i] = (tirerAleatoire(aleatoire) & 1) ? pere[i] : mere[i];
+            if (tirerUniforme(aleatoire) < TAUX_MUTATION)
+            {
+                enfant[i] += (float)(ECART_MUTATION * tirerGaussienne(aleatoire));
+            }
+        }
+    }
+    evolution->premier = elite;
+    free(parents);
+}
+
+/**
+ * @brief Choisit un parent par tournoi : le meilleur de TAILLE_SELECTION réseaux tirés au hasard.
+ *
+ * @param evolution La population classée (le plus petit indice est le meilleur).
+ * @param aleatoire Générateur des tirages génétiques.
+ * @return L'indice du parent.
+ */
+static int selectionner(const Evolution *evolution, uint32_t *aleatoire)
+{
+    int choix = evolution->population;
+
+    for (int i = 0; i < TAILLE_SELECTION; i++)
+    {
+        int candidat = (int)(tirerAleatoire(aleatoire) % (uint32_t)evolution->population);
+
+        if (candidat < choix)
+        {
+            choix = candidat;
+        }
+    }
+    return choix;
+}
+
+/**
+ * @brief Tire un réel uniforme dans ]0, 1[.
+ *
+ * @param aleatoire Générateur.
+ * @return Le nombre tiré.
+ */
+static double tirerUniforme(uint32_t *aleatoire)
+{
+    return ((double)tirerAleatoire(aleatoire) + 0.5) / 4294967296.0;
+}
+
+/**
+ * @brief Tire un réel de loi normale centrée réduite (méthode de Box-Muller).
+ *
+ * @param aleatoire Générateur.
+ * @return Le nombre tiré.
+ */
+static double tirerGaussienne(uint32_t *aleatoire)
+{
+    double u = tirerUniforme(aleatoire);
+    double v = tirerUniforme(aleatoire);
+
+    return sqrt(-2.0 * log(u)) * cos(2.0 * M_PI * v);
+}
+
+/**
+ * @brief Horloge monotone en secondes.
+ *
+ * @return L'instant présent.
+ */
+static double secondes(void)
+{
+    struct timespec instant;
+
+    clock_gettime(CLOCK_MONOTONIC, &instant);
+    return (double)instant.tv_sec + instant.tv_nsec / 1e9;
+}
@@ -0,0 +1,221 @@
+/**
+ * @file glyphes.c
+ * @brief Encodage des glyphes et suivi du style courant du terminal.
+ *
+ * @details
+ * - Habillage ASCII : chaque case s'affiche avec son propre caractère, sans
+ *   aucune séquence de couleur (rendu identique à la version 4 d'origine).
+ * - Habillage Unicode : bordures en traits reliés, pavés pleins, serpent,
+ *   pommes et bonus en couleur. Le glyphe d'un mur dépend de ses voisins : son
+ *   identifiant est calculé à partir des cases autour de lui.
+ * - Une case vide s'affiche pareil quelle que soit la couleur courante : elle
+ *   ne provoque jamais l'envoi d'une séquence SGR.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <string.h>
+
+#include "glyphes.h"
+#include "jeu.h"
+
+/** @brief Styles (couleurs) utilisés par l'habillage Unicode. */
+enum
+{
+    STYLE_NEUTRE,       /**< Couleurs par défaut du terminal. */
+    STYLE_MUR,          /**< Bordures et pavés. */
+    STYLE_CORPS,        /**< Corps du serpent. */
+    STYLE_TETE,         /**< Tête du serpent. */
+    STYLE_POMME,        /**< Pomme. */
+    STYLE_BONUS,        /**< Bonus. */
+    NOMBRE_STYLES
+};
+
+/** Séquences SGR de chaque style. */
+static const char *const SEQUENCES_STYLES[NOMBRE_STYLES] =
+{
+    "\033[0m",
+    "\033[0;36m",
+    "\033[0;32m",
+    "\033[0;1;92m",
+    "\033[0;1;91m",
+    "\033[0;1;93m",
+};
+
+/** Murs reliés, indexés par le masque des voisins (1 haut, 2 droite, 4 bas, 8 gauche). */
+static const char *const TRAITS_MURS[16] =
+{
+    "■", "│", "─", "└", "│", "│", "┌", "├",
+    "─", "┘", "─", "┴", "┐", "┤", "┬", "┼",
+};
+
+static Glyphe glyphes[NOMBRE_GLYPHES];  /**< Table des glyphes pré-encodés. */
+static bool murs_relies = false;        /**< Le glyphe des murs dépend des voisins. */
+
+static void encoderGlyphe(uint16_t identifiant, unsigned char style, const char *texte);
+static bool estMur(const char *cases, int largeur, int hauteur, int x, int y);
+
+/**
+ * @brief Pré-encode tous les glyphes de l'habillage choisi.
+ *
+ * @param unicode true pour l'habillage Unicode en couleur, false pour l'ASCII d'origine.
+ */
+void preparerGlyphes(bool unicode)
+{
+    murs_relies = unicode;
+
+    for (int c = 0; c < 256; c++)
+    {
+        char texte[2] = {(char)c, '\0'};
+
+        encoderGlyphe((uint16_t)c, unicode ? STYLE_NEUTRE : STYLE_QUELCONQUE, texte);
+    }
+    encoderGlyphe((unsigned char)VIDE, STYLE_QUELCONQUE, " ");
+
+    if (!unicode)
+    {
+        return;
+    }
+    encoderGlyphe((unsigned char)TETE, STYLE_TETE, "●");
+    encoderGlyphe((unsigned char)CORPS, STYLE_CORPS, "█");
+    encoderGlyphe((unsigned char)POMME, STYLE_POMME, "●");
+    encoderGlyphe((unsigned char)ACCELERATEUR, STYLE_BONUS, "»");
+    encoderGlyphe((unsigned char)RALENTISSEUR, STYLE_BONUS, "«");
+    encoderGlyphe((unsigned char)RETRECISSEUR, STYLE_BONUS, "÷");
+    for (int masque = 0; masque < 16; masque++)
+    {
+        encoderGlyphe(GLYPHE_MUR + masque, STYLE_MUR, TRAITS_MURS[masque]);
+    }
+    encoderGlyphe(GLYPHE_MUR_PLEIN, STYLE_MUR, "█");
+}
+
+/**
+ * @brief Identifiant du glyphe d'une case d'image.
+ *
+ * Pour un mur de l'habillage Unicode, l'identifiant dépend des murs voisins :
+ * un trait pour les bordures, un bloc plein pour les pavés.
+ *
+ * @param cases Cases de l'image, ligne par ligne.
+ * @param largeur Largeur de l'image.
+ * @param hauteur Hauteur de l'image.
+ * @param x Colonne de la case.
+ * @param y Ligne de la case.
+ * @return L'identifiant du glyphe.
+ */
+uint16_t identifiantGlyphe(const char *cases, int largeur, int hauteur, int x, int y)
+{
+    unsigned char c = (unsigned char)cases[(size_t)y * largeur + x];
+    int masque = 0, voisins = 0;
+
+    if (!murs_relies || c != (unsigned char)COTE_BORDURE)
+    {
+        return c;
+    }
+
+    if (estMur(cases, largeur, hauteur, x, y - 1)) masque |= 1;
+    if (estMur(cases, largeur, hauteur, x + 1, y)) masque |= 2;
+    if (estMur(cases, largeur, hauteur, x, y + 1)) masque |= 4;
+    if (estMur(cases, largeur, hauteur, x - 1, y)) masque |= 8;
+    for (int bit = 1; bit < 16; bit <<= 1)
+    {
+        voisins += (masque & bit) != 0;
+    }
+
+    // Trois voisins ou plus, ou un coin rempli en diagonale : intérieur ou bord d'un pavé
+    if (voisins >= 3 ||
+        (masque == 6 && estMur(cases, largeur, hauteur, x + 1, y + 1)) ||
+        (masque == 12 && estMur(cases, largeur, hauteur, x - 1, y + 1)) ||
+        (masque == 3 && estMur(cases, largeur, hauteur, x + 1, y - 1)) ||
+        (masque == 9 && estMur(cases, largeur, hauteur, x - 1, y - 1)))
+    {
+        return GLYPHE_MUR_PLEIN;
+    }
+    return GLYPHE_MUR + masque;
+}
+
+/**
+ * @brief Recopie un glyphe dans le tampon de sortie.
+ *
+ * La séquence SGR n'est recopiée que si le style du glyphe diffère du style
+ * courant du terminal, qui est alors mis à jour.
+ *
+ * @param sortie Tampon de sortie (au moins GLYPHE_OCTETS_MAX octets libres).
+ * @param identifiant Identifiant du glyphe.
+ * @param style_courant Style courant du terminal, mis à jour.
+ * @return Le nombre d'octets écrits.
+ */
+size_t ecrireGlyphe(char *sortie, uint16_t identifiant, unsigned char *style_courant)
+{
+    const Glyphe *glyphe = &glyphes[identifiant];
+
+    if (glyphe->style == STYLE_QUELCONQUE || glyphe->style == *style_courant)
+    {
+        size_t longueur = glyphe->longueur - glyphe->debut_texte;
+        memcpy(sortie, glyphe->octets + glyphe->debut_texte, longueur);
+        return longueur;
+    }
+    *style_courant = glyphe->style;
+    memcpy(sortie, glyphe->octets, glyphe->longueur);
+    return glyphe->longueur;
+}
+
+/**
+ * @brief Remet les couleurs par défaut du terminal si nécessaire.
+ *
+ * @param sortie Tampon de sortie.
+ * @param style_courant Style courant du terminal, mis à jour.
+ * @return Le nombre d'octets écrits.
+ */
+size_t terminerStyle(char *sortie, unsigned char *style_courant)
+{
+    size_t longueur = strlen(SEQUENCES_STYLES[STYLE_NEUTRE]);
+
+    if (*style_courant == STYLE_INCONNU || *style_courant == STYLE_NEUTRE)
+    {
+        return 0;
+    }
+    memcpy(sortie, SEQUENCES_STYLES[STYLE_NEUTRE], longueur);
+    *style_courant = STYLE_NEUTRE;
+    return longueur;
+}
+
+/**
+ * @brief Encode un glyphe : séquence SGR de son style puis texte UTF-8.
+ *
+ * @param identifiant Identifiant du glyphe.
+ * @param style Style du glyphe (ou STYLE_QUELCONQUE : aucune séquence SGR).
+ * @param texte Caractère UTF-8 (une seule case d'affichage).
+ */
+static void encoderGlyphe(uint16_t identifiant, unsigned char style, const char *texte)
+{
+    Glyphe *glyphe = &glyphes[identifiant];
+    const char *sequence = (style == STYLE_QUELCONQUE) ? "" : SEQUENCES_STYLES[style];
+    size_t longueur_sequence = strlen(sequence);
+    size_t longueur_texte = (texte[0] == '\0') ? 1 : strlen(texte);
+
+    memcpy(glyphe->octets, sequence, longueur_sequence);
+    memcpy(glyphe->octets + longueur_sequence, texte, longueur_texte);
+    glyphe->debut_texte = (unsigned char)longueur_sequence;
+    glyphe->longueur = (unsigned char)(longueur_sequence + longueur_texte);
+    glyphe->style = style;
+}
+
+/**
+ * @brief Indique si une case de l'image est un mur (hors de l'image : non).
+ *
+ * @param cases Cases de l'image.
+ * @param largeur Largeur de l'image.
+ * @param hauteur Hauteur de l'image.
+ * @param x Colonne.
+ * @param y Ligne.
+ * @return true pour un mur.
+ */
+static bool estMur(const char *cases, int largeur, int hauteur, int x, int y)
+{
+    return x >= 0 && x < largeur && y >= 0 && y < hauteur &&
+           cases[(size_t)y * largeur + x] == COTE_BORDURE;
+}
@@ -0,0 +1,45 @@
+/**
+ * @file glyphes.h
+ * @brief Table des glyphes pré-encodés du rendu.
+ *
+ * Chaque type de case est encodé une seule fois au démarrage : séquence SGR
+ * de couleur suivie des octets UTF-8 du caractère. Le thread de rendu ne fait
+ * ensuite que recopier des octets, et n'envoie la séquence de couleur que
+ * lorsqu'elle change.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef GLYPHES_H
+#define GLYPHES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GLYPHE_OCTETS_MAX 24    /**< Taille maximale d'un glyphe encodé (SGR + UTF-8). */
+#define GLYPHE_MUR 256          /**< Premier identifiant des murs reliés (+ masque des voisins). */
+#define GLYPHE_MUR_PLEIN 272    /**< Identifiant d'un mur plein (intérieur d'un pavé). */
+#define NOMBRE_GLYPHES 273      /**< Nombre d'identifiants de glyphes. */
+#define STYLE_INCONNU 0xFE      /**< Style courant du terminal inconnu. */
+#define STYLE_QUELCONQUE 0xFF   /**< Glyphe identique quel que soit le style courant. */
+
+/** @brief Glyphe pré-encodé. */
+typedef struct
+{
+    char octets[GLYPHE_OCTETS_MAX]; /**< Séquence SGR puis caractère UTF-8. */
+    unsigned char longueur;         /**< Longueur totale de la séquence. */
+    unsigned char debut_texte;      /**< Position du caractère après la séquence SGR. */
+    unsigned char style;            /**< Style nécessaire (ou STYLE_QUELCONQUE). */
+} Glyphe;
+
+/* Déclaration des fonctions */
+void preparerGlyphes(bool unicode);
+uint16_t identifiantGlyphe(const char *cases, int largeur, int hauteur, int x, int y);
+size_t ecrireGlyphe(char *sortie, uint16_t identifiant, unsigned char *style_courant);
+size_t terminerStyle(char *sortie, unsigned char *style_courant);
+
+#endif
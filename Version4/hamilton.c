@@ -0,0 +1,987 @@
+/**
+ * @file hamilton.c
+ * @brief Pilote « hamilton » : parcours d'un cycle hamiltonien du niveau.
+ *
+ * @details
+ * - Le cycle est construit sur des blocs de 2×2 cases libres : un arbre
+ *   couvrant des blocs donne un cycle qui passe par toutes leurs cases. Les
+ *   cases libres restantes (autour des pavés) sont ensuite insérées deux par
+ *   deux dans le cycle lorsqu'elles longent une de ses arêtes.
+ * - Tant que le corps du serpent est rangé dans l'ordre du cycle, le pilote
+ *   peut prendre un raccourci vers la pomme : la case visée doit rester devant
+ *   la queue, avec une marge pour la croissance. Au-delà de la moitié du
+ *   cycle, il le suit sans raccourci et peut ainsi le remplir entièrement.
+ * - Une pomme hors du cycle est mangée par un détour : un chemin hors du
+ *   cycle qui part d'une case du cycle, passe par la pomme et revient sur le
+ *   cycle plus loin, sans danger. Une pomme au fond d'un couloir sans issue
+ *   reste inaccessible (le serpent ne peut pas faire demi-tour).
+ * - Les cycles sont enregistrés sur disque, un fichier par niveau (empreinte
+ *   des murs), dans le dossier $SNAKE_CYCLES ou, à défaut, « cycles ».
+ * - Le cycle est celui du niveau au départ : il suppose des pavés fixes. Un
+ *   pavé mobile (periode_paves > 0) qui le barre est contourné par un
+ *   déplacement sans danger, puis le serpent rejoint le cycle comme au
+ *   démarrage ; le pilote y survit mais mange peu de pommes (prudent fait
+ *   bien mieux sur ces niveaux).
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "bots.h"
+
+#define MARGE_RACCOURCI 4                   /**< Cases gardées libres devant la queue lors d'un raccourci. */
+#define DOSSIER_CYCLES "cycles"             /**< Dossier des cycles enregistrés (si $SNAKE_CYCLES est absent). */
+#define SIGNATURE_CYCLE "SNKCYC01"          /**< Début d'un fichier de cycle. */
+
+/** Les quatre directions, dans l'ordre où elles sont essayées. */
+static const char DIRECTIONS[4] = {HAUT, DROITE, BAS, GAUCHE};
+
+/** @brief En-tête d'un fichier de cycle. */
+typedef struct
+{
+    char signature[8];      /**< SIGNATURE_CYCLE. */
+    int32_t largeur;        /**< Largeur du plateau. */
+    int32_t hauteur;        /**< Hauteur du plateau. */
+    uint64_t empreinte;     /**< Empreinte du niveau. */
+} EnteteCycle;
+
+/** @brief Contexte du pilote « hamilton ». */
+typedef struct
+{
+    int *rang;          /**< Position de chaque case dans le cycle (-1 : hors du cycle). */
+    int *ancre;         /**< Pour une case hors du cycle : rang de la case d'où le serpent y est entré. */
+    int longueur;       /**< Nombre de cases du cycle. */
+    bool ordonne;       /**< Le corps du serpent est rangé dans l'ordre du cycle. */
+    unsigned int *marque;   /**< Numéro du dernier parcours passé par chaque case. */
+    int *parent;        /**< Case précédente dans le parcours depuis la pomme. */
+    int *branche;       /**< Première case après la pomme sur ce parcours. */
+    int *file;          /**< File du parcours. */
+    int *profondeur;    /**< Nombre de pas depuis la pomme sur ce parcours. */
+    int *bords;         /**< Positions dans la file des cases voisines du cycle. */
+    unsigned int parcours;  /**< Numéro du parcours en cours. */
+    int *detour;        /**< Cases du détour, de la première à la dernière hors du cycle. */
+    int longueur_detour;    /**< Nombre de cases du détour (0 : aucun détour possible). */
+    int etape_detour;   /**< Prochaine case du détour à jouer (longueur_detour : détour fini). */
+    int entree;         /**< Rang de la case du cycle d'où part le détour. */
+    int sortie;         /**< Rang de la case du cycle où revient le détour. */
+    Segment pomme;      /**< Pomme visée par le détour. */
+} ContexteHamilton;
+
+static void construireCycle(const Partie *partie, char *sens);
+static int cycleBlocs(const Partie *partie, int decalage_x, int decalage_y, char *sens);
+static void etendreCycle(const Partie *partie, char *sens);
+static int numeroterCycle(const Partie *partie, const char *sens, int *rang);
+static bool lireCycle(const Partie *partie, const char *chemin, uint64_t empreinte, char *sens);
+static void ecrireCycle(const Partie *partie, const char *chemin, uint64_t empreinte, const char *sens);
+static uint64_t empreinteNiveau(const Partie *partie);
+static int rangCase(const Partie *partie, const ContexteHamilton *contexte, Segment position);
+static int ecart(const ContexteHamilton *contexte, int depart, int arrivee);
+static bool corpsOrdonne(const Partie *partie, const ContexteHamilton *contexte);
+static void planifierDetour(const Partie *partie, ContexteHamilton *contexte);
+static int cheminVersPomme(const ContexteHamilton *contexte, int depart, int *chemin, bool vers_pomme);
+static char choisirDemarrage(const Partie *partie, const ContexteHamilton *contexte);
+static char opposee(char direction);
+static bool estLibre(const Partie *partie, Segment position);
+
+/**
+ * @brief Prépare le cycle du niveau : lu sur disque s'il existe, calculé sinon.
+ *
+ * Le sens de parcours est choisi pour que la tête ne reparte pas vers le cou.
+ *
+ * @param partie La partie.
+ * @return Le contexte alloué.
+ */
+void *creerHamilton(const Partie *partie)
+{
+    size_t cases = (size_t)partie->largeur * partie->hauteur;
+    ContexteHamilton *contexte = malloc(sizeof(ContexteHamilton));
+    const char *dossier = getenv("SNAKE_CYCLES");
+    uint64_t empreinte = empreinteNiveau(partie);
+    char *sens = malloc(cases);
+    char chemin[4096];
+    Segment tete, cou;
+    Parcours parcours;
+
+    if (contexte == NULL || sens == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    contexte->rang = malloc(cases * sizeof(int));
+    contexte->ancre = malloc(cases * sizeof(int));
+    contexte->marque = calloc(cases, sizeof(unsigned int));
+    contexte->parent = malloc(cases * sizeof(int));
+    contexte->branche = malloc(cases * sizeof(int));
+    contexte->file = malloc(cases * sizeof(int));
+    contexte->profondeur = malloc(cases * sizeof(int));
+    contexte->bords = malloc(cases * sizeof(int));
+    contexte->detour = malloc(cases * sizeof(int));
+    if (contexte->rang == NULL || contexte->ancre == NULL || contexte->marque == NULL ||
+        contexte->parent == NULL || contexte->branche == NULL || contexte->file == NULL ||
+        contexte->profondeur == NULL || contexte->bords == NULL || contexte->detour == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < cases; i++)
+    {
+        contexte->ancre[i] = -1;
+    }
+
+    if (dossier == NULL || dossier[0] == '\0')
+    {
+        dossier = DOSSIER_CYCLES;
+    }
+    snprintf(chemin, sizeof(chemin), "%s/%016llx.cyc", dossier, (unsigned long long)empreinte);
+
+    contexte->longueur = 0;
+    if (lireCycle(partie, chemin, empreinte, sens))
+    {
+        contexte->longueur = numeroterCycle(partie, sens, contexte->rang);
+    }
+    if (contexte->longueur == 0)
+    {
+        construireCycle(partie, sens);
+        contexte->longueur = numeroterCycle(partie, sens, contexte->rang);
+        mkdir(dossier, 0777);
+        ecrireCycle(partie, chemin, empreinte, sens);
+    }
+    free(sens);
+
+    // Sens de parcours : la case qui suit la tête ne doit pas être le cou
+    debutParcours(&partie->serpent, &parcours);
+    segmentSuivant(&parcours, &tete);
+    if (segmentSuivant(&parcours, &cou) && contexte->longueur > 0 &&
+        rangCase(partie, contexte, tete) >= 0 &&
+        rangCase(partie, contexte, cou) == (rangCase(partie, contexte, tete) + 1) % contexte->longueur)
+    {
+        for (size_t i = 0; i < cases; i++)
+        {
+            if (contexte->rang[i] >= 0)
+            {
+                contexte->rang[i] = (contexte->longueur - contexte->rang[i]) % contexte->longueur;
+            }
+        }
+    }
+    contexte->ordonne = false;
+    contexte->parcours = 0;
+    contexte->longueur_detour = 0;
+    contexte->etape_detour = 0;
+    contexte->pomme.x = -1;
+    contexte->pomme.y = -1;
+    return contexte;
+}
+
+/**
+ * @brief Choisit la direction : suivre le cycle, ou raccourcir vers la pomme.
+ *
+ * @param partie La partie.
+ * @param contexte Contexte du pilote.
+ * @return La direction choisie.
+ */
+char choisirHamilton(const Partie *partie, void *contexte)
+{
+    ContexteHamilton *hamilton = contexte;
+    Segment tete = teteSerpent(&partie->serpent);
+    Segment pomme = partie->pomme;
+    int rang_tete, libre, rang_pomme, cible = -1, reserve = 0;
+    char choix = 0;
+    int meilleur = 0;
+    bool en_detour, raccourcis;
+
+    if (hamilton->longueur == 0)
+    {
+        return partie->direction;
+    }
+    if (!hamilton->ordonne)
+    {
+        hamilton->ordonne = corpsOrdonne(partie, hamilton);
+        if (!hamilton->ordonne)
+        {
+            return choisirDemarrage(partie, hamilton);
+        }
+    }
+
+    // Passé la moitié du cycle, plus de raccourci : les trous laissés dans le corps se referment
+    raccourcis = partie->serpent.taille * 2 < hamilton->longueur;
+    rang_tete = rangCase(partie, hamilton, tete);
+    en_detour = hamilton->rang[(size_t)tete.y * partie->largeur + tete.x] < 0;
+    libre = ecart(hamilton, rang_tete, rangCase(partie, hamilton, queueSerpent(&partie->serpent)));
+    if (libre == 0)
+    {
+        libre = hamilton->longueur;
+    }
+
+    // Pendant un détour, les cases hors du cycle sont jouées une à une
+    if (en_detour && hamilton->etape_detour < hamilton->longueur_detour)
+    {
+        int suivante = hamilton->detour[hamilton->etape_detour];
+
+        for (int i = 0; i < 4; i++)
+        {
+            Segment arrivee = caseSuivante(partie, tete, DIRECTIONS[i]);
+
+            if ((size_t)arrivee.y * partie->largeur + arrivee.x == (size_t)suivante &&
+                directionAutorisee(partie->direction, DIRECTIONS[i]) &&
+                deplacementSansDanger(partie, DIRECTIONS[i]))
+            {
+                hamilton->ancre[suivante] = hamilton->entree;
+                hamilton->etape_detour++;
+                return DIRECTIONS[i];
+            }
+        }
+        // Chemin barré : retour au cycle dès que possible
+        hamilton->etape_detour = hamilton->longueur_detour;
+    }
+
+    // Rang à ne pas dépasser : la pomme, ou la case d'entrée du détour qui y mène
+    rang_pomme = hamilton->rang[(size_t)pomme.y * partie->largeur + pomme.x];
+    if (rang_pomme >= 0)
+    {
+        cible = rang_pomme;
+    }
+    else if (!en_detour)
+    {
+        if (pomme.x != hamilton->pomme.x || pomme.y != hamilton->pomme.y ||
+            hamilton->longueur_detour == 0)
+        {
+            planifierDetour(partie, hamilton);
+        }
+        if (hamilton->longueur_detour > 0)
+        {
+            // Les raccourcis doivent laisser la place de faire le détour en arrivant
+            cible = hamilton->entree;
+            reserve = ecart(hamilton, hamilton->entree, hamilton->sortie) + hamilton->longueur_detour;
+        }
+    }
+    if (cible >= 0 && ecart(hamilton, rang_tete, cible) >= libre)
+    {
+        // Sous le corps : le serpent la rejoindra en suivant le cycle
+        cible = -1;
+    }
+
+    for (int i = 0; i < 4; i++)
+    {
+        char direction = DIRECTIONS[i];
+        Segment arrivee;
+        int rang_arrivee, avance;
+
+        if (!directionAutorisee(partie->direction, direction) ||
+            !deplacementSansDanger(partie, direction))
+        {
+            continue;
+        }
+        arrivee = caseSuivante(partie, tete, direction);
+        rang_arrivee = hamilton->rang[(size_t)arrivee.y * partie->largeur + arrivee.x];
+
+        if (rang_arrivee < 0)
+        {
+            // Début du détour vers une pomme hors du cycle
+            size_t indice = (size_t)arrivee.y * partie->largeur + arrivee.x;
+
+            if (!en_detour && cible >= 0 && rang_pomme < 0 && rang_tete == hamilton->entree &&
+                hamilton->detour[0] == (int)indice &&
+                ecart(hamilton, rang_tete, hamilton->sortie) + hamilton->longueur_detour + MARGE_RACCOURCI < libre)
+            {
+                hamilton->ancre[indice] = rang_tete;
+                hamilton->etape_detour = 1;
+                return direction;
+            }
+            continue;
+        }
+
+        avance = ecart(hamilton, rang_tete, rang_arrivee);
+        if (avance == 0 || avance >= libre)
+        {
+            continue;
+        }
+        if (!en_detour && avance > 1 &&
+            (cible < 0 || !raccourcis || avance > ecart(hamilton, rang_tete, cible) ||
+             avance + MARGE_RACCOURCI + reserve >= libre))
+        {
+            continue;
+        }
+        // Au retour d'un détour, la plus petite avance ; sinon, la plus grande
+        if (choix == 0 || (en_detour ? avance < meilleur : avance > meilleur))
+        {
+            choix = direction;
+            meilleur = avance;
+        }
+    }
+    if (choix == 0)
+    {
+        // Cycle barré (pavé mobile) : contournement, puis retour au cycle comme au démarrage
+        hamilton->ordonne = false;
+        hamilton->etape_detour = hamilton->longueur_detour;
+        return choisirDemarrage(partie, hamilton);
+    }
+    return choix;
+}
+
+/**
+ * @brief Libère le contexte du pilote « hamilton ».
+ *
+ * @param contexte Contexte à libérer.
+ */
+void detruireHamilton(void *contexte)
+{
+    ContexteHamilton *hamilton = contexte;
+
+    free(hamilton->rang);
+    free(hamilton->ancre);
+    free(hamilton->marque);
+    free(hamilton->parent);
+    free(hamilton->branche);
+    free(hamilton->file);
+    free(hamilton->profondeur);
+    free(hamilton->bords);
+    free(hamilton->detour);
+    free(hamilton);
+}
+
+/**
+ * @brief Construit le plus long cycle parmi les quatre alignements possibles des blocs.
+ *
+ * @param partie La partie.
+ * @param sens Reçoit, pour chaque case, la direction vers la case suivante du cycle (0 : hors du cycle).
+ */
+static void construireCycle(const Partie *partie, char *sens)
+{
+    size_t cases = (size_t)partie->largeur * partie->hauteur;
+    char *essai = malloc(cases);
+    int meilleur = -1;
+
+    if (essai == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (int decalage = 0; decalage < 4; decalage++)
+    {
+        int longueur = cycleBlocs(partie, decalage % 2, decalage / 2, essai);
+
+        if (longueur > 0)
+        {
+            etendreCycle(partie, essai);
+            longueur = 0;
+            for (size_t i = 0; i < cases; i++)
+            {
+                longueur += (essai[i] != 0);
+            }
+        }
+        if (longueur > meilleur)
+        {
+            meilleur = longueur;
+            memcpy(sens, essai, cases);
+        }
+    }
+    free(essai);
+}
+
+/**
+ * @brief Cycle qui passe par toutes les cases des blocs 2×2 libres reliés à la tête.
+ *
+ * Chaque bloc forme seul un petit cycle ; chaque arête de l'arbre couvrant
+ * (parcours en largeur des blocs) fusionne les cycles de deux blocs voisins
+ * en remplaçant deux arêtes parallèles par deux arêtes qui les relient.
+ *
+ * @param partie La partie.
+ * @param decalage_x Colonne du premier bloc (0 ou 1).
+ * @param decalage_y Ligne du premier bloc (0 ou 1).
+ * @param sens Reçoit la direction vers la case suivante de chaque case (0 : hors du cycle).
+ * @return Le nombre de blocs du cycle.
+ */
+static int cycleBlocs(const Partie *partie, int decalage_x, int decalage_y, char *sens)
+{
+    int largeur = (partie->largeur - decalage_x) / 2;
+    int hauteur = (partie->hauteur - decalage_y) / 2;
+    int blocs = largeur * hauteur;
+    unsigned char *etat = calloc(blocs, 1);     // 1 : libre, 2 : atteint
+    unsigned char *liens = calloc(blocs, 1);    // 1 : relié à droite, 2 : relié en bas
+    int *file = malloc(blocs * sizeof(int));
+    Segment tete = teteSerpent(&partie->serpent);
+    int depart = -1, debut = 0, fin = 0;
+
+    if (etat == NULL || liens == NULL || file == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    memset(sens, 0, (size_t)partie->largeur * partie->hauteur);
+
+    for (int b = 0; b < blocs; b++)
+    {
+        int x = decalage_x + 2 * (b % largeur), y = decalage_y + 2 * (b / largeur);
+
+        etat[b] = CASE(partie, x, y) != COTE_BORDURE && CASE(partie, x + 1, y) != COTE_BORDURE &&
+                  CASE(partie, x, y + 1) != COTE_BORDURE && CASE(partie, x + 1, y + 1) != COTE_BORDURE;
+        if (etat[b] && (depart < 0 ||
+                        ((tete.x - decalage_x) / 2 == b % largeur && (tete.y - decalage_y) / 2 == b / largeur)))
+        {
+            depart = b;
+        }
+    }
+    if (depart >= 0)
+    {
+        etat[depart] = 2;
+        file[fin++] = depart;
+    }
+
+    // Arbre couvrant des blocs libres
+    while (debut < fin)
+    {
+        int b = file[debut++], bx = b % largeur, by = b / largeur;
+        int voisins[4] = {by > 0 ? b - largeur : -1, bx < largeur - 1 ? b + 1 : -1,
+                          by < hauteur - 1 ? b + largeur : -1, bx > 0 ? b - 1 : -1};
+
+        for (int i = 0; i < 4; i++)
+        {
+            int v = voisins[i];
+
+            if (v < 0 || etat[v] != 1)
+            {
+                continue;
+            }
+            etat[v] = 2;
+            file[fin++] = v;
+            switch (i)
+            {
+                case 0: liens[v] |= 2; break;
+                case 1: liens[b] |= 1; break;
+                case 2: liens[b] |= 2; break;
+                case 3: liens[v] |= 1; break;
+            }
+        }
+    }
+
+    // Chaque bloc tourne sur lui-même, sauf là où l'arbre le relie à un voisin
+    for (int i = 0; i < fin; i++)
+    {
+        int b = file[i], bx = b % largeur, by = b / largeur;
+        int x = decalage_x + 2 * bx, y = decalage_y + 2 * by;
+        bool relie_gauche = bx > 0 && (liens[b - 1] & 1);
+        bool relie_haut = by > 0 && (liens[b - largeur] & 2);
+
+        sens[(size_t)y * partie->largeur + x] = relie_gauche ? GAUCHE : BAS;
+        sens[(size_t)y * partie->largeur + x + 1] = relie_haut ? HAUT : GAUCHE;
+        sens[(size_t)(y + 1) * partie->largeur + x + 1] = (liens[b] & 1) ? DROITE : HAUT;
+        sens[(size_t)(y + 1) * partie->largeur + x] = (liens[b] & 2) ? BAS : DROITE;
+    }
+
+    free(etat);
+    free(liens);
+    free(file);
+    return fin;
+}
+
+/**
+ * @brief Insère dans le cycle les paires de cases libres qui longent une de ses arêtes.
+ *
+ * L'arête a → b devient a → c → d → b, où c et d sont les voisines de a et b
+ * du même côté.
+ *
+ * @param partie La partie.
+ * @param sens Directions du cycle, modifiées.
+ */
+static void etendreCycle(const Partie *partie, char *sens)
+{
+    bool insere = true;
+
+    while (insere)
+    {
+        insere = false;
+        for (int y = 0; y < partie->hauteur; y++)
+        {
+            for (int x = 0; x < partie->largeur; x++)
+            {
+                Segment a = {x, y}, b;
+                char direction = sens[(size_t)y * partie->largeur + x];
+                char cotes[2];
+
+                if (direction == 0)
+                {
+                    continue;
+                }
+                b = caseSuivante(partie, a, direction);
+                cotes[0] = (direction == HAUT || direction == BAS) ? GAUCHE : HAUT;
+                cotes[1] = opposee(cotes[0]);
+
+                for (int i = 0; i < 2; i++)
+                {
+                    Segment c = caseSuivante(partie, a, cotes[i]);
+                    Segment d = caseSuivante(partie, b, cotes[i]);
+                    Segment apres_c = caseSuivante(partie, c, direction);
+                    size_t indice_c = (size_t)c.y * partie->largeur + c.x;
+                    size_t indice_d = (size_t)d.y * partie->largeur + d.x;
+
+                    if (estLibre(partie, c) && estLibre(partie, d) &&
+                        sens[indice_c] == 0 && sens[indice_d] == 0 && indice_c != indice_d &&
+                        apres_c.x == d.x && apres_c.y == d.y)
+                    {
+                        sens[(size_t)y * partie->largeur + x] = cotes[i];
+                        sens[indice_c] = direction;
+                        sens[indice_d] = opposee(cotes[i]);
+                        insere = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Vérifie le cycle et numérote ses cases dans l'ordre de parcours.
+ *
+ * @param partie La partie.
+ * @param sens Directions du cycle.
+ * @param rang Reçoit le rang de chaque case (-1 : hors du cycle).
+ * @return La longueur du cycle, ou 0 s'il n'est pas valide pour ce niveau.
+ */
+static int numeroterCycle(const Partie *partie, const char *sens, int *rang)
+{
+    size_t cases = (size_t)partie->largeur * partie->hauteur;
+    int attendues = 0, longueur = 0;
+    Segment position = {-1, -1};
+
+    for (size_t i = 0; i < cases; i++)
+    {
+        rang[i] = -1;
+        if (sens[i] != 0)
+        {
+            if (attendues == 0)
+            {
+                position.x = (int)(i % partie->largeur);
+                position.y = (int)(i / partie->largeur);
+            }
+            attendues++;
+        }
+    }
+    if (attendues < 4)
+    {
+        return 0;
+    }
+
+    while (longueur < attendues)
+    {
+        size_t indice = (size_t)position.y * partie->largeur + position.x;
+        char direction = sens[indice];
+
+        if (rang[indice] >= 0 || !estLibre(partie, position) ||
+            (direction != HAUT && direction != DROITE && direction != BAS && direction != GAUCHE))
+        {
+            return 0;
+        }
+        rang[indice] = longueur++;
+        position = caseSuivante(partie, position, direction);
+    }
+    // Le parcours doit revenir à son point de départ
+    return rang[(size_t)position.y * partie->largeur + position.x] == 0 ? longueur : 0;
+}
+
+/**
+ * @brief Lit un cycle enregistré pour ce niveau.
+ *
+ * @param partie La partie.
+ * @param chemin Fichier du cycle.
+ * @param empreinte Empreinte du niveau.
+ * @param sens Reçoit les directions du cycle.
+ * @return true si le fichier existe et correspond au niveau.
+ */
+static bool lireCycle(const Partie *partie, const char *chemin, uint64_t empreinte, char *sens)
+{
+    size_t cases = (size_t)partie->largeur * partie->hauteur;
+    FILE *fichier = fopen(chemin, "rb");
+    EnteteCycle entete;
+    bool lu;
+
+    if (fichier == NULL)
+    {
+        return false;
+    }
+    lu = fread(&entete, sizeof(entete), 1, fichier) == 1 &&
+         memcmp(entete.signature, SIGNATURE_CYCLE, sizeof(entete.signature)) == 0 &&
+         entete.largeur == partie->largeur && entete.hauteur == partie->hauteur &&
+         entete.empreinte == empreinte &&
+         fread(sens, 1, cases, fichier) == cases;
+    fclose(fichier);
+    return lu;
+}
+
+/**
+ * @brief Enregistre le cycle du niveau.
+ *
+ * Le fichier est écrit sous un nom temporaire puis renommé : un autre
+ * processus ou thread ne lit jamais un cycle à moitié écrit. Une erreur
+ * d'écriture est sans conséquence (le cycle sera recalculé).
+ *
+ * @param partie La partie.
+ * @param chemin Fichier du cycle.
+ * @param empreinte Empreinte du niveau.
+ * @param sens Directions du cycle.
+ */
+static void ecrireCycle(const Partie *partie, const char *chemin, uint64_t empreinte, const char *sens)
+{
+    size_t cases = (size_t)partie->largeur * partie->hauteur;
+    EnteteCycle entete;
+    char temporaire[4096 + 16];
+    FILE *fichier;
+    int descripteur;
+    bool ecrit;
+
+    snprintf(temporaire, sizeof(temporaire), "%s.XXXXXX", chemin);
+    descripteur = mkstemp(temporaire);
+    if (descripteur < 0)
+    {
+        return;
+    }
+    fichier = fdopen(descripteur, "wb");
+    if (fichier == NULL)
+    {
+        close(descripteur);
+        unlink(temporaire);
+        return;
+    }
+
+    memset(&entete, 0, sizeof(entete));
+    memcpy(entete.signature, SIGNATURE_CYCLE, sizeof(entete.signature));
+    entete.largeur = partie->largeur;
+    entete.hauteur = partie->hauteur;
+    entete.empreinte = empreinte;
+    ecrit = fwrite(&entete, sizeof(entete), 1, fichier) == 1 &&
+            fwrite(sens, 1, cases, fichier) == cases;
+    if (fclose(fichier) != 0 || !ecrit || rename(temporaire, chemin) != 0)
+    {
+        unlink(temporaire);
+    }
+}
+
+/**
+ * @brief Empreinte FNV-1a du niveau : dimensions, murs et position de départ de la tête.
+ *
+ * @param partie La partie.
+ * @return L'empreinte.
+ */
+static uint64_t empreinteNiveau(const Partie *partie)
+{
+    size_t cases = (size_t)partie->largeur * partie->hauteur;
+    Segment tete = teteSerpent(&partie->serpent);
+    int valeurs[4] = {partie->largeur, partie->hauteur, tete.x, tete.y};
+    uint64_t empreinte = 14695981039346656037ull;
+
+    for (int i = 0; i < 4; i++)
+    {
+        for (int octet = 0; octet < 4; octet++)
+        {
+            empreinte ^= (uint64_t)((valeurs[i] >> (8 * octet)) & 0xFF);
+            empreinte *= 1099511628211ull;
+        }
+    }
+    for (size_t i = 0; i < cases; i++)
+    {
+        empreinte ^= (uint64_t)(partie->plateau[i] == COTE_BORDURE);
+        empreinte *= 1099511628211ull;
+    }
+    return empreinte;
+}
+
+/**
+ * @brief Rang d'une case du serpent : son rang dans le cycle, ou celui de son ancre.
+ *
+ * @param partie La partie.
+ * @param contexte Contexte du pilote.
+ * @param position La case.
+ * @return Le rang, ou -1 pour une case hors du cycle sans ancre.
+ */
+static int rangCase(const Partie *partie, const ContexteHamilton *contexte, Segment position)
+{
+    size_t indice = (size_t)position.y * partie->largeur + position.x;
+
+    return (contexte->rang[indice] >= 0) ? contexte->rang[indice] : contexte->ancre[indice];
+}
+
+/**
+ * @brief Nombre de pas pour aller d'un rang à un autre en suivant le cycle.
+ *
+ * @param contexte Contexte du pilote.
+ * @param depart Rang de départ.
+ * @param arrivee Rang d'arrivée.
+ * @return L'écart, entre 0 et la longueur du cycle - 1.
+ */
+static int ecart(const ContexteHamilton *contexte, int depart, int arrivee)
+{
+    return (arrivee - depart + contexte->longueur) % contexte->longueur;
+}
+
+/**
+ * @brief Indique si le corps est rangé de la queue à la tête dans l'ordre du cycle,
+ * sur moins d'un tour.
+ *
+ * @param partie La partie.
+ * @param contexte Contexte du pilote.
+ * @return true si le corps est ordonné.
+ */
+static bool corpsOrdonne(const Partie *partie, const ContexteHamilton *contexte)
+{
+    Parcours parcours;
+    Segment segment;
+    int precedent = -1;
+    long total = 0;
+
+    debutParcours(&partie->serpent, &parcours);
+    while (segmentSuivant(&parcours, &segment))
+    {
+        int rang = rangCase(partie, contexte, segment);
+
+        if (rang < 0)
+        {
+            return false;
+        }
+        if (precedent >= 0)
+        {
+            total += ecart(contexte, rang, precedent);
+            if (total >= contexte->longueur)
+            {
+                return false;
+            }
+        }
+        precedent = rang;
+    }
+    return true;
+}
+
+/**
+ * @brief Prépare le détour vers la pomme, si elle est hors du cycle.
+ *
+ * Un parcours en largeur depuis la pomme, sur les cases libres hors du cycle,
+ * donne un chemin vers chaque case atteinte. Le détour relie deux de ces
+ * cases voisines du cycle par des chemins qui ne partagent que la pomme
+ * (ils quittent la pomme par des cases différentes). Parmi les détours
+ * possibles, retient celui qui saute le moins de cases du cycle.
+ *
+ * @param partie La partie.
+ * @param contexte Contexte du pilote.
+ */
+static void planifierDetour(const Partie *partie, ContexteHamilton *contexte)
+{
+    int largeur = partie->largeur;
+    int depart = partie->pomme.y * largeur + partie->pomme.x;
+    unsigned int numero = ++contexte->parcours;
+    int debut = 0, fin = 0, nombre_bords = 0, meilleur = -1;
+    int meilleure_entree = -1, meilleure_sortie = -1;
+
+    contexte->pomme = partie->pomme;
+    contexte->longueur_detour = 0;
+    contexte->etape_detour = 0;
+
+    contexte->marque[depart] = numero;
+    contexte->parent[depart] = -1;
+    contexte->branche[depart] = -1;
+    contexte->profondeur[depart] = 0;
+    contexte->file[fin++] = depart;
+    while (debut < fin)
+    {
+        int indice = contexte->file[debut++];
+        Segment position = {indice % largeur, indice / largeur};
+
+        for (int i = 0; i < 4; i++)
+        {
+            Segment voisine = caseSuivante(partie, position, DIRECTIONS[i]);
+            int indice_voisine = voisine.y * largeur + voisine.x;
+
+            if (contexte->marque[indice_voisine] != numero && contexte->rang[indice_voisine] < 0 &&
+                estLibre(partie, voisine) && OCCUPATION(partie, voisine.x, voisine.y) == 0)
+            {
+                contexte->marque[indice_voisine] = numero;
+                contexte->parent[indice_voisine] = indice;
+                contexte->branche[indice_voisine] = (indice == depart) ? indice_voisine : contexte->branche[indice];
+                contexte->profondeur[indice_voisine] = contexte->profondeur[indice] + 1;
+                contexte->file[fin++] = indice_voisine;
+            }
+        }
+    }
+
+    // Seules les cases voisines du cycle peuvent commencer ou finir un détour
+    for (int i = 0; i < fin; i++)
+    {
+        Segment position = {contexte->file[i] % largeur, contexte->file[i] / largeur};
+
+        for (int a = 0; a < 4; a++)
+        {
+            Segment voisine = caseSuivante(partie, position, DIRECTIONS[a]);
+
+            if (contexte->rang[voisine.y * largeur + voisine.x] >= 0)
+            {
+                contexte->bords[nombre_bords++] = i;
+                break;
+            }
+        }
+    }
+
+    // Couples (case d'entrée, case de sortie) voisins du cycle
+    for (int k = 0; k < nombre_bords; k++)
+    {
+        for (int l = 0; l < nombre_bords; l++)
+        {
+            int i = contexte->bords[k], j = contexte->bords[l];
+            int u = contexte->file[i], v = contexte->file[j];
+            // Cases du détour : de u à la pomme, puis de la pomme à v
+            int longueur_chemin = 1 + contexte->profondeur[u] + contexte->profondeur[v];
+
+            if ((u != depart && v != depart && contexte->branche[u] == contexte->branche[v]) ||
+                (u == v && u != depart))
+            {
+                continue;
+            }
+
+            for (int a = 0; a < 4; a++)
+            {
+                Segment voisine_u = caseSuivante(partie, (Segment){u % largeur, u / largeur}, DIRECTIONS[a]);
+                int entree = contexte->rang[voisine_u.y * largeur + voisine_u.x];
+
+                if (entree < 0)
+                {
+                    continue;
+                }
+                for (int b = 0; b < 4; b++)
+                {
+                    Segment voisine_v = caseSuivante(partie, (Segment){v % largeur, v / largeur}, DIRECTIONS[b]);
+                    int sortie = contexte->rang[voisine_v.y * largeur + voisine_v.x];
+                    int cout = ecart(contexte, entree, sortie) + longueur_chemin;
+
+                    if (sortie >= 0 && sortie != entree && (meilleur < 0 || cout < meilleur))
+                    {
+                        meilleur = cout;
+                        meilleure_entree = i;
+                        meilleure_sortie = j;
+                        contexte->entree = entree;
+                        contexte->sortie = sortie;
+                    }
+                }
+            }
+        }
+    }
+    if (meilleur < 0)
+    {
+        return;
+    }
+
+    // Détour : de la case d'entrée jusqu'à la pomme, puis de la pomme à la case de sortie
+    contexte->longueur_detour = cheminVersPomme(contexte, contexte->file[meilleure_entree],
+                                                contexte->detour, true);
+    contexte->longueur_detour += cheminVersPomme(contexte, contexte->file[meilleure_sortie],
+                                                 contexte->detour + contexte->longueur_detour, false);
+}
+
+/**
+ * @brief Recopie le chemin entre une case atteinte par le parcours et la pomme.
+ *
+ * @param contexte Contexte du pilote (parcours depuis la pomme).
+ * @param depart Case atteinte.
+ * @param chemin Reçoit les cases du chemin.
+ * @param vers_pomme true : de la case vers la pomme comprise ; false : de la
+ *        case qui suit la pomme jusqu'à la case atteinte.
+ * @return Le nombre de cases recopiées.
+ */
+static int cheminVersPomme(const ContexteHamilton *contexte, int depart, int *chemin, bool vers_pomme)
+{
+    int longueur = 0;
+
+    for (int c = depart; c >= 0 && (vers_pomme || contexte->parent[c] >= 0); c = contexte->parent[c])
+    {
+        chemin[longueur++] = c;
+    }
+    if (!vers_pomme)
+    {
+        for (int i = 0; i < longueur / 2; i++)
+        {
+            int echange = chemin[i];
+            chemin[i] = chemin[longueur - 1 - i];
+            chemin[longueur - 1 - i] = echange;
+        }
+    }
+    return longueur;
+}
+
+/**
+ * @brief Direction au démarrage, tant que le corps n'est pas rangé dans l'ordre du cycle.
+ *
+ * Rejoint le cycle puis le suit ; au bout d'autant de tours que le serpent a
+ * de segments, le corps est entièrement sur le cycle.
+ *
+ * @param partie La partie.
+ * @param contexte Contexte du pilote.
+ * @return La direction choisie.
+ */
+static char choisirDemarrage(const Partie *partie, const ContexteHamilton *contexte)
+{
+    Segment tete = teteSerpent(&partie->serpent);
+    int rang_tete = contexte->rang[(size_t)tete.y * partie->largeur + tete.x];
+    char choix = partie->direction;
+    int meilleur = contexte->longueur + 1;
+
+    for (int i = 0; i < 4; i++)
+    {
+        char direction = DIRECTIONS[i];
+        Segment arrivee;
+        int rang, avance;
+
+        if (!directionAutorisee(partie->direction, direction) ||
+            !deplacementSansDanger(partie, direction))
+        {
+            continue;
+        }
+        arrivee = caseSuivante(partie, tete, direction);
+        rang = contexte->rang[(size_t)arrivee.y * partie->largeur + arrivee.x];
+        avance = (rang < 0) ? contexte->longueur : (rang_tete < 0) ? 1 : ecart(contexte, rang_tete, rang);
+        if (avance > 0 && avance < meilleur)
+        {
+            meilleur = avance;
+            choix = direction;
+        }
+    }
+    return choix;
+}
+
+/**
+ * @brief Direction opposée.
+ *
+ * @param direction Une direction.
+ * @return La direction opposée.
+ */
+static char opposee(char direction)
+{
+    switch (direction)
+    {
+        case HAUT:
+            return BAS;
+        case BAS:
+            return HAUT;
+        case DROITE:
+            return GAUCHE;
+        case GAUCHE:
+            return DROITE;
+    }
+    return direction;
+}
+
+/**
+ * @brief Indique si une case n'est ni une bordure ni un pavé.
+ *
+ * @param partie La partie.
+ * @param position La case.
+ * @return true si la case est libre.
+ */
+static bool estLibre(const Partie *partie, Segment position)
+{
+    return CASE(partie, position.x, position.y) != COTE_BORDURE;
+}
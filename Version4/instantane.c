@@ -0,0 +1,322 @@
+/**
+ * @file instantane.c
+ * @brief Publication de l'état de la partie en mémoire partagée (voir instantane.h).
+ *
+ * @details
+ * - Seqlock : l'écrivain rend la séquence impaire, écrit, puis la rend paire
+ *   (publication) ; un lecteur copie entre deux lectures de la séquence et
+ *   recommence si elle était impaire ou a changé. L'écrivain n'attend jamais.
+ * - Le segment est écrit en entier au démarrage et quand une partie est
+ *   recommencée (sous le seqlock). Ensuite, un tour ne recopie
+ *   que ce qu'il a changé : la nouvelle tête (ajoutée à l'anneau, la queue
+ *   n'étant qu'une longueur), la queue (réécrite au début de la fenêtre, où
+ *   elle est dédoublée après une pomme), la case de la tête (objet mangé) et
+ *   les cases notées par les objets et les pavés mobiles.
+ * - Un segment laissé par une exécution précédente est remplacé ; il est
+ *   supprimé à l'arrêt, les lecteurs qui l'ont ouvert gardent leur copie.
+ *   Il est aussi recréé si une partie recommencée n'a plus la même taille.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "instantane.h"
+
+#define ALIGNEMENT 64   /**< Alignement des tableaux du segment (une ligne de cache). */
+
+static EnTeteInstantane *entete;    /**< Segment partagé (NULL : pas de publication). */
+static size_t taille_segment;       /**< Taille du segment. */
+static char *nom_segment;           /**< Nom du segment, pour le supprimer à l'arrêt. */
+static char *plateau_publie;        /**< Plateau dans le segment. */
+static Segment *anneau;             /**< Anneau des segments dans le segment. */
+static Segment derniere_tete;       /**< Dernière tête ajoutée à l'anneau. */
+
+static void commencerEcriture(void);
+static void terminerEcriture(void);
+static void publierCase(const Partie *partie, Segment position);
+static void remplirAnneau(const Partie *partie);
+static size_t aligner(size_t taille);
+
+/**
+ * @brief Crée le segment partagé et y écrit l'état complet de la partie.
+ *
+ * @param nom Nom POSIX du segment (par exemple « /snake »).
+ * @param partie La partie publiée ; la taille de son plateau ne change plus, sauf par recommencerInstantane().
+ * @return false si le segment ne peut pas être créé.
+ */
+bool demarrerInstantane(const char *nom, const Partie *partie)
+{
+    size_t cases = (size_t)partie->largeur * partie->hauteur;
+    size_t decalage_plateau = aligner(sizeof(EnTeteInstantane));
+    size_t decalage_segments = aligner(decalage_plateau + cases);
+    void *memoire;
+    int descripteur;
+
+    taille_segment = decalage_segments + cases * sizeof(Segment);
+    shm_unlink(nom);
+    descripteur = shm_open(nom, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (descripteur < 0 || ftruncate(descripteur, (off_t)taille_segment) != 0)
+    {
+        perror(nom);
+        if (descripteur >= 0)
+        {
+            close(descripteur);
+            shm_unlink(nom);
+        }
+        return false;
+    }
+    memoire = mmap(NULL, taille_segment, PROT_READ | PROT_WRITE, MAP_SHARED, descripteur, 0);
+    close(descripteur);
+    if (memoire == MAP_FAILED)
+    {
+        perror(nom);
+        shm_unlink(nom);
+        return false;
+    }
+    nom_segment = malloc(strlen(nom) + 1);
+    if (nom_segment == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    strcpy(nom_segment, nom);
+
+    entete = memoire;
+    plateau_publie = (char *)memoire + decalage_plateau;
+    anneau = (Segment *)((char *)memoire + decalage_segments);
+    // Segment neuf, rempli de zéros : séquence nulle, aucun lecteur ne copie avant la première publication
+    entete->version = VERSION_INSTANTANE;
+    entete->largeur = partie->largeur;
+    entete->hauteur = partie->hauteur;
+    entete->decalage_plateau = decalage_plateau;
+    entete->decalage_segments = decalage_segments;
+    entete->capacite_segments = (int64_t)cases;
+    memcpy(plateau_publie, partie->plateau, cases);
+    remplirAnneau(partie);
+    entete->magie = MAGIE_INSTANTANE;
+    publierInstantane(partie, PARTIE_EN_COURS);
+    return true;
+}
+
+/**
+ * @brief Publie l'état de la partie après un tour.
+ *
+ * Sans effet si la publication n'a pas été démarrée.
+ *
+ * @param partie La partie, après jouerTour().
+ * @param issue Issue du tour.
+ */
+void publierInstantane(const Partie *partie, Issue issue)
+{
+    Segment tete;
+
+    if (entete == NULL)
+    {
+        return;
+    }
+    commencerEcriture();
+    tete = teteSerpent(&partie->serpent);
+    if (tete.x != derniere_tete.x || tete.y != derniere_tete.y)
+    {
+        entete->tete++;
+        anneau[entete->tete % entete->capacite_segments] = tete;
+        derniere_tete = tete;
+    }
+    entete->longueur = (partie->serpent.taille < entete->capacite_segments) ?
+                       partie->serpent.taille : entete->capacite_segments;
+    // Après une pomme, la queue est dédoublée : la plus ancienne entrée de la
+    // fenêtre doit être la queue, pas la case qu'elle vient de quitter
+    anneau[((entete->tete - entete->longueur + 1) % entete->capacite_segments + entete->capacite_segments) %
+           entete->capacite_segments] = queueSerpent(&partie->serpent);
+    publierCase(partie, tete);
+    for (int i = 0; i < partie->objets.nombre_changees; i++)
+    {
+        publierCase(partie, partie->objets.changees[i]);
+    }
+    for (int i = 0; i < partie->obstacles.nombre_changees; i++)
+    {
+        publierCase(partie, partie->obstacles.changees[i]);
+    }
+    entete->tour = partie->tour;
+    entete->pommes_mangees = partie->pommes_mangees;
+    entete->objectif_pommes = partie->objectif_pommes;
+    entete->vitesse = partie->vitesse_actuelle;
+    entete->issue = issue;
+    terminerEcriture();
+}
+
+/**
+ * @brief Publie l'état complet d'une partie remise à son départ.
+ *
+ * Le plateau et l'anneau sont réécrits en une seule écriture du seqlock.
+ * Si la taille du plateau a changé, le segment est recréé sous le même nom
+ * (les lecteurs doivent le rouvrir).
+ *
+ * @param partie La partie, après recommencerPartie().
+ * @return false si le segment ne peut pas être recréé (la publication est alors arrêtée).
+ */
+bool recommencerInstantane(const Partie *partie)
+{
+    if (entete == NULL)
+    {
+        return true;
+    }
+    if (entete->largeur != partie->largeur || entete->hauteur != partie->hauteur)
+    {
+        char *nom = nom_segment;
+        bool recree;
+
+        munmap(entete, taille_segment);
+        entete = NULL;
+        nom_segment = NULL;
+        recree = demarrerInstantane(nom, partie);
+        free(nom);
+        return recree;
+    }
+    commencerEcriture();
+    memcpy(plateau_publie, partie->plateau, (size_t)partie->largeur * partie->hauteur);
+    remplirAnneau(partie);
+    terminerEcriture();
+    publierInstantane(partie, PARTIE_EN_COURS);
+    return true;
+}
+
+/**
+ * @brief Arrête la publication et supprime le segment partagé.
+ */
+void arreterInstantane(void)
+{
+    if (entete == NULL)
+    {
+        return;
+    }
+    munmap(entete, taille_segment);
+    shm_unlink(nom_segment);
+    free(nom_segment);
+    entete = NULL;
+    nom_segment = NULL;
+}
+
+/**
+ * @brief Copie un instantané cohérent, sans verrou (côté lecteur).
+ *
+ * Recommence tant que l'écrivain a pu modifier le segment pendant la copie.
+ *
+ * @param source En-tête du segment partagé, projeté en lecture.
+ * @param copie Reçoit l'en-tête.
+ * @param plateau Reçoit le plateau (largeur x hauteur octets).
+ * @param segments Reçoit les segments, de la tête vers la queue (capacite_segments au plus).
+ * @return Le nombre de copies recommencées.
+ */
+unsigned long copierInstantane(const EnTeteInstantane *source, EnTeteInstantane *copie,
+                               char *plateau, Segment *segments)
+{
+    const char *octets = (const char *)source;
+    unsigned long essais = 0;
+
+    while (true)
+    {
+        uint64_t avant = atomic_load_explicit(&source->sequence, memory_order_acquire);
+
+        if (avant != 0 && (avant & 1) == 0)
+        {
+            const Segment *lus;
+            int64_t capacite;
+
+            memcpy(copie, source, sizeof(*copie));
+            lus = (const Segment *)(octets + copie->decalage_segments);
+            capacite = copie->capacite_segments;
+            memcpy(plateau, octets + copie->decalage_plateau, (size_t)copie->largeur * copie->hauteur);
+            // Un en-tête déchiré peut donner n'importe quelle longueur : elle est bornée
+            for (int64_t i = 0; i < copie->longueur && i < capacite; i++)
+            {
+                segments[i] = lus[((copie->tete - i) % capacite + capacite) % capacite];
+            }
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&source->sequence, memory_order_relaxed) == avant)
+            {
+                return essais;
+            }
+        }
+        essais++;
+    }
+}
+
+/**
+ * @brief Rend la séquence impaire : les lecteurs écarteront leur copie.
+ */
+static void commencerEcriture(void)
+{
+    uint64_t sequence = atomic_load_explicit(&entete->sequence, memory_order_relaxed);
+
+    atomic_store_explicit(&entete->sequence, sequence + 1, memory_order_relaxed);
+    // Aucune écriture des données ne passe avant la séquence impaire
+    atomic_thread_fence(memory_order_release);
+}
+
+/**
+ * @brief Rend la séquence paire : l'état écrit est publié.
+ */
+static void terminerEcriture(void)
+{
+    uint64_t sequence = atomic_load_explicit(&entete->sequence, memory_order_relaxed);
+
+    atomic_store_explicit(&entete->sequence, sequence + 1, memory_order_release);
+}
+
+/**
+ * @brief Recopie une case du plateau dans le segment.
+ *
+ * @param partie La partie.
+ * @param position La case.
+ */
+static void publierCase(const Partie *partie, Segment position)
+{
+    size_t indice = (size_t)position.y * partie->largeur + position.x;
+
+    plateau_publie[indice] = partie->plateau[indice];
+}
+
+/**
+ * @brief Range tous les segments du serpent dans l'anneau.
+ *
+ * L'anneau est rempli de la tête (numéro taille - 1) vers la queue (numéro 0).
+ *
+ * @param partie La partie.
+ */
+static void remplirAnneau(const Partie *partie)
+{
+    Parcours parcours;
+    Segment segment;
+    long i = 0;
+
+    debutParcours(&partie->serpent, &parcours);
+    while (segmentSuivant(&parcours, &segment))
+    {
+        anneau[partie->serpent.taille - 1 - i++] = segment;
+    }
+    entete->tete = partie->serpent.taille - 1;
+    derniere_tete = teteSerpent(&partie->serpent);
+}
+
+/**
+ * @brief Arrondit une taille au multiple de ALIGNEMENT supérieur.
+ *
+ * @param taille La taille.
+ * @return La taille arrondie.
+ */
+static size_t aligner(size_t taille)
+{
+    return (taille + ALIGNEMENT - 1) / ALIGNEMENT * ALIGNEMENT;
+}
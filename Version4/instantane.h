@@ -0,0 +1,61 @@
+/**
+ * @file instantane.h
+ * @brief Instantané de la partie en mémoire partagée, publié sous seqlock.
+ *
+ * Après chaque tour, le jeu recopie l'état de la partie (plateau, segments du
+ * serpent, pommes mangées, vitesse, tour) dans un segment de mémoire partagée
+ * POSIX. Des outils externes (tableaux de bord, débogueurs) le lisent sans
+ * verrou et sans jamais ralentir le jeu : copierInstantane() relit tant que
+ * la copie a pu être modifiée pendant la lecture.
+ *
+ * Le segment commence par un EnTeteInstantane ; le plateau (une case par
+ * octet, ligne par ligne, sans le serpent) et l'anneau des segments se
+ * trouvent aux décalages qu'il indique.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef INSTANTANE_H
+#define INSTANTANE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#include "jeu.h"
+
+#define MAGIE_INSTANTANE 0x534E4B45u    /**< Marque d'un segment d'instantané (« SNKE »). */
+#define VERSION_INSTANTANE 1            /**< Version de la disposition du segment. */
+
+/** @brief En-tête du segment partagé. */
+typedef struct
+{
+    uint32_t magie;                     /**< MAGIE_INSTANTANE, écrite une fois le segment prêt. */
+    uint32_t version;                   /**< VERSION_INSTANTANE. */
+    atomic_uint_least64_t sequence;     /**< Impaire pendant une écriture, augmentée de 2 à chaque tour publié. */
+    int32_t largeur;                    /**< Largeur du plateau. */
+    int32_t hauteur;                    /**< Hauteur du plateau. */
+    uint64_t decalage_plateau;          /**< Décalage du plateau depuis le début du segment. */
+    uint64_t decalage_segments;         /**< Décalage de l'anneau des segments. */
+    int64_t capacite_segments;          /**< Taille de l'anneau (une entrée par case du plateau). */
+    int64_t tete;                       /**< Numéro de la tête : elle est rangée à tete % capacite_segments. */
+    int64_t longueur;                   /**< Nombre de segments, la tête et ceux qui la précèdent dans l'anneau. */
+    int64_t tour;                       /**< Tours joués. */
+    int32_t pommes_mangees;             /**< Pommes mangées. */
+    int32_t objectif_pommes;            /**< Pommes à manger pour gagner. */
+    int32_t vitesse;                    /**< Durée d'un tour (µs). */
+    int32_t issue;                      /**< Issue du dernier tour (Issue). */
+} EnTeteInstantane;
+
+/* Déclaration des fonctions */
+bool demarrerInstantane(const char *nom, const Partie *partie);
+void publierInstantane(const Partie *partie, Issue issue);
+bool recommencerInstantane(const Partie *partie);
+void arreterInstantane(void);
+unsigned long copierInstantane(const EnTeteInstantane *source, EnTeteInstantane *entete,
+                               char *plateau, Segment *segments);
+
+#endif
@@ -0,0 +1,204 @@
+/**
+ * @file jeu.h
+ * @brief Constantes et moteur du jeu Snake version 4.
+ *
+ * Le moteur (moteur.c) applique les règles de la version 4 sur une partie
+ * autonome, sans aucun affichage : le jeu interactif, le tournoi de robots
+ * et les autres outils partagent ainsi exactement les mêmes règles.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef JEU_H
+#define JEU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "serpent.h"
+#include "obstacles.h"
+#include "objets.h"
+
+/*
+ * @defgroup Constante du jeu
+ * @{
+ */
+#define TRUE  1             /**< Variable pour vrai. */
+#define FALSE  0            /**< Variable pour faut. */
+#define HAUT 'z'            /**< Touche pour déplacer le serpent vers le haut. */
+#define DROITE 'd'          /**< Touche pour déplacer le serpent à droite. */
+#define BAS 's'             /**< Touche pour déplacer le serpent vers le bas. */
+#define GAUCHE 'q'          /**< Touche pour déplacer le serpent à gauche. */
+#define TAILLE_SERPENT 10   /**< Taille du serpent. */
+#define LARGEUR_PLATEAU 80  /**< Largeur du plateau (règles par défaut). */
+#define HAUTEUR_PLATEAU 40  /**< Longueur du plateau (règles par défaut). */
+#define VITESSE_MIN 1000    /**< Temporisation minimale entre deux déplacements (µs). */
+
+/** Définitions des constantes (voir moteur.c) */
+extern const char COTE_BORDURE;
+extern const char POMME;
+extern const char ACCELERATEUR;
+extern const char RALENTISSEUR;
+extern const char RETRECISSEUR;
+extern const int ACCELERATION;
+extern const char STOP_JEU;
+extern const char CORPS;
+extern const char TETE;
+extern const char VIDE;
+extern const int COORD_DEPART_X_SERPENT;
+extern const int COORD_DEPART_Y_SERPENT;
+extern const int VITESSE_JEU;
+extern const int NOMBRES_PAVES;
+extern const int TAILLE_PAVE;
+extern const int OBJECTIF_POMMES;
+/*! @} */
+
+/** @brief Case (x, y) du plateau d'une partie. */
+#define CASE(partie, x, y) ((partie)->plateau[(size_t)(y) * (partie)->largeur + (x)])
+
+/** @brief Nombre de segments du serpent sur la case (x, y) d'une partie. */
+#define OCCUPATION(partie, x, y) ((partie)->occupation[(size_t)(y) * (partie)->largeur + (x)])
+
+/** @brief Type de niveau (voir niveaux.h). */
+typedef enum
+{
+    NIVEAU_PAVES,       /**< Bordure et pavés carrés (niveau d'origine). */
+    NIVEAU_LABYRINTHE,  /**< Labyrinthe, plus ou moins percé de boucles. */
+    NIVEAU_SALLES,      /**< Salles reliées par des couloirs. */
+    NIVEAU_GROTTES,     /**< Grottes (automate cellulaire). */
+    NOMBRE_NIVEAUX
+} TypeNiveau;
+
+/**
+ * @brief Règles d'une partie (voir regles.h pour le fichier de configuration).
+ *
+ * Des règles publiées ne sont plus jamais modifiées : une partie garde un
+ * pointeur vers les siennes, et de nouvelles règles sont publiées à côté.
+ * La taille du plateau, le niveau et les pavés ne s'appliquent qu'aux
+ * parties créées ensuite (sauf la période de pavés déjà mobiles), comme le
+ * nombre de pommes et de bonus ; la vitesse, l'accélération, l'objectif et les touches
+ * s'appliquent aussi aux parties en cours (voir appliquerRegles()).
+ */
+typedef struct
+{
+    int32_t vitesse_jeu;        /**< Temporisation de départ entre les déplacements (µs). */
+    int32_t acceleration;       /**< Diminution de la temporisation à chaque pomme (µs). */
+    int32_t objectif_pommes;    /**< Pommes à manger pour gagner. */
+    int16_t largeur;            /**< Largeur du plateau. */
+    int16_t hauteur;            /**< Hauteur du plateau. */
+    int16_t nombre_paves;       /**< Nombre de pavés. */
+    int16_t taille_pave;        /**< Côté des pavés. */
+    int16_t periode_paves;      /**< Tours entre deux déplacements d'un pavé (0 : pavés fixes). */
+    int16_t pommes;             /**< Pommes présentes en même temps sur le plateau. */
+    int16_t bonus;              /**< Bonus présents en même temps sur le plateau. */
+    int16_t duree_bonus;        /**< Tours de présence d'un bonus non mangé. */
+    int8_t niveau;              /**< Type de niveau (TypeNiveau). */
+    int8_t densite;             /**< Densité des murs des niveaux générés (0 à 100). */
+    char touche_haut;           /**< Touche pour aller vers le haut. */
+    char touche_bas;            /**< Touche pour aller vers le bas. */
+    char touche_gauche;         /**< Touche pour aller à gauche. */
+    char touche_droite;         /**< Touche pour aller à droite. */
+    char touche_arret;          /**< Touche pour arrêter le jeu. */
+} Regles;
+
+/** @brief Issue d'un tour de jeu. */
+typedef enum
+{
+    PARTIE_EN_COURS,    /**< La partie continue. */
+    PARTIE_PERDUE,      /**< Le serpent a heurté un obstacle ou son corps. */
+    PARTIE_GAGNEE       /**< L'objectif de pommes est atteint. */
+} Issue;
+
+/** @brief Familles de clés de Zobrist (voir cleZobrist()). */
+typedef enum
+{
+    CLE_LIEN,           /**< Segment et sens vers le suivant côté tête (indice : case * 5 + sens, 4 : même case). */
+    CLE_TETE,           /**< Case de la tête. */
+    CLE_QUEUE,          /**< Case de la queue. */
+    CLE_POMME,          /**< Case de la pomme. */
+    CLE_MUR,            /**< Bordure ou pavé. */
+    CLE_DIRECTION,      /**< Dernière direction jouée (indice : la touche). */
+    CLE_ACCELERATEUR,   /**< Case d'un bonus accélérateur. */
+    CLE_RALENTISSEUR,   /**< Case d'un bonus ralentisseur. */
+    CLE_RETRECISSEUR    /**< Case d'un bonus rétrécisseur. */
+} FamilleCle;
+
+/** @brief État complet d'une partie, indépendant de tout affichage. */
+typedef struct
+{
+    int largeur;                /**< Largeur du plateau. */
+    int hauteur;                /**< Hauteur du plateau. */
+    char *plateau;              /**< Bordures, pavés et objets, ligne par ligne (peut être partagé). */
+    char *plateau_prive;        /**< Plateau propre à la partie (reçoit le plateau partagé à la première écriture). */
+    bool plateau_partage;       /**< plateau appartient à la partie clonée : copie avant toute écriture. */
+    unsigned char *occupation;  /**< Nombre de segments du serpent sur chaque case. */
+    unsigned char *touchee;     /**< Cases modifiées depuis le plateau vierge, ou depuis le clonage pour un clone (NULL : pas de suivi). */
+    size_t *touchees;           /**< Indices des cases marquées dans touchee. */
+    size_t nombre_touchees;     /**< Nombre de cases touchées. */
+    size_t capacite_touchees;   /**< Taille du tableau touchees. */
+    bool occupation_notee;      /**< Clone : les cases d'occupation modifiées sont aussi notées (voir reprendreClone()). */
+    uint64_t empreinte_vierge;  /**< Empreinte des murs du plateau vierge (bordure sans pavés). */
+    Arene arene;                /**< Mémoire de la partie, libérée en bloc. */
+    Serpent serpent;            /**< Le serpent. */
+    Segment pomme;              /**< Dernière pomme placée (toujours présente, visée par les pilotes). */
+    Objets objets;              /**< Pommes et bonus du plateau. */
+    Obstacles obstacles;        /**< Pavés mobiles (aucun si les pavés sont fixes). */
+    char direction;             /**< Dernière direction jouée. */
+    int vitesse_actuelle;       /**< Temporisation entre les déplacements en microsecondes. */
+    int pommes_mangees;         /**< Nombre de pommes mangées. */
+    int objectif_pommes;        /**< Pommes à manger pour gagner (0 : partie sans fin). */
+    long tour;                  /**< Nombre de tours joués. */
+    uint32_t aleatoire;         /**< État du générateur pseudo-aléatoire. */
+    uint64_t empreinte;         /**< Empreinte de Zobrist : liens du corps, tête, queue, objets, murs et direction. */
+    const Regles *regles;       /**< Règles de la partie (publiées, jamais modifiées). */
+} Partie;
+
+/**
+ * @brief Ce qu'il faut pour annuler un tour joué par jouerCoup().
+ *
+ * Seuls les pommes et les pavés fixes sont pris en charge : les bonus et les
+ * pavés mobiles changent d'autres éléments de la partie, qu'un coup ne note pas.
+ */
+typedef struct
+{
+    Segment queue;              /**< Queue avant le tour (elle a quitté sa case). */
+    Segment pomme;              /**< Pomme visée avant le tour. */
+    Segment nouvelle_pomme;     /**< Pomme placée pendant le tour (si une pomme a été mangée). */
+    bool pomme_mangee;          /**< Une pomme a été mangée : le serpent a grandi. */
+    char direction;             /**< Direction avant le tour. */
+    int vitesse_actuelle;       /**< Temporisation avant le tour. */
+    uint32_t aleatoire;         /**< État du générateur avant le tour. */
+    uint64_t empreinte;         /**< Empreinte avant le tour. */
+} Coup;
+
+/* Déclaration des fonctions */
+void creerPartie(Partie *partie, uint32_t graine);
+void detruirePartie(Partie *partie);
+void recommencerPartie(Partie *partie, uint32_t graine);
+void preparerCopie(Partie *copie);
+void clonerPartie(Partie *copie, const Partie *source);
+void reprendreClone(Partie *copie, const Partie *source);
+Issue jouerTour(Partie *partie, char direction, bool *pomme_mangee);
+Issue jouerCoup(Partie *partie, char direction, Coup *coup);
+void annulerCoup(Partie *partie, const Coup *coup);
+void progresser(Partie *partie, char direction, bool *collision, bool *pomme_mangee);
+void initPlateau(Partie *partie);
+void placerPaves(Partie *partie);
+void ajouterPomme(Partie *partie);
+Segment caseSuivante(const Partie *partie, Segment position, char direction);
+bool deplacementSansDanger(const Partie *partie, char direction);
+bool directionAutorisee(char actuelle, char nouvelle);
+uint32_t tirerAleatoire(uint32_t *etat);
+uint64_t cleZobrist(FamilleCle famille, size_t indice);
+uint64_t calculerEmpreinte(const Partie *partie);
+void reglesParDefaut(Regles *regles);
+const Regles *reglesCourantes(void);
+const Regles *publierRegles(const Regles *regles);
+void appliquerRegles(Partie *partie, const Regles *regles);
+char commandeTouche(const Regles *regles, char touche);
+
+#endif
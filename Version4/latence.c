@@ -0,0 +1,137 @@
+/**
+ * @file latence.c
+ * @brief Distribution des latences entre une touche et son affichage.
+ *
+ * @details
+ * - Les durées sont rangées dans des histogrammes à classes logarithmiques :
+ *   la classe c couvre [2^c, 2^(c+1)[ ns. Un centile est donc donné par la
+ *   borne haute de sa classe (à un facteur 2 près).
+ * - Moyenne, dernière valeur et maximum sont exacts.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <time.h>
+
+#include "latence.h"
+
+/** Noms des phases, pour le rapport. */
+static const char *const NOMS_PHASES[NOMBRE_PHASES] = {"attente", "logique", "sortie", "total"};
+
+/**
+ * @brief Horloge monotone en nanosecondes.
+ *
+ * @return L'instant présent.
+ */
+uint64_t instantPresent(void)
+{
+    struct timespec instant;
+
+    clock_gettime(CLOCK_MONOTONIC, &instant);
+    return (uint64_t)instant.tv_sec * 1000000000u + (uint64_t)instant.tv_nsec;
+}
+
+/**
+ * @brief Ajoute la mesure d'une touche.
+ *
+ * @param latences Distribution à compléter.
+ * @param touche Lecture de la touche.
+ * @param debut_tour Début du tour qui a appliqué la touche.
+ * @param publication Publication de l'image de ce tour.
+ * @param ecriture Fin de l'écriture dans le terminal de l'image qui la montre.
+ */
+void ajouterLatence(Latences *latences, uint64_t touche, uint64_t debut_tour,
+                    uint64_t publication, uint64_t ecriture)
+{
+    uint64_t durees[NOMBRE_PHASES] =
+    {
+        debut_tour - touche,
+        publication - debut_tour,
+        ecriture - publication,
+        ecriture - touche,
+    };
+
+    latences->nombre++;
+    for (int phase = 0; phase < NOMBRE_PHASES; phase++)
+    {
+        latences->somme[phase] += durees[phase];
+        latences->derniere[phase] = durees[phase];
+        if (durees[phase] > latences->max[phase])
+        {
+            latences->max[phase] = durees[phase];
+        }
+        latences->histogramme[phase][classeLatence(durees[phase])]++;
+    }
+}
+
+/**
+ * @brief Centile d'une phase (borne haute de sa classe).
+ *
+ * @param latences La distribution.
+ * @param phase La phase.
+ * @param pourcentage Le centile voulu (50 pour la médiane).
+ * @return La borne en ns (0 si aucune mesure).
+ */
+uint64_t centileLatence(const Latences *latences, Phase phase, int pourcentage)
+{
+    uint64_t cumul = 0;
+    int classe = 0;
+
+    if (latences->nombre == 0)
+    {
+        return 0;
+    }
+    while (classe < NOMBRE_CLASSES_LATENCE - 1 &&
+           (cumul += latences->histogramme[phase][classe]) * 100 < latences->nombre * pourcentage)
+    {
+        classe++;
+    }
+    return 2ull << classe;
+}
+
+/**
+ * @brief Affiche le rapport des latences, phase par phase.
+ *
+ * @param latences La distribution.
+ * @param flux Flux de sortie.
+ */
+void afficherLatences(const Latences *latences, FILE *flux)
+{
+    if (latences->nombre == 0)
+    {
+        fprintf(flux, "Latence touche → écran : aucune touche mesurée\n");
+        return;
+    }
+    fprintf(flux, "Latence touche → écran (%llu touches)\n", (unsigned long long)latences->nombre);
+    fprintf(flux, "%-8s %12s %12s %12s %12s\n", "Phase", "moyenne", "p50 <", "p99 <", "max");
+    for (int phase = 0; phase < NOMBRE_PHASES; phase++)
+    {
+        fprintf(flux, "%-8s %9.2f ms %9.2f ms %9.2f ms %9.2f ms\n", NOMS_PHASES[phase],
+                latences->somme[phase] / 1e6 / latences->nombre,
+                centileLatence(latences, phase, 50) / 1e6,
+                centileLatence(latences, phase, 99) / 1e6,
+                latences->max[phase] / 1e6);
+    }
+}
+
+/**
+ * @brief Classe d'une durée dans un histogramme : la classe c couvre [2^c, 2^(c+1)[ ns.
+ *
+ * @param nanosecondes La durée.
+ * @return La classe (au plus NOMBRE_CLASSES_LATENCE - 1).
+ */
+int classeLatence(uint64_t nanosecondes)
+{
+    int classe = 0;
+
+    while (nanosecondes > 1 && classe < NOMBRE_CLASSES_LATENCE - 1)
+    {
+        nanosecondes >>= 1;
+        classe++;
+    }
+    return classe;
+}
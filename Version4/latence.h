@@ -0,0 +1,52 @@
+/**
+ * @file latence.h
+ * @brief Mesure de la latence entre une touche et son affichage.
+ *
+ * Chaque touche est horodatée à sa lecture ; la mesure s'arrête quand
+ * l'image qui montre la tête déplacée a été écrite dans le terminal. Le
+ * temps total est découpé en trois phases : attente du tour suivant,
+ * logique du tour (et composition de l'image), sortie vers le terminal.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef LATENCE_H
+#define LATENCE_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define NOMBRE_CLASSES_LATENCE 48   /**< Classes des histogrammes (puissances de 2 en ns). */
+
+/** @brief Phases du trajet d'une touche jusqu'à l'écran. */
+typedef enum
+{
+    PHASE_ATTENTE,      /**< De la lecture de la touche au début du tour suivant. */
+    PHASE_LOGIQUE,      /**< Du début du tour à la publication de l'image. */
+    PHASE_SORTIE,       /**< De la publication à la fin de l'écriture dans le terminal. */
+    PHASE_TOTAL,        /**< De la lecture de la touche à la fin de l'écriture. */
+    NOMBRE_PHASES
+} Phase;
+
+/** @brief Distribution des latences mesurées. */
+typedef struct
+{
+    uint64_t nombre;                                        /**< Nombre de touches mesurées. */
+    uint64_t somme[NOMBRE_PHASES];                          /**< Somme des durées en ns. */
+    uint64_t max[NOMBRE_PHASES];                            /**< Plus longue durée en ns. */
+    uint64_t derniere[NOMBRE_PHASES];                       /**< Durées de la dernière touche en ns. */
+    uint64_t histogramme[NOMBRE_PHASES][NOMBRE_CLASSES_LATENCE]; /**< Durées par classe. */
+} Latences;
+
+/* Déclaration des fonctions */
+uint64_t instantPresent(void);
+int classeLatence(uint64_t nanosecondes);
+void ajouterLatence(Latences *latences, uint64_t touche, uint64_t debut_tour,
+                    uint64_t publication, uint64_t ecriture);
+uint64_t centileLatence(const Latences *latences, Phase phase, int pourcentage);
+void afficherLatences(const Latences *latences, FILE *flux);
+
+#endif
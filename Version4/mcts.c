@@ -0,0 +1,631 @@
+/**
+ * @file mcts.c
+ * @brief Pilote « mcts » : recherche arborescente Monte-Carlo en parallèle.
+ *
+ * @details
+ * - Arbre en boucle ouverte : un nœud correspond à une suite de directions,
+ *   pas à un état. Chaque simulation repart d'un clone de la partie (voir
+ *   clonerPartie()) dont le générateur est retiré au hasard : la position des
+ *   prochaines pommes est inconnue du pilote, comme pour un joueur.
+ * - Sélection UCT dans l'arbre, puis fin de simulation par une politique
+ *   rapide (vers la pomme le plus souvent, au hasard sinon) sur au plus
+ *   PROFONDEUR_SIMULATION tours. La récompense tient compte de la survie et
+ *   des pommes mangées, d'autant plus qu'elles sont proches ; sans pomme sur
+ *   l'horizon, de la distance restante jusqu'à la pomme.
+ * - Les simulations d'une même décision repartent du même clone, ramené à la
+ *   racine par reprendreClone() : seules les cases et les segments que la
+ *   simulation précédente a changés sont repris.
+ * - Parallélisation à la racine : chaque thread construit son propre arbre
+ *   dans sa réserve de nœuds, sans verrou ; les visites des directions de la
+ *   racine sont additionnées à la fin. Les threads sont créés avec le
+ *   contexte et attendent chaque décision. Ils se partagent les cœurs avec
+ *   les autres parties du programme (voir limiterThreadsMcts()).
+ * - Les threads partagent une table de transposition (voir transposition.h)
+ *   : la position atteinte au développement d'un nœud y accumule les
+ *   récompenses de toutes les simulations qui en sont parties, quel que
+ *   soit l'arbre, et c'est leur moyenne qui est remontée. Les clés sont
+ *   salées à chaque décision, ce qui évite de vider la table.
+ * - Le temps de réflexion est une fraction (POURCENTAGE_REFLEXION, ou
+ *   $SNAKE_REFLEXION) de la durée d'un tour : il diminue à mesure que le jeu
+ *   accélère.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "bots.h"
+#include "transposition.h"
+#include "latence.h"
+
+#define NOEUDS_PAR_THREAD 65536     /**< Taille de la réserve de nœuds de chaque thread. */
+#define THREADS_MAX 16              /**< Nombre maximal de threads de recherche. */
+#define PROFONDEUR_SIMULATION 40    /**< Nombre maximal de tours d'une simulation. */
+#define POURCENTAGE_REFLEXION 25    /**< Part de la durée d'un tour consacrée à la recherche. */
+#define REFLEXION_MIN 1000          /**< Temps de réflexion minimal en microsecondes. */
+#define EXPLORATION 0.7             /**< Constante d'exploration de UCT. */
+#define ACTUALISATION 0.95          /**< Poids d'une pomme à chaque tour d'attente supplémentaire. */
+#define CHANCES_GLOUTON 3           /**< Sur 4 tours de simulation, nombre de tours joués vers la pomme. */
+#define ENTREES_TABLE 65536         /**< Entrées de la table de transposition. */
+#define BITS_SOMME 48               /**< Bits de la somme des récompenses dans une entrée (le reste : visites). */
+#define ECHELLE_SOMME 16777216.0    /**< Récompense 1 dans la somme d'une entrée (2^24). */
+#define VISITES_TABLE_MAX 65535     /**< Visites au-delà desquelles une entrée n'est plus mise à jour. */
+
+/** Les quatre directions, dans l'ordre où elles sont essayées. */
+static const char DIRECTIONS[4] = {HAUT, DROITE, BAS, GAUCHE};
+
+/** @brief Nœud de l'arbre : statistiques d'une suite de directions. */
+typedef struct
+{
+    int enfants[4];         /**< Nœud atteint par chaque direction (-1 : pas encore développé). */
+    unsigned int visites;   /**< Nombre de simulations passées par le nœud. */
+    double gains;           /**< Somme des récompenses de ces simulations. */
+} Noeud;
+
+typedef struct ContexteMcts ContexteMcts;
+
+/** @brief Recherche menée par un thread. */
+typedef struct
+{
+    ContexteMcts *contexte;         /**< Contexte du pilote. */
+    const Partie *racine;           /**< Partie à l'instant de la décision (lue seulement). */
+    Partie copie;                   /**< Clone rejoué à chaque simulation. */
+    bool clonee;                    /**< copie est un clone de la racine de cette décision. */
+    Noeud *noeuds;                  /**< Réserve de nœuds (le nœud 0 est la racine). */
+    int nombre_noeuds;              /**< Nœuds utilisés. */
+    int *chemin;                    /**< Nœuds traversés par la simulation en cours. */
+    uint32_t aleatoire;             /**< Générateur propre au thread. */
+    uint64_t echeance;              /**< Fin de la recherche (horloge monotone, ns). */
+    unsigned long simulations;      /**< Simulations faites pendant la décision. */
+} Recherche;
+
+/** @brief Contexte du pilote « mcts ». */
+struct ContexteMcts
+{
+    int threads;                    /**< Nombre de threads de recherche. */
+    int pourcentage;                /**< Part de la durée d'un tour consacrée à la recherche. */
+    Recherche recherches[THREADS_MAX];  /**< Recherches, une par thread. */
+    pthread_t travailleurs[THREADS_MAX];    /**< Threads des recherches 1 et suivantes (la 0 est celle de l'appelant). */
+    TableTransposition table;       /**< Récompenses par position, partagées par les threads. */
+    uint64_t sel;                   /**< Sel des clés de la table pour la décision en cours. */
+    pthread_mutex_t verrou;         /**< Protège les champs qui suivent. */
+    pthread_cond_t depart;          /**< Signalé au début d'une décision et à l'arrêt. */
+    pthread_cond_t arrivee;         /**< Signalé quand la dernière recherche auxiliaire se termine. */
+    unsigned long decision;         /**< Numéro de la décision en cours. */
+    int en_cours;                   /**< Recherches auxiliaires pas encore terminées. */
+    bool arret;                     /**< Le contexte est détruit : les threads s'arrêtent. */
+};
+
+static int parties_simultanees = 1;     /**< Parties jouées en même temps (voir limiterThreadsMcts()). */
+
+static void *attendreDecisions(void *argument);
+static void rechercher(Recherche *recherche);
+static void simuler(Recherche *recherche);
+static double partagerRecompense(TableTransposition *table, uint64_t cle, double recompense);
+static int directionsSures(const Partie *partie, int *possibles);
+static int choisirDansArbre(const Recherche *recherche, const Noeud *noeud,
+                            const int *possibles, int nombre);
+static int choisirSimulation(Recherche *recherche, const Partie *partie,
+                             const int *possibles, int nombre);
+
+/**
+ * @brief Crée les recherches du pilote « mcts ».
+ *
+ * @param partie La partie (sa graine initialise les générateurs des threads).
+ * @return Le contexte alloué.
+ */
+void *creerMcts(const Partie *partie)
+{
+    ContexteMcts *contexte = malloc(sizeof(ContexteMcts));
+    const char *reflexion = getenv("SNAKE_REFLEXION");
+    long coeurs = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (contexte == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    // Les cœurs sont partagés entre les parties jouées en même temps
+    coeurs /= parties_simultanees;
+    contexte->threads = (coeurs < 1) ? 1 : (coeurs > THREADS_MAX) ? THREADS_MAX : (int)coeurs;
+    contexte->pourcentage = (reflexion != NULL) ? atoi(reflexion) : POURCENTAGE_REFLEXION;
+    if (contexte->pourcentage <= 0)
+    {
+        contexte->pourcentage = POURCENTAGE_REFLEXION;
+    }
+
+    for (int i = 0; i < contexte->threads; i++)
+    {
+        Recherche *recherche = &contexte->recherches[i];
+
+        recherche->noeuds = malloc(NOEUDS_PAR_THREAD * sizeof(Noeud));
+        recherche->chemin = malloc((PROFONDEUR_SIMULATION + 1) * sizeof(int));
+        if (recherche->noeuds == NULL || recherche->chemin == NULL)
+        {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        preparerCopie(&recherche->copie);
+        recherche->contexte = contexte;
+        recherche->aleatoire = (partie->aleatoire ^ 0x85EBCA6Bu) + 0x9E3779B9u * (uint32_t)(i + 1);
+        if (recherche->aleatoire == 0)
+        {
+            recherche->aleatoire = 1;
+        }
+    }
+
+    if (!creerTable(&contexte->table, ENTREES_TABLE))
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    contexte->sel = 0;
+    pthread_mutex_init(&contexte->verrou, NULL);
+    pthread_cond_init(&contexte->depart, NULL);
+    pthread_cond_init(&contexte->arrivee, NULL);
+    contexte->decision = 0;
+    contexte->en_cours = 0;
+    contexte->arret = false;
+    for (int i = 1; i < contexte->threads; i++)
+    {
+        if (pthread_create(&contexte->travailleurs[i], NULL, attendreDecisions, &contexte->recherches[i]) != 0)
+        {
+            perror("pthread_create");
+            exit(EXIT_FAILURE);
+        }
+    }
+    return contexte;
+}
+
+/**
+ * @brief Partage les cœurs entre plusieurs parties jouées en même temps.
+ *
+ * Les contextes créés ensuite n'ont que leur part des cœurs (au moins un
+ * thread) : un tournoi sur n threads ne lance pas n fois autant de threads
+ * de recherche que de cœurs. À appeler avant de créer les parties.
+ *
+ * @param parties Nombre de parties jouées en même temps (1 par défaut).
+ */
+void limiterThreadsMcts(int parties)
+{
+    parties_simultanees = (parties < 1) ? 1 : parties;
+}
+
+/**
+ * @brief Choisit une direction par recherche Monte-Carlo.
+ *
+ * Une direction qui est la seule sans danger est jouée sans recherche.
+ * Sinon, la direction retenue est la plus visitée, tous threads confondus.
+ *
+ * @param partie La partie.
+ * @param contexte Contexte du pilote.
+ * @return La direction choisie.
+ */
+char choisirMcts(const Partie *partie, void *contexte)
+{
+    ContexteMcts *mcts = contexte;
+    int possibles[4];
+    int nombre = directionsSures(partie, possibles);
+    long reflexion = (long)partie->vitesse_actuelle * mcts->pourcentage / 100;
+    uint64_t echeance;
+    unsigned long visites[4] = {0, 0, 0, 0};
+    double gains[4] = {0, 0, 0, 0};
+    int meilleure;
+
+    if (nombre == 0)
+    {
+        return partie->direction;
+    }
+    if (nombre == 1)
+    {
+        return DIRECTIONS[possibles[0]];
+    }
+
+    if (reflexion < REFLEXION_MIN)
+    {
+        reflexion = REFLEXION_MIN;
+    }
+    echeance = instantPresent() + (uint64_t)reflexion * 1000u;
+    meilleure = possibles[0];
+    for (int i = 0; i < mcts->threads; i++)
+    {
+        mcts->recherches[i].racine = partie;
+        mcts->recherches[i].echeance = echeance;
+    }
+
+    // Le thread appelant mène la première recherche, les threads du contexte les autres
+    pthread_mutex_lock(&mcts->verrou);
+    mcts->decision++;
+    mcts->sel = mcts->decision * 0x9E3779B97F4A7C15ull;
+    mcts->en_cours = mcts->threads - 1;
+    pthread_cond_broadcast(&mcts->depart);
+    pthread_mutex_unlock(&mcts->verrou);
+    rechercher(&mcts->recherches[0]);
+    pthread_mutex_lock(&mcts->verrou);
+    while (mcts->en_cours > 0)
+    {
+        pthread_cond_wait(&mcts->arrivee, &mcts->verrou);
+    }
+    pthread_mutex_unlock(&mcts->verrou);
+
+    for (int i = 0; i < mcts->threads; i++)
+    {
+        const Recherche *recherche = &mcts->recherches[i];
+
+        for (int d = 0; d < 4; d++)
+        {
+            int enfant = recherche->noeuds[0].enfants[d];
+
+            if (enfant >= 0)
+            {
+                visites[d] += recherche->noeuds[enfant].visites;
+                gains[d] += recherche->noeuds[enfant].gains;
+            }
+        }
+    }
+    for (int i = 1; i < nombre; i++)
+    {
+        int d = possibles[i];
+
+        if (visites[d] > visites[meilleure] ||
+            (visites[d] == visites[meilleure] && gains[d] > gains[meilleure]))
+        {
+            meilleure = d;
+        }
+    }
+    return DIRECTIONS[meilleure];
+}
+
+/**
+ * @brief Libère le contexte du pilote « mcts ».
+ *
+ * @param contexte Contexte à libérer.
+ */
+void detruireMcts(void *contexte)
+{
+    ContexteMcts *mcts = contexte;
+
+    pthread_mutex_lock(&mcts->verrou);
+    mcts->arret = true;
+    pthread_cond_broadcast(&mcts->depart);
+    pthread_mutex_unlock(&mcts->verrou);
+    for (int i = 1; i < mcts->threads; i++)
+    {
+        pthread_join(mcts->travailleurs[i], NULL);
+    }
+    pthread_mutex_destroy(&mcts->verrou);
+    pthread_cond_destroy(&mcts->depart);
+    pthread_cond_destroy(&mcts->arrivee);
+    detruireTable(&mcts->table);
+
+    for (int i = 0; i < mcts->threads; i++)
+    {
+        free(mcts->recherches[i].noeuds);
+        free(mcts->recherches[i].chemin);
+        detruirePartie(&mcts->recherches[i].copie);
+    }
+    free(mcts);
+}
+
+/**
+ * @brief Boucle d'un thread du contexte : une recherche par décision.
+ *
+ * @param argument La recherche du thread (Recherche *).
+ * @return NULL, à la destruction du contexte.
+ */
+static void *attendreDecisions(void *argument)
+{
+    Recherche *recherche = argument;
+    ContexteMcts *mcts = recherche->contexte;
+    unsigned long vue = 0;
+
+    pthread_mutex_lock(&mcts->verrou);
+    while (true)
+    {
+        while (!mcts->arret && mcts->decision == vue)
+        {
+            pthread_cond_wait(&mcts->depart, &mcts->verrou);
+        }
+        if (mcts->arret)
+        {
+            break;
+        }
+        vue = mcts->decision;
+        pthread_mutex_unlock(&mcts->verrou);
+        rechercher(recherche);
+        pthread_mutex_lock(&mcts->verrou);
+        if (--mcts->en_cours == 0)
+        {
+            pthread_cond_signal(&mcts->arrivee);
+        }
+    }
+    pthread_mutex_unlock(&mcts->verrou);
+    return NULL;
+}
+
+/**
+ * @brief Mène une recherche jusqu'à son échéance, sur un arbre neuf.
+ *
+ * @param recherche La recherche.
+ */
+static void rechercher(Recherche *recherche)
+{
+    memset(&recherche->noeuds[0], 0, sizeof(Noeud));
+    memset(recherche->noeuds[0].enfants, -1, sizeof(recherche->noeuds[0].enfants));
+    recherche->nombre_noeuds = 1;
+    recherche->simulations = 0;
+    recherche->clonee = false;
+
+    // Au moins une simulation, même si l'échéance est déjà passée
+    do {
+        simuler(recherche);
+        recherche->simulations++;
+    } while (instantPresent() < recherche->echeance);
+}
+
+/**
+ * @brief Joue une simulation depuis la racine et remonte sa récompense.
+ *
+ * Tant que la simulation est dans l'arbre, la direction est choisie par
+ * UCT ; le premier nœud absent est ajouté, puis la simulation continue avec
+ * la politique rapide.
+ *
+ * @param recherche La recherche.
+ */
+static void simuler(Recherche *recherche)
+{
+    Partie *copie = &recherche->copie;
+    int noeud = 0, profondeur = 0, longueur_chemin = 0;
+    double pommes = 0, poids = 1, recompense;
+    Issue issue = PARTIE_EN_COURS;
+    bool developpe = false, feuille = false;
+    uint64_t cle = 0;
+
+    // La racine ne change pas pendant la décision : le clone y est ramené à peu de frais
+    if (recherche->clonee)
+    {
+        reprendreClone(copie, recherche->racine);
+    }
+    else
+    {
+        clonerPartie(copie, recherche->racine);
+        recherche->clonee = true;
+    }
+    // Les prochaines pommes sont tirées au hasard à chaque simulation
+    copie->aleatoire = tirerAleatoire(&recherche->aleatoire) | 1u;
+    recherche->chemin[longueur_chemin++] = 0;
+
+    while (issue == PARTIE_EN_COURS && profondeur < PROFONDEUR_SIMULATION)
+    {
+        int possibles[4];
+        int nombre = directionsSures(copie, possibles);
+        char direction;
+        bool pomme_mangee;
+
+        if (nombre == 0)
+        {
+            issue = PARTIE_PERDUE;
+            break;
+        }
+        if (noeud >= 0)
+        {
+            int d = choisirDansArbre(recherche, &recherche->noeuds[noeud], possibles, nombre);
+            int enfant = recherche->noeuds[noeud].enfants[d];
+
+            if (enfant < 0 && recherche->nombre_noeuds < NOEUDS_PAR_THREAD)
+            {
+                // Développement : le nouveau nœud est le dernier de l'arbre
+                enfant = recherche->nombre_noeuds++;
+                memset(&recherche->noeuds[enfant], 0, sizeof(Noeud));
+                memset(recherche->noeuds[enfant].enfants, -1, sizeof(recherche->noeuds[enfant].enfants));
+                recherche->noeuds[noeud].enfants[d] = enfant;
+                recherche->chemin[longueur_chemin++] = enfant;
+                noeud = -1;
+                developpe = true;
+            }
+            else if (enfant < 0)
+            {
+                noeud = -1;
+            }
+            else
+            {
+                recherche->chemin[longueur_chemin++] = enfant;
+                noeud = enfant;
+            }
+            direction = DIRECTIONS[d];
+        }
+        else
+        {
+            direction = DIRECTIONS[choisirSimulation(recherche, copie, possibles, nombre)];
+        }
+
+        issue = jouerTour(copie, direction, &pomme_mangee);
+        if (developpe && !feuille && issue == PARTIE_EN_COURS)
+        {
+            // Position du nœud développé : clé de sa récompense partagée
+            cle = copie->empreinte ^ recherche->contexte->sel;
+            feuille = true;
+        }
+        developpe = false;
+        if (pomme_mangee)
+        {
+            pommes += poids;
+        }
+        poids *= ACTUALISATION;
+        profondeur++;
+    }
+
+    // Survie sur l'horizon de la simulation, pommes (une pomme proche vaut presque 1)
+    // et, sans pomme mangée, distance restante jusqu'à la pomme
+    if (issue == PARTIE_PERDUE)
+    {
+        recompense = 0.5 * profondeur / PROFONDEUR_SIMULATION;
+    }
+    else if (pommes > 0)
+    {
+        recompense = 0.75 + 0.25 * (pommes < 1 ? pommes : 1);
+    }
+    else
+    {
+        Segment tete = teteSerpent(&copie->serpent);
+        int distance = abs(tete.x - copie->pomme.x) + abs(tete.y - copie->pomme.y);
+
+        recompense = 0.5 + 0.25 * (1.0 - (double)distance / (copie->largeur + copie->hauteur));
+    }
+    if (feuille)
+    {
+        recompense = partagerRecompense(&recherche->contexte->table, cle, recompense);
+    }
+
+    for (int i = 0; i < longueur_chemin; i++)
+    {
+        Noeud *traverse = &recherche->noeuds[recherche->chemin[i]];
+
+        traverse->visites++;
+        traverse->gains += recompense;
+    }
+}
+
+/**
+ * @brief Ajoute une récompense à celles d'une position et en donne la moyenne.
+ *
+ * Une entrée garde le nombre de visites (bits de poids fort) et la somme des
+ * récompenses en virgule fixe. Deux threads qui mettent à jour la même entrée
+ * en même temps peuvent perdre une récompense : la moyenne reste une
+ * estimation, sans verrou.
+ *
+ * @param table La table de transposition.
+ * @param cle Empreinte de la position, salée.
+ * @param recompense Récompense de la simulation (entre 0 et 1).
+ * @return Moyenne des récompenses connues de la position, celle-ci comprise.
+ */
+static double partagerRecompense(TableTransposition *table, uint64_t cle, double recompense)
+{
+    uint64_t donnee = 0, visites, somme;
+
+    lirePosition(table, cle, &donnee);
+    visites = donnee >> BITS_SOMME;
+    somme = donnee & ((1ull << BITS_SOMME) - 1);
+    if (visites >= VISITES_TABLE_MAX)
+    {
+        return somme / ECHELLE_SOMME / visites;
+    }
+    visites++;
+    somme += (uint64_t)(recompense * ECHELLE_SOMME);
+    enregistrerPosition(table, cle, (visites << BITS_SOMME) | somme);
+    return somme / ECHELLE_SOMME / visites;
+}
+
+/**
+ * @brief Liste les directions sans danger immédiat.
+ *
+ * @param partie La partie.
+ * @param possibles Reçoit les indices (dans DIRECTIONS) des directions sûres.
+ * @return Le nombre de directions sûres.
+ */
+static int directionsSures(const Partie *partie, int *possibles)
+{
+    int nombre = 0;
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (directionAutorisee(partie->direction, DIRECTIONS[i]) &&
+            deplacementSansDanger(partie, DIRECTIONS[i]))
+        {
+            possibles[nombre++] = i;
+        }
+    }
+    return nombre;
+}
+
+/**
+ * @brief Choisit une direction dans l'arbre (UCT).
+ *
+ * Une direction jamais essayée depuis ce nœud passe avant les autres.
+ *
+ * @param recherche La recherche.
+ * @param noeud Nœud courant.
+ * @param possibles Directions sûres (indices).
+ * @param nombre Nombre de directions sûres (au moins 1).
+ * @return L'indice de la direction choisie.
+ */
+static int choisirDansArbre(const Recherche *recherche, const Noeud *noeud,
+                            const int *possibles, int nombre)
+{
+    double logarithme = log((double)noeud->visites + 1);
+    double meilleur_score = -1;
+    int meilleure = possibles[0];
+
+    for (int i = 0; i < nombre; i++)
+    {
+        int d = possibles[i];
+        int enfant = noeud->enfants[d];
+        const Noeud *suivant;
+        double score;
+
+        if (enfant < 0)
+        {
+            return d;
+        }
+        suivant = &recherche->noeuds[enfant];
+        if (suivant->visites == 0)
+        {
+            return d;
+        }
+        score = suivant->gains / suivant->visites +
+                EXPLORATION * sqrt(logarithme / suivant->visites);
+        if (score > meilleur_score)
+        {
+            meilleur_score = score;
+            meilleure = d;
+        }
+    }
+    return meilleure;
+}
+
+/**
+ * @brief Politique rapide de fin de simulation.
+ *
+ * Le plus souvent, la direction sûre qui rapproche le plus de la pomme ;
+ * sinon une direction sûre au hasard.
+ *
+ * @param recherche La recherche (pour son générateur).
+ * @param partie La partie simulée.
+ * @param possibles Directions sûres (indices).
+ * @param nombre Nombre de directions sûres (au moins 1).
+ * @return L'indice de la direction choisie.
+ */
+static int choisirSimulation(Recherche *recherche, const Partie *partie,
+                             const int *possibles, int nombre)
+{
+    uint32_t tirage = tirerAleatoire(&recherche->aleatoire);
+    Segment tete = teteSerpent(&partie->serpent);
+    int meilleure = possibles[0];
+    int meilleure_distance = -1;
+
+    if ((int)(tirage & 3) >= CHANCES_GLOUTON)
+    {
+        return possibles[(tirage >> 2) % nombre];
+    }
+    for (int i = 0; i < nombre; i++)
+    {
+        Segment arrivee = caseSuivante(partie, tete, DIRECTIONS[possibles[i]]);
+        int distance = abs(arrivee.x - partie->pomme.x) + abs(arrivee.y - partie->pomme.y);
+
+        if (meilleure_distance < 0 || distance < meilleure_distance)
+        {
+            meilleure_distance = distance;
+            meilleure = possibles[i];
+        }
+    }
+    return meilleure;
+}
@@ -0,0 +1,487 @@
+/**
+ * @file metriques.c
+ * @brief Compteurs par thread et export au format texte de Prometheus.
+ *
+ * @details
+ * - Un bloc de compteurs est créé pour chaque thread à sa première mesure et
+ *   ajouté (compare-and-swap) à une liste qui ne fait que grandir : un thread
+ *   terminé garde ses compteurs dans les totaux.
+ * - Le thread propriétaire est le seul écrivain de son bloc : une mesure est
+ *   une lecture et une écriture ordinaires (atomiques relâchées, sans
+ *   préfixe lock), sur une ligne de cache qu'aucun autre thread n'écrit.
+ * - Les compteurs sont additionnés sur tous les blocs à chaque lecture de
+ *   l'export ; les jauges sont données thread par thread (étiquette « fil »).
+ * - Un thread d'export attend les connexions (socket Unix) ou réécrit le
+ *   fichier chaque seconde ; un tube le réveille pour l'arrêter.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "metriques.h"
+
+#define TAILLE_EXPORT 16384         /**< Taille maximale d'un export. */
+#define TAILLE_REQUETE 1024         /**< Octets de la requête HTTP lus (et ignorés). */
+#define ATTENTE_REQUETE 100         /**< Attente maximale (ms) de la requête d'un client. */
+#define PERIODE_FICHIER 1000        /**< Période (ms) de réécriture du fichier d'export. */
+#define SUFFIXE_FICHIER ".prom"     /**< Suffixe qui choisit l'export par fichier. */
+
+/** @brief Compteurs et jauges d'un thread. */
+typedef struct BlocMetriques
+{
+    _Alignas(64) atomic_uint_least64_t compteurs[NOMBRE_COMPTEURS];  /**< Compteurs du thread. */
+    atomic_int_least64_t jauges[NOMBRE_JAUGES];     /**< Jauges du thread. */
+    atomic_bool jauge;                              /**< Le thread a positionné au moins une jauge. */
+    int numero;                                     /**< Numéro du thread (ordre de première mesure). */
+    struct BlocMetriques *suivant;                  /**< Bloc créé avant celui-ci. */
+} BlocMetriques;
+
+/** @brief Description d'un compteur pour l'export. */
+typedef struct
+{
+    const char *nom;            /**< Nom de la métrique. */
+    const char *etiquette;      /**< Étiquette (NULL : aucune). */
+    const char *aide;           /**< Texte d'aide (NULL : même métrique que le compteur précédent). */
+} DescriptionMetrique;
+
+/** Descriptions des compteurs, dans l'ordre de Compteur. */
+static const DescriptionMetrique COMPTEURS[NOMBRE_COMPTEURS] = {
+    {"snake_tours_total", NULL, "Tours joués."},
+    {"snake_pommes_total", NULL, "Pommes mangées."},
+    {"snake_collisions_total", "cause=\"mur\"", "Parties perdues, par obstacle heurté."},
+    {"snake_collisions_total", "cause=\"corps\"", NULL},
+    {"snake_images_total", NULL, "Images écrites dans le terminal."},
+    {"snake_octets_total", NULL, "Octets écrits dans le terminal."},
+    {"snake_images_sautees_total", NULL, "Images remplacées avant d'être écrites (terminal en retard)."},
+    {"snake_tours_en_retard_total", NULL, "Tours dont l'échéance était déjà dépassée."},
+    {"snake_parties_recommencees_total", NULL, "Parties recommencées sans quitter le jeu."},
+};
+
+/** Descriptions des jauges, dans l'ordre de Jauge. */
+static const DescriptionMetrique JAUGES[NOMBRE_JAUGES] = {
+    {"snake_vitesse_microsecondes", NULL, "Durée d'un tour de la partie en cours."},
+    {"snake_longueur_serpent", NULL, "Segments du serpent de la partie en cours."},
+};
+
+static _Atomic(BlocMetriques *) blocs = NULL;       /**< Liste des blocs, le plus récent en tête. */
+static atomic_int nombre_blocs;                     /**< Nombre de blocs créés. */
+static _Thread_local BlocMetriques *bloc_local;     /**< Bloc du thread courant. */
+static pthread_t thread_export;                     /**< Thread d'export. */
+static bool export_actif = false;                   /**< Le thread d'export tourne. */
+static char *chemin_export;                         /**< Socket ou fichier d'export. */
+static bool export_fichier;                         /**< Export par fichier plutôt que par socket. */
+static int ecoute = -1;                             /**< Socket d'écoute. */
+static int reveil[2] = {-1, -1};                    /**< Tube de réveil du thread d'export. */
+
+static BlocMetriques *blocLocal(void);
+static void *servirMetriques(void *argument);
+static void repondre(int client);
+static void ecrireFichier(void);
+static bool envoyerTout(int descripteur, const char *octets, size_t taille);
+static size_t ajouterTexte(char *texte, size_t taille, size_t longueur, const char *format, ...);
+
+/**
+ * @brief Démarre l'export des métriques.
+ *
+ * @param chemin Socket Unix à créer, ou fichier « .prom » à réécrire.
+ * @return false si l'export ne peut pas être créé.
+ */
+bool demarrerMetriques(const char *chemin)
+{
+    size_t longueur = strlen(chemin);
+    struct sockaddr_un adresse;
+    sigset_t signaux, anciens;
+
+    export_fichier = longueur >= strlen(SUFFIXE_FICHIER) &&
+                     strcmp(chemin + longueur - strlen(SUFFIXE_FICHIER), SUFFIXE_FICHIER) == 0;
+    if (!export_fichier)
+    {
+        memset(&adresse, 0, sizeof(adresse));
+        adresse.sun_family = AF_UNIX;
+        if (longueur >= sizeof(adresse.sun_path))
+        {
+            fprintf(stderr, "%s : chemin de socket trop long\n", chemin);
+            return false;
+        }
+        memcpy(adresse.sun_path, chemin, longueur + 1);
+        ecoute = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        // Une socket laissée par une exécution précédente est remplacée
+        unlink(chemin);
+        if (ecoute < 0 || bind(ecoute, (struct sockaddr *)&adresse, sizeof(adresse)) != 0 ||
+            listen(ecoute, 8) != 0)
+        {
+            perror(chemin);
+            if (ecoute >= 0)
+            {
+                close(ecoute);
+                ecoute = -1;
+            }
+            return false;
+        }
+    }
+    if (pipe(reveil) != 0)
+    {
+        perror("pipe");
+        return false;
+    }
+    chemin_export = malloc(longueur + 1);
+    if (chemin_export == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(chemin_export, chemin, longueur + 1);
+
+    // Les signaux restent au thread principal : le thread d'export les bloque dès sa création
+    sigfillset(&signaux);
+    pthread_sigmask(SIG_BLOCK, &signaux, &anciens);
+    export_actif = pthread_create(&thread_export, NULL, servirMetriques, NULL) == 0;
+    pthread_sigmask(SIG_SETMASK, &anciens, NULL);
+    return export_actif;
+}
+
+/**
+ * @brief Arrête l'export (un dernier fichier est écrit) et supprime la socket.
+ */
+void arreterMetriques(void)
+{
+    if (!export_actif)
+    {
+        return;
+    }
+    if (write(reveil[1], "", 1) != 1)
+    {
+        perror("write");
+    }
+    pthread_join(thread_export, NULL);
+    export_actif = false;
+    if (export_fichier)
+    {
+        ecrireFichier();
+    }
+    else
+    {
+        close(ecoute);
+        ecoute = -1;
+        unlink(chemin_export);
+    }
+    close(reveil[0]);
+    close(reveil[1]);
+    free(chemin_export);
+    chemin_export = NULL;
+}
+
+/**
+ * @brief Ajoute une valeur à un compteur du thread courant.
+ *
+ * @param compteur Le compteur.
+ * @param valeur Valeur à ajouter.
+ */
+void compter(Compteur compteur, uint64_t valeur)
+{
+    BlocMetriques *bloc = blocLocal();
+
+    // Seul écrivain du bloc : pas besoin d'incrément atomique
+    atomic_store_explicit(&bloc->compteurs[compteur],
+                          atomic_load_explicit(&bloc->compteurs[compteur], memory_order_relaxed) + valeur,
+                          memory_order_relaxed);
+}
+
+/**
+ * @brief Positionne une jauge du thread courant.
+ *
+ * @param jauge La jauge.
+ * @param valeur Sa valeur.
+ */
+void jauger(Jauge jauge, int64_t valeur)
+{
+    BlocMetriques *bloc = blocLocal();
+
+    atomic_store_explicit(&bloc->jauges[jauge], valeur, memory_order_relaxed);
+    atomic_store_explicit(&bloc->jauge, true, memory_order_relaxed);
+}
+
+/**
+ * @brief Mesure un tour joué : tours, pommes, collision et ses causes, jauges.
+ *
+ * @param partie La partie, après jouerTour().
+ * @param issue Issue du tour.
+ * @param pomme_mangee Une pomme a été mangée pendant le tour.
+ */
+void compterTour(const Partie *partie, Issue issue, bool pomme_mangee)
+{
+    compter(COMPTEUR_TOURS, 1);
+    if (pomme_mangee)
+    {
+        compter(COMPTEUR_POMMES, 1);
+    }
+    if (issue == PARTIE_PERDUE)
+    {
+        Segment tete = teteSerpent(&partie->serpent);
+
+        // La tête partage sa case avec un segment : collision avec le corps
+        compter(OCCUPATION(partie, tete.x, tete.y) > 1 ? COMPTEUR_COLLISIONS_CORPS : COMPTEUR_COLLISIONS_MUR, 1);
+    }
+    jauger(JAUGE_VITESSE, partie->vitesse_actuelle);
+    jauger(JAUGE_LONGUEUR, partie->serpent.taille);
+}
+
+/**
+ * @brief Écrit toutes les métriques au format texte de Prometheus.
+ *
+ * @param texte Reçoit le texte (terminé par un zéro).
+ * @param taille Taille de texte ; le texte est tronqué s'il ne tient pas.
+ * @return La longueur du texte écrit.
+ */
+size_t ecrireMetriques(char *texte, size_t taille)
+{
+    uint64_t totaux[NOMBRE_COMPTEURS] = {0};
+    BlocMetriques *premier = atomic_load(&blocs);
+    size_t longueur = 0;
+
+    for (BlocMetriques *bloc = premier; bloc != NULL; bloc = bloc->suivant)
+    {
+        for (int c = 0; c < NOMBRE_COMPTEURS; c++)
+        {
+            totaux[c] += atomic_load_explicit(&bloc->compteurs[c], memory_order_relaxed);
+        }
+    }
+
+    for (int c = 0; c < NOMBRE_COMPTEURS; c++)
+    {
+        if (COMPTEURS[c].aide != NULL)
+        {
+            longueur = ajouterTexte(texte, taille, longueur, "# HELP %s %s\n# TYPE %s counter\n",
+                                    COMPTEURS[c].nom, COMPTEURS[c].aide, COMPTEURS[c].nom);
+        }
+        if (COMPTEURS[c].etiquette != NULL)
+        {
+            longueur = ajouterTexte(texte, taille, longueur, "%s{%s} %llu\n", COMPTEURS[c].nom,
+                                    COMPTEURS[c].etiquette, (unsigned long long)totaux[c]);
+        }
+        else
+        {
+            longueur = ajouterTexte(texte, taille, longueur, "%s %llu\n", COMPTEURS[c].nom,
+                                    (unsigned long long)totaux[c]);
+        }
+    }
+
+    for (int j = 0; j < NOMBRE_JAUGES; j++)
+    {
+        longueur = ajouterTexte(texte, taille, longueur, "# HELP %s %s\n# TYPE %s gauge\n",
+                                JAUGES[j].nom, JAUGES[j].aide, JAUGES[j].nom);
+        for (BlocMetriques *bloc = premier; bloc != NULL; bloc = bloc->suivant)
+        {
+            if (atomic_load_explicit(&bloc->jauge, memory_order_relaxed))
+            {
+                longueur = ajouterTexte(texte, taille, longueur, "%s{fil=\"%d\"} %lld\n", JAUGES[j].nom,
+                                        bloc->numero,
+                                        (long long)atomic_load_explicit(&bloc->jauges[j], memory_order_relaxed));
+            }
+        }
+    }
+    return longueur;
+}
+
+/**
+ * @brief Bloc de compteurs du thread courant, créé à la première mesure.
+ *
+ * @return Le bloc.
+ */
+static BlocMetriques *blocLocal(void)
+{
+    BlocMetriques *bloc = bloc_local;
+
+    if (bloc == NULL)
+    {
+        bloc = aligned_alloc(64, sizeof(BlocMetriques));
+        if (bloc == NULL)
+        {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        memset(bloc, 0, sizeof(BlocMetriques));
+        bloc->numero = atomic_fetch_add(&nombre_blocs, 1);
+        bloc->suivant = atomic_load(&blocs);
+        while (!atomic_compare_exchange_weak(&blocs, &bloc->suivant, bloc))
+        {
+        }
+        bloc_local = bloc;
+    }
+    return bloc;
+}
+
+/**
+ * @brief Boucle du thread d'export.
+ *
+ * @param argument Inutilisé.
+ * @return NULL.
+ */
+static void *servirMetriques(void *argument)
+{
+    struct pollfd attentes[2] = {{reveil[0], POLLIN, 0}, {ecoute, POLLIN, 0}};
+
+    (void)argument;
+    while (true)
+    {
+        int prets = poll(attentes, export_fichier ? 1 : 2, export_fichier ? PERIODE_FICHIER : -1);
+
+        if (attentes[0].revents & POLLIN)
+        {
+            break;
+        }
+        if (export_fichier && prets == 0)
+        {
+            ecrireFichier();
+        }
+        else if (!export_fichier && (attentes[1].revents & POLLIN))
+        {
+            int client = accept(ecoute, NULL, NULL);
+
+            if (client >= 0)
+            {
+                repondre(client);
+                close(client);
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Répond à un client de la socket : en-tête HTTP puis métriques.
+ *
+ * La requête est lue si elle arrive vite, mais son contenu est ignoré :
+ * tout client reçoit l'export.
+ *
+ * @param client Connexion du client.
+ */
+static void repondre(int client)
+{
+    char requete[TAILLE_REQUETE];
+    char texte[TAILLE_EXPORT];
+    char entete[160];
+    struct pollfd attente = {client, POLLIN, 0};
+    size_t longueur;
+    int taille_entete;
+
+    if (poll(&attente, 1, ATTENTE_REQUETE) > 0 && read(client, requete, sizeof(requete)) < 0)
+    {
+        return;
+    }
+    longueur = ecrireMetriques(texte, sizeof(texte));
+    taille_entete = snprintf(entete, sizeof(entete),
+                             "HTTP/1.0 200 OK\r\n"
+                             "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                             "Content-Length: %zu\r\n\r\n", longueur);
+    if (envoyerTout(client, entete, (size_t)taille_entete))
+    {
+        envoyerTout(client, texte, longueur);
+    }
+}
+
+/**
+ * @brief Remplace le fichier d'export (écriture sous un nom temporaire puis renommage).
+ */
+static void ecrireFichier(void)
+{
+    char texte[TAILLE_EXPORT];
+    size_t longueur = ecrireMetriques(texte, sizeof(texte));
+    size_t taille_chemin = strlen(chemin_export);
+    char temporaire[taille_chemin + 8];
+    int descripteur;
+    bool ecrit;
+
+    memcpy(temporaire, chemin_export, taille_chemin);
+    strcpy(temporaire + taille_chemin, ".XXXXXX");
+    descripteur = mkstemp(temporaire);
+    if (descripteur < 0)
+    {
+        return;
+    }
+    fchmod(descripteur, 0644);
+    ecrit = envoyerTout(descripteur, texte, longueur);
+    if (close(descripteur) != 0 || !ecrit || rename(temporaire, chemin_export) != 0)
+    {
+        unlink(temporaire);
+    }
+}
+
+/**
+ * @brief Écrit tous les octets, en reprenant les écritures partielles.
+ *
+ * @param descripteur Fichier ou socket.
+ * @param octets Octets à écrire.
+ * @param taille Nombre d'octets.
+ * @return false si l'écriture a échoué (client parti, disque plein).
+ */
+static bool envoyerTout(int descripteur, const char *octets, size_t taille)
+{
+    while (taille > 0)
+    {
+        ssize_t ecrits = send(descripteur, octets, taille, MSG_NOSIGNAL);
+
+        if (ecrits < 0 && errno == ENOTSOCK)
+        {
+            ecrits = write(descripteur, octets, taille);
+        }
+        if (ecrits < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        octets += ecrits;
+        taille -= (size_t)ecrits;
+    }
+    return true;
+}
+
+/**
+ * @brief Ajoute du texte formaté, sans dépasser la taille du tampon.
+ *
+ * @param texte Le tampon.
+ * @param taille Taille du tampon.
+ * @param longueur Longueur déjà écrite.
+ * @param format Format de printf().
+ * @return La nouvelle longueur.
+ */
+static size_t ajouterTexte(char *texte, size_t taille, size_t longueur, const char *format, ...)
+{
+    va_list arguments;
+    int ajout;
+
+    if (longueur + 1 >= taille)
+    {
+        return longueur;
+    }
+    va_start(arguments, format);
+    ajout = vsnprintf(texte + longueur, taille - longueur, format, arguments);
+    va_end(arguments);
+    if (ajout < 0)
+    {
+        return longueur;
+    }
+    // Texte tronqué : seule la partie écrite compte
+    return ((size_t)ajout < taille - longueur) ? longueur + (size_t)ajout : taille - 1;
+}
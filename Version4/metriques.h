@@ -0,0 +1,61 @@
+/**
+ * @file metriques.h
+ * @brief Compteurs et jauges du jeu, exportés au format texte de Prometheus.
+ *
+ * Chaque thread écrit dans son propre bloc de compteurs, sans verrou ni
+ * instruction atomique coûteuse (un seul écrivain par bloc). Les blocs ne
+ * sont additionnés qu'au moment d'une lecture de l'export : la mesure ne
+ * coûte presque rien au tour de jeu.
+ *
+ * L'export est servi sur une socket Unix (réponse HTTP, par exemple
+ * « curl --unix-socket chemin http://snake/metrics ») ou, si le chemin se
+ * termine par « .prom », écrit dans un fichier remplacé atomiquement chaque
+ * seconde (collecteur textfile de node_exporter).
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef METRIQUES_H
+#define METRIQUES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "jeu.h"
+
+/** @brief Compteurs (valeurs qui ne font que croître). */
+typedef enum
+{
+    COMPTEUR_TOURS,             /**< Tours joués. */
+    COMPTEUR_POMMES,            /**< Pommes mangées. */
+    COMPTEUR_COLLISIONS_MUR,    /**< Parties perdues contre une bordure ou un pavé. */
+    COMPTEUR_COLLISIONS_CORPS,  /**< Parties perdues contre le corps du serpent. */
+    COMPTEUR_IMAGES,            /**< Images écrites dans le terminal. */
+    COMPTEUR_OCTETS,            /**< Octets écrits dans le terminal. */
+    COMPTEUR_IMAGES_SAUTEES,    /**< Images jamais écrites (terminal en retard). */
+    COMPTEUR_RETARDS,           /**< Tours dont l'échéance était dépassée avant l'attente. */
+    COMPTEUR_PARTIES,           /**< Parties recommencées sans quitter le jeu. */
+    NOMBRE_COMPTEURS
+} Compteur;
+
+/** @brief Jauges (dernière valeur connue, par thread). */
+typedef enum
+{
+    JAUGE_VITESSE,              /**< vitesse_actuelle de la partie (µs par tour). */
+    JAUGE_LONGUEUR,             /**< Nombre de segments du serpent. */
+    NOMBRE_JAUGES
+} Jauge;
+
+/* Déclaration des fonctions */
+bool demarrerMetriques(const char *chemin);
+void arreterMetriques(void);
+void compter(Compteur compteur, uint64_t valeur);
+void jauger(Jauge jauge, int64_t valeur);
+void compterTour(const Partie *partie, Issue issue, bool pomme_mangee);
+size_t ecrireMetriques(char *texte, size_t taille);
+
+#endif
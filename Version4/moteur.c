@@ -0,0 +1,1391 @@
+/**
+ * @file moteur.c
+ * @brief Moteur du jeu Snake version 4, sans affichage.
+ *
+ * @details
+ * - Toutes les données d'une partie sont regroupées dans une structure Partie :
+ *   plusieurs parties peuvent être jouées en même temps, dans des threads différents.
+ * - Le hasard vient d'un générateur propre à chaque partie : une même graine
+ *   donne toujours les mêmes pavés et la même suite de pommes.
+ * - Le serpent n'est pas inscrit dans le plateau : une pomme peut apparaître
+ *   sous son corps, comme dans la version 4 d'origine. Il en va de même des
+ *   bonus ; pommes et bonus sont aussi rangés dans la table des objets de la
+ *   partie (voir objets.h), que le moteur ne parcourt jamais en entier.
+ * - Une partie peut être clonée à peu de frais (recherche, simulations) : le
+ *   clone partage le plateau de l'original et ne le recopie qu'à sa première
+ *   modification (pomme mangée ou placée). L'original ne doit pas être joué
+ *   tant que ses clones sont utilisés. Le clone note les cases qu'il modifie :
+ *   reprendreClone() le ramène à l'original en ne reprenant que celles-là et
+ *   les segments ajoutés ou retirés, quelle que soit la taille du plateau et
+ *   du serpent.
+ * - L'empreinte de Zobrist de la partie est tenue à jour à chaque tour en
+ *   quelques opérations (tête, queue, liens du corps, objets, direction),
+ *   quelle que soit la taille du serpent ; calculerEmpreinte() la recalcule
+ *   entièrement. Le corps est haché par ses liens (voir cleLien()) : l'ordre
+ *   des segments compte, pas seulement les cases occupées.
+ * - Une partie terminée peut être recommencée sur place (recommencerPartie()) :
+ *   seules les cases du plateau modifiées depuis le départ, notées au fil
+ *   de la partie, sont remises à neuf.
+ * - Un tour joué par jouerCoup() peut être annulé par annulerCoup() (parcours
+ *   exhaustifs, sans copie de la partie) quand les règles n'ont ni bonus ni
+ *   pavés mobiles.
+ * - Les règles (taille du plateau, pavés, vitesse, objectif, touches) sont
+ *   lues dans les règles publiées (voir regles.h) : de nouvelles règles
+ *   peuvent être publiées pendant que des parties sont jouées, chacune les
+ *   prend entre deux tours (appliquerRegles()).
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "jeu.h"
+#include "niveaux.h"
+
+/** Définitions des constantes */
+const char COTE_BORDURE = '#';          /**< Caractère utilisé pour afficher les bordures et pavés. */
+const char POMME = '6';                 /**< Caractère qui représente une pomme. */
+const char ACCELERATEUR = '>';          /**< Caractère qui représente un bonus accélérateur. */
+const char RALENTISSEUR = '<';          /**< Caractère qui représente un bonus ralentisseur. */
+const char RETRECISSEUR = '%';          /**< Caractère qui représente un bonus rétrécisseur. */
+const int ACCELERATION = 15000;         /**< Vitesse pour diminuer l'acceleration. */
+const char STOP_JEU = 'a';              /**< Touche pour arrêter le jeu. */
+const char CORPS = 'X';                 /**< Caractère qui représente le corps du serpent. */
+const char TETE = 'O';                  /**< Caractère qui représente la tête du serpent. */
+const char VIDE = ' ';                  /**< Caractère qui représente une case vide. */
+const int COORD_DEPART_X_SERPENT = 40;  /**< Position de départ en X du serpent. */
+const int COORD_DEPART_Y_SERPENT = 20;  /**< Position de départ en Y du serpent. */
+const int VITESSE_JEU = 200000;         /**< Temporisation entre les déplacements en microsecondes. */
+const int NOMBRES_PAVES = 4;            /**< Nombre de pavés à placer sur le plateau. */
+const int TAILLE_PAVE = 5;              /**< Taille des pavés (carrés). */
+const int OBJECTIF_POMMES = 10;         /**< Nombre de pomme au total pour les manger. */
+
+#define GRAINE_PAR_DEFAUT 2463534242u   /**< Graine utilisée à la place de 0, interdit pour le générateur. */
+#define EFFET_VITESSE 4                 /**< Un accélérateur ôte (un ralentisseur ajoute) 1/EFFET_VITESSE de la temporisation. */
+#define RETRECISSEMENT 5                /**< Segments perdus avec un rétrécisseur. */
+#define TAILLE_MIN_SERPENT 2            /**< Taille en deçà de laquelle un rétrécisseur est sans effet. */
+#define CAPACITE_TOUCHEES 256           /**< Cases touchées notées avant le premier agrandissement du tableau. */
+
+/** Familles de clés de Zobrist des objets, dans l'ordre de TypeObjet. */
+static const FamilleCle FAMILLES_OBJETS[NOMBRE_TYPES_OBJETS] =
+{
+    CLE_POMME, CLE_ACCELERATEUR, CLE_RALENTISSEUR, CLE_RETRECISSEUR
+};
+
+/** Directions de départ des pavés mobiles (dx, dy). */
+static const int DEPLACEMENTS_PAVES[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+
+static _Atomic(const Regles *) regles_publiees = NULL;  /**< Règles des nouvelles parties (NULL : par défaut). */
+
+static Regles *copierRegles(const Regles *regles);
+static void placerDepart(Partie *partie, uint32_t graine);
+static char caseVierge(const Partie *partie, int x, int y);
+static void modifierPlateau(Partie *partie, int x, int y, char c);
+static void noterCase(Partie *partie, size_t indice);
+static void occuperCase(Partie *partie, Segment position);
+static uint64_t cleLien(const Partie *partie, Segment segment, Segment suivant);
+static void libererCase(Partie *partie, Segment position);
+static void deplacerPaves(Partie *partie);
+static void deplacerPave(Partie *partie, int indice);
+static void basculerMur(Partie *partie, int x, int y, char c);
+static Segment tirerCaseVide(Partie *partie);
+static void poserObjet(Partie *partie, Segment position, int type, long disparition);
+static void enleverObjet(Partie *partie, int indice);
+static void renouvelerBonus(Partie *partie);
+static void appliquerBonus(Partie *partie, int type);
+static void changerVitesse(Partie *partie, long vitesse);
+
+/**
+ * @brief Prépare une nouvelle partie.
+ *
+ * Alloue le plateau dans l'arène de la partie, place le serpent à sa position
+ * de départ, les bordures, les pavés, les premières pommes et les bonus.
+ *
+ * @param partie Partie à créer.
+ * @param graine Graine du générateur pseudo-aléatoire.
+ */
+void creerPartie(Partie *partie, uint32_t graine)
+{
+    const Regles *regles = reglesCourantes();
+    size_t cases;
+
+    partie->regles = regles;
+    partie->largeur = regles->largeur;
+    partie->hauteur = regles->hauteur;
+    cases = (size_t)partie->largeur * partie->hauteur;
+
+    initialiserArene(&partie->arene);
+    partie->plateau = allouerDansArene(&partie->arene, cases);
+    partie->plateau_prive = partie->plateau;
+    partie->plateau_partage = false;
+    partie->occupation = allouerDansArene(&partie->arene, cases);
+    memset(partie->occupation, 0, cases);
+    partie->touchee = NULL;
+    partie->touchees = NULL;
+    partie->nombre_touchees = 0;
+    partie->capacite_touchees = 0;
+    partie->occupation_notee = false;
+    partie->empreinte_vierge = 0;
+    initialiserSerpent(&partie->serpent, &partie->arene);
+
+    memset(&partie->obstacles, 0, sizeof(Obstacles));
+    if (regles->niveau == NIVEAU_PAVES)
+    {
+        // Plateau vierge : les cases modifiées ensuite sont notées pour recommencerPartie()
+        initPlateau(partie);
+        for (size_t i = 0; i < cases; i++)
+        {
+            if (partie->plateau[i] == COTE_BORDURE)
+            {
+                partie->empreinte_vierge ^= cleZobrist(CLE_MUR, i);
+            }
+        }
+        partie->touchee = allouerDansArene(&partie->arene, cases);
+        memset(partie->touchee, 0, cases);
+        partie->capacite_touchees = CAPACITE_TOUCHEES;
+        partie->touchees = allouerDansArene(&partie->arene, CAPACITE_TOUCHEES * sizeof(size_t));
+        if (regles->periode_paves > 0 && regles->nombre_paves > 0)
+        {
+            initialiserObstacles(&partie->obstacles, &partie->arene, partie->largeur, partie->hauteur,
+                                 regles->taille_pave, regles->nombre_paves, regles->periode_paves);
+        }
+    }
+
+    initialiserObjets(&partie->objets, &partie->arene, partie->largeur, regles->pommes, regles->bonus,
+                      regles->duree_bonus);
+    placerDepart(partie, graine);
+    partie->empreinte = calculerEmpreinte(partie);
+}
+
+/**
+ * @brief Remet une partie à son départ, avec une nouvelle graine, sans la recréer.
+ *
+ * Donne la même partie que creerPartie() avec la même graine et les règles
+ * courantes. Seules les cases du plateau touchées depuis le départ précédent
+ * (pavés, objets) sont remises à neuf et l'occupation n'est effacée que sous
+ * le serpent : le coût dépend de la partie jouée, pas de la taille du
+ * plateau. La partie est recréée entièrement si le niveau est généré, ou si
+ * les règles ont changé la taille du plateau, les pavés mobiles ou les objets.
+ *
+ * @param partie Partie créée par creerPartie() (pas un clone).
+ * @param graine Graine du générateur pseudo-aléatoire.
+ */
+void recommencerPartie(Partie *partie, uint32_t graine)
+{
+    const Regles *regles = reglesCourantes();
+    bool mobiles = regles->periode_paves > 0 && regles->nombre_paves > 0;
+    Parcours parcours;
+    Segment segment;
+
+    if (partie->touchee == NULL || regles->niveau != NIVEAU_PAVES ||
+        regles->largeur != partie->largeur || regles->hauteur != partie->hauteur ||
+        regles->pommes + regles->bonus != partie->objets.capacite ||
+        regles->bonus != partie->objets.bonus_voulus || regles->duree_bonus != partie->objets.duree_bonus ||
+        mobiles != (partie->obstacles.capacite > 0) ||
+        (mobiles && (regles->nombre_paves != partie->obstacles.capacite ||
+                     regles->taille_pave != partie->obstacles.taille)))
+    {
+        detruirePartie(partie);
+        creerPartie(partie, graine);
+        return;
+    }
+
+    for (size_t i = 0; i < partie->nombre_touchees; i++)
+    {
+        size_t indice = partie->touchees[i];
+
+        partie->plateau[indice] = caseVierge(partie, (int)(indice % partie->largeur), (int)(indice / partie->largeur));
+        partie->touchee[indice] = 0;
+    }
+    partie->nombre_touchees = 0;
+    debutParcours(&partie->serpent, &parcours);
+    while (segmentSuivant(&parcours, &segment))
+    {
+        OCCUPATION(partie, segment.x, segment.y) = 0;
+    }
+    viderSerpent(&partie->serpent);
+    viderObjets(&partie->objets);
+    if (mobiles)
+    {
+        viderObstacles(&partie->obstacles);
+        partie->obstacles.periode = regles->periode_paves;
+    }
+    partie->regles = regles;
+    placerDepart(partie, graine);
+}
+
+/**
+ * @brief Termine une partie et rend toute sa mémoire d'un coup.
+ *
+ * @param partie Partie à détruire.
+ */
+void detruirePartie(Partie *partie)
+{
+    libererArene(&partie->arene);
+    partie->plateau = NULL;
+    partie->plateau_prive = NULL;
+    partie->occupation = NULL;
+    partie->touchee = NULL;
+    partie->touchees = NULL;
+}
+
+/**
+ * @brief Prépare une partie vide destinée à recevoir des clones.
+ *
+ * La même copie peut recevoir des clones successifs sans nouvelle
+ * allocation ; elle est libérée par detruirePartie().
+ *
+ * @param copie Partie à préparer.
+ */
+void preparerCopie(Partie *copie)
+{
+    initialiserArene(&copie->arene);
+    initialiserSerpent(&copie->serpent, &copie->arene);
+    copie->largeur = 0;
+    copie->hauteur = 0;
+    copie->plateau = NULL;
+    copie->plateau_prive = NULL;
+    copie->plateau_partage = false;
+    copie->occupation = NULL;
+    copie->touchee = NULL;
+    copie->touchees = NULL;
+    copie->nombre_touchees = 0;
+    copie->occupation_notee = false;
+    memset(&copie->obstacles, 0, sizeof(Obstacles));
+    memset(&copie->objets, 0, sizeof(Objets));
+    copie->regles = NULL;
+}
+
+/**
+ * @brief Remplace une copie par un clone de la partie source.
+ *
+ * Le plateau n'est pas recopié : il est partagé jusqu'à la première
+ * modification du clone. L'occupation, le serpent, les pavés mobiles et les
+ * objets sont recopiés ; les cases que le clone modifiera ensuite sont
+ * notées pour reprendreClone().
+ *
+ * @param copie Copie préparée par preparerCopie() (ou clone précédent).
+ * @param source Partie à cloner.
+ */
+void clonerPartie(Partie *copie, const Partie *source)
+{
+    size_t cases = (size_t)source->largeur * source->hauteur;
+    Arene arene = copie->arene;
+    Serpent serpent = copie->serpent;
+    char *plateau_prive = copie->plateau_prive;
+    unsigned char *occupation = copie->occupation;
+    unsigned char *touchee = copie->touchee;
+    size_t *touchees = copie->touchees;
+    size_t capacite_touchees = copie->capacite_touchees;
+    Obstacles obstacles = copie->obstacles;
+    Objets objets = copie->objets;
+
+    if (occupation == NULL || (size_t)copie->largeur * copie->hauteur != cases)
+    {
+        plateau_prive = allouerDansArene(&arene, cases);
+        occupation = allouerDansArene(&arene, cases);
+        touchee = allouerDansArene(&arene, cases);
+        memset(touchee, 0, cases);
+        capacite_touchees = CAPACITE_TOUCHEES;
+        touchees = allouerDansArene(&arene, CAPACITE_TOUCHEES * sizeof(size_t));
+    }
+    else
+    {
+        for (size_t i = 0; i < copie->nombre_touchees; i++)
+        {
+            touchee[touchees[i]] = 0;
+        }
+    }
+
+    *copie = *source;
+    copie->arene = arene;
+    copie->serpent = serpent;
+    copie->serpent.arene = &copie->arene;
+    copie->plateau_prive = plateau_prive;
+    copie->plateau_partage = true;
+    copie->occupation = occupation;
+    // Un clone n'est jamais recommencé : ses cases touchées sont celles modifiées depuis le clonage
+    copie->touchee = touchee;
+    copie->touchees = touchees;
+    copie->nombre_touchees = 0;
+    copie->capacite_touchees = capacite_touchees;
+    copie->occupation_notee = true;
+    memcpy(copie->occupation, source->occupation, cases);
+    copierSerpent(&copie->serpent, &source->serpent);
+    copie->obstacles = obstacles;
+    copierObstacles(&copie->obstacles, &source->obstacles, &copie->arene);
+    copie->objets = objets;
+    copierObjets(&copie->objets, &source->objets, &copie->arene);
+}
+
+/**
+ * @brief Ramène un clone à l'état de sa source, sans recopier plateau ni serpent.
+ *
+ * Seules les cases notées depuis le clonage (occupation, et plateau s'il a
+ * été recopié) et les segments ajoutés ou retirés sont repris de la source :
+ * le coût dépend de ce que le clone a joué, pas de la taille du plateau ni
+ * du serpent. Les pavés mobiles et les objets sont recopiés comme par
+ * clonerPartie().
+ *
+ * @param copie Clone de source fait par clonerPartie() (ou repris depuis).
+ * @param source Partie clonée, qui n'a pas été modifiée depuis.
+ */
+void reprendreClone(Partie *copie, const Partie *source)
+{
+    Arene arene = copie->arene;
+    Serpent serpent = copie->serpent;
+    char *plateau_prive = copie->plateau_prive;
+    bool plateau_partage = copie->plateau_partage;
+    unsigned char *occupation = copie->occupation;
+    unsigned char *touchee = copie->touchee;
+    size_t *touchees = copie->touchees;
+    size_t capacite_touchees = copie->capacite_touchees;
+    Obstacles obstacles = copie->obstacles;
+    Objets objets = copie->objets;
+
+    for (size_t i = 0; i < copie->nombre_touchees; i++)
+    {
+        size_t indice = touchees[i];
+
+        occupation[indice] = source->occupation[indice];
+        if (!plateau_partage)
+        {
+            plateau_prive[indice] = source->plateau[indice];
+        }
+        touchee[indice] = 0;
+    }
+
+    *copie = *source;
+    copie->arene = arene;
+    copie->serpent = serpent;
+    copie->serpent.arene = &copie->arene;
+    copie->plateau_prive = plateau_prive;
+    // Un plateau déjà recopié est redevenu celui de la source : il reste propre au clone
+    if (!plateau_partage)
+    {
+        copie->plateau = plateau_prive;
+    }
+    copie->plateau_partage = plateau_partage;
+    copie->occupation = occupation;
+    copie->touchee = touchee;
+    copie->touchees = touchees;
+    copie->nombre_touchees = 0;
+    copie->capacite_touchees = capacite_touchees;
+    copie->occupation_notee = true;
+    reprendreSerpent(&copie->serpent, &source->serpent);
+    copie->obstacles = obstacles;
+    copierObstacles(&copie->obstacles, &source->obstacles, &copie->arene);
+    copie->objets = objets;
+    copierObjets(&copie->objets, &source->objets, &copie->arene);
+}
+
+/**
+ * @brief Joue un tour complet : déplacement, objets, accélération et fin de partie.
+ *
+ * @param partie La partie.
+ * @param direction Direction du serpent pour ce tour.
+ * @param pomme_mangee Indicateur de pomme mangée (une nouvelle pomme a alors été placée).
+ * @return L'issue du tour.
+ */
+Issue jouerTour(Partie *partie, char direction, bool *pomme_mangee)
+{
+    bool collision;
+
+    partie->objets.nombre_changees = 0;
+    progresser(partie, direction, &collision, pomme_mangee);
+    partie->tour++;
+    if (partie->obstacles.periode > 0 && !collision)
+    {
+        deplacerPaves(partie);
+    }
+
+    if (*pomme_mangee)
+    {
+        partie->pommes_mangees++;
+        ajouterPomme(partie);
+        // Accélération du jeu (le serpent a grandi dans progresser()), bornée en mode sans fin
+        changerVitesse(partie, (long)partie->vitesse_actuelle - partie->regles->acceleration);
+
+        if (partie->objectif_pommes > 0 && partie->pommes_mangees >= partie->objectif_pommes)
+        {
+            return PARTIE_GAGNEE;
+        }
+    }
+
+    if (collision)
+    {
+        return PARTIE_PERDUE;
+    }
+    renouvelerBonus(partie);
+    return PARTIE_EN_COURS;
+}
+
+/**
+ * @brief Joue un tour complet en notant de quoi l'annuler.
+ *
+ * Le tour est joué par jouerTour() : les mêmes règles, au même générateur.
+ * La partie ne doit avoir ni bonus ni pavés mobiles.
+ *
+ * @param partie La partie.
+ * @param direction Direction du serpent pour ce tour.
+ * @param coup Reçoit de quoi annuler le tour (voir annulerCoup()).
+ * @return L'issue du tour.
+ */
+Issue jouerCoup(Partie *partie, char direction, Coup *coup)
+{
+    Issue issue;
+
+    coup->queue = queueSerpent(&partie->serpent);
+    coup->pomme = partie->pomme;
+    coup->direction = partie->direction;
+    coup->vitesse_actuelle = partie->vitesse_actuelle;
+    coup->aleatoire = partie->aleatoire;
+    coup->empreinte = partie->empreinte;
+    issue = jouerTour(partie, direction, &coup->pomme_mangee);
+    coup->nouvelle_pomme = partie->pomme;
+    return issue;
+}
+
+/**
+ * @brief Annule le dernier tour joué par jouerCoup().
+ *
+ * Les coups s'annulent dans l'ordre inverse où ils ont été joués. La partie
+ * redevient celle d'avant le tour, à l'ordre près de sa table des objets.
+ *
+ * @param partie La partie.
+ * @param coup Le coup à annuler.
+ */
+void annulerCoup(Partie *partie, const Coup *coup)
+{
+    Serpent *serpent = &partie->serpent;
+    Segment tete = teteSerpent(serpent);
+
+    if (coup->pomme_mangee)
+    {
+        // La nouvelle pomme peut être tombée sur la case de la tête : retirée avant de remettre l'ancienne
+        Segment nouvelle = coup->nouvelle_pomme;
+
+        retirerObjet(&partie->objets, chercherObjet(&partie->objets, nouvelle));
+        modifierPlateau(partie, nouvelle.x, nouvelle.y, VIDE);
+        ajouterObjet(&partie->objets, tete, OBJET_POMME, -1);
+        modifierPlateau(partie, tete.x, tete.y, POMME);
+        libererCase(partie, retirerQueue(serpent));
+        partie->pommes_mangees--;
+    }
+    libererCase(partie, retirerTete(serpent));
+    ajouterQueue(serpent, coup->queue);
+    occuperCase(partie, coup->queue);
+
+    partie->tour--;
+    partie->pomme = coup->pomme;
+    partie->direction = coup->direction;
+    partie->vitesse_actuelle = coup->vitesse_actuelle;
+    partie->aleatoire = coup->aleatoire;
+    partie->empreinte = coup->empreinte;
+    partie->objets.nombre_changees = 0;
+}
+
+/**
+ * @brief Met à jour la position du serpent en fonction de la direction.
+ *
+ * Gère les déplacements, détecte les collisions (obstacles, corps), et
+ * vérifie si une pomme ou un bonus a été mangé (son effet est alors appliqué).
+ * Met à jour la position du plateau en conséquence.
+ *
+ * Le serpent avance en gagnant une tête et en perdant sa queue, sans
+ * déplacer les autres segments. La collision avec le corps se lit dans
+ * la grille d'occupation, quelle que soit la taille du serpent.
+ * Le dessin est laissé à l'appelant.
+ *
+ * @param partie La partie.
+ * @param direction Direction actuelle du serpent ('z', 'q', 's', 'd').
+ * @param collision Indicateur de collision (modifié si le serpent se heurte).
+ * @param pomme_mangee Indicateur de pomme mangée (modifié si une pomme est mangée).
+ */
+void progresser(Partie *partie, char direction, bool *collision, bool *pomme_mangee)
+{
+    Serpent *serpent = &partie->serpent;
+    Segment ancienne_tete = teteSerpent(serpent);
+    Segment tete = caseSuivante(partie, ancienne_tete, direction);
+    Segment queue, nouvelle_queue;
+    bool heurte_corps;
+
+    *collision = false;
+    *pomme_mangee = false;
+    partie->empreinte ^= cleZobrist(CLE_DIRECTION, (unsigned char)partie->direction) ^
+                         cleZobrist(CLE_DIRECTION, (unsigned char)direction);
+    partie->direction = direction;
+
+    // La queue libère sa case avant que la tête n'avance
+    queue = retirerQueue(serpent);
+    libererCase(partie, queue);
+    heurte_corps = (OCCUPATION(partie, tete.x, tete.y) > 0);
+    ajouterTete(serpent, tete);
+    occuperCase(partie, tete);
+
+    // Un lien de plus côté tête, un de moins côté queue
+    nouvelle_queue = queueSerpent(serpent);
+    partie->empreinte ^= cleZobrist(CLE_TETE, (size_t)ancienne_tete.y * partie->largeur + ancienne_tete.x) ^
+                         cleZobrist(CLE_TETE, (size_t)tete.y * partie->largeur + tete.x) ^
+                         cleZobrist(CLE_QUEUE, (size_t)queue.y * partie->largeur + queue.x) ^
+                         cleZobrist(CLE_QUEUE, (size_t)nouvelle_queue.y * partie->largeur + nouvelle_queue.x) ^
+                         cleLien(partie, ancienne_tete, tete) ^ cleLien(partie, queue, nouvelle_queue);
+
+    // Collisions avec le corps
+    if (heurte_corps)
+    {
+        *collision = true;
+        return;
+    }
+
+    // Collisions avec les obstacles
+    if (CASE(partie, tete.x, tete.y) == COTE_BORDURE)
+    {
+        *collision = true;
+        return;
+    }
+
+    // Gestion des pommes et des bonus, retrouvés par leur case
+    if (CASE(partie, tete.x, tete.y) != VIDE)
+    {
+        int indice = chercherObjet(&partie->objets, tete);
+        int type = partie->objets.objets[indice].type;
+
+        enleverObjet(partie, indice);
+        if (type != OBJET_POMME)
+        {
+            appliquerBonus(partie, type);
+            return;
+        }
+        *pomme_mangee = true;
+
+        // Ajout d'un nouveau segment à la queue du serpent, sur la même case
+        ajouterQueue(serpent, nouvelle_queue);
+        occuperCase(partie, nouvelle_queue);
+        partie->empreinte ^= cleLien(partie, nouvelle_queue, nouvelle_queue);
+    }
+}
+
+/**
+ * @brief Initialise le plateau de jeu.
+ *
+ * Remplit le plateau avec des bordures et des espaces vides. Ajoute des ouvertures aux bordures.
+ *
+ * @param partie La partie dont le plateau est initialisé.
+ */
+void initPlateau(Partie *partie)
+{
+    for (int i = 0; i < partie->hauteur; i++)
+    {
+        for (int j = 0; j < partie->largeur; j++)
+        {
+            CASE(partie, j, i) = caseVierge(partie, j, i);
+        }
+    }
+}
+
+/**
+ * @brief Place des pavés (obstacles fixes) sur le plateau.
+ *
+ * Les pavés sont placés aléatoirement, tout en respectant une distance
+ * minimale avec le serpent initial. Si les pavés sont mobiles, chacun est
+ * aussi ajouté aux obstacles de la partie avec une direction tirée au hasard.
+ *
+ * @param partie La partie dont le plateau reçoit les pavés.
+ */
+void placerPaves(Partie *partie)
+{
+    int taille_pave = partie->regles->taille_pave;
+    int depart_x = partie->largeur / 2;
+    int depart_y = partie->hauteur / 2;
+
+    for (int p = 0; p < partie->regles->nombre_paves; p++)
+    {
+        int x, y;
+        do {
+            x = tirerAleatoire(&partie->aleatoire) % (partie->largeur - 2 * taille_pave - 2) + 2;
+            y = tirerAleatoire(&partie->aleatoire) % (partie->hauteur - 2 * taille_pave - 2) + 2;
+        } while (CASE(partie, x, y) == COTE_BORDURE ||
+                ((x >= depart_x - 15) &&
+                 (x <= depart_x + 15) &&
+                 (y >= depart_y - 15) &&
+                 (y <= depart_y + 15)));
+
+        for (int i = 0; i < taille_pave; i++)
+        {
+            for (int j = 0; j < taille_pave; j++)
+            {
+                // Les pavés peuvent se recouvrir
+                if (CASE(partie, x + j, y + i) != COTE_BORDURE)
+                {
+                    modifierPlateau(partie, x + j, y + i, COTE_BORDURE);
+                    partie->empreinte ^= cleZobrist(CLE_MUR, (size_t)(y + i) * partie->largeur + x + j);
+                }
+            }
+        }
+        if (partie->obstacles.periode > 0)
+        {
+            const int *deplacement = DEPLACEMENTS_PAVES[tirerAleatoire(&partie->aleatoire) % 4];
+
+            ajouterObstacle(&partie->obstacles, x, y, deplacement[0], deplacement[1]);
+        }
+    }
+}
+
+/**
+ * @brief Ajoute une pomme à une position aléatoire sur le plateau.
+ *
+ * La pomme est placée uniquement sur une case vide ; elle devient la pomme
+ * visée par les pilotes (partie->pomme).
+ *
+ * @param partie La partie.
+ */
+void ajouterPomme(Partie *partie)
+{
+    Segment position = tirerCaseVide(partie);
+
+    poserObjet(partie, position, OBJET_POMME, -1);
+    partie->pomme = position;
+}
+
+/**
+ * @brief Donne la case atteinte en partant d'une position dans une direction.
+ *
+ * Applique la télétransportation par les issues des bordures.
+ *
+ * @param partie La partie.
+ * @param position Position de départ.
+ * @param direction Direction du déplacement ('z', 'q', 's', 'd').
+ * @return La case d'arrivée.
+ */
+Segment caseSuivante(const Partie *partie, Segment position, char direction)
+{
+    switch (direction)
+    {
+        case HAUT:
+            position.y--;
+            break;
+        case BAS:
+            position.y++;
+            break;
+        case DROITE:
+            position.x++;
+            break;
+        case GAUCHE:
+            position.x--;
+            break;
+    }
+
+    // Gestion des télétransportations
+    if (position.x < 0) position.x = partie->largeur - 1;
+    if (position.x >= partie->largeur) position.x = 0;
+    if (position.y < 0) position.y = partie->hauteur - 1;
+    if (position.y >= partie->hauteur) position.y = 0;
+    return position;
+}
+
+/**
+ * @brief Indique si un déplacement ne provoque pas de collision immédiate.
+ *
+ * Applique les mêmes règles que progresser() : la case que la queue quitte
+ * pendant le tour est considérée comme libre.
+ *
+ * @param partie La partie.
+ * @param direction Direction envisagée.
+ * @return true si le serpent survit au déplacement.
+ */
+bool deplacementSansDanger(const Partie *partie, char direction)
+{
+    Segment arrivee = caseSuivante(partie, teteSerpent(&partie->serpent), direction);
+    Segment queue = queueSerpent(&partie->serpent);
+    int occupation = OCCUPATION(partie, arrivee.x, arrivee.y);
+
+    if (arrivee.x == queue.x && arrivee.y == queue.y)
+    {
+        occupation--;
+    }
+    return occupation == 0 && CASE(partie, arrivee.x, arrivee.y) != COTE_BORDURE;
+}
+
+/**
+ * @brief Indique si le serpent peut prendre une nouvelle direction.
+ *
+ * Le demi-tour est interdit.
+ *
+ * @param actuelle Direction actuelle.
+ * @param nouvelle Direction demandée.
+ * @return true si la nouvelle direction est acceptée.
+ */
+bool directionAutorisee(char actuelle, char nouvelle)
+{
+    switch (nouvelle)
+    {
+        case HAUT:
+            return actuelle != BAS;
+        case BAS:
+            return actuelle != HAUT;
+        case DROITE:
+            return actuelle != GAUCHE;
+        case GAUCHE:
+            return actuelle != DROITE;
+    }
+    return false;
+}
+
+/**
+ * @brief Tire un nombre pseudo-aléatoire (xorshift 32 bits).
+ *
+ * @param etat État du générateur, mis à jour (jamais nul).
+ * @return Le nombre tiré.
+ */
+uint32_t tirerAleatoire(uint32_t *etat)
+{
+    uint32_t x = *etat;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *etat = x;
+    return x;
+}
+
+/**
+ * @brief Clé de Zobrist d'un élément de la partie.
+ *
+ * Les clés sont tirées d'une fonction de mélange (splitmix64) plutôt que
+ * d'une table : elles ne dépendent pas de la taille du plateau et sont les
+ * mêmes dans tous les threads et tous les programmes.
+ *
+ * @param famille Famille de la clé.
+ * @param indice Indice de la case (y * largeur + x), ou touche pour CLE_DIRECTION.
+ * @return La clé.
+ */
+uint64_t cleZobrist(FamilleCle famille, size_t indice)
+{
+    uint64_t z = ((uint64_t)famille << 40) + indice + 0x9E3779B97F4A7C15ull;
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Clé de Zobrist du lien d'un segment vers le suivant, côté tête.
+ *
+ * Le corps est haché lien par lien : case du segment et sens vers le
+ * suivant (4 : même case, pour la queue dupliquée d'un serpent qui grandit).
+ * Deux serpents sur les mêmes cases dans un ordre différent n'ont donc pas
+ * la même empreinte ; un tour ajoute un lien et en retire un.
+ *
+ * @param partie La partie (taille du plateau, pour les passages d'un bord à l'autre).
+ * @param segment Le segment.
+ * @param suivant Le segment suivant, côté tête.
+ * @return La clé.
+ */
+static uint64_t cleLien(const Partie *partie, Segment segment, Segment suivant)
+{
+    int sens;
+
+    if (suivant.x == segment.x && suivant.y == segment.y)
+    {
+        sens = 4;
+    }
+    else if (suivant.y == segment.y)
+    {
+        sens = (suivant.x == segment.x + 1 || (suivant.x == 0 && segment.x == partie->largeur - 1)) ? 1 : 3;
+    }
+    else
+    {
+        sens = (suivant.y == segment.y + 1 || (suivant.y == 0 && segment.y == partie->hauteur - 1)) ? 2 : 0;
+    }
+    return cleZobrist(CLE_LIEN, ((size_t)segment.y * partie->largeur + segment.x) * 5 + (size_t)sens);
+}
+
+/**
+ * @brief Recalcule entièrement l'empreinte de Zobrist d'une partie.
+ *
+ * Sert à initialiser l'empreinte et à vérifier sa mise à jour incrémentale.
+ *
+ * @param partie La partie.
+ * @return L'empreinte.
+ */
+uint64_t calculerEmpreinte(const Partie *partie)
+{
+    size_t cases = (size_t)partie->largeur * partie->hauteur;
+    Segment tete = teteSerpent(&partie->serpent);
+    Segment queue = queueSerpent(&partie->serpent);
+    uint64_t empreinte = cleZobrist(CLE_DIRECTION, (unsigned char)partie->direction);
+    Parcours parcours;
+    Segment segment, suivant = tete;
+
+    for (size_t i = 0; i < cases; i++)
+    {
+        char c = partie->plateau[i];
+
+        if (c == COTE_BORDURE)
+        {
+            empreinte ^= cleZobrist(CLE_MUR, i);
+        }
+        else if (c == POMME)
+        {
+            empreinte ^= cleZobrist(CLE_POMME, i);
+        }
+        else if (c != VIDE)
+        {
+            FamilleCle famille = (c == ACCELERATEUR) ? CLE_ACCELERATEUR :
+                                 (c == RALENTISSEUR) ? CLE_RALENTISSEUR : CLE_RETRECISSEUR;
+
+            empreinte ^= cleZobrist(famille, i);
+        }
+    }
+    // Liens du corps, de la tête vers la queue
+    debutParcours(&partie->serpent, &parcours);
+    segmentSuivant(&parcours, &segment);
+    while (segmentSuivant(&parcours, &segment))
+    {
+        empreinte ^= cleLien(partie, segment, suivant);
+        suivant = segment;
+    }
+    empreinte ^= cleZobrist(CLE_TETE, (size_t)tete.y * partie->largeur + tete.x);
+    empreinte ^= cleZobrist(CLE_QUEUE, (size_t)queue.y * partie->largeur + queue.x);
+    return empreinte;
+}
+
+/**
+ * @brief Remplit des règles avec les constantes d'origine du jeu.
+ *
+ * @param regles Règles à remplir.
+ */
+void reglesParDefaut(Regles *regles)
+{
+    memset(regles, 0, sizeof(Regles));
+    regles->vitesse_jeu = VITESSE_JEU;
+    regles->acceleration = ACCELERATION;
+    regles->objectif_pommes = OBJECTIF_POMMES;
+    regles->largeur = LARGEUR_PLATEAU;
+    regles->hauteur = HAUTEUR_PLATEAU;
+    regles->nombre_paves = NOMBRES_PAVES;
+    regles->taille_pave = TAILLE_PAVE;
+    regles->periode_paves = 0;
+    regles->pommes = 1;
+    regles->bonus = 0;
+    regles->duree_bonus = DUREE_BONUS;
+    regles->niveau = NIVEAU_PAVES;
+    regles->densite = DENSITE_NIVEAU;
+    regles->touche_haut = HAUT;
+    regles->touche_bas = BAS;
+    regles->touche_gauche = GAUCHE;
+    regles->touche_droite = DROITE;
+    regles->touche_arret = STOP_JEU;
+}
+
+/**
+ * @brief Règles des parties créées maintenant.
+ *
+ * Une seule lecture atomique : peut être appelé à chaque tour.
+ *
+ * @return Les dernières règles publiées, ou les règles par défaut.
+ */
+const Regles *reglesCourantes(void)
+{
+    const Regles *regles = atomic_load_explicit(&regles_publiees, memory_order_acquire);
+    const Regles *attendues = NULL;
+    Regles defaut;
+    Regles *copie;
+
+    if (regles != NULL)
+    {
+        return regles;
+    }
+    // Premier appel : les règles par défaut sont publiées une fois pour toutes
+    reglesParDefaut(&defaut);
+    copie = copierRegles(&defaut);
+    if (!atomic_compare_exchange_strong(&regles_publiees, &attendues, copie))
+    {
+        free(copie);
+        return attendues;
+    }
+    return copie;
+}
+
+/**
+ * @brief Publie de nouvelles règles pour toutes les parties.
+ *
+ * Les règles sont recopiées ; la copie n'est jamais libérée, car des parties
+ * peuvent encore la désigner (quelques dizaines d'octets par publication).
+ *
+ * @param regles Règles à publier (validées par l'appelant).
+ * @return Les règles publiées.
+ */
+const Regles *publierRegles(const Regles *regles)
+{
+    Regles *copie = copierRegles(regles);
+
+    atomic_store_explicit(&regles_publiees, copie, memory_order_release);
+    return copie;
+}
+
+/**
+ * @brief Fait passer une partie en cours à de nouvelles règles, entre deux tours.
+ *
+ * La vitesse devient celle que la partie aurait avec les nouvelles règles
+ * (vitesse de départ moins une accélération par pomme mangée, sans descendre
+ * sous VITESSE_MIN) ; l'effet des bonus déjà mangés est oublié. L'objectif
+ * est remplacé s'il n'avait pas été changé pour cette partie. La taille du
+ * plateau et les pavés ne changent pas ; des pavés mobiles prennent leur
+ * nouvelle période (ils ne deviennent ni fixes ni mobiles en cours de partie).
+ *
+ * @param partie La partie.
+ * @param regles Les nouvelles règles.
+ */
+void appliquerRegles(Partie *partie, const Regles *regles)
+{
+    if (partie->objectif_pommes == partie->regles->objectif_pommes)
+    {
+        partie->objectif_pommes = regles->objectif_pommes;
+    }
+    // Les pommes déjà mangées peuvent dépasser l'objectif des nouvelles règles
+    changerVitesse(partie, (long)regles->vitesse_jeu - (long)partie->pommes_mangees * regles->acceleration);
+    if (partie->obstacles.periode > 0 && regles->periode_paves > 0)
+    {
+        partie->obstacles.periode = regles->periode_paves;
+    }
+    partie->regles = regles;
+}
+
+/**
+ * @brief Traduit une touche du clavier selon les règles.
+ *
+ * @param regles Les règles.
+ * @param touche Touche lue.
+ * @return HAUT, BAS, GAUCHE, DROITE, STOP_JEU, ou 0 pour une touche sans effet.
+ */
+char commandeTouche(const Regles *regles, char touche)
+{
+    if (touche == regles->touche_haut)
+    {
+        return HAUT;
+    }
+    if (touche == regles->touche_bas)
+    {
+        return BAS;
+    }
+    if (touche == regles->touche_gauche)
+    {
+        return GAUCHE;
+    }
+    if (touche == regles->touche_droite)
+    {
+        return DROITE;
+    }
+    return (touche == regles->touche_arret) ? STOP_JEU : 0;
+}
+
+/**
+ * @brief Copie des règles dans un bloc alloué.
+ *
+ * @param regles Les règles.
+ * @return La copie.
+ */
+static Regles *copierRegles(const Regles *regles)
+{
+    Regles *copie = malloc(sizeof(Regles));
+
+    if (copie == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    *copie = *regles;
+    return copie;
+}
+
+/**
+ * @brief Place le serpent, les pavés (ou le niveau) et les objets d'une partie qui commence.
+ *
+ * L'empreinte est tenue à jour depuis celle du plateau vierge. Le générateur
+ * est tiré dans le même ordre que pour la partie d'origine : une même graine
+ * donne la même partie, créée ou recommencée.
+ *
+ * @param partie La partie : plateau vierge, occupation nulle, serpent et objets vides.
+ * @param graine Graine du générateur pseudo-aléatoire.
+ */
+static void placerDepart(Partie *partie, uint32_t graine)
+{
+    const Regles *regles = partie->regles;
+    Segment tete, queue;
+
+    partie->direction = DROITE;
+    partie->vitesse_actuelle = regles->vitesse_jeu;
+    partie->pommes_mangees = 0;
+    partie->objectif_pommes = regles->objectif_pommes;
+    partie->tour = 0;
+    partie->empreinte = partie->empreinte_vierge ^ cleZobrist(CLE_DIRECTION, (unsigned char)DROITE);
+    partie->aleatoire = (graine != 0) ? graine : GRAINE_PAR_DEFAUT;
+
+    // Initialisation du serpent, de la queue vers la tête
+    for (int i = TAILLE_SERPENT - 1; i >= 0; i--)
+    {
+        // Départ au centre du plateau (COORD_DEPART_X_SERPENT, COORD_DEPART_Y_SERPENT par défaut)
+        Segment segment = {partie->largeur / 2 - i, partie->hauteur / 2};
+
+        if (partie->serpent.taille > 0)
+        {
+            partie->empreinte ^= cleLien(partie, teteSerpent(&partie->serpent), segment);
+        }
+        ajouterTete(&partie->serpent, segment);
+        occuperCase(partie, segment);
+    }
+    tete = teteSerpent(&partie->serpent);
+    queue = queueSerpent(&partie->serpent);
+    partie->empreinte ^= cleZobrist(CLE_TETE, (size_t)tete.y * partie->largeur + tete.x) ^
+                         cleZobrist(CLE_QUEUE, (size_t)queue.y * partie->largeur + queue.x);
+
+    if (regles->niveau == NIVEAU_PAVES)
+    {
+        placerPaves(partie);
+    }
+    else
+    {
+        genererNiveau(partie->plateau, partie->largeur, partie->hauteur, (TypeNiveau)regles->niveau,
+                      regles->densite, tirerAleatoire(&partie->aleatoire));
+    }
+
+    for (int i = 0; i < regles->pommes; i++)
+    {
+        ajouterPomme(partie);
+    }
+    renouvelerBonus(partie);
+}
+
+/**
+ * @brief Contenu d'une case du plateau vierge : bordure percée d'une issue au centre de chaque côté.
+ *
+ * @param partie La partie.
+ * @param x Colonne.
+ * @param y Ligne.
+ * @return COTE_BORDURE ou VIDE.
+ */
+static char caseVierge(const Partie *partie, int x, int y)
+{
+    bool bord = (x == 0 || y == 0 || x == partie->largeur - 1 || y == partie->hauteur - 1);
+    bool issue = (x == partie->largeur / 2 && (y == 0 || y == partie->hauteur - 1)) ||
+                 (y == partie->hauteur / 2 && (x == 0 || x == partie->largeur - 1));
+
+    return (bord && !issue) ? COTE_BORDURE : VIDE;
+}
+
+/**
+ * @brief Modifie une case du plateau, en recopiant d'abord un plateau partagé.
+ *
+ * @param partie La partie.
+ * @param x Colonne.
+ * @param y Ligne.
+ * @param c Nouveau contenu de la case.
+ */
+static void modifierPlateau(Partie *partie, int x, int y, char c)
+{
+    if (partie->plateau_partage)
+    {
+        memcpy(partie->plateau_prive, partie->plateau, (size_t)partie->largeur * partie->hauteur);
+        partie->plateau = partie->plateau_prive;
+        partie->plateau_partage = false;
+    }
+    CASE(partie, x, y) = c;
+    if (partie->touchee != NULL)
+    {
+        noterCase(partie, (size_t)y * partie->largeur + x);
+    }
+}
+
+/**
+ * @brief Note une case touchée, qui sera remise à neuf par recommencerPartie().
+ *
+ * Dans un clone, elle sera reprise de la source par reprendreClone(). Le
+ * tableau des cases touchées double dans l'arène quand il est plein ; chaque
+ * case n'y figure qu'une fois.
+ *
+ * @param partie La partie.
+ * @param indice Indice de la case.
+ */
+static void noterCase(Partie *partie, size_t indice)
+{
+    if (partie->touchee[indice])
+    {
+        return;
+    }
+    if (partie->nombre_touchees == partie->capacite_touchees)
+    {
+        size_t *touchees = allouerDansArene(&partie->arene, 2 * partie->capacite_touchees * sizeof(size_t));
+
+        memcpy(touchees, partie->touchees, partie->nombre_touchees * sizeof(size_t));
+        partie->touchees = touchees;
+        partie->capacite_touchees *= 2;
+    }
+    partie->touchee[indice] = 1;
+    partie->touchees[partie->nombre_touchees++] = indice;
+}
+
+/**
+ * @brief Ajoute un segment sur une case (l'empreinte est tenue par l'appelant, voir cleLien()).
+ *
+ * @param partie La partie.
+ * @param position La case.
+ */
+static void occuperCase(Partie *partie, Segment position)
+{
+    size_t indice = (size_t)position.y * partie->largeur + position.x;
+    partie->occupation[indice]++;
+    if (partie->occupation_notee)
+    {
+        noterCase(partie, indice);
+    }
+}
+
+/**
+ * @brief Retire un segment d'une case (l'empreinte est tenue par l'appelant, voir cleLien()).
+ *
+ * @param partie La partie.
+ * @param position La case.
+ */
+static void libererCase(Partie *partie, Segment position)
+{
+    size_t indice = (size_t)position.y * partie->largeur + position.x;
+    partie->occupation[indice]--;
+    if (partie->occupation_notee)
+    {
+        noterCase(partie, indice);
+    }
+}
+
+/**
+ * @brief Déplace les pavés mobiles dont c'est le tour.
+ *
+ * Le pavé i bouge aux tours où (tour + i) est un multiple de la période :
+ * les déplacements sont étalés sur la période au lieu d'arriver tous au
+ * même tour. Les cases modifiées sont notées dans partie->obstacles.changees.
+ *
+ * @param partie La partie.
+ */
+static void deplacerPaves(Partie *partie)
+{
+    Obstacles *obstacles = &partie->obstacles;
+    int periode = obstacles->periode;
+
+    obstacles->nombre_changees = 0;
+    for (int i = (periode - (int)(partie->tour % periode)) % periode; i < obstacles->nombre; i += periode)
+    {
+        deplacerPave(partie, i);
+    }
+}
+
+/**
+ * @brief Avance un pavé d'une case, ou le fait repartir en sens inverse s'il est bloqué.
+ *
+ * Un pavé est bloqué par la bordure, les objets et le serpent, pas par les
+ * autres pavés : il peut les recouvrir. Seules la rangée de cases où il
+ * entre et celle qu'il quitte sont réécrites ; une case quittée reste un mur
+ * si un autre pavé la recouvre encore.
+ *
+ * @param partie La partie.
+ * @param indice Le pavé.
+ */
+static void deplacerPave(Partie *partie, int indice)
+{
+    Obstacles *obstacles = &partie->obstacles;
+    Obstacle *pave = &obstacles->obstacles[indice];
+    int taille = obstacles->taille;
+    // Rangée entrée (ex, ey) et rangée quittée (qx, qy), parcourues selon (px, py)
+    int ex = (pave->dx > 0) ? pave->x + taille : pave->x + pave->dx;
+    int ey = (pave->dy > 0) ? pave->y + taille : pave->y + pave->dy;
+    int qx = (pave->dx < 0) ? pave->x + taille - 1 : pave->x;
+    int qy = (pave->dy < 0) ? pave->y + taille - 1 : pave->y;
+    int px = (pave->dx == 0), py = (pave->dy == 0);
+
+    if (ex < 1 || ey < 1 || ex + px * (taille - 1) > partie->largeur - 2 ||
+        ey + py * (taille - 1) > partie->hauteur - 2)
+    {
+        pave->dx = -pave->dx;
+        pave->dy = -pave->dy;
+        return;
+    }
+    for (int k = 0; k < taille; k++)
+    {
+        int x = ex + k * px, y = ey + k * py;
+
+        if ((CASE(partie, x, y) != VIDE && CASE(partie, x, y) != COTE_BORDURE) || OCCUPATION(partie, x, y) > 0)
+        {
+            pave->dx = -pave->dx;
+            pave->dy = -pave->dy;
+            return;
+        }
+    }
+
+    deplacerObstacle(obstacles, indice, pave->x + pave->dx, pave->y + pave->dy);
+    for (int k = 0; k < taille; k++)
+    {
+        int x = qx + k * px, y = qy + k * py;
+
+        basculerMur(partie, ex + k * px, ey + k * py, COTE_BORDURE);
+        if (!caseCouverte(obstacles, x, y))
+        {
+            basculerMur(partie, x, y, VIDE);
+        }
+    }
+}
+
+/**
+ * @brief Pose ou retire un mur de pavé : plateau, empreinte et cases modifiées.
+ *
+ * @param partie La partie.
+ * @param x Colonne.
+ * @param y Ligne.
+ * @param c COTE_BORDURE ou VIDE (sans effet si la case le contient déjà).
+ */
+static void basculerMur(Partie *partie, int x, int y, char c)
+{
+    Obstacles *obstacles = &partie->obstacles;
+
+    if (CASE(partie, x, y) == c)
+    {
+        return;
+    }
+    modifierPlateau(partie, x, y, c);
+    partie->empreinte ^= cleZobrist(CLE_MUR, (size_t)y * partie->largeur + x);
+    obstacles->changees[obstacles->nombre_changees++] = (Segment){x, y};
+}
+
+/**
+ * @brief Tire une case vide de l'intérieur du plateau.
+ *
+ * @param partie La partie.
+ * @return La case.
+ */
+static Segment tirerCaseVide(Partie *partie)
+{
+    Segment position;
+
+    do {
+        position.x = tirerAleatoire(&partie->aleatoire) % (partie->largeur - 2) + 1;
+        position.y = tirerAleatoire(&partie->aleatoire) % (partie->hauteur - 2) + 1;
+    } while (CASE(partie, position.x, position.y) != VIDE);
+    return position;
+}
+
+/**
+ * @brief Pose un objet sur une case vide : plateau, empreinte, table des objets.
+ *
+ * @param partie La partie.
+ * @param position La case.
+ * @param type Type de l'objet (TypeObjet).
+ * @param disparition Tour de disparition (-1 : jamais).
+ */
+static void poserObjet(Partie *partie, Segment position, int type, long disparition)
+{
+    const char caracteres[NOMBRE_TYPES_OBJETS] = {POMME, ACCELERATEUR, RALENTISSEUR, RETRECISSEUR};
+    Objets *objets = &partie->objets;
+
+    modifierPlateau(partie, position.x, position.y, caracteres[type]);
+    partie->empreinte ^= cleZobrist(FAMILLES_OBJETS[type], (size_t)position.y * partie->largeur + position.x);
+    ajouterObjet(objets, position, type, disparition);
+    objets->changees[objets->nombre_changees++] = position;
+}
+
+/**
+ * @brief Enlève un objet du plateau : plateau, empreinte, table des objets.
+ *
+ * @param partie La partie.
+ * @param indice L'objet dans la table des objets.
+ */
+static void enleverObjet(Partie *partie, int indice)
+{
+    Objet objet = partie->objets.objets[indice];
+
+    modifierPlateau(partie, objet.position.x, objet.position.y, VIDE);
+    partie->empreinte ^= cleZobrist(FAMILLES_OBJETS[objet.type],
+                                    (size_t)objet.position.y * partie->largeur + objet.position.x);
+    retirerObjet(&partie->objets, indice);
+}
+
+/**
+ * @brief Retire les bonus arrivés à leur fin et remplace ceux qui manquent.
+ *
+ * Chaque nouveau bonus est d'un type tiré au hasard et reste
+ * objets->duree_bonus tours (la durée des règles au début de la partie).
+ *
+ * @param partie La partie.
+ */
+static void renouvelerBonus(Partie *partie)
+{
+    Objets *objets = &partie->objets;
+    int indice;
+
+    while ((indice = objetDisparu(objets, partie->tour)) >= 0)
+    {
+        objets->changees[objets->nombre_changees++] = objets->objets[indice].position;
+        enleverObjet(partie, indice);
+    }
+    while (objets->bonus < objets->bonus_voulus)
+    {
+        int type = OBJET_ACCELERATEUR + (int)(tirerAleatoire(&partie->aleatoire) % 3);
+
+        poserObjet(partie, tirerCaseVide(partie), type, partie->tour + objets->duree_bonus);
+    }
+}
+
+/**
+ * @brief Change la temporisation de la partie sans descendre sous VITESSE_MIN.
+ *
+ * Toute modification de vitesse_actuelle en cours de partie passe par ici :
+ * au-delà de l'objectif (mode sans fin), la vitesse cesse d'augmenter.
+ *
+ * @param partie La partie.
+ * @param vitesse Temporisation voulue (µs), éventuellement trop petite ou négative.
+ */
+static void changerVitesse(Partie *partie, long vitesse)
+{
+    partie->vitesse_actuelle = (vitesse < VITESSE_MIN) ? VITESSE_MIN : (int)vitesse;
+}
+
+/**
+ * @brief Applique l'effet d'un bonus mangé.
+ *
+ * @param partie La partie.
+ * @param type Type du bonus.
+ */
+static void appliquerBonus(Partie *partie, int type)
+{
+    Serpent *serpent = &partie->serpent;
+
+    if (type == OBJET_ACCELERATEUR)
+    {
+        // validerRegles() ne compte pas les accélérateurs : la borne les rattrape
+        changerVitesse(partie, partie->vitesse_actuelle - partie->vitesse_actuelle / EFFET_VITESSE);
+    }
+    else if (type == OBJET_RALENTISSEUR)
+    {
+        long vitesse = partie->vitesse_actuelle + partie->vitesse_actuelle / EFFET_VITESSE;
+
+        changerVitesse(partie, (vitesse > partie->regles->vitesse_jeu) ? partie->regles->vitesse_jeu : vitesse);
+    }
+    else
+    {
+        for (int i = 0; i < RETRECISSEMENT && serpent->taille > TAILLE_MIN_SERPENT; i++)
+        {
+            Segment queue = retirerQueue(serpent);
+            Segment nouvelle_queue = queueSerpent(serpent);
+
+            libererCase(partie, queue);
+            partie->empreinte ^= cleZobrist(CLE_QUEUE, (size_t)queue.y * partie->largeur + queue.x) ^
+                                 cleZobrist(CLE_QUEUE, (size_t)nouvelle_queue.y * partie->largeur + nouvelle_queue.x) ^
+                                 cleLien(partie, queue, nouvelle_queue);
+        }
+    }
+}
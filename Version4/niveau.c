@@ -0,0 +1,231 @@
+/**
+ * @file niveau.c
+ * @brief Génération et vérification de niveaux (voir niveaux.h).
+ *
+ * @details
+ * Utilisation : niveau [-t type] [-d densite] [-g graine] [-l largeur] [-h hauteur] [-a]
+ * - Génère un niveau et affiche le temps de génération, la part de murs et
+ *   le nombre de cases libres qui ne sont pas reliées au départ (0 attendu).
+ * - Le type, la densité et la taille par défaut sont ceux des règles
+ *   (regles.conf ou $SNAKE_REGLES) ; la graine par défaut est 1.
+ * - -a : affiche aussi le niveau.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "jeu.h"
+#include "niveaux.h"
+#include "regles.h"
+
+#define COTE_MAX 65536      /**< Côté maximal d'un niveau généré par l'outil. */
+#define ATTEINTE '.'        /**< Marque des cases atteintes depuis le départ. */
+
+static long compterIsolees(char *plateau, int largeur, int hauteur);
+static double secondes(void);
+
+/**
+ * @brief Lit les options, génère le niveau et le vérifie.
+ *
+ * @param argc Nombre d'arguments.
+ * @param argv Arguments.
+ * @return EXIT_SUCCESS, ou EXIT_FAILURE si le niveau a des cases isolées.
+ */
+int main(int argc, char *argv[])
+{
+    const char *utilisation = "Utilisation : %s [-t type] [-d densite] [-g graine] [-l largeur] [-h hauteur] [-a]\n";
+    const Regles *regles;
+    int type, densite, largeur, hauteur;
+    unsigned long long graine = 1;
+    bool afficher = false;
+    int option;
+    char *plateau;
+    double debut, duree;
+    size_t murs = 0;
+    long isolees;
+
+    if (!chargerRegles(cheminRegles()))
+    {
+        return EXIT_FAILURE;
+    }
+    regles = reglesCourantes();
+    type = regles->niveau;
+    densite = regles->densite;
+    largeur = regles->largeur;
+    hauteur = regles->hauteur;
+
+    while ((option = getopt(argc, argv, "t:d:g:l:h:a")) != -1)
+    {
+        switch (option)
+        {
+            case 't':
+                for (type = 0; type < NOMBRE_NIVEAUX && strcmp(NOMS_NIVEAUX[type], optarg) != 0; type++)
+                {
+                }
+                break;
+            case 'd':
+                densite = atoi(optarg);
+                break;
+            case 'g':
+                graine = strtoull(optarg, NULL, 10);
+                break;
+            case 'l':
+                largeur = atoi(optarg);
+                break;
+            case 'h':
+                hauteur = atoi(optarg);
+                break;
+            case 'a':
+                afficher = true;
+                break;
+            default:
+                fprintf(stderr, utilisation, argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc || type == NOMBRE_NIVEAUX || densite < 0 || densite > 100 ||
+        largeur < 2 * TAILLE_SERPENT || largeur > COTE_MAX || hauteur < 5 || hauteur > COTE_MAX)
+    {
+        fprintf(stderr, utilisation, argv[0]);
+        fprintf(stderr, "Types : paves, labyrinthe, salles, grottes ; densité de 0 à 100 ; "
+                        "largeur de %d à %d, hauteur de 5 à %d\n", 2 * TAILLE_SERPENT, COTE_MAX, COTE_MAX);
+        return EXIT_FAILURE;
+    }
+
+    plateau = malloc((size_t)largeur * hauteur);
+    if (plateau == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    debut = secondes();
+    genererNiveau(plateau, largeur, hauteur, (TypeNiveau)type, densite, graine);
+    duree = secondes() - debut;
+
+    for (size_t i = 0; i < (size_t)largeur * hauteur; i++)
+    {
+        murs += (plateau[i] == COTE_BORDURE);
+    }
+    if (afficher)
+    {
+        for (int y = 0; y < hauteur; y++)
+        {
+            fwrite(plateau + (size_t)y * largeur, 1, largeur, stdout);
+            putchar('\n');
+        }
+    }
+    isolees = compterIsolees(plateau, largeur, hauteur);
+    printf("Niveau %s de %dx%d (densité %d, graine %llu) généré en %.3f s\n",
+           NOMS_NIVEAUX[type], largeur, hauteur, densite, graine, duree);
+    printf("%.1f %% de murs, %ld cases libres non reliées au départ\n",
+           100.0 * murs / ((double)largeur * hauteur), isolees);
+
+    free(plateau);
+    return (isolees == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Compte les cases libres de l'intérieur du plateau non reliées au départ.
+ *
+ * Remplissage par segments de ligne depuis la case de départ de la tête ;
+ * les cases atteintes sont marquées dans le plateau.
+ *
+ * @param plateau Le niveau (modifié).
+ * @param largeur Largeur du plateau.
+ * @param hauteur Hauteur du plateau.
+ * @return Le nombre de cases libres non atteintes.
+ */
+static long compterIsolees(char *plateau, int largeur, int hauteur)
+{
+    size_t capacite = 1024, nombre = 0;
+    Segment *pile = malloc(capacite * sizeof(Segment));
+    long isolees = 0;
+
+    if (pile == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    pile[nombre++] = (Segment){largeur / 2, hauteur / 2};
+    while (nombre > 0)
+    {
+        Segment graine = pile[--nombre];
+        char *ligne = plateau + (size_t)graine.y * largeur;
+        int gauche = graine.x, droite = graine.x;
+
+        if (ligne[graine.x] != VIDE)
+        {
+            continue;
+        }
+        while (gauche > 1 && ligne[gauche - 1] == VIDE)
+        {
+            gauche--;
+        }
+        while (droite < largeur - 2 && ligne[droite + 1] == VIDE)
+        {
+            droite++;
+        }
+        memset(ligne + gauche, ATTEINTE, droite - gauche + 1);
+
+        // Un départ par suite de cases libres sur les lignes voisines
+        for (int y = graine.y - 1; y <= graine.y + 1; y += 2)
+        {
+            const char *voisine = plateau + (size_t)y * largeur;
+
+            if (y < 1 || y > hauteur - 2)
+            {
+                continue;
+            }
+            for (int x = gauche; x <= droite; x++)
+            {
+                if (voisine[x] == VIDE && (x == gauche || voisine[x - 1] != VIDE))
+                {
+                    if (nombre == capacite)
+                    {
+                        capacite *= 2;
+                        pile = realloc(pile, capacite * sizeof(Segment));
+                        if (pile == NULL)
+                        {
+                            perror("realloc");
+                            exit(EXIT_FAILURE);
+                        }
+                    }
+                    pile[nombre++] = (Segment){x, y};
+                }
+            }
+        }
+    }
+    free(pile);
+
+    for (int y = 1; y < hauteur - 1; y++)
+    {
+        for (int x = 1; x < largeur - 1; x++)
+        {
+            isolees += (plateau[(size_t)y * largeur + x] == VIDE);
+        }
+    }
+    return isolees;
+}
+
+/**
+ * @brief Horloge monotone en secondes.
+ *
+ * @return L'instant présent.
+ */
+static double secondes(void)
+{
+    struct timespec instant;
+
+    clock_gettime(CLOCK_MONOTONIC, &instant);
+    return instant.tv_sec + instant.tv_nsec / 1e9;
+}
@@ -0,0 +1,820 @@
+/**
+ * @file niveaux.c
+ * @brief Générateurs de niveaux, parallèles par lignes.
+ *
+ * @details
+ * - Le travail est découpé en tranches de lignes consécutives, une par
+ *   thread (un seul thread sur les petits plateaux) : chaque thread n'écrit
+ *   que ses lignes, dans l'ordre de la mémoire.
+ * - Labyrinthe : algorithme « sidewinder ». Chaque ligne de cases est
+ *   indépendante des autres (des séries de cases reliées vers la droite,
+ *   chacune ouverte une fois vers le haut) : le labyrinthe est parfait, puis
+ *   chaque mur entre deux cases est percé avec la probabilité
+ *   (100 - densité) % pour créer des boucles.
+ * - Salles : une salle par secteur de COTE_SECTEUR cases de côté, plus
+ *   petite quand la densité augmente, reliée à ses voisines de droite et du
+ *   dessous par des couloirs en L. Une salle ne dépend que des coordonnées de
+ *   son secteur : chaque thread recalcule celles qui touchent ses lignes.
+ * - Grottes : remplissage aléatoire (densité = part de murs), puis
+ *   ITERATIONS_GROTTES passes d'automate cellulaire (une case devient un mur
+ *   si son voisinage 3 × 3 en compte au moins 5), calculées avec des sommes
+ *   par colonne sur trois lignes. Des galeries droites, toutes les
+ *   ECART_GALERIES cases et passant par le départ, relient les grottes ;
+ *   les poches qui ne touchent aucune galerie sont comblées. Chaque carreau
+ *   entre deux galeries tient en 63 bits par ligne : la propagation se fait
+ *   sur des masques, 64 cases à la fois.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "niveaux.h"
+
+#define SEUIL_PARALLELE (1 << 20)   /**< Nombre de cases en deçà duquel un seul thread génère le niveau. */
+#define THREADS_MAX 64              /**< Nombre maximal de threads de génération. */
+#define COTE_SECTEUR 32             /**< Côté des secteurs des salles. */
+#define ECART_GALERIES 64           /**< Écart entre deux galeries des grottes. */
+#define ITERATIONS_GROTTES 4        /**< Passes d'automate cellulaire (nombre pair). */
+#define VOISINS_MUR 5               /**< Murs du voisinage 3 × 3 qui font un mur. */
+#define MARGE_DEPART (TAILLE_SERPENT + 2)   /**< Demi-largeur de la zone dégagée autour du départ. */
+#define SEL_SALLES 0x5A11E5u        /**< Distingue les tirages des salles de ceux des autres niveaux. */
+#define OCTETS(v) (0x0101010101010101ull * (uint64_t)(v))  /**< Mot de 8 octets valant tous v. */
+
+const char *const NOMS_NIVEAUX[NOMBRE_NIVEAUX] = {"paves", "labyrinthe", "salles", "grottes"};
+
+/** @brief Niveau en cours de génération, partagé par les threads. */
+typedef struct
+{
+    char *plateau;              /**< Plateau généré. */
+    int largeur;                /**< Largeur du plateau. */
+    int hauteur;                /**< Hauteur du plateau. */
+    int densite;                /**< Densité des murs (0 à 100). */
+    uint64_t graine;            /**< Graine du niveau. */
+    int depart_x;               /**< Colonne de la tête du serpent au départ. */
+    int depart_y;               /**< Ligne du serpent au départ. */
+    int secteurs_x;             /**< Salles : nombre de secteurs par ligne. */
+    int secteurs_y;             /**< Salles : nombre de secteurs par colonne. */
+    int largeur_secteur;        /**< Salles : largeur d'un secteur (le dernier prend le reste). */
+    int hauteur_secteur;        /**< Salles : hauteur d'un secteur (le dernier prend le reste). */
+    unsigned char *source;      /**< Grottes : grille lue par la passe en cours (1 : mur). */
+    unsigned char *destination; /**< Grottes : grille écrite par la passe en cours. */
+    int galerie_x;              /**< Grottes : colonne de la première galerie verticale. */
+    int galerie_y;              /**< Grottes : ligne de la première galerie horizontale. */
+} Generation;
+
+/** @brief Travail sur les unités [debut, fin[ (lignes, lignes de cases ou bandes). */
+typedef void (*Tache)(Generation *generation, int debut, int fin);
+
+/** @brief Part du travail confiée à un thread. */
+typedef struct
+{
+    Tache tache;                /**< Travail à faire. */
+    Generation *generation;     /**< Le niveau. */
+    int debut;                  /**< Première unité. */
+    int fin;                    /**< Unité qui suit la dernière. */
+} Part;
+
+/** @brief Salle d'un secteur (bornes comprises). */
+typedef struct
+{
+    int x0, y0;                 /**< Coin haut gauche. */
+    int x1, y1;                 /**< Coin bas droit. */
+    int cx, cy;                 /**< Centre, où arrivent les couloirs. */
+} Salle;
+
+static void executerEnParallele(Tache tache, Generation *generation, int nombre);
+static void *executerPart(void *argument);
+static uint64_t hacher(uint64_t graine, uint64_t a, uint64_t b);
+static uint64_t lireMot(const void *adresse);
+static void ecrireMot(void *adresse, uint64_t mot);
+static void tacheLabyrinthe(Generation *generation, int debut, int fin);
+static void calculerSalle(const Generation *generation, int i, int j, Salle *salle);
+static void creuser(Generation *generation, int x0, int y0, int x1, int y1, int debut, int fin);
+static void tacheSalles(Generation *generation, int debut, int fin);
+static void tacheRemplissage(Generation *generation, int debut, int fin);
+static void tacheAutomate(Generation *generation, int debut, int fin);
+static void tacheGaleries(Generation *generation, int debut, int fin);
+static void bornesBande(int indice, int premiere, int limite, int *debut, int *fin);
+static int nombreBandes(int premiere, int limite);
+static void tachePoches(Generation *generation, int debut, int fin);
+static void comblerPoches(Generation *generation, int x0, int x1, int y0, int y1);
+static uint64_t etendre(uint64_t graines, uint64_t libres);
+static void terminerNiveau(Generation *generation);
+
+/**
+ * @brief Génère un niveau sur tout le plateau.
+ *
+ * @param plateau Plateau de largeur × hauteur cases, entièrement réécrit.
+ * @param largeur Largeur du plateau.
+ * @param hauteur Hauteur du plateau.
+ * @param type Type de niveau (NIVEAU_PAVES : bordure seule, voir placerPaves()).
+ * @param densite Densité des murs, de 0 à 100.
+ * @param graine Graine du niveau.
+ */
+void genererNiveau(char *plateau, int largeur, int hauteur, TypeNiveau type, int densite, uint64_t graine)
+{
+    Generation generation;
+    unsigned char *tampon;
+
+    memset(&generation, 0, sizeof(generation));
+    generation.plateau = plateau;
+    generation.largeur = largeur;
+    generation.hauteur = hauteur;
+    generation.densite = densite;
+    generation.graine = graine;
+    generation.depart_x = largeur / 2;
+    generation.depart_y = hauteur / 2;
+
+    switch (type)
+    {
+        case NIVEAU_LABYRINTHE:
+            executerEnParallele(tacheLabyrinthe, &generation, (hauteur - 1) / 2);
+            // Lignes sous la dernière ligne de cases
+            for (int y = ((hauteur - 1) / 2) * 2; y < hauteur; y++)
+            {
+                memset(plateau + (size_t)y * largeur, COTE_BORDURE, largeur);
+            }
+            break;
+
+        case NIVEAU_SALLES:
+        {
+            Salle salle;
+            int i, j;
+
+            generation.secteurs_x = (largeur - 2) / COTE_SECTEUR > 1 ? (largeur - 2) / COTE_SECTEUR : 1;
+            generation.secteurs_y = (hauteur - 2) / COTE_SECTEUR > 1 ? (hauteur - 2) / COTE_SECTEUR : 1;
+            generation.largeur_secteur = (largeur - 2) / generation.secteurs_x;
+            generation.hauteur_secteur = (hauteur - 2) / generation.secteurs_y;
+            executerEnParallele(tacheSalles, &generation, hauteur);
+
+            // Couloir du départ à la salle de son secteur
+            i = (generation.depart_x - 1) / generation.largeur_secteur;
+            j = (generation.depart_y - 1) / generation.hauteur_secteur;
+            calculerSalle(&generation, i < generation.secteurs_x ? i : generation.secteurs_x - 1,
+                          j < generation.secteurs_y ? j : generation.secteurs_y - 1, &salle);
+            creuser(&generation, generation.depart_x < salle.cx ? generation.depart_x : salle.cx, generation.depart_y,
+                    generation.depart_x < salle.cx ? salle.cx : generation.depart_x, generation.depart_y, 0, hauteur);
+            creuser(&generation, salle.cx, generation.depart_y < salle.cy ? generation.depart_y : salle.cy,
+                    salle.cx, generation.depart_y < salle.cy ? salle.cy : generation.depart_y, 0, hauteur);
+            break;
+        }
+
+        case NIVEAU_GROTTES:
+            tampon = malloc((size_t)largeur * hauteur);
+            if (tampon == NULL)
+            {
+                perror("malloc");
+                exit(EXIT_FAILURE);
+            }
+            // Le plateau sert de première grille : après un nombre pair de passes, le résultat y revient
+            generation.source = (unsigned char *)plateau;
+            generation.destination = tampon;
+            executerEnParallele(tacheRemplissage, &generation, hauteur);
+            for (int passe = 0; passe < ITERATIONS_GROTTES; passe++)
+            {
+                unsigned char *lue = generation.destination;
+
+                executerEnParallele(tacheAutomate, &generation, hauteur);
+                generation.destination = generation.source;
+                generation.source = lue;
+            }
+            free(tampon);
+
+            generation.galerie_x = generation.depart_x % ECART_GALERIES;
+            generation.galerie_y = generation.depart_y % ECART_GALERIES;
+            generation.galerie_x += (generation.galerie_x == 0) ? ECART_GALERIES : 0;
+            generation.galerie_y += (generation.galerie_y == 0) ? ECART_GALERIES : 0;
+            executerEnParallele(tacheGaleries, &generation, hauteur);
+            executerEnParallele(tachePoches, &generation, nombreBandes(generation.galerie_y, hauteur - 1));
+            break;
+
+        default:
+            for (int y = 0; y < hauteur; y++)
+            {
+                memset(plateau + (size_t)y * largeur, VIDE, largeur);
+            }
+            break;
+    }
+    terminerNiveau(&generation);
+}
+
+/**
+ * @brief Répartit des unités de travail entre les threads, par tranches consécutives.
+ *
+ * @param tache Le travail.
+ * @param generation Le niveau.
+ * @param nombre Nombre d'unités.
+ */
+static void executerEnParallele(Tache tache, Generation *generation, int nombre)
+{
+    Part parts[THREADS_MAX];
+    pthread_t threads[THREADS_MAX];
+    bool lance[THREADS_MAX];
+    int nombre_threads = 1;
+
+    if ((size_t)generation->largeur * generation->hauteur >= SEUIL_PARALLELE)
+    {
+        long processeurs = sysconf(_SC_NPROCESSORS_ONLN);
+
+        nombre_threads = (processeurs < 1) ? 1 : (processeurs > THREADS_MAX) ? THREADS_MAX : (int)processeurs;
+        if (nombre_threads > nombre)
+        {
+            nombre_threads = (nombre > 0) ? nombre : 1;
+        }
+    }
+    for (int t = 0; t < nombre_threads; t++)
+    {
+        parts[t].tache = tache;
+        parts[t].generation = generation;
+        parts[t].debut = (int)((long long)nombre * t / nombre_threads);
+        parts[t].fin = (int)((long long)nombre * (t + 1) / nombre_threads);
+    }
+    for (int t = 1; t < nombre_threads; t++)
+    {
+        lance[t] = pthread_create(&threads[t], NULL, executerPart, &parts[t]) == 0;
+        if (!lance[t])
+        {
+            executerPart(&parts[t]);
+        }
+    }
+    executerPart(&parts[0]);
+    for (int t = 1; t < nombre_threads; t++)
+    {
+        if (lance[t])
+        {
+            pthread_join(threads[t], NULL);
+        }
+    }
+}
+
+/**
+ * @brief Fait la part de travail d'un thread.
+ *
+ * @param argument La part (Part).
+ * @return NULL.
+ */
+static void *executerPart(void *argument)
+{
+    Part *part = argument;
+
+    part->tache(part->generation, part->debut, part->fin);
+    return NULL;
+}
+
+/**
+ * @brief Tirage pseudo-aléatoire attaché à des coordonnées (splitmix64).
+ *
+ * @param graine Graine du niveau.
+ * @param a Première coordonnée.
+ * @param b Seconde coordonnée.
+ * @return 64 bits pseudo-aléatoires.
+ */
+static uint64_t hacher(uint64_t graine, uint64_t a, uint64_t b)
+{
+    uint64_t z = graine ^ (a * 0x9E3779B97F4A7C15ull) ^ (b * 0xC2B2AE3D27D4EB4Full);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Lit 8 octets consécutifs, sans contrainte d'alignement.
+ *
+ * @param adresse Le premier octet.
+ * @return Les 8 octets (le premier dans l'octet de poids faible sur x86).
+ */
+static uint64_t lireMot(const void *adresse)
+{
+    uint64_t mot;
+
+    memcpy(&mot, adresse, sizeof(mot));
+    return mot;
+}
+
+/**
+ * @brief Écrit 8 octets consécutifs, sans contrainte d'alignement.
+ *
+ * @param adresse Le premier octet.
+ * @param mot Les 8 octets.
+ */
+static void ecrireMot(void *adresse, uint64_t mot)
+{
+    memcpy(adresse, &mot, sizeof(mot));
+}
+
+/**
+ * @brief Labyrinthe : lignes de cases [debut, fin[.
+ *
+ * La ligne de cases j occupe la ligne 2j + 1 du plateau, ses passages vers
+ * le haut la ligne 2j : les threads écrivent des lignes distinctes.
+ *
+ * @param generation Le niveau.
+ * @param debut Première ligne de cases.
+ * @param fin Ligne de cases qui suit la dernière.
+ */
+static void tacheLabyrinthe(Generation *generation, int debut, int fin)
+{
+    int largeur = generation->largeur;
+    int cases_x = (largeur - 1) / 2;
+    uint64_t seuil = (uint64_t)generation->densite * 65536u / 100u;
+    // Les tirages sont imprévisibles : les cases sont choisies par index plutôt que par branchement
+    char motifs[2] = {COTE_BORDURE, VIDE};
+
+    for (int j = debut; j < fin; j++)
+    {
+        char *dessus = generation->plateau + (size_t)(2 * j) * largeur;
+        char *ligne = dessus + largeur;
+        int debut_serie = 0;
+
+        memset(dessus, COTE_BORDURE, largeur);
+        memset(ligne, COTE_BORDURE, largeur);
+        for (int i = 0; i < cases_x; i++)
+        {
+            uint64_t tirage = hacher(generation->graine, (uint64_t)j, (uint64_t)i);
+            // Première ligne : un seul couloir ; ailleurs, la série se termine une fois sur deux
+            int fin_serie = (j > 0) & ((i == cases_x - 1) | (int)(tirage & 1));
+            // Case de la série ouverte vers le haut (tirage sur 24 bits ramené à la longueur de la série)
+            int k = debut_serie + (int)(((tirage >> 40) * (uint64_t)(i - debut_serie + 1)) >> 24);
+
+            ligne[2 * i + 1] = VIDE;
+            // Boucles : les autres murs entre deux cases sont percés avec la probabilité (100 - densité) %
+            dessus[2 * i + 1] = motifs[(j > 0) & (((tirage >> 24) & 0xFFFF) >= seuil)];
+            dessus[2 * k + 1] = motifs[fin_serie | (dessus[2 * k + 1] == VIDE)];
+            if (i < cases_x - 1)
+            {
+                ligne[2 * i + 2] = motifs[!fin_serie | (((tirage >> 8) & 0xFFFF) >= seuil)];
+            }
+            debut_serie = fin_serie ? i + 1 : debut_serie;
+        }
+    }
+}
+
+/**
+ * @brief Calcule la salle d'un secteur.
+ *
+ * @param generation Le niveau.
+ * @param i Colonne du secteur.
+ * @param j Ligne du secteur.
+ * @param salle Reçoit la salle.
+ */
+static void calculerSalle(const Generation *generation, int i, int j, Salle *salle)
+{
+    int secteur_x = 1 + i * generation->largeur_secteur;
+    int secteur_y = 1 + j * generation->hauteur_secteur;
+    int largeur_secteur = (i == generation->secteurs_x - 1) ? generation->largeur - 1 - secteur_x
+                                                            : generation->largeur_secteur;
+    int hauteur_secteur = (j == generation->secteurs_y - 1) ? generation->hauteur - 1 - secteur_y
+                                                            : generation->hauteur_secteur;
+    // Une case de marge autour de la salle, dans son secteur
+    int largeur_max = largeur_secteur - 2;
+    int hauteur_max = hauteur_secteur - 2;
+    int espace = 100 - generation->densite;
+    uint64_t tirage = hacher(generation->graine ^ SEL_SALLES, (uint64_t)j, (uint64_t)i);
+    int largeur = largeur_max * espace * (60 + (int)(tirage % 41)) / 10000;
+    int hauteur = hauteur_max * espace * (60 + (int)((tirage >> 8) % 41)) / 10000;
+
+    largeur = (largeur < 1) ? 1 : largeur;
+    hauteur = (hauteur < 1) ? 1 : hauteur;
+    salle->x0 = secteur_x + 1 + (int)((tirage >> 16) % (uint64_t)(largeur_max - largeur + 1));
+    salle->y0 = secteur_y + 1 + (int)((tirage >> 40) % (uint64_t)(hauteur_max - hauteur + 1));
+    salle->x1 = salle->x0 + largeur - 1;
+    salle->y1 = salle->y0 + hauteur - 1;
+    salle->cx = salle->x0 + largeur / 2;
+    salle->cy = salle->y0 + hauteur / 2;
+}
+
+/**
+ * @brief Vide un rectangle (bornes comprises), limité aux lignes [debut, fin[.
+ *
+ * @param generation Le niveau.
+ * @param x0 Colonne de gauche.
+ * @param y0 Ligne du haut.
+ * @param x1 Colonne de droite.
+ * @param y1 Ligne du bas.
+ * @param debut Première ligne que l'appelant peut écrire.
+ * @param fin Ligne qui suit la dernière que l'appelant peut écrire.
+ */
+static void creuser(Generation *generation, int x0, int y0, int x1, int y1, int debut, int fin)
+{
+    for (int y = (y0 > debut) ? y0 : debut; y <= y1 && y < fin; y++)
+    {
+        memset(generation->plateau + (size_t)y * generation->largeur + x0, VIDE, x1 - x0 + 1);
+    }
+}
+
+/**
+ * @brief Salles et couloirs : lignes [debut, fin[ du plateau.
+ *
+ * @param generation Le niveau.
+ * @param debut Première ligne.
+ * @param fin Ligne qui suit la dernière.
+ */
+static void tacheSalles(Generation *generation, int debut, int fin)
+{
+    int hauteur_secteur = generation->hauteur_secteur;
+    // Un couloir vers le bas part du secteur précédent : il est compté aussi
+    int premier = (debut - 1) / hauteur_secteur - 1;
+    int dernier = (fin - 1) / hauteur_secteur;
+
+    premier = (premier < 0) ? 0 : premier;
+    dernier = (dernier > generation->secteurs_y - 1) ? generation->secteurs_y - 1 : dernier;
+    for (int y = debut; y < fin; y++)
+    {
+        memset(generation->plateau + (size_t)y * generation->largeur, COTE_BORDURE, generation->largeur);
+    }
+
+    for (int j = premier; j <= dernier; j++)
+    {
+        for (int i = 0; i < generation->secteurs_x; i++)
+        {
+            Salle salle, voisine;
+
+            calculerSalle(generation, i, j, &salle);
+            creuser(generation, salle.x0, salle.y0, salle.x1, salle.y1, debut, fin);
+            if (i + 1 < generation->secteurs_x)
+            {
+                // Vers la droite : à l'horizontale puis à la verticale
+                calculerSalle(generation, i + 1, j, &voisine);
+                creuser(generation, salle.cx, salle.cy, voisine.cx, salle.cy, debut, fin);
+                creuser(generation, voisine.cx, salle.cy < voisine.cy ? salle.cy : voisine.cy,
+                        voisine.cx, salle.cy < voisine.cy ? voisine.cy : salle.cy, debut, fin);
+            }
+            if (j + 1 < generation->secteurs_y)
+            {
+                // Vers le bas : à la verticale puis à l'horizontale
+                calculerSalle(generation, i, j + 1, &voisine);
+                creuser(generation, salle.cx, salle.cy, salle.cx, voisine.cy, debut, fin);
+                creuser(generation, salle.cx < voisine.cx ? salle.cx : voisine.cx, voisine.cy,
+                        salle.cx < voisine.cx ? voisine.cx : salle.cx, voisine.cy, debut, fin);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Grottes : remplissage aléatoire des lignes [debut, fin[ (1 : mur).
+ *
+ * Un tirage de 64 bits donne les 8 cases suivantes (un octet chacune).
+ *
+ * @param generation Le niveau.
+ * @param debut Première ligne.
+ * @param fin Ligne qui suit la dernière.
+ */
+static void tacheRemplissage(Generation *generation, int debut, int fin)
+{
+    int largeur = generation->largeur;
+    // Octet tiré sur 7 bits t : t + (128 - seuil) a son bit de poids fort si t >= seuil (case libre)
+    uint64_t decalage = OCTETS(128 - generation->densite * 128 / 100);
+
+    for (int y = debut; y < fin; y++)
+    {
+        unsigned char *ligne = generation->source + (size_t)y * largeur;
+
+        if (y == 0 || y == generation->hauteur - 1)
+        {
+            memset(ligne, 1, largeur);
+            continue;
+        }
+        for (int x = 0; x < largeur; x += 8)
+        {
+            uint64_t tirage = hacher(generation->graine, (uint64_t)y, (uint64_t)(x >> 3));
+            uint64_t murs = (~((tirage & OCTETS(0x7F)) + decalage) >> 7) & OCTETS(1);
+
+            if (x + 8 <= largeur)
+            {
+                ecrireMot(ligne + x, murs);
+            }
+            else
+            {
+                for (int b = 0; x + b < largeur; b++)
+                {
+                    ligne[x + b] = (unsigned char)(murs >> (8 * b));
+                }
+            }
+        }
+        ligne[0] = 1;
+        ligne[largeur - 1] = 1;
+    }
+}
+
+/**
+ * @brief Grottes : une passe d'automate cellulaire sur les lignes [debut, fin[.
+ *
+ * Les murs sont d'abord additionnés par colonne sur trois lignes, puis sur
+ * trois colonnes voisines, 8 cases à la fois (un octet par case : les sommes
+ * ne dépassent pas 9 et ne débordent pas d'un octet sur l'autre).
+ *
+ * @param generation Le niveau.
+ * @param debut Première ligne.
+ * @param fin Ligne qui suit la dernière.
+ */
+static void tacheAutomate(Generation *generation, int debut, int fin)
+{
+    int largeur = generation->largeur;
+    unsigned char *colonnes = malloc(largeur);
+
+    if (colonnes == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (int y = debut; y < fin; y++)
+    {
+        unsigned char *ecrite = generation->destination + (size_t)y * largeur;
+        const unsigned char *dessus, *milieu, *dessous;
+
+        if (y == 0 || y == generation->hauteur - 1)
+        {
+            memset(ecrite, 1, largeur);
+            continue;
+        }
+        milieu = generation->source + (size_t)y * largeur;
+        dessus = milieu - largeur;
+        dessous = milieu + largeur;
+        int x = 0;
+
+        for (; x + 8 <= largeur; x += 8)
+        {
+            ecrireMot(colonnes + x, lireMot(dessus + x) + lireMot(milieu + x) + lireMot(dessous + x));
+        }
+        for (; x < largeur; x++)
+        {
+            colonnes[x] = dessus[x] + milieu[x] + dessous[x];
+        }
+        // Somme s <= 9 : s + (128 - VOISINS_MUR) a son bit de poids fort si s >= VOISINS_MUR
+        for (x = 1; x + 9 <= largeur; x += 8)
+        {
+            uint64_t somme = lireMot(colonnes + x - 1) + lireMot(colonnes + x) + lireMot(colonnes + x + 1);
+
+            ecrireMot(ecrite + x, ((somme + OCTETS(128 - VOISINS_MUR)) >> 7) & OCTETS(1));
+        }
+        for (; x < largeur - 1; x++)
+        {
+            ecrite[x] = (colonnes[x - 1] + colonnes[x] + colonnes[x + 1]) >= VOISINS_MUR;
+        }
+        ecrite[0] = 1;
+        ecrite[largeur - 1] = 1;
+    }
+    free(colonnes);
+}
+
+/**
+ * @brief Grottes : conversion en caractères et galeries, lignes [debut, fin[.
+ *
+ * @param generation Le niveau (la grille est dans le plateau).
+ * @param debut Première ligne.
+ * @param fin Ligne qui suit la dernière.
+ */
+static void tacheGaleries(Generation *generation, int debut, int fin)
+{
+    int largeur = generation->largeur;
+    char mur = COTE_BORDURE;
+    char vide = VIDE;
+    // Case c (0 ou 1) : vide ^ c × (vide ^ mur), 8 cases à la fois
+    uint64_t fond = OCTETS((unsigned char)vide);
+    uint64_t ecart = (unsigned char)(vide ^ mur);
+
+    for (int y = debut; y < fin; y++)
+    {
+        char *ligne = generation->plateau + (size_t)y * largeur;
+        int x = 0;
+
+        if (y > 0 && y < generation->hauteur - 1 && y >= generation->galerie_y &&
+            (y - generation->galerie_y) % ECART_GALERIES == 0)
+        {
+            memset(ligne, vide, largeur);
+            continue;
+        }
+        for (; x + 8 <= largeur; x += 8)
+        {
+            ecrireMot(ligne + x, fond ^ (lireMot(ligne + x) * ecart));
+        }
+        for (; x < largeur; x++)
+        {
+            ligne[x] = ligne[x] ? mur : vide;
+        }
+        if (y > 0 && y < generation->hauteur - 1)
+        {
+            for (int x = generation->galerie_x; x < largeur - 1; x += ECART_GALERIES)
+            {
+                ligne[x] = vide;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Bornes d'une bande entre deux galeries (ou une galerie et la bordure).
+ *
+ * @param indice Numéro de la bande.
+ * @param premiere Première galerie.
+ * @param limite Bordure de fin (largeur - 1 ou hauteur - 1).
+ * @param debut Reçoit la première case de la bande.
+ * @param fin Reçoit la dernière case de la bande (debut > fin : bande vide).
+ */
+static void bornesBande(int indice, int premiere, int limite, int *debut, int *fin)
+{
+    int suivante = premiere + indice * ECART_GALERIES;
+
+    *debut = (indice == 0) ? 1 : suivante - ECART_GALERIES + 1;
+    *fin = ((suivante < limite) ? suivante : limite) - 1;
+}
+
+/**
+ * @brief Nombre de bandes entre la bordure 0 et la bordure « limite ».
+ *
+ * @param premiere Première galerie.
+ * @param limite Bordure de fin.
+ * @return Le nombre de bandes.
+ */
+static int nombreBandes(int premiere, int limite)
+{
+    return (premiere < limite) ? (limite - 1 - premiere) / ECART_GALERIES + 2 : 1;
+}
+
+/**
+ * @brief Grottes : comble les poches des bandes horizontales [debut, fin[.
+ *
+ * @param generation Le niveau.
+ * @param debut Première bande.
+ * @param fin Bande qui suit la dernière.
+ */
+static void tachePoches(Generation *generation, int debut, int fin)
+{
+    int colonnes = nombreBandes(generation->galerie_x, generation->largeur - 1);
+
+    for (int b = debut; b < fin; b++)
+    {
+        int y0, y1;
+
+        bornesBande(b, generation->galerie_y, generation->hauteur - 1, &y0, &y1);
+        for (int c = 0; c < colonnes && y0 <= y1; c++)
+        {
+            int x0, x1;
+
+            bornesBande(c, generation->galerie_x, generation->largeur - 1, &x0, &x1);
+            if (x0 <= x1)
+            {
+                comblerPoches(generation, x0, x1, y0, y1);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Comble les cases d'un carreau qui ne sont pas reliées à ses galeries.
+ *
+ * Chaque ligne du carreau (63 cases au plus) est un masque de 64 bits :
+ * les cases atteintes depuis les galeries sont propagées ligne par ligne,
+ * vers le bas puis vers le haut, jusqu'à stabilité.
+ *
+ * @param generation Le niveau.
+ * @param x0 Première colonne du carreau.
+ * @param x1 Dernière colonne du carreau.
+ * @param y0 Première ligne du carreau.
+ * @param y1 Dernière ligne du carreau.
+ */
+static void comblerPoches(Generation *generation, int x0, int x1, int y0, int y1)
+{
+    uint64_t libres[ECART_GALERIES];
+    uint64_t atteintes[ECART_GALERIES];
+    int largeur = x1 - x0 + 1;
+    int hauteur = y1 - y0 + 1;
+    // Un côté du carreau touche une galerie, sauf s'il touche la bordure
+    uint64_t bords = ((x0 > 1) ? 1u : 0u) | ((x1 < generation->largeur - 2) ? 1ull << (largeur - 1) : 0u);
+    bool change = true;
+
+    for (int r = 0; r < hauteur; r++)
+    {
+        const char *ligne = generation->plateau + (size_t)(y0 + r) * generation->largeur + x0;
+        uint64_t masque = 0;
+        int x = 0;
+
+        // 8 cases à la fois : octet non nul après ^ mur, puis un bit par octet regroupé par multiplication.
+        // Les mots peuvent dépasser le carreau (bits retirés ensuite), mais pas la ligne.
+        for (; x < largeur && x0 + x + 8 <= generation->largeur; x += 8)
+        {
+            uint64_t ecart = lireMot(ligne + x) ^ OCTETS((unsigned char)COTE_BORDURE);
+            uint64_t libres_mot = ((((ecart & OCTETS(0x7F)) + OCTETS(0x7F)) | ecart) >> 7) & OCTETS(1);
+
+            masque |= ((libres_mot * 0x0102040810204080ull) >> 56) << x;
+        }
+        for (; x < largeur; x++)
+        {
+            masque |= (uint64_t)(ligne[x] == VIDE) << x;
+        }
+        libres[r] = masque & ((1ull << largeur) - 1);
+        atteintes[r] = masque & bords;
+    }
+    if (y0 > 1)
+    {
+        atteintes[0] = libres[0];
+    }
+    if (y1 < generation->hauteur - 2)
+    {
+        atteintes[hauteur - 1] = libres[hauteur - 1];
+    }
+
+    while (change)
+    {
+        change = false;
+        for (int r = 0; r < hauteur; r++)
+        {
+            uint64_t atteinte = etendre((atteintes[r] | (r > 0 ? atteintes[r - 1] : 0)) & libres[r], libres[r]);
+
+            change |= (atteinte != atteintes[r]);
+            atteintes[r] = atteinte;
+        }
+        for (int r = hauteur - 1; r >= 0; r--)
+        {
+            uint64_t atteinte = etendre((atteintes[r] | (r < hauteur - 1 ? atteintes[r + 1] : 0)) & libres[r],
+                                        libres[r]);
+
+            change |= (atteinte != atteintes[r]);
+            atteintes[r] = atteinte;
+        }
+    }
+
+    for (int r = 0; r < hauteur; r++)
+    {
+        char *ligne = generation->plateau + (size_t)(y0 + r) * generation->largeur + x0;
+        uint64_t poches = libres[r] & ~atteintes[r];
+
+        while (poches != 0)
+        {
+            ligne[__builtin_ctzll(poches)] = COTE_BORDURE;
+            poches &= poches - 1;
+        }
+    }
+}
+
+/**
+ * @brief Étend des cases atteintes le long des suites de cases libres d'une ligne.
+ *
+ * Vers les bits de poids fort, une addition suffit : la retenue partie d'une
+ * graine traverse la suite de cases libres jusqu'à son premier mur. Vers les
+ * bits de poids faible, remplissage de Kogge-Stone (six décalages).
+ *
+ * @param graines Cases atteintes (comprises dans libres).
+ * @param libres Cases libres (le bit 63 est toujours un mur).
+ * @return Toutes les cases libres reliées à une graine sur la ligne.
+ */
+static uint64_t etendre(uint64_t graines, uint64_t libres)
+{
+    uint64_t hautes = (((libres + graines) ^ libres) & libres) | graines;
+    uint64_t basses = graines, passage = libres;
+
+    for (int decalage = 1; decalage < 64; decalage <<= 1)
+    {
+        basses |= passage & (basses >> decalage);
+        passage &= passage >> decalage;
+    }
+    return hautes | basses;
+}
+
+/**
+ * @brief Bordure, issues et zone de départ, communes à tous les niveaux.
+ *
+ * @param generation Le niveau.
+ */
+static void terminerNiveau(Generation *generation)
+{
+    char *plateau = generation->plateau;
+    int largeur = generation->largeur;
+    int hauteur = generation->hauteur;
+    int gauche = (generation->depart_x - MARGE_DEPART > 1) ? generation->depart_x - MARGE_DEPART : 1;
+    int droite = (generation->depart_x + MARGE_DEPART < largeur - 2) ? generation->depart_x + MARGE_DEPART : largeur - 2;
+
+    memset(plateau, COTE_BORDURE, largeur);
+    memset(plateau + (size_t)(hauteur - 1) * largeur, COTE_BORDURE, largeur);
+    for (int y = 1; y < hauteur - 1; y++)
+    {
+        plateau[(size_t)y * largeur] = COTE_BORDURE;
+        plateau[(size_t)y * largeur + largeur - 1] = COTE_BORDURE;
+    }
+    // Les mêmes issues que initPlateau()
+    plateau[largeur / 2] = VIDE;
+    plateau[(size_t)(hauteur - 1) * largeur + largeur / 2] = VIDE;
+    plateau[(size_t)(hauteur / 2) * largeur] = VIDE;
+    plateau[(size_t)(hauteur / 2) * largeur + largeur - 1] = VIDE;
+
+    // Le serpent part sur une ligne dégagée, reliée au reste du niveau
+    for (int y = generation->depart_y - 1; y <= generation->depart_y + 1; y++)
+    {
+        if (y > 0 && y < hauteur - 1)
+        {
+            memset(plateau + (size_t)y * largeur + gauche, VIDE, droite - gauche + 1);
+        }
+    }
+}
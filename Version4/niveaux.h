@@ -0,0 +1,35 @@
+/**
+ * @file niveaux.h
+ * @brief Générateurs de niveaux : labyrinthes, salles et couloirs, grottes.
+ *
+ * Un niveau généré remplace la bordure et les pavés du niveau d'origine. Il
+ * garde la bordure et ses quatre issues, dégage la zone de départ du serpent
+ * et ne contient que des cases libres reliées au départ.
+ *
+ * Le niveau ne dépend que de sa graine, de sa taille et de sa densité (pas
+ * du nombre de threads) : chaque case est tirée d'un hachage de la graine et
+ * de ses coordonnées. Les plateaux sont générés ligne par ligne, en
+ * parallèle sur les grands plateaux.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef NIVEAUX_H
+#define NIVEAUX_H
+
+#include <stdint.h>
+
+#include "jeu.h"
+
+#define DENSITE_NIVEAU 45   /**< Densité des murs par défaut. */
+
+/** Noms des types de niveau (fichier de règles, outils), dans l'ordre de TypeNiveau. */
+extern const char *const NOMS_NIVEAUX[NOMBRE_NIVEAUX];
+
+/* Déclaration des fonctions */
+void genererNiveau(char *plateau, int largeur, int hauteur, TypeNiveau type, int densite, uint64_t graine);
+
+#endif
@@ -0,0 +1,262 @@
+/**
+ * @file objets.c
+ * @brief Table dense des objets, indexée par case (voir objets.h).
+ *
+ * @details
+ * - La table de hachage, deux fois plus grande que le nombre maximal
+ *   d'objets, est sondée linéairement ; un retrait recule les entrées
+ *   suivantes au lieu de laisser des marques d'effacement.
+ * - Un objet retiré est remplacé par le dernier de la table dense, dont
+ *   l'entrée de hachage est mise à jour.
+ * - Tous les tableaux sont pris dans l'arène de la partie ; un clone réutilise
+ *   les siens d'une copie à l'autre (voir clonerPartie()).
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "objets.h"
+
+static int alveole(const Objets *objets, Segment position);
+static int entreeObjet(const Objets *objets, Segment position);
+
+/**
+ * @brief Prépare une table d'objets vide.
+ *
+ * @param objets Objets à préparer.
+ * @param arene Arène de la partie.
+ * @param largeur Largeur du plateau.
+ * @param pommes Nombre de pommes.
+ * @param bonus Nombre de bonus.
+ * @param duree_bonus Tours de présence d'un bonus.
+ */
+void initialiserObjets(Objets *objets, Arene *arene, int largeur, int pommes, int bonus, int duree_bonus)
+{
+    int capacite = pommes + bonus;
+    int taille = 2;
+
+    while (taille < 2 * capacite)
+    {
+        taille *= 2;
+    }
+    objets->capacite = capacite;
+    objets->bonus_voulus = bonus;
+    objets->duree_bonus = duree_bonus;
+    // Au plus un bonus mangé par tour : au plus duree_bonus entrées périmées
+    objets->capacite_file = (bonus > 0) ? bonus + duree_bonus : 1;
+    objets->objets = allouerDansArene(arene, (size_t)capacite * sizeof(Objet));
+    objets->index = allouerDansArene(arene, (size_t)taille * sizeof(int));
+    objets->file = allouerDansArene(arene, (size_t)objets->capacite_file * sizeof(Objet));
+    // Un tour fait apparaître et disparaître chacun au plus « capacite » objets
+    objets->changees = allouerDansArene(arene, (size_t)2 * capacite * sizeof(Segment));
+    objets->masque = taille - 1;
+    objets->largeur = largeur;
+    viderObjets(objets);
+}
+
+/**
+ * @brief Retire tous les objets (les tableaux restent alloués).
+ *
+ * @param objets Les objets.
+ */
+void viderObjets(Objets *objets)
+{
+    objets->nombre = 0;
+    objets->bonus = 0;
+    objets->debut_file = 0;
+    objets->longueur_file = 0;
+    objets->nombre_changees = 0;
+    memset(objets->index, 0xFF, (size_t)(objets->masque + 1) * sizeof(int));
+}
+
+/**
+ * @brief Ajoute un objet sur une case sans objet.
+ *
+ * @param objets Les objets (nombre < capacite).
+ * @param position Case de l'objet.
+ * @param type Type de l'objet (TypeObjet).
+ * @param disparition Tour de disparition, croissant d'un bonus au suivant (-1 : jamais).
+ */
+void ajouterObjet(Objets *objets, Segment position, int type, long disparition)
+{
+    Objet *objet = &objets->objets[objets->nombre];
+    int entree = alveole(objets, position);
+
+    while (objets->index[entree] >= 0)
+    {
+        entree = (entree + 1) & objets->masque;
+    }
+    objets->index[entree] = objets->nombre;
+    objet->position = position;
+    objet->type = type;
+    objet->disparition = disparition;
+    objets->nombre++;
+    if (type != OBJET_POMME)
+    {
+        objets->bonus++;
+    }
+    if (disparition >= 0)
+    {
+        objets->file[(objets->debut_file + objets->longueur_file) % objets->capacite_file] = *objet;
+        objets->longueur_file++;
+    }
+}
+
+/**
+ * @brief Cherche l'objet d'une case.
+ *
+ * @param objets Les objets.
+ * @param position La case.
+ * @return Indice de l'objet dans la table dense, ou -1 si la case n'en a pas.
+ */
+int chercherObjet(const Objets *objets, Segment position)
+{
+    int entree = entreeObjet(objets, position);
+
+    return (entree >= 0) ? objets->index[entree] : -1;
+}
+
+/**
+ * @brief Retire un objet.
+ *
+ * Le dernier objet de la table dense prend sa place : les indices d'objets
+ * obtenus avant le retrait ne sont plus valables.
+ *
+ * @param objets Les objets.
+ * @param indice Indice de l'objet dans la table dense.
+ */
+void retirerObjet(Objets *objets, int indice)
+{
+    int libre = entreeObjet(objets, objets->objets[indice].position);
+    int dernier = objets->nombre - 1;
+
+    // Recul des entrées suivantes qui ne seraient plus atteintes depuis leur alvéole
+    for (int entree = (libre + 1) & objets->masque; objets->index[entree] >= 0;
+         entree = (entree + 1) & objets->masque)
+    {
+        int depart = alveole(objets, objets->objets[objets->index[entree]].position);
+
+        if (((entree - depart) & objets->masque) >= ((entree - libre) & objets->masque))
+        {
+            objets->index[libre] = objets->index[entree];
+            libre = entree;
+        }
+    }
+    objets->index[libre] = -1;
+
+    if (objets->objets[indice].type != OBJET_POMME)
+    {
+        objets->bonus--;
+    }
+    if (indice != dernier)
+    {
+        objets->objets[indice] = objets->objets[dernier];
+        objets->index[entreeObjet(objets, objets->objets[indice].position)] = indice;
+    }
+    objets->nombre--;
+}
+
+/**
+ * @brief Donne un bonus arrivé à son tour de disparition.
+ *
+ * Les entrées périmées de la file (bonus déjà mangés) sont sautées.
+ * L'entrée du bonus rendu est retirée de la file, pas le bonus lui-même.
+ *
+ * @param objets Les objets.
+ * @param tour Tour courant.
+ * @return Indice du bonus à retirer, ou -1 s'il n'y en a plus pour ce tour.
+ */
+int objetDisparu(Objets *objets, long tour)
+{
+    while (objets->longueur_file > 0 && objets->file[objets->debut_file].disparition <= tour)
+    {
+        Objet entree = objets->file[objets->debut_file];
+        int indice = chercherObjet(objets, entree.position);
+
+        objets->debut_file = (objets->debut_file + 1) % objets->capacite_file;
+        objets->longueur_file--;
+        if (indice >= 0 && objets->objets[indice].disparition == entree.disparition)
+        {
+            return indice;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Recopie des objets, en réutilisant les tableaux de la copie s'ils suffisent.
+ *
+ * @param copie Objets qui reçoivent la copie.
+ * @param source Objets recopiés.
+ * @param arene Arène de la copie.
+ */
+void copierObjets(Objets *copie, const Objets *source, Arene *arene)
+{
+    Objets tableaux = *copie;
+
+    if (tableaux.objets == NULL || tableaux.capacite != source->capacite ||
+        tableaux.capacite_file != source->capacite_file || tableaux.largeur != source->largeur)
+    {
+        initialiserObjets(&tableaux, arene, source->largeur, source->capacite - source->bonus_voulus,
+                          source->bonus_voulus, source->duree_bonus);
+    }
+
+    *copie = *source;
+    copie->objets = tableaux.objets;
+    copie->index = tableaux.index;
+    copie->file = tableaux.file;
+    copie->changees = tableaux.changees;
+    memcpy(copie->objets, source->objets, (size_t)source->nombre * sizeof(Objet));
+    memcpy(copie->index, source->index, (size_t)(source->masque + 1) * sizeof(int));
+    for (int i = 0; i < source->longueur_file; i++)
+    {
+        int entree = (source->debut_file + i) % source->capacite_file;
+
+        copie->file[entree] = source->file[entree];
+    }
+    memcpy(copie->changees, source->changees, (size_t)source->nombre_changees * sizeof(Segment));
+}
+
+/**
+ * @brief Alvéole de départ d'une case dans la table de hachage.
+ *
+ * @param objets Les objets.
+ * @param position La case.
+ * @return L'alvéole.
+ */
+static int alveole(const Objets *objets, Segment position)
+{
+    uint64_t cle = (uint64_t)position.y * objets->largeur + position.x;
+
+    return (int)((cle * 0x9E3779B97F4A7C15ull) >> 32) & objets->masque;
+}
+
+/**
+ * @brief Alvéole de la table de hachage qui désigne l'objet d'une case.
+ *
+ * @param objets Les objets.
+ * @param position La case.
+ * @return L'alvéole, ou -1 si la case n'a pas d'objet.
+ */
+static int entreeObjet(const Objets *objets, Segment position)
+{
+    for (int entree = alveole(objets, position); objets->index[entree] >= 0;
+         entree = (entree + 1) & objets->masque)
+    {
+        const Objet *objet = &objets->objets[objets->index[entree]];
+
+        if (objet->position.x == position.x && objet->position.y == position.y)
+        {
+            return entree;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file objets.h
+ * @brief Objets posés sur le plateau : pommes et bonus.
+ *
+ * Les objets sont rangés dans une table dense (parcourue par les pilotes et
+ * l'affichage) et retrouvés par leur case grâce à une table de hachage à
+ * adressage ouvert : apparition, consommation et disparition coûtent un
+ * temps constant, quel que soit le nombre d'objets, sans jamais parcourir
+ * le plateau.
+ *
+ * Tous les bonus restent le même nombre de tours : l'ordre d'apparition est
+ * aussi celui de disparition, gardé dans une file. Un bonus mangé avant sa
+ * disparition laisse dans la file une entrée périmée, sautée à son tour.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef OBJETS_H
+#define OBJETS_H
+
+#include <stdbool.h>
+
+#include "serpent.h"
+
+#define DUREE_BONUS 100     /**< Tours de présence d'un bonus non mangé (règles par défaut). */
+
+/** @brief Type d'objet. */
+typedef enum
+{
+    OBJET_POMME,            /**< Pomme : le serpent grandit. */
+    OBJET_ACCELERATEUR,     /**< Bonus : le jeu accélère. */
+    OBJET_RALENTISSEUR,     /**< Bonus : le jeu ralentit. */
+    OBJET_RETRECISSEUR,     /**< Bonus : le serpent raccourcit. */
+    NOMBRE_TYPES_OBJETS
+} TypeObjet;
+
+/** @brief Objet posé sur le plateau. */
+typedef struct
+{
+    Segment position;       /**< Case de l'objet. */
+    int type;               /**< Type de l'objet (TypeObjet). */
+    long disparition;       /**< Tour de disparition (-1 : jamais, pour les pommes). */
+} Objet;
+
+/** @brief Objets d'une partie. */
+typedef struct
+{
+    Objet *objets;          /**< Table dense des objets. */
+    int nombre;             /**< Nombre d'objets. */
+    int capacite;           /**< Nombre maximal d'objets. */
+    int bonus;              /**< Nombre de bonus parmi les objets. */
+    int bonus_voulus;       /**< Nombre de bonus à garder sur le plateau. */
+    int duree_bonus;        /**< Tours de présence d'un bonus. */
+    int largeur;            /**< Largeur du plateau (indice des cases). */
+    int *index;             /**< Table de hachage : indice de l'objet de chaque case (-1 : libre). */
+    int masque;             /**< Taille de la table de hachage moins un. */
+    Objet *file;            /**< Bonus dans l'ordre d'apparition (file circulaire). */
+    int debut_file;         /**< Première entrée de la file. */
+    int longueur_file;      /**< Nombre d'entrées de la file. */
+    int capacite_file;      /**< Taille de la file. */
+    Segment *changees;      /**< Cases où un objet est apparu ou a disparu au dernier tour. */
+    int nombre_changees;    /**< Nombre de cases modifiées. */
+} Objets;
+
+/* Déclaration des fonctions */
+void initialiserObjets(Objets *objets, Arene *arene, int largeur, int pommes, int bonus, int duree_bonus);
+void viderObjets(Objets *objets);
+void ajouterObjet(Objets *objets, Segment position, int type, long disparition);
+int chercherObjet(const Objets *objets, Segment position);
+void retirerObjet(Objets *objets, int indice);
+int objetDisparu(Objets *objets, long tour);
+void copierObjets(Objets *copie, const Objets *source, Arene *arene);
+
+#endif
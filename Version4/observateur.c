@@ -0,0 +1,145 @@
+/**
+ * @file observateur.c
+ * @brief Lecture de l'instantané publié par le jeu (voir instantane.h).
+ *
+ * @details
+ * Utilisation : observateur [-a] [-n lectures] [-p periode] nom
+ * - Lit l'instantané du segment « nom » (option -i du jeu) sans jamais
+ *   ralentir le jeu, et affiche une ligne par lecture : tour, pommes,
+ *   longueur, vitesse, issue et nombre de copies recommencées.
+ * - -n : nombre de lectures (1 par défaut, 0 : jusqu'à la fin de la partie).
+ * - -p : période entre deux lectures en millisecondes (1000 par défaut).
+ * - -a : affiche aussi le plateau et le serpent à chaque lecture.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "instantane.h"
+
+static void afficherInstantane(const EnTeteInstantane *entete, char *plateau, const Segment *segments);
+
+/**
+ * @brief Lit les options et affiche les instantanés.
+ *
+ * @param argc Nombre d'arguments.
+ * @param argv Arguments.
+ * @return EXIT_SUCCESS, ou EXIT_FAILURE si le segment est absent ou invalide.
+ */
+int main(int argc, char *argv[])
+{
+    const char *ISSUES[] = {"en cours", "perdue", "gagnée"};
+    bool affichage = false;
+    long lectures = 1;
+    int periode = 1000;
+    int option;
+    int descripteur;
+    struct stat informations;
+    const EnTeteInstantane *source;
+    EnTeteInstantane entete;
+    char *plateau;
+    Segment *segments;
+
+    while ((option = getopt(argc, argv, "an:p:")) != -1)
+    {
+        if (option == 'a')
+        {
+            affichage = true;
+        }
+        else if (option == 'n')
+        {
+            lectures = atol(optarg);
+        }
+        else if (option == 'p')
+        {
+            periode = atoi(optarg);
+        }
+        else
+        {
+            fprintf(stderr, "Utilisation : %s [-a] [-n lectures] [-p periode] nom\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1)
+    {
+        fprintf(stderr, "Utilisation : %s [-a] [-n lectures] [-p periode] nom\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    descripteur = shm_open(argv[optind], O_RDONLY, 0);
+    if (descripteur < 0 || fstat(descripteur, &informations) != 0)
+    {
+        perror(argv[optind]);
+        return EXIT_FAILURE;
+    }
+    source = mmap(NULL, (size_t)informations.st_size, PROT_READ, MAP_SHARED, descripteur, 0);
+    close(descripteur);
+    if (source == MAP_FAILED || (size_t)informations.st_size < sizeof(EnTeteInstantane) ||
+        source->magie != MAGIE_INSTANTANE || source->version != VERSION_INSTANTANE)
+    {
+        fprintf(stderr, "%s : pas un instantané du jeu (version %d)\n", argv[optind], VERSION_INSTANTANE);
+        return EXIT_FAILURE;
+    }
+    plateau = malloc((size_t)source->largeur * source->hauteur);
+    segments = malloc((size_t)source->capacite_segments * sizeof(Segment));
+    if (plateau == NULL || segments == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    for (long n = 0; lectures == 0 || n < lectures; n++)
+    {
+        unsigned long essais = copierInstantane(source, &entete, plateau, segments);
+
+        if (affichage)
+        {
+            afficherInstantane(&entete, plateau, segments);
+        }
+        printf("tour %ld  pommes %d/%d  longueur %ld  vitesse %d µs  partie %s  (%lu copies recommencées)\n",
+               (long)entete.tour, entete.pommes_mangees, entete.objectif_pommes, (long)entete.longueur,
+               entete.vitesse, (entete.issue >= 0 && entete.issue <= PARTIE_GAGNEE) ? ISSUES[entete.issue] : "?",
+               essais);
+        fflush(stdout);
+        if (entete.issue != PARTIE_EN_COURS)
+        {
+            break;
+        }
+        poll(NULL, 0, periode);
+    }
+
+    free(plateau);
+    free(segments);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Affiche le plateau d'un instantané avec son serpent.
+ *
+ * @param entete En-tête de l'instantané.
+ * @param plateau Plateau de l'instantané (le serpent y est dessiné).
+ * @param segments Segments, de la tête vers la queue.
+ */
+static void afficherInstantane(const EnTeteInstantane *entete, char *plateau, const Segment *segments)
+{
+    for (int64_t i = entete->longueur - 1; i >= 0; i--)
+    {
+        plateau[(size_t)segments[i].y * entete->largeur + segments[i].x] = (i == 0) ? 'O' : 'X';
+    }
+    for (int y = 0; y < entete->hauteur; y++)
+    {
+        fwrite(plateau + (size_t)y * entete->largeur, 1, (size_t)entete->largeur, stdout);
+        putchar('\n');
+    }
+}
@@ -0,0 +1,248 @@
+/**
+ * @file obstacles.c
+ * @brief Grille de hachage spatial des pavés mobiles.
+ *
+ * @details
+ * - Chaque seau est une liste doublement chaînée d'indices de pavés : un pavé
+ *   change de seau en temps constant.
+ * - Tous les tableaux sont pris dans l'arène de la partie ; un clone réutilise
+ *   les siens d'une copie à l'autre (voir clonerPartie()).
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "obstacles.h"
+
+static int seau(const Obstacles *obstacles, int x, int y);
+static void chainer(Obstacles *obstacles, int indice);
+static void dechainer(Obstacles *obstacles, int indice);
+
+/**
+ * @brief Prépare des pavés mobiles vides.
+ *
+ * @param obstacles Pavés à préparer.
+ * @param arene Arène de la partie.
+ * @param largeur Largeur du plateau.
+ * @param hauteur Hauteur du plateau.
+ * @param taille Côté des pavés (au plus COTE_SEAU).
+ * @param capacite Nombre maximal de pavés.
+ * @param periode Tours entre deux déplacements d'un même pavé.
+ */
+void initialiserObstacles(Obstacles *obstacles, Arene *arene, int largeur, int hauteur,
+                          int taille, int capacite, int periode)
+{
+    obstacles->seaux_x = (largeur + COTE_SEAU - 1) / COTE_SEAU;
+    obstacles->seaux_y = (hauteur + COTE_SEAU - 1) / COTE_SEAU;
+    obstacles->seaux = allouerDansArene(arene, (size_t)obstacles->seaux_x * obstacles->seaux_y * sizeof(int));
+    obstacles->obstacles = allouerDansArene(arene, (size_t)capacite * sizeof(Obstacle));
+    // Un déplacement modifie au plus une rangée entrée et une rangée quittée par pavé
+    obstacles->changees = allouerDansArene(arene, (size_t)capacite * 2 * taille * sizeof(Segment));
+    obstacles->capacite = capacite;
+    obstacles->taille = taille;
+    obstacles->periode = periode;
+    obstacles->nombre = 0;
+    obstacles->nombre_changees = 0;
+    for (int i = 0; i < obstacles->seaux_x * obstacles->seaux_y; i++)
+    {
+        obstacles->seaux[i] = -1;
+    }
+}
+
+/**
+ * @brief Retire tous les pavés (les tableaux restent alloués).
+ *
+ * Seuls les seaux des pavés présents sont vidés : le coût ne dépend pas de
+ * la taille du plateau.
+ *
+ * @param obstacles Les pavés.
+ */
+void viderObstacles(Obstacles *obstacles)
+{
+    for (int i = 0; i < obstacles->nombre; i++)
+    {
+        obstacles->seaux[seau(obstacles, obstacles->obstacles[i].x, obstacles->obstacles[i].y)] = -1;
+    }
+    obstacles->nombre = 0;
+    obstacles->nombre_changees = 0;
+}
+
+/**
+ * @brief Ajoute un pavé.
+ *
+ * @param obstacles Les pavés (nombre < capacite).
+ * @param x Colonne du coin haut gauche.
+ * @param y Ligne du coin haut gauche.
+ * @param dx Déplacement en X.
+ * @param dy Déplacement en Y.
+ */
+void ajouterObstacle(Obstacles *obstacles, int x, int y, int dx, int dy)
+{
+    Obstacle *obstacle = &obstacles->obstacles[obstacles->nombre];
+
+    obstacle->x = x;
+    obstacle->y = y;
+    obstacle->dx = dx;
+    obstacle->dy = dy;
+    chainer(obstacles, obstacles->nombre);
+    obstacles->nombre++;
+}
+
+/**
+ * @brief Déplace un pavé, en changeant de seau si besoin.
+ *
+ * @param obstacles Les pavés.
+ * @param indice Le pavé.
+ * @param x Nouvelle colonne du coin haut gauche.
+ * @param y Nouvelle ligne du coin haut gauche.
+ */
+void deplacerObstacle(Obstacles *obstacles, int indice, int x, int y)
+{
+    Obstacle *obstacle = &obstacles->obstacles[indice];
+    bool change_de_seau = seau(obstacles, x, y) != seau(obstacles, obstacle->x, obstacle->y);
+
+    if (change_de_seau)
+    {
+        dechainer(obstacles, indice);
+    }
+    obstacle->x = x;
+    obstacle->y = y;
+    if (change_de_seau)
+    {
+        chainer(obstacles, indice);
+    }
+}
+
+/**
+ * @brief Indique si une case est recouverte par un pavé.
+ *
+ * @param obstacles Les pavés.
+ * @param x Colonne de la case.
+ * @param y Ligne de la case.
+ * @return true si un pavé recouvre la case.
+ */
+bool caseCouverte(const Obstacles *obstacles, int x, int y)
+{
+    int seau_x = x / COTE_SEAU, seau_y = y / COTE_SEAU;
+
+    // Coin du pavé entre (x - taille + 1, y - taille + 1) et (x, y)
+    for (int sy = (seau_y > 0) ? seau_y - 1 : 0; sy <= seau_y; sy++)
+    {
+        for (int sx = (seau_x > 0) ? seau_x - 1 : 0; sx <= seau_x; sx++)
+        {
+            for (int i = obstacles->seaux[sy * obstacles->seaux_x + sx]; i >= 0; i = obstacles->obstacles[i].suivant)
+            {
+                const Obstacle *obstacle = &obstacles->obstacles[i];
+
+                if (x >= obstacle->x && x < obstacle->x + obstacles->taille &&
+                    y >= obstacle->y && y < obstacle->y + obstacles->taille)
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Recopie des pavés, en réutilisant les tableaux de la copie s'ils suffisent.
+ *
+ * @param copie Pavés qui reçoivent la copie.
+ * @param source Pavés recopiés.
+ * @param arene Arène de la copie.
+ */
+void copierObstacles(Obstacles *copie, const Obstacles *source, Arene *arene)
+{
+    Obstacles tableaux = *copie;
+    size_t nombre_seaux = (size_t)source->seaux_x * source->seaux_y;
+
+    if (source->periode == 0)
+    {
+        copie->nombre = 0;
+        copie->periode = 0;
+        copie->nombre_changees = 0;
+        return;
+    }
+    if (tableaux.obstacles == NULL || tableaux.capacite < source->nombre || tableaux.taille < source->taille ||
+        (size_t)tableaux.seaux_x * tableaux.seaux_y != nombre_seaux)
+    {
+        tableaux.capacite = source->capacite;
+        tableaux.obstacles = allouerDansArene(arene, (size_t)source->capacite * sizeof(Obstacle));
+        tableaux.seaux = allouerDansArene(arene, nombre_seaux * sizeof(int));
+        tableaux.changees = allouerDansArene(arene, (size_t)source->capacite * 2 * source->taille * sizeof(Segment));
+    }
+
+    *copie = *source;
+    copie->obstacles = tableaux.obstacles;
+    copie->capacite = tableaux.capacite;
+    copie->seaux = tableaux.seaux;
+    copie->changees = tableaux.changees;
+    memcpy(copie->obstacles, source->obstacles, (size_t)source->nombre * sizeof(Obstacle));
+    memcpy(copie->seaux, source->seaux, nombre_seaux * sizeof(int));
+    memcpy(copie->changees, source->changees, (size_t)source->nombre_changees * sizeof(Segment));
+}
+
+/**
+ * @brief Seau d'une case.
+ *
+ * @param obstacles Les pavés.
+ * @param x Colonne.
+ * @param y Ligne.
+ * @return Indice du seau.
+ */
+static int seau(const Obstacles *obstacles, int x, int y)
+{
+    return (y / COTE_SEAU) * obstacles->seaux_x + x / COTE_SEAU;
+}
+
+/**
+ * @brief Ajoute un pavé en tête de la liste de son seau.
+ *
+ * @param obstacles Les pavés.
+ * @param indice Le pavé.
+ */
+static void chainer(Obstacles *obstacles, int indice)
+{
+    Obstacle *obstacle = &obstacles->obstacles[indice];
+    int *premier = &obstacles->seaux[seau(obstacles, obstacle->x, obstacle->y)];
+
+    obstacle->precedent = -1;
+    obstacle->suivant = *premier;
+    if (*premier >= 0)
+    {
+        obstacles->obstacles[*premier].precedent = indice;
+    }
+    *premier = indice;
+}
+
+/**
+ * @brief Retire un pavé de la liste de son seau.
+ *
+ * @param obstacles Les pavés.
+ * @param indice Le pavé.
+ */
+static void dechainer(Obstacles *obstacles, int indice)
+{
+    Obstacle *obstacle = &obstacles->obstacles[indice];
+
+    if (obstacle->precedent >= 0)
+    {
+        obstacles->obstacles[obstacle->precedent].suivant = obstacle->suivant;
+    }
+    else
+    {
+        obstacles->seaux[seau(obstacles, obstacle->x, obstacle->y)] = obstacle->suivant;
+    }
+    if (obstacle->suivant >= 0)
+    {
+        obstacles->obstacles[obstacle->suivant].precedent = obstacle->precedent;
+    }
+}
@@ -0,0 +1,65 @@
+/**
+ * @file obstacles.h
+ * @brief Pavés mobiles rangés dans une grille de hachage spatial.
+ *
+ * Le plateau est découpé en seaux de COTE_SEAU × COTE_SEAU cases ; chaque
+ * pavé est chaîné dans le seau de son coin haut gauche. Un pavé ne dépassant
+ * pas COTE_SEAU cases de côté, les pavés qui recouvrent une case sont tous
+ * dans son seau ou dans les trois seaux situés à gauche et au-dessus : savoir
+ * si une case est recouverte ne coûte que quatre seaux, quel que soit le
+ * nombre de pavés.
+ *
+ * Le plateau de la partie reste la référence pour les collisions ; la grille
+ * sert à savoir si une case quittée par un pavé reste recouverte par un autre.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef OBSTACLES_H
+#define OBSTACLES_H
+
+#include <stdbool.h>
+
+#include "serpent.h"
+
+#define COTE_SEAU 8     /**< Côté d'un seau de la grille (au moins le côté maximal d'un pavé). */
+
+/** @brief Pavé mobile. */
+typedef struct
+{
+    int x;              /**< Colonne du coin haut gauche. */
+    int y;              /**< Ligne du coin haut gauche. */
+    int dx;             /**< Déplacement en X à chaque période (-1, 0 ou 1). */
+    int dy;             /**< Déplacement en Y à chaque période (-1, 0 ou 1). */
+    int precedent;      /**< Pavé précédent dans le même seau (-1 : premier). */
+    int suivant;        /**< Pavé suivant dans le même seau (-1 : dernier). */
+} Obstacle;
+
+/** @brief Pavés mobiles d'une partie (aucun si les pavés sont fixes). */
+typedef struct
+{
+    Obstacle *obstacles;    /**< Les pavés. */
+    int nombre;             /**< Nombre de pavés. */
+    int capacite;           /**< Nombre de pavés alloués. */
+    int taille;             /**< Côté des pavés. */
+    int periode;            /**< Tours entre deux déplacements d'un même pavé (0 : pavés fixes). */
+    int seaux_x;            /**< Nombre de seaux par ligne. */
+    int seaux_y;            /**< Nombre de seaux par colonne. */
+    int *seaux;             /**< Premier pavé de chaque seau (-1 : seau vide). */
+    Segment *changees;      /**< Cases modifiées par les déplacements du dernier tour. */
+    int nombre_changees;    /**< Nombre de cases modifiées. */
+} Obstacles;
+
+/* Déclaration des fonctions */
+void initialiserObstacles(Obstacles *obstacles, Arene *arene, int largeur, int hauteur,
+                          int taille, int capacite, int periode);
+void viderObstacles(Obstacles *obstacles);
+void ajouterObstacle(Obstacles *obstacles, int x, int y, int dx, int dy);
+void deplacerObstacle(Obstacles *obstacles, int indice, int x, int y);
+bool caseCouverte(const Obstacles *obstacles, int x, int y);
+void copierObstacles(Obstacles *copie, const Obstacles *source, Arene *arene);
+
+#endif
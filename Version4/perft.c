@@ -0,0 +1,422 @@
+/**
+ * @file perft.c
+ * @brief Décompte exhaustif des parties possibles jusqu'à une profondeur (« perft »).
+ *
+ * Depuis la position de départ (serpent au centre du plateau, soit
+ * COORD_DEPART_X_SERPENT, COORD_DEPART_Y_SERPENT avec les règles par défaut),
+ * joue toutes les suites de tours où le serpent va devant, à gauche ou à
+ * droite, et compte les états atteints à chaque profondeur. Les pommes
+ * apparaissent comme en partie, tirées du générateur de la partie : une
+ * même graine donne toujours les mêmes nombres. Ils servent de mesure de
+ * vitesse du moteur et de référence pour vérifier une version optimisée de
+ * progresser() : la somme des empreintes de Zobrist change au moindre écart.
+ *
+ * @details
+ * Utilisation : perft [-p profondeur] [-g graine] [-j threads] [-v] [-t]
+ * - -p : profondeur (10 par défaut).
+ * - -g : graine de la partie (1 par défaut).
+ * - -j : nombre de threads (nombre de cœurs par défaut).
+ * - -v : recalcule l'empreinte de la partie après chaque tour joué et chaque
+ *   tour annulé, et compte les différences avec l'empreinte tenue à jour.
+ * - -t : range chaque état dans une table de transposition partagée par les
+ *   threads (voir transposition.h), avec pour donnée une empreinte de ses
+ *   segments dans l'ordre. Un état dont l'empreinte est déjà dans la table
+ *   est une transposition si les segments sont les mêmes, une collision
+ *   sinon (même empreinte de Zobrist pour deux serpents différents : le
+ *   programme échoue). Les nombres varient avec les threads : une entrée
+ *   peut être remplacée ou écrite en même temps par un autre thread avant
+ *   d'être relue.
+ * - Les tours sont joués par jouerCoup() et annulés par annulerCoup() : chaque
+ *   thread garde une seule partie, jamais recopiée. Les premiers niveaux sont
+ *   parcourus d'abord ; chacun de leurs états devient un sous-arbre, parcouru
+ *   par le premier thread libre.
+ * - Une partie perdue ou gagnée compte comme un état mais n'est pas prolongée.
+ * - Les règles sont toujours les règles par défaut (regles.conf est ignoré),
+ *   pour que les nombres ne dépendent que de la graine et de la profondeur.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "jeu.h"
+#include "transposition.h"
+
+#define SOUS_ARBRES_PAR_THREAD 16   /**< Sous-arbres voulus par thread, pour équilibrer la charge. */
+#define SENS_RELATIFS 3             /**< Devant, à droite, à gauche. */
+#define ENTREES_TABLE (1 << 20)     /**< Entrées de la table de transposition (option -t). */
+
+/** @brief Décompte des états d'une profondeur. */
+typedef struct
+{
+    long etats;             /**< États atteints. */
+    long perdues;           /**< Parties perdues à cette profondeur. */
+    long gagnees;           /**< Parties gagnées à cette profondeur. */
+    long erreurs;           /**< Empreintes fausses (option -v). */
+    long transpositions;    /**< États déjà dans la table (option -t). */
+    long collisions;        /**< États de même empreinte qu'un autre état de la table (option -t). */
+    uint64_t somme;         /**< Somme des empreintes des états (modulo 2^64). */
+} Compte;
+
+/** @brief Paramètres partagés par les threads. */
+typedef struct
+{
+    uint32_t graine;        /**< Graine de la partie. */
+    int profondeur;         /**< Profondeur totale. */
+    int decoupe;            /**< Profondeur des racines des sous-arbres. */
+    int sous_arbres;        /**< Nombre de sous-arbres : 3 puissance decoupe. */
+    bool verification;      /**< Recalcul des empreintes (option -v). */
+    TableTransposition *table;  /**< Table des états (option -t), NULL sinon. */
+    Compte *comptes;        /**< Décomptes, sous-arbre par sous-arbre puis profondeur par profondeur. */
+    atomic_int prochain;    /**< Prochain sous-arbre à parcourir. */
+} Perft;
+
+/** Les quatre directions dans le sens des aiguilles d'une montre. */
+static const char DIRECTIONS[4] = {HAUT, DROITE, BAS, GAUCHE};
+/** Quarts de tour de chaque sens relatif : devant, à droite, à gauche. */
+static const int QUARTS[SENS_RELATIFS] = {0, 1, 3};
+
+static void *travailleur(void *argument);
+static void explorer(const Perft *perft, Partie *partie, int profondeur, int fin, Compte *comptes);
+static void noterTransposition(TableTransposition *table, const Partie *partie, Compte *compte);
+static uint64_t empreinteOrdonnee(const Partie *partie);
+static char tourner(char direction, int sens);
+static double secondes(void);
+
+/**
+ * @brief Lit les options, parcourt l'arbre et affiche le décompte.
+ *
+ * @param argc Nombre d'arguments.
+ * @param argv Arguments.
+ * @return EXIT_SUCCESS, ou EXIT_FAILURE si les arguments sont invalides une empreinte fausse ou une collision.
+ */
+int main(int argc, char *argv[])
+{
+    Perft perft;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    pthread_t *travailleurs;
+    Compte *total;
+    TableTransposition table;
+    Regles regles;
+    Partie partie;
+    long etats = 0, erreurs = 0, transpositions = 0, collisions = 0;
+    double debut, duree;
+    int option;
+
+    perft.graine = 1;
+    perft.profondeur = 10;
+    perft.verification = false;
+    perft.table = NULL;
+
+    while ((option = getopt(argc, argv, "p:g:j:vt")) != -1)
+    {
+        switch (option)
+        {
+            case 'p':
+                perft.profondeur = atoi(optarg);
+                break;
+            case 'g':
+                perft.graine = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'j':
+                threads = atol(optarg);
+                break;
+            case 'v':
+                perft.verification = true;
+                break;
+            case 't':
+                perft.table = &table;
+                break;
+            default:
+                fprintf(stderr, "Utilisation : %s [-p profondeur] [-g graine] [-j threads] [-v] [-t]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (perft.profondeur <= 0 || threads <= 0)
+    {
+        fprintf(stderr, "%s : les nombres doivent être positifs\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Découpe : assez de sous-arbres pour tous les threads, sans atteindre la profondeur totale
+    perft.decoupe = 0;
+    perft.sous_arbres = 1;
+    while (perft.decoupe < perft.profondeur - 1 && perft.sous_arbres < SOUS_ARBRES_PAR_THREAD * threads)
+    {
+        perft.decoupe++;
+        perft.sous_arbres *= SENS_RELATIFS;
+    }
+    perft.comptes = calloc((size_t)(perft.sous_arbres + 1) * (perft.profondeur + 1), sizeof(Compte));
+    travailleurs = malloc(threads * sizeof(pthread_t));
+    if (perft.comptes == NULL || travailleurs == NULL ||
+        (perft.table != NULL && !creerTable(perft.table, ENTREES_TABLE)))
+    {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    // Le décompte total est rangé après ceux des sous-arbres
+    total = perft.comptes + (size_t)perft.sous_arbres * (perft.profondeur + 1);
+    atomic_init(&perft.prochain, 0);
+    reglesParDefaut(&regles);
+    publierRegles(&regles);
+
+    debut = secondes();
+    // Premiers niveaux, jusqu'aux racines des sous-arbres
+    creerPartie(&partie, perft.graine);
+    total[0].etats = 1;
+    total[0].somme = partie.empreinte;
+    if (perft.table != NULL)
+    {
+        noterTransposition(perft.table, &partie, &total[0]);
+    }
+    explorer(&perft, &partie, 0, perft.decoupe, total);
+    detruirePartie(&partie);
+
+    for (long i = 0; i < threads; i++)
+    {
+        pthread_create(&travailleurs[i], NULL, travailleur, &perft);
+    }
+    for (long i = 0; i < threads; i++)
+    {
+        pthread_join(travailleurs[i], NULL);
+    }
+    duree = secondes() - debut;
+    for (int s = 0; s < perft.sous_arbres; s++)
+    {
+        const Compte *comptes = perft.comptes + (size_t)s * (perft.profondeur + 1);
+
+        for (int p = perft.decoupe + 1; p <= perft.profondeur; p++)
+        {
+            total[p].etats += comptes[p].etats;
+            total[p].perdues += comptes[p].perdues;
+            total[p].gagnees += comptes[p].gagnees;
+            total[p].erreurs += comptes[p].erreurs;
+            total[p].transpositions += comptes[p].transpositions;
+            total[p].collisions += comptes[p].collisions;
+            total[p].somme += comptes[p].somme;
+        }
+    }
+
+    printf("Graine %u, profondeur %d, %ld threads, %d sous-arbres à la profondeur %d\n\n",
+           perft.graine, perft.profondeur, threads, perft.sous_arbres, perft.decoupe);
+    printf("%10s %16s %14s %10s %20s\n", "Profondeur", "États", "Perdues", "Gagnées", "Empreintes");
+    for (int p = 0; p <= perft.profondeur; p++)
+    {
+        printf("%10d %16ld %14ld %10ld %20llu\n", p, total[p].etats, total[p].perdues,
+               total[p].gagnees, (unsigned long long)total[p].somme);
+        etats += total[p].etats;
+        erreurs += total[p].erreurs;
+        transpositions += total[p].transpositions;
+        collisions += total[p].collisions;
+    }
+    printf("\n%ld états en %.3f s (%.2f millions par seconde)\n", etats, duree, etats / duree / 1e6);
+    if (perft.verification)
+    {
+        printf("%ld empreintes fausses\n", erreurs);
+    }
+    if (perft.table != NULL)
+    {
+        printf("%ld transpositions, %ld collisions (même empreinte, autres segments)\n",
+               transpositions, collisions);
+        detruireTable(perft.table);
+    }
+
+    free(travailleurs);
+    free(perft.comptes);
+    return (erreurs == 0 && collisions == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**
+ * @brief Boucle d'un thread : parcourt les sous-arbres un à un jusqu'au dernier.
+ *
+ * Le thread rejoue depuis le départ les tours qui mènent à la racine du
+ * sous-arbre (chiffres en base 3 de son numéro), le parcourt, puis annule
+ * ces tours : sa partie est créée une seule fois.
+ *
+ * @param argument Le perft.
+ * @return NULL.
+ */
+static void *travailleur(void *argument)
+{
+    Perft *perft = argument;
+    Coup *chemin = malloc((perft->decoupe + 1) * sizeof(Coup));
+    Partie partie;
+    int numero;
+
+    if (chemin == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    creerPartie(&partie, perft->graine);
+    while ((numero = atomic_fetch_add(&perft->prochain, 1)) < perft->sous_arbres)
+    {
+        Issue issue = PARTIE_EN_COURS;
+        int joues = 0;
+        int chiffres = numero;
+
+        // Une racine atteinte par une partie déjà finie n'a pas de sous-arbre (comptée aux premiers niveaux)
+        while (joues < perft->decoupe && issue == PARTIE_EN_COURS)
+        {
+            issue = jouerCoup(&partie, tourner(partie.direction, chiffres % SENS_RELATIFS), &chemin[joues++]);
+            chiffres /= SENS_RELATIFS;
+        }
+        if (issue == PARTIE_EN_COURS)
+        {
+            explorer(perft, &partie, perft->decoupe, perft->profondeur,
+                     perft->comptes + (size_t)numero * (perft->profondeur + 1));
+        }
+        while (joues > 0)
+        {
+            annulerCoup(&partie, &chemin[--joues]);
+        }
+    }
+    detruirePartie(&partie);
+    free(chemin);
+    return NULL;
+}
+
+/**
+ * @brief Compte les états atteints depuis la partie, de profondeur + 1 à fin.
+ *
+ * @param perft Le perft (options -v et -t).
+ * @param partie La partie, en cours ; elle est rendue dans le même état.
+ * @param profondeur Profondeur de la partie.
+ * @param fin Dernière profondeur comptée.
+ * @param comptes Décomptes, indicés par la profondeur.
+ */
+static void explorer(const Perft *perft, Partie *partie, int profondeur, int fin, Compte *comptes)
+{
+    bool verification = perft->verification;
+    Compte *compte = &comptes[profondeur + 1];
+
+    if (profondeur >= fin)
+    {
+        return;
+    }
+    for (int sens = 0; sens < SENS_RELATIFS; sens++)
+    {
+        Coup coup;
+        Issue issue = jouerCoup(partie, tourner(partie->direction, sens), &coup);
+
+        compte->etats++;
+        compte->somme += partie->empreinte;
+        if (verification && calculerEmpreinte(partie) != partie->empreinte)
+        {
+            compte->erreurs++;
+        }
+        if (perft->table != NULL)
+        {
+            noterTransposition(perft->table, partie, compte);
+        }
+        if (issue == PARTIE_PERDUE)
+        {
+            compte->perdues++;
+        }
+        else if (issue == PARTIE_GAGNEE)
+        {
+            compte->gagnees++;
+        }
+        else
+        {
+            explorer(perft, partie, profondeur + 1, fin, comptes);
+        }
+        annulerCoup(partie, &coup);
+        if (verification && calculerEmpreinte(partie) != partie->empreinte)
+        {
+            compte->erreurs++;
+        }
+    }
+}
+
+/**
+ * @brief Cherche un état dans la table de transposition, puis l'y range.
+ *
+ * @param table La table.
+ * @param partie L'état atteint.
+ * @param compte Décompte de sa profondeur.
+ */
+static void noterTransposition(TableTransposition *table, const Partie *partie, Compte *compte)
+{
+    uint64_t ordonnee = empreinteOrdonnee(partie);
+    uint64_t connue;
+
+    if (lirePosition(table, partie->empreinte, &connue))
+    {
+        if (connue == ordonnee)
+        {
+            compte->transpositions++;
+        }
+        else
+        {
+            compte->collisions++;
+        }
+    }
+    enregistrerPosition(table, partie->empreinte, ordonnee);
+}
+
+/**
+ * @brief Empreinte FNV-1a de la direction, de la pomme et des segments dans l'ordre.
+ *
+ * Au contraire de l'empreinte de Zobrist, elle distingue deux serpents
+ * occupant les mêmes cases dans un ordre différent ; elle est recalculée
+ * entièrement, en temps proportionnel à la taille du serpent.
+ *
+ * @param partie La partie.
+ * @return L'empreinte.
+ */
+static uint64_t empreinteOrdonnee(const Partie *partie)
+{
+    uint64_t empreinte = (0xCBF29CE484222325ull ^ (unsigned char)partie->direction) * 0x100000001B3ull;
+    Parcours parcours;
+    Segment segment;
+
+    empreinte = (empreinte ^ ((uint64_t)partie->pomme.y * partie->largeur + partie->pomme.x)) * 0x100000001B3ull;
+    debutParcours(&partie->serpent, &parcours);
+    while (segmentSuivant(&parcours, &segment))
+    {
+        empreinte = (empreinte ^ ((uint64_t)segment.y * partie->largeur + segment.x)) * 0x100000001B3ull;
+    }
+    return empreinte;
+}
+
+/**
+ * @brief Direction obtenue en tournant depuis une direction.
+ *
+ * @param direction Direction actuelle.
+ * @param sens Sens relatif : 0 devant, 1 à droite, 2 à gauche.
+ * @return La nouvelle direction (jamais un demi-tour).
+ */
+static char tourner(char direction, int sens)
+{
+    int i = 0;
+
+    while (DIRECTIONS[i] != direction)
+    {
+        i++;
+    }
+    return DIRECTIONS[(i + QUARTS[sens]) % 4];
+}
+
+/**
+ * @brief Horloge monotone en secondes.
+ *
+ * @return L'instant présent.
+ */
+static double secondes(void)
+{
+    struct timespec instant;
+
+    clock_gettime(CLOCK_MONOTONIC, &instant);
+    return (double)instant.tv_sec + instant.tv_nsec / 1e9;
+}
@@ -0,0 +1,515 @@
+/**
+ * @file regles.c
+ * @brief Lecture, validation et surveillance du fichier de règles.
+ *
+ * @details
+ * - Chaque clé est décrite par sa position dans la structure Regles, sa
+ *   taille et ses bornes : la lecture est la même pour toutes les clés.
+ * - Les règles lues sont validées dans leur ensemble (un plateau trop petit
+ *   pour le serpent de départ ou pour ses pavés, une vitesse qui deviendrait
+ *   nulle avant l'objectif, deux touches identiques sont refusés).
+ * - C'est le dossier du fichier qui est surveillé : un éditeur qui écrit un
+ *   fichier temporaire puis le renomme est vu comme une modification.
+ * - Un tube réveille le thread de surveillance pour l'arrêter.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stddef.h>
+#include <unistd.h>
+#include <poll.h>
+#include <signal.h>
+#include <pthread.h>
+#include <sys/inotify.h>
+
+#include "regles.h"
+#include "niveaux.h"
+
+#define FICHIER_REGLES "regles.conf"    /**< Fichier de règles par défaut (si $SNAKE_REGLES est absent). */
+#define TAILLE_LIGNE 256                /**< Longueur maximale d'une ligne du fichier. */
+#define LARGEUR_MAX 16384               /**< Largeur maximale du plateau. */
+#define HAUTEUR_MAX 16384               /**< Hauteur maximale du plateau. */
+#define TAILLE_PAVE_MAX 6               /**< Côté maximal d'un pavé (au-delà, il pourrait recouvrir le serpent de départ). */
+#define ZONE_DEPART 15                  /**< Distance au départ en deçà de laquelle aucun pavé ne commence (voir placerPaves()). */
+#define TAILLE_EVENEMENTS 4096          /**< Taille du tampon des événements inotify. */
+
+_Static_assert(TAILLE_PAVE_MAX <= COTE_SEAU, "un pavé mobile doit tenir dans un seau de la grille (voir obstacles.h)");
+
+/** @brief Forme de la valeur d'une clé. */
+typedef enum
+{
+    VALEUR_ENTIER,          /**< Entier borné. */
+    VALEUR_TOUCHE,          /**< Un caractère visible. */
+    VALEUR_NOM              /**< Un nom de NOMS_NIVEAUX, rangé comme son numéro. */
+} FormeValeur;
+
+/** @brief Description d'une clé du fichier de règles. */
+typedef struct
+{
+    const char *nom;        /**< Nom de la clé. */
+    FormeValeur forme;      /**< Forme de la valeur. */
+    size_t position;        /**< Position du champ dans Regles. */
+    size_t taille;          /**< Taille du champ (1, 2 ou 4 octets). */
+    long minimum;           /**< Plus petite valeur acceptée (entiers). */
+    long maximum;           /**< Plus grande valeur acceptée (entiers). */
+} Cle;
+
+/** Clés du fichier de règles. */
+static const Cle CLES[] = {
+    {"vitesse_jeu", VALEUR_ENTIER, offsetof(Regles, vitesse_jeu), sizeof(int32_t), VITESSE_MIN, 10000000},
+    {"acceleration", VALEUR_ENTIER, offsetof(Regles, acceleration), sizeof(int32_t), 0, 10000000},
+    {"objectif_pommes", VALEUR_ENTIER, offsetof(Regles, objectif_pommes), sizeof(int32_t), 1, 100000},
+    {"largeur", VALEUR_ENTIER, offsetof(Regles, largeur), sizeof(int16_t), 2 * TAILLE_SERPENT, LARGEUR_MAX},
+    {"hauteur", VALEUR_ENTIER, offsetof(Regles, hauteur), sizeof(int16_t), 5, HAUTEUR_MAX},
+    {"nombre_paves", VALEUR_ENTIER, offsetof(Regles, nombre_paves), sizeof(int16_t), 0, 10000},
+    {"taille_pave", VALEUR_ENTIER, offsetof(Regles, taille_pave), sizeof(int16_t), 1, TAILLE_PAVE_MAX},
+    {"periode_paves", VALEUR_ENTIER, offsetof(Regles, periode_paves), sizeof(int16_t), 0, 10000},
+    {"pommes", VALEUR_ENTIER, offsetof(Regles, pommes), sizeof(int16_t), 1, 10000},
+    {"bonus", VALEUR_ENTIER, offsetof(Regles, bonus), sizeof(int16_t), 0, 10000},
+    {"duree_bonus", VALEUR_ENTIER, offsetof(Regles, duree_bonus), sizeof(int16_t), 1, 10000},
+    {"niveau", VALEUR_NOM, offsetof(Regles, niveau), sizeof(int8_t), 0, NOMBRE_NIVEAUX - 1},
+    {"densite", VALEUR_ENTIER, offsetof(Regles, densite), sizeof(int8_t), 0, 100},
+    {"touche_haut", VALEUR_TOUCHE, offsetof(Regles, touche_haut), sizeof(char), 0, 0},
+    {"touche_bas", VALEUR_TOUCHE, offsetof(Regles, touche_bas), sizeof(char), 0, 0},
+    {"touche_gauche", VALEUR_TOUCHE, offsetof(Regles, touche_gauche), sizeof(char), 0, 0},
+    {"touche_droite", VALEUR_TOUCHE, offsetof(Regles, touche_droite), sizeof(char), 0, 0},
+    {"touche_arret", VALEUR_TOUCHE, offsetof(Regles, touche_arret), sizeof(char), 0, 0},
+};
+
+#define NOMBRE_CLES (sizeof(CLES) / sizeof(CLES[0]))    /**< Nombre de clés. */
+
+static pthread_t thread_surveillance;       /**< Thread de surveillance. */
+static bool surveillance_active = false;    /**< Le thread de surveillance tourne. */
+static int notification = -1;               /**< Descripteur inotify. */
+static int reveil[2] = {-1, -1};            /**< Tube de réveil du thread de surveillance. */
+static char *chemin_surveille;              /**< Fichier de règles surveillé. */
+static FILE *erreurs_surveillance;          /**< Flux des erreurs de relecture. */
+static const char *nom_surveille;           /**< Nom du fichier dans son dossier. */
+
+static bool lireValeur(const Cle *cle, const char *valeur, Regles *regles);
+static bool validerRegles(const Regles *regles, const char **erreur);
+static void *surveiller(void *argument);
+static char *nettoyer(char *texte);
+
+/**
+ * @brief Lit un fichier de règles.
+ *
+ * Les clés absentes gardent leur valeur par défaut. Les erreurs sont
+ * écrites dans le flux donné (fichier, ligne et cause).
+ *
+ * @param chemin Le fichier.
+ * @param regles Reçoit les règles lues.
+ * @param erreurs Flux qui reçoit les erreurs.
+ * @return false si le fichier est illisible ou invalide.
+ */
+bool lireRegles(const char *chemin, Regles *regles, FILE *erreurs)
+{
+    FILE *fichier = fopen(chemin, "r");
+    char ligne[TAILLE_LIGNE];
+    int numero = 0;
+    bool valide = true;
+    const char *erreur;
+
+    if (fichier == NULL)
+    {
+        fprintf(erreurs, "%s : %s\n", chemin, strerror(errno));
+        return false;
+    }
+    reglesParDefaut(regles);
+    while (fgets(ligne, sizeof(ligne), fichier) != NULL)
+    {
+        char *commentaire = strchr(ligne, '#');
+        char *egal;
+        char *nom;
+        size_t k;
+
+        numero++;
+        if (commentaire != NULL)
+        {
+            *commentaire = '\0';
+        }
+        nom = nettoyer(ligne);
+        if (*nom == '\0')
+        {
+            continue;
+        }
+        egal = strchr(nom, '=');
+        if (egal == NULL)
+        {
+            fprintf(erreurs, "%s:%d : « clé = valeur » attendu\n", chemin, numero);
+            valide = false;
+            continue;
+        }
+        *egal = '\0';
+        nom = nettoyer(nom);
+        for (k = 0; k < NOMBRE_CLES && strcmp(CLES[k].nom, nom) != 0; k++)
+        {
+        }
+        if (k == NOMBRE_CLES)
+        {
+            fprintf(erreurs, "%s:%d : clé inconnue « %s »\n", chemin, numero, nom);
+            valide = false;
+        }
+        else if (!lireValeur(&CLES[k], nettoyer(egal + 1), regles))
+        {
+            if (CLES[k].forme == VALEUR_TOUCHE)
+            {
+                fprintf(erreurs, "%s:%d : %s doit être un seul caractère visible\n", chemin, numero, nom);
+            }
+            else if (CLES[k].forme == VALEUR_NOM)
+            {
+                fprintf(erreurs, "%s:%d : %s doit être l'un de :", chemin, numero, nom);
+                for (int n = 0; n < NOMBRE_NIVEAUX; n++)
+                {
+                    fprintf(erreurs, " %s", NOMS_NIVEAUX[n]);
+                }
+                fprintf(erreurs, "\n");
+            }
+            else
+            {
+                fprintf(erreurs, "%s:%d : %s doit être un entier de %ld à %ld\n", chemin, numero, nom,
+                        CLES[k].minimum, CLES[k].maximum);
+            }
+            valide = false;
+        }
+    }
+    fclose(fichier);
+
+    if (valide && !validerRegles(regles, &erreur))
+    {
+        fprintf(erreurs, "%s : %s\n", chemin, erreur);
+        valide = false;
+    }
+    return valide;
+}
+
+/**
+ * @brief Lit le fichier de règles et publie ses règles.
+ *
+ * Sans fichier, les règles par défaut restent en place, sauf si le fichier
+ * a été demandé explicitement ($SNAKE_REGLES).
+ *
+ * @param chemin Le fichier (voir cheminRegles()).
+ * @return false si le fichier est invalide, ou absent alors qu'il a été demandé.
+ */
+bool chargerRegles(const char *chemin)
+{
+    Regles regles;
+
+    if (access(chemin, F_OK) != 0 && errno == ENOENT && getenv("SNAKE_REGLES") == NULL)
+    {
+        return true;
+    }
+    if (!lireRegles(chemin, &regles, stderr))
+    {
+        return false;
+    }
+    publierRegles(&regles);
+    return true;
+}
+
+/**
+ * @brief Surveille le fichier de règles et publie ses règles à chaque modification.
+ *
+ * Les erreurs d'une relecture sont écrites dans le flux donné : un jeu qui
+ * occupe le terminal passe un fichier qu'il affiche une fois le terminal rendu.
+ *
+ * @param chemin Le fichier (il peut ne pas encore exister).
+ * @param erreurs Flux qui reçoit les erreurs de relecture.
+ * @return false si la surveillance ne peut pas être mise en place.
+ */
+bool surveillerRegles(const char *chemin, FILE *erreurs)
+{
+    char *separateur;
+    sigset_t signaux, anciens;
+    int surveille;
+
+    chemin_surveille = malloc(strlen(chemin) + 3);
+    if (chemin_surveille == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    // Dossier surveillé, puis nom du fichier (chemin_surveille reste le chemin complet)
+    strcpy(chemin_surveille, chemin);
+    erreurs_surveillance = erreurs;
+    separateur = strrchr(chemin_surveille, '/');
+    nom_surveille = (separateur != NULL) ? separateur + 1 : chemin_surveille;
+
+    notification = inotify_init1(IN_CLOEXEC);
+    if (notification < 0)
+    {
+        perror("inotify");
+        free(chemin_surveille);
+        return false;
+    }
+    if (separateur == NULL)
+    {
+        surveille = inotify_add_watch(notification, ".", IN_CLOSE_WRITE | IN_MOVED_TO);
+    }
+    else
+    {
+        *separateur = '\0';
+        surveille = inotify_add_watch(notification, separateur == chemin_surveille ? "/" : chemin_surveille,
+                                      IN_CLOSE_WRITE | IN_MOVED_TO);
+        *separateur = '/';
+    }
+    if (surveille < 0 || pipe(reveil) != 0)
+    {
+        perror(chemin);
+        close(notification);
+        free(chemin_surveille);
+        return false;
+    }
+
+    // Les signaux restent au thread principal : le thread de surveillance les bloque dès sa création
+    sigfillset(&signaux);
+    pthread_sigmask(SIG_BLOCK, &signaux, &anciens);
+    surveillance_active = pthread_create(&thread_surveillance, NULL, surveiller, NULL) == 0;
+    pthread_sigmask(SIG_SETMASK, &anciens, NULL);
+    return surveillance_active;
+}
+
+/**
+ * @brief Arrête la surveillance du fichier de règles.
+ */
+void arreterSurveillance(void)
+{
+    if (!surveillance_active)
+    {
+        return;
+    }
+    if (write(reveil[1], "", 1) != 1)
+    {
+        perror("write");
+    }
+    pthread_join(thread_surveillance, NULL);
+    surveillance_active = false;
+    close(notification);
+    close(reveil[0]);
+    close(reveil[1]);
+    free(chemin_surveille);
+    chemin_surveille = NULL;
+}
+
+/**
+ * @brief Fichier de règles à utiliser : $SNAKE_REGLES ou FICHIER_REGLES.
+ *
+ * @return Le chemin du fichier.
+ */
+const char *cheminRegles(void)
+{
+    const char *chemin = getenv("SNAKE_REGLES");
+
+    return (chemin != NULL && chemin[0] != '\0') ? chemin : FICHIER_REGLES;
+}
+
+/**
+ * @brief Lit la valeur d'une clé dans les règles.
+ *
+ * @param cle La clé.
+ * @param valeur Texte de la valeur (sans espaces autour).
+ * @param regles Règles à compléter.
+ * @return false si la valeur est invalide.
+ */
+static bool lireValeur(const Cle *cle, const char *valeur, Regles *regles)
+{
+    char *champ = (char *)regles + cle->position;
+    char *fin;
+    long entier;
+
+    if (cle->forme == VALEUR_TOUCHE)
+    {
+        if (valeur[0] == '\0' || valeur[1] != '\0' || !isgraph((unsigned char)valeur[0]))
+        {
+            return false;
+        }
+        *champ = valeur[0];
+        return true;
+    }
+
+    if (cle->forme == VALEUR_NOM)
+    {
+        for (entier = cle->minimum; entier <= cle->maximum && strcmp(NOMS_NIVEAUX[entier], valeur) != 0; entier++)
+        {
+        }
+    }
+    else
+    {
+        errno = 0;
+        entier = strtol(valeur, &fin, 10);
+        if (errno != 0 || fin == valeur || *fin != '\0')
+        {
+            return false;
+        }
+    }
+    if (entier < cle->minimum || entier > cle->maximum)
+    {
+        return false;
+    }
+    if (cle->taille == sizeof(int8_t))
+    {
+        *champ = (char)entier;
+    }
+    else if (cle->taille == sizeof(int16_t))
+    {
+        int16_t court = (int16_t)entier;
+        memcpy(champ, &court, sizeof(court));
+    }
+    else
+    {
+        int32_t mot = (int32_t)entier;
+        memcpy(champ, &mot, sizeof(mot));
+    }
+    return true;
+}
+
+/**
+ * @brief Vérifie que des règles permettent de jouer.
+ *
+ * @param regles Les règles (chaque valeur est déjà dans ses bornes).
+ * @param erreur Reçoit la cause d'un refus.
+ * @return false si les règles sont refusées.
+ */
+static bool validerRegles(const Regles *regles, const char **erreur)
+{
+    const char touches[] = {regles->touche_haut, regles->touche_bas, regles->touche_gauche,
+                            regles->touche_droite, regles->touche_arret};
+    int taille = regles->taille_pave;
+    int depart_x = regles->largeur / 2;
+    int depart_y = regles->hauteur / 2;
+    int fin_x, fin_y, zone_x, zone_y;
+    long positions;
+
+    for (size_t i = 0; i < sizeof(touches); i++)
+    {
+        for (size_t j = i + 1; j < sizeof(touches); j++)
+        {
+            if (touches[i] == touches[j])
+            {
+                *erreur = "deux commandes utilisent la même touche";
+                return false;
+            }
+        }
+    }
+    if ((long)regles->vitesse_jeu - (long)(regles->objectif_pommes - 1) * regles->acceleration < VITESSE_MIN)
+    {
+        *erreur = "l'accélération rendrait la vitesse nulle avant l'objectif";
+        return false;
+    }
+    // Les objets sont tirés au hasard parmi les cases vides : il doit en rester beaucoup
+    if (4L * (regles->pommes + regles->bonus) > (long)(regles->largeur - 2) * (regles->hauteur - 2))
+    {
+        *erreur = "trop de pommes et de bonus pour la taille du plateau";
+        return false;
+    }
+    // Les pavés ne sont placés que sur le niveau d'origine
+    if (regles->niveau != NIVEAU_PAVES || regles->nombre_paves == 0)
+    {
+        return true;
+    }
+    if (regles->largeur - 2 * taille - 2 <= 0 || regles->hauteur - 2 * taille - 2 <= 0)
+    {
+        *erreur = "plateau trop petit pour les pavés";
+        return false;
+    }
+
+    // Coins de pavé possibles (voir placerPaves()), moins ceux de la zone de départ :
+    // chaque pavé en recouvre au plus taille × taille, il en reste toujours un
+    fin_x = regles->largeur - 2 * taille - 1;
+    fin_y = regles->hauteur - 2 * taille - 1;
+    zone_x = ((depart_x + ZONE_DEPART < fin_x) ? depart_x + ZONE_DEPART : fin_x) -
+             ((depart_x - ZONE_DEPART > 2) ? depart_x - ZONE_DEPART : 2) + 1;
+    zone_y = ((depart_y + ZONE_DEPART < fin_y) ? depart_y + ZONE_DEPART : fin_y) -
+             ((depart_y - ZONE_DEPART > 2) ? depart_y - ZONE_DEPART : 2) + 1;
+    positions = (long)(fin_x - 1) * (fin_y - 1);
+    if (zone_x > 0 && zone_y > 0)
+    {
+        positions -= (long)zone_x * zone_y;
+    }
+    if (positions <= (long)regles->nombre_paves * taille * taille)
+    {
+        *erreur = "trop de pavés pour la place disponible hors de la zone de départ";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Boucle du thread de surveillance.
+ *
+ * @param argument Inutilisé.
+ * @return NULL.
+ */
+static void *surveiller(void *argument)
+{
+    _Alignas(struct inotify_event) char evenements[TAILLE_EVENEMENTS];
+    struct pollfd attentes[2] = {{reveil[0], POLLIN, 0}, {notification, POLLIN, 0}};
+
+    (void)argument;
+    while (poll(attentes, 2, -1) >= 0 || errno == EINTR)
+    {
+        ssize_t lus;
+        bool modifie = false;
+        Regles regles;
+
+        if (attentes[0].revents & POLLIN)
+        {
+            break;
+        }
+        if (!(attentes[1].revents & POLLIN))
+        {
+            continue;
+        }
+        lus = read(notification, evenements, sizeof(evenements));
+        for (ssize_t i = 0; i < lus; )
+        {
+            const struct inotify_event *evenement = (const struct inotify_event *)(evenements + i);
+
+            if (evenement->len > 0 && strcmp(evenement->name, nom_surveille) == 0)
+            {
+                modifie = true;
+            }
+            i += (ssize_t)(sizeof(struct inotify_event) + evenement->len);
+        }
+        // Plusieurs événements pour le même fichier : une seule relecture
+        if (modifie && lireRegles(chemin_surveille, &regles, erreurs_surveillance))
+        {
+            publierRegles(&regles);
+        }
+        fflush(erreurs_surveillance);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Retire les espaces au début et à la fin d'un texte.
+ *
+ * @param texte Le texte (modifié).
+ * @return Le début du texte sans espaces.
+ */
+static char *nettoyer(char *texte)
+{
+    char *fin;
+
+    while (isspace((unsigned char)*texte))
+    {
+        texte++;
+    }
+    fin = texte + strlen(texte);
+    while (fin > texte && isspace((unsigned char)fin[-1]))
+    {
+        fin--;
+    }
+    *fin = '\0';
+    return texte;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file regles.h
+ * @brief Fichier de règles du jeu, relu automatiquement quand il change.
+ *
+ * Le fichier contient des lignes « clé = valeur » (un « # » commence un
+ * commentaire) ; une clé absente garde sa valeur par défaut (constantes de
+ * jeu.h). Clés : vitesse_jeu, acceleration, objectif_pommes, largeur,
+ * hauteur, nombre_paves, taille_pave, periode_paves (0 : pavés fixes, voir
+ * obstacles.h), pommes, bonus, duree_bonus (voir objets.h), niveau (paves,
+ * labyrinthe, salles ou grottes, voir niveaux.h), densite, touche_haut,
+ * touche_bas, touche_gauche, touche_droite, touche_arret.
+ *
+ * Le fichier est surveillé avec inotify : à chaque modification, il est relu
+ * et, s'il est valide, ses règles sont publiées (voir publierRegles()). Les
+ * parties en cours les prennent entre deux tours ; un fichier invalide est
+ * signalé et les règles précédentes restent en place.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef REGLES_H
+#define REGLES_H
+
+#include <stdio.h>
+#include <stdbool.h>
+
+#include "jeu.h"
+
+/* Déclaration des fonctions */
+bool lireRegles(const char *chemin, Regles *regles, FILE *erreurs);
+bool chargerRegles(const char *chemin);
+bool surveillerRegles(const char *chemin, FILE *erreurs);
+void arreterSurveillance(void);
+const char *cheminRegles(void);
+
+#endif
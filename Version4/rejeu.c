@@ -0,0 +1,1024 @@
+/**
+ * @file rejeu.c
+ * @brief Fichiers de rejeu : événements compressés, images clés et index.
+ *
+ * @details
+ * Organisation d'un fichier (entiers variables LEB128, sauf mention contraire) :
+ * - En-tête : REJEU_SIGNATURE, graine, largeur, hauteur, intervalle des
+ *   images clés, objectif de pommes, règles de la partie (les champs de
+ *   Regles dans leur ordre de déclaration).
+ * - Suite d'enregistrements, chacun commençant par un entier v :
+ *   - v pair : changement de direction, (tours depuis l'événement ou
+ *     l'image clé précédente) << 3 | code de la direction << 1 ;
+ *   - v = 1 : image clé (état avant le tour indiqué) : tour, 1 si les
+ *     règles viennent d'être appliquées (appliquerRegles()) sinon 0, règles
+ *     en vigueur, objectif de pommes, empreinte (8 octets), direction,
+ *     vitesse, pommes, générateur (4 octets), pomme,
+ *     plateau en plages (longueur, caractère), puis le serpent : taille,
+ *     tête, et pour chaque segment suivant la direction qui y mène depuis le
+ *     précédent (4 : même case), deux segments par octet ; enfin, si les
+ *     pavés sont mobiles, leur nombre et pour chacun son coin et le code de
+ *     sa direction ; si la partie a plus d'une pomme ou des bonus, le nombre
+ *     d'objets puis chaque pomme (case, type) et chaque bonus (case, type,
+ *     tours restants) dans l'ordre de leur disparition ;
+ *   - v = 3 : fin des enregistrements.
+ * - Une image clé est aussi écrite dès que la partie change de règles
+ *   (fichier rechargé) : le rejeu les applique au même tour que la partie
+ *   enregistrée et n'utilise jamais le fichier de règles courant.
+ * - Index : nombre d'images clés, puis pour chacune l'écart de tour et de
+ *   position avec la précédente, nombre de tours, issue.
+ * - Pied fixe : position de l'index (8 octets) et REJEU_FIN.
+ *
+ * Les entiers de taille fixe sont écrits octet par octet, poids faible en
+ * premier : un fichier se relit sur n'importe quelle machine.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rejeu.h"
+
+#define REJEU_SIGNATURE "SNKREJ04"      /**< Début d'un fichier de rejeu. */
+#define REJEU_FIN "SNKFIN01"            /**< Fin d'un fichier de rejeu. */
+#define TAILLE_PIED 16                  /**< Taille du pied : position de l'index et REJEU_FIN. */
+#define ENREGISTREMENT_IMAGE_CLE 1      /**< Premier entier d'une image clé. */
+#define ENREGISTREMENT_FIN 3            /**< Premier entier de la fin des enregistrements. */
+#define SEGMENT_SUPERPOSE 4             /**< Code d'un segment sur la même case que le précédent. */
+#define CHAMPS_REGLES 18                /**< Nombre de champs de Regles enregistrés. */
+
+/** Les quatre directions, dans l'ordre de leur code. */
+static const char DIRECTIONS[4] = {HAUT, DROITE, BAS, GAUCHE};
+
+/** Déplacements (dx, dy) des quatre directions, dans l'ordre de leur code. */
+static const int DEPLACEMENTS[4][2] = {{0, -1}, {1, 0}, {0, 1}, {-1, 0}};
+
+/** @brief Nature du prochain enregistrement lu. */
+enum
+{
+    PROCHAIN_EVENEMENT,
+    PROCHAIN_IMAGE_CLE,
+    PROCHAIN_FIN
+};
+
+static void ecrireEntier(FILE *fichier, uint64_t valeur);
+static bool lireEntier(FILE *fichier, uint64_t *valeur);
+static void ecrireFixe(FILE *fichier, uint64_t valeur, int octets);
+static bool lireFixe(FILE *fichier, uint64_t *valeur, int octets);
+static int codeDirection(char direction);
+static void ajouterAIndex(IndexRejeu *index, long tour, off_t position);
+static void ecrireImageCle(Enregistreur *enregistreur, const Partie *partie);
+static bool lireImageCle(Rejeu *rejeu, Partie *partie, bool restaurer);
+static bool lirePaves(Rejeu *rejeu, Partie *partie, bool restaurer);
+static void ecrireObjets(FILE *fichier, const Partie *partie);
+static bool lireObjets(Rejeu *rejeu, Partie *partie, bool restaurer);
+static bool lireSuivant(Rejeu *rejeu);
+static void valeursRegles(const Regles *regles, int64_t valeurs[CHAMPS_REGLES]);
+static void ecrireRegles(FILE *fichier, const Regles *regles);
+static bool lireReglesEnregistrees(FILE *fichier, Regles *regles);
+static bool memesRegles(const Regles *premieres, const Regles *secondes);
+
+/**
+ * @brief Commence l'enregistrement d'une partie.
+ *
+ * @param enregistreur Enregistreur à préparer.
+ * @param chemin Fichier à créer (remplacé s'il existe).
+ * @param partie La partie, telle que créée par creerPartie().
+ * @param graine Graine passée à creerPartie().
+ * @param intervalle Tours entre deux images clés (INTERVALLE_IMAGES_CLES si nul ou négatif).
+ * @return false si le fichier ne peut pas être créé.
+ */
+bool ouvrirEnregistrement(Enregistreur *enregistreur, const char *chemin,
+                          const Partie *partie, uint32_t graine, int intervalle)
+{
+    enregistreur->fichier = fopen(chemin, "wb");
+    if (enregistreur->fichier == NULL)
+    {
+        perror(chemin);
+        return false;
+    }
+    enregistreur->intervalle = (intervalle > 0) ? intervalle : INTERVALLE_IMAGES_CLES;
+    enregistreur->base = partie->tour;
+    enregistreur->direction = partie->direction;
+    enregistreur->regles = partie->regles;
+    memset(&enregistreur->index, 0, sizeof(IndexRejeu));
+
+    fwrite(REJEU_SIGNATURE, 1, strlen(REJEU_SIGNATURE), enregistreur->fichier);
+    ecrireEntier(enregistreur->fichier, graine);
+    ecrireEntier(enregistreur->fichier, (uint64_t)partie->largeur);
+    ecrireEntier(enregistreur->fichier, (uint64_t)partie->hauteur);
+    ecrireEntier(enregistreur->fichier, (uint64_t)enregistreur->intervalle);
+    ecrireEntier(enregistreur->fichier, (uint64_t)partie->objectif_pommes);
+    ecrireRegles(enregistreur->fichier, partie->regles);
+    return true;
+}
+
+/**
+ * @brief Enregistre la direction jouée à ce tour.
+ *
+ * À appeler avant jouerTour(), avec la direction qui lui sera passée. Une
+ * image clé est écrite au premier tour enregistré, tous les « intervalle »
+ * tours et quand les règles de la partie ont changé (appliquerRegles()) ; un
+ * événement n'est écrit que si la direction change.
+ *
+ * @param enregistreur L'enregistreur.
+ * @param partie La partie, avant le tour.
+ * @param direction Direction jouée.
+ * @return false après une erreur d'écriture.
+ */
+bool enregistrerTour(Enregistreur *enregistreur, const Partie *partie, char direction)
+{
+    if (enregistreur->index.nombre == 0 || partie->tour % enregistreur->intervalle == 0 ||
+        partie->regles != enregistreur->regles)
+    {
+        ecrireImageCle(enregistreur, partie);
+    }
+    if (direction != enregistreur->direction)
+    {
+        uint64_t ecart = (uint64_t)(partie->tour - enregistreur->base);
+
+        ecrireEntier(enregistreur->fichier, (ecart << 3) | ((uint64_t)codeDirection(direction) << 1));
+        enregistreur->base = partie->tour;
+        enregistreur->direction = direction;
+    }
+    return !ferror(enregistreur->fichier);
+}
+
+/**
+ * @brief Termine l'enregistrement : fin des événements, index et pied.
+ *
+ * @param enregistreur L'enregistreur (libéré).
+ * @param partie La partie, après son dernier tour.
+ * @param issue Issue du dernier tour.
+ * @return false si le fichier n'a pas pu être écrit entièrement.
+ */
+bool fermerEnregistrement(Enregistreur *enregistreur, const Partie *partie, Issue issue)
+{
+    FILE *fichier = enregistreur->fichier;
+    IndexRejeu *index = &enregistreur->index;
+    off_t position_index;
+    bool ecrit;
+
+    if (index->nombre == 0)
+    {
+        ecrireImageCle(enregistreur, partie);
+    }
+    ecrireEntier(fichier, ENREGISTREMENT_FIN);
+    position_index = ftello(fichier);
+    ecrireEntier(fichier, (uint64_t)index->nombre);
+    for (int i = 0; i < index->nombre; i++)
+    {
+        ecrireEntier(fichier, (uint64_t)(index->tours[i] - (i > 0 ? index->tours[i - 1] : 0)));
+        ecrireEntier(fichier, (uint64_t)(index->positions[i] - (i > 0 ? index->positions[i - 1] : 0)));
+    }
+    ecrireEntier(fichier, (uint64_t)partie->tour);
+    ecrireEntier(fichier, (uint64_t)issue);
+    ecrireFixe(fichier, (uint64_t)position_index, 8);
+    fwrite(REJEU_FIN, 1, strlen(REJEU_FIN), fichier);
+
+    ecrit = !ferror(fichier);
+    ecrit = (fclose(fichier) == 0) && ecrit;
+    free(index->tours);
+    free(index->positions);
+    memset(index, 0, sizeof(IndexRejeu));
+    return ecrit;
+}
+
+/**
+ * @brief Ouvre un fichier de rejeu et lit son index.
+ *
+ * @param rejeu Rejeu à préparer.
+ * @param chemin Fichier de rejeu.
+ * @return false si le fichier est illisible ou incomplet.
+ */
+bool ouvrirRejeu(Rejeu *rejeu, const char *chemin)
+{
+    char signature[8];
+    uint64_t valeurs[5], position_index, nombre, tour = 0, position = 0, issue;
+
+    memset(rejeu, 0, sizeof(Rejeu));
+    rejeu->fichier = fopen(chemin, "rb");
+    if (rejeu->fichier == NULL)
+    {
+        perror(chemin);
+        return false;
+    }
+
+    if (fread(signature, 1, sizeof(signature), rejeu->fichier) != sizeof(signature) ||
+        memcmp(signature, REJEU_SIGNATURE, sizeof(signature)) != 0)
+    {
+        fprintf(stderr, "%s : ce n'est pas un fichier de rejeu\n", chemin);
+        fermerRejeu(rejeu);
+        return false;
+    }
+    for (int i = 0; i < 5; i++)
+    {
+        if (!lireEntier(rejeu->fichier, &valeurs[i]))
+        {
+            fprintf(stderr, "%s : en-tête tronqué\n", chemin);
+            fermerRejeu(rejeu);
+            return false;
+        }
+    }
+    rejeu->graine = (uint32_t)valeurs[0];
+    rejeu->largeur = (int)valeurs[1];
+    rejeu->hauteur = (int)valeurs[2];
+    rejeu->intervalle = (int)valeurs[3];
+    rejeu->objectif_pommes = (int)valeurs[4];
+    if (!lireReglesEnregistrees(rejeu->fichier, &rejeu->regles))
+    {
+        fprintf(stderr, "%s : en-tête tronqué\n", chemin);
+        fermerRejeu(rejeu);
+        return false;
+    }
+
+    // Le pied donne la position de l'index
+    if (fseeko(rejeu->fichier, -TAILLE_PIED, SEEK_END) != 0 ||
+        !lireFixe(rejeu->fichier, &position_index, 8) ||
+        fread(signature, 1, sizeof(signature), rejeu->fichier) != sizeof(signature) ||
+        memcmp(signature, REJEU_FIN, sizeof(signature)) != 0 ||
+        fseeko(rejeu->fichier, (off_t)position_index, SEEK_SET) != 0 ||
+        !lireEntier(rejeu->fichier, &nombre))
+    {
+        fprintf(stderr, "%s : enregistrement incomplet (pas d'index)\n", chemin);
+        fermerRejeu(rejeu);
+        return false;
+    }
+    for (uint64_t i = 0; i < nombre; i++)
+    {
+        uint64_t ecart_tour, ecart_position;
+
+        if (!lireEntier(rejeu->fichier, &ecart_tour) || !lireEntier(rejeu->fichier, &ecart_position))
+        {
+            fprintf(stderr, "%s : index tronqué\n", chemin);
+            fermerRejeu(rejeu);
+            return false;
+        }
+        tour += ecart_tour;
+        position += ecart_position;
+        ajouterAIndex(&rejeu->index, (long)tour, (off_t)position);
+    }
+    if (rejeu->index.nombre == 0 ||
+        !lireEntier(rejeu->fichier, &tour) || !lireEntier(rejeu->fichier, &issue))
+    {
+        fprintf(stderr, "%s : index tronqué\n", chemin);
+        fermerRejeu(rejeu);
+        return false;
+    }
+    rejeu->tours = (long)tour;
+    rejeu->issue = (Issue)issue;
+    rejeu->conforme = true;
+    return true;
+}
+
+/**
+ * @brief Place la partie au tour demandé.
+ *
+ * Charge l'image clé qui précède le tour, puis rejoue les tours suivants.
+ *
+ * @param rejeu Le rejeu.
+ * @param partie Partie créée par creerPartie() avec rejeu->graine et rejeu->regles.
+ * @param tour Tour voulu (entre le tour de la première image clé et rejeu->tours).
+ * @return false si le tour est hors de l'enregistrement ou si le fichier est illisible.
+ */
+bool allerAuTour(Rejeu *rejeu, Partie *partie, long tour)
+{
+    const IndexRejeu *index = &rejeu->index;
+    int debut = 0, fin = index->nombre - 1;
+    uint64_t nature;
+    Issue issue;
+
+    if (tour < index->tours[0] || tour > rejeu->tours)
+    {
+        return false;
+    }
+    // Dernière image clé au plus tard au tour voulu
+    while (debut < fin)
+    {
+        int milieu = (debut + fin + 1) / 2;
+
+        if (index->tours[milieu] <= tour)
+        {
+            debut = milieu;
+        }
+        else
+        {
+            fin = milieu - 1;
+        }
+    }
+
+    if (fseeko(rejeu->fichier, index->positions[debut], SEEK_SET) != 0 ||
+        !lireEntier(rejeu->fichier, &nature) || nature != ENREGISTREMENT_IMAGE_CLE ||
+        !lireImageCle(rejeu, partie, true) || !lireSuivant(rejeu))
+    {
+        return false;
+    }
+    while (partie->tour < tour)
+    {
+        if (!rejouerTour(rejeu, partie, &issue))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Rejoue le tour suivant de la partie.
+ *
+ * Une image clé rencontrée en chemin est comparée à la partie rejouée
+ * (voir rejeu->conforme).
+ *
+ * @param rejeu Le rejeu, placé par allerAuTour().
+ * @param partie La partie.
+ * @param issue Reçoit l'issue du tour.
+ * @return false à la fin de l'enregistrement ou si le fichier est illisible.
+ */
+bool rejouerTour(Rejeu *rejeu, Partie *partie, Issue *issue)
+{
+    bool pomme_mangee;
+
+    while (rejeu->prochain != PROCHAIN_FIN && rejeu->tour_prochain <= partie->tour)
+    {
+        if (rejeu->prochain == PROCHAIN_IMAGE_CLE)
+        {
+            if (!lireImageCle(rejeu, partie, false))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            rejeu->direction = rejeu->direction_prochaine;
+        }
+        if (!lireSuivant(rejeu))
+        {
+            return false;
+        }
+    }
+    if (partie->tour >= rejeu->tours)
+    {
+        return false;
+    }
+    *issue = jouerTour(partie, rejeu->direction, &pomme_mangee);
+    return true;
+}
+
+/**
+ * @brief Ferme le fichier de rejeu et libère son index.
+ *
+ * @param rejeu Le rejeu.
+ */
+void fermerRejeu(Rejeu *rejeu)
+{
+    if (rejeu->fichier != NULL)
+    {
+        fclose(rejeu->fichier);
+        rejeu->fichier = NULL;
+    }
+    free(rejeu->index.tours);
+    free(rejeu->index.positions);
+    memset(&rejeu->index, 0, sizeof(IndexRejeu));
+}
+
+/**
+ * @brief Écrit un entier variable (7 bits par octet, poids faible en premier).
+ *
+ * @param fichier Le fichier.
+ * @param valeur L'entier.
+ */
+static void ecrireEntier(FILE *fichier, uint64_t valeur)
+{
+    while (valeur >= 0x80)
+    {
+        putc((int)(valeur & 0x7F) | 0x80, fichier);
+        valeur >>= 7;
+    }
+    putc((int)valeur, fichier);
+}
+
+/**
+ * @brief Lit un entier variable.
+ *
+ * @param fichier Le fichier.
+ * @param valeur Reçoit l'entier.
+ * @return false en fin de fichier ou si l'entier est trop long.
+ */
+static bool lireEntier(FILE *fichier, uint64_t *valeur)
+{
+    int octet;
+
+    *valeur = 0;
+    for (int decalage = 0; decalage < 64; decalage += 7)
+    {
+        if ((octet = getc(fichier)) == EOF)
+        {
+            return false;
+        }
+        *valeur |= (uint64_t)(octet & 0x7F) << decalage;
+        if ((octet & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Écrit un entier de taille fixe, poids faible en premier.
+ *
+ * @param fichier Le fichier.
+ * @param valeur L'entier.
+ * @param octets Nombre d'octets.
+ */
+static void ecrireFixe(FILE *fichier, uint64_t valeur, int octets)
+{
+    for (int i = 0; i < octets; i++)
+    {
+        putc((int)((valeur >> (8 * i)) & 0xFF), fichier);
+    }
+}
+
+/**
+ * @brief Lit un entier de taille fixe.
+ *
+ * @param fichier Le fichier.
+ * @param valeur Reçoit l'entier.
+ * @param octets Nombre d'octets.
+ * @return false en fin de fichier.
+ */
+static bool lireFixe(FILE *fichier, uint64_t *valeur, int octets)
+{
+    *valeur = 0;
+    for (int i = 0; i < octets; i++)
+    {
+        int octet = getc(fichier);
+
+        if (octet == EOF)
+        {
+            return false;
+        }
+        *valeur |= (uint64_t)octet << (8 * i);
+    }
+    return true;
+}
+
+/**
+ * @brief Code d'une direction (indice dans DIRECTIONS).
+ *
+ * @param direction La direction.
+ * @return Son code (0 pour une touche inconnue).
+ */
+static int codeDirection(char direction)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        if (DIRECTIONS[i] == direction)
+        {
+            return i;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Ajoute une image clé à la table.
+ *
+ * @param index La table.
+ * @param tour Tour de l'image clé.
+ * @param position Position de l'image clé dans le fichier.
+ */
+static void ajouterAIndex(IndexRejeu *index, long tour, off_t position)
+{
+    if (index->nombre == index->capacite)
+    {
+        index->capacite = (index->capacite > 0) ? 2 * index->capacite : 64;
+        index->tours = realloc(index->tours, index->capacite * sizeof(long));
+        index->positions = realloc(index->positions, index->capacite * sizeof(off_t));
+        if (index->tours == NULL || index->positions == NULL)
+        {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    index->tours[index->nombre] = tour;
+    index->positions[index->nombre] = position;
+    index->nombre++;
+}
+
+/**
+ * @brief Écrit une image clé : l'état complet de la partie avant ce tour.
+ *
+ * @param enregistreur L'enregistreur.
+ * @param partie La partie.
+ */
+static void ecrireImageCle(Enregistreur *enregistreur, const Partie *partie)
+{
+    FILE *fichier = enregistreur->fichier;
+    size_t cases = (size_t)partie->largeur * partie->hauteur;
+    Parcours parcours;
+    Segment segment, precedent;
+    int codes = 0, nombre_codes = 0;
+
+    ajouterAIndex(&enregistreur->index, partie->tour, ftello(fichier));
+    ecrireEntier(fichier, ENREGISTREMENT_IMAGE_CLE);
+    ecrireEntier(fichier, (uint64_t)partie->tour);
+    ecrireEntier(fichier, partie->regles != enregistreur->regles);
+    ecrireRegles(fichier, partie->regles);
+    ecrireEntier(fichier, (uint64_t)partie->objectif_pommes);
+    ecrireFixe(fichier, partie->empreinte, 8);
+    ecrireEntier(fichier, (uint64_t)codeDirection(partie->direction));
+    // Jamais sous VITESSE_MIN (voir changerVitesse()) : un entier sans signe suffit
+    ecrireEntier(fichier, (uint64_t)partie->vitesse_actuelle);
+    ecrireEntier(fichier, (uint64_t)partie->pommes_mangees);
+    ecrireFixe(fichier, partie->aleatoire, 4);
+    ecrireEntier(fichier, (uint64_t)partie->pomme.x);
+    ecrireEntier(fichier, (uint64_t)partie->pomme.y);
+
+    for (size_t i = 0; i < cases; )
+    {
+        size_t longueur = 1;
+
+        while (i + longueur < cases && partie->plateau[i + longueur] == partie->plateau[i])
+        {
+            longueur++;
+        }
+        ecrireEntier(fichier, longueur);
+        putc((unsigned char)partie->plateau[i], fichier);
+        i += longueur;
+    }
+
+    ecrireEntier(fichier, (uint64_t)partie->serpent.taille);
+    debutParcours(&partie->serpent, &parcours);
+    segmentSuivant(&parcours, &precedent);
+    ecrireEntier(fichier, (uint64_t)precedent.x);
+    ecrireEntier(fichier, (uint64_t)precedent.y);
+    while (segmentSuivant(&parcours, &segment))
+    {
+        int code = SEGMENT_SUPERPOSE;
+
+        for (int d = 0; d < 4 && code == SEGMENT_SUPERPOSE; d++)
+        {
+            Segment voisine = caseSuivante(partie, precedent, DIRECTIONS[d]);
+
+            if (voisine.x == segment.x && voisine.y == segment.y)
+            {
+                code = d;
+            }
+        }
+        codes |= code << (4 * nombre_codes);
+        if (++nombre_codes == 2)
+        {
+            putc(codes, fichier);
+            codes = nombre_codes = 0;
+        }
+        precedent = segment;
+    }
+    if (nombre_codes > 0)
+    {
+        putc(codes, fichier);
+    }
+
+    if (partie->obstacles.periode > 0)
+    {
+        ecrireEntier(fichier, (uint64_t)partie->obstacles.nombre);
+        for (int i = 0; i < partie->obstacles.nombre; i++)
+        {
+            const Obstacle *pave = &partie->obstacles.obstacles[i];
+            int code = 0;
+
+            while (DEPLACEMENTS[code][0] != pave->dx || DEPLACEMENTS[code][1] != pave->dy)
+            {
+                code++;
+            }
+            ecrireEntier(fichier, (uint64_t)pave->x);
+            ecrireEntier(fichier, (uint64_t)pave->y);
+            ecrireEntier(fichier, (uint64_t)code);
+        }
+    }
+    if (partie->objets.capacite > 1)
+    {
+        ecrireObjets(fichier, partie);
+    }
+
+    enregistreur->base = partie->tour;
+    enregistreur->direction = partie->direction;
+    enregistreur->regles = partie->regles;
+}
+
+/**
+ * @brief Lit la suite d'une image clé (après son tour, déjà lu par lireSuivant()).
+ *
+ * @param rejeu Le rejeu.
+ * @param partie La partie.
+ * @param restaurer true pour remplacer l'état de la partie, false pour seulement
+ *                  comparer son empreinte (rejeu->conforme).
+ * @return false si le fichier est illisible.
+ */
+static bool lireImageCle(Rejeu *rejeu, Partie *partie, bool restaurer)
+{
+    FILE *fichier = rejeu->fichier;
+    size_t cases = (size_t)partie->largeur * partie->hauteur;
+    uint64_t tour, appliquees, objectif, empreinte, direction, vitesse, pommes, aleatoire, x, y, taille;
+    Regles regles;
+    Segment segment;
+    int codes = 0;
+
+    if (restaurer)
+    {
+        if (!lireEntier(fichier, &tour))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        tour = (uint64_t)rejeu->tour_prochain;
+    }
+    if (!lireEntier(fichier, &appliquees) || !lireReglesEnregistrees(fichier, &regles) ||
+        !lireEntier(fichier, &objectif))
+    {
+        return false;
+    }
+    // Règles appliquées à ce tour dans la partie enregistrée (même identiques,
+    // appliquerRegles() recalcule la vitesse), ou différentes de celles de la
+    // partie rejouée après un saut : publiées puis appliquées
+    if (appliquees != 0 || !memesRegles(&regles, partie->regles))
+    {
+        appliquerRegles(partie, publierRegles(&regles));
+    }
+    if (!lireFixe(fichier, &empreinte, 8) || !lireEntier(fichier, &direction) ||
+        !lireEntier(fichier, &vitesse) || !lireEntier(fichier, &pommes) ||
+        !lireFixe(fichier, &aleatoire, 4) || !lireEntier(fichier, &x) || !lireEntier(fichier, &y))
+    {
+        return false;
+    }
+    if (!restaurer)
+    {
+        // Le reste de l'image est sauté : plateau, serpent puis pavés mobiles
+        if (empreinte != partie->empreinte || (long)tour != partie->tour ||
+            (int)objectif != partie->objectif_pommes)
+        {
+            rejeu->conforme = false;
+        }
+        for (size_t i = 0; i < cases; )
+        {
+            uint64_t longueur;
+
+            if (!lireEntier(fichier, &longueur) || getc(fichier) == EOF || longueur == 0)
+            {
+                return false;
+            }
+            i += longueur;
+        }
+        if (!lireEntier(fichier, &taille) || !lireEntier(fichier, &x) || !lireEntier(fichier, &y))
+        {
+            return false;
+        }
+        if (fseeko(fichier, (off_t)(taille / 2), SEEK_CUR) != 0)
+        {
+            return false;
+        }
+        return lirePaves(rejeu, partie, false) && lireObjets(rejeu, partie, false);
+    }
+
+    partie->tour = (long)tour;
+    partie->objectif_pommes = (int)objectif;
+    partie->direction = DIRECTIONS[direction & 3];
+    partie->vitesse_actuelle = (int)vitesse;
+    partie->pommes_mangees = (int)pommes;
+    partie->aleatoire = (uint32_t)aleatoire;
+    partie->pomme.x = (int)x;
+    partie->pomme.y = (int)y;
+
+    // Plateau propre à la partie, même s'il était partagé avec une autre
+    partie->plateau = partie->plateau_prive;
+    partie->plateau_partage = false;
+    for (size_t i = 0; i < cases; )
+    {
+        uint64_t longueur;
+        int caractere;
+
+        if (!lireEntier(fichier, &longueur) || (caractere = getc(fichier)) == EOF ||
+            longueur == 0 || longueur > cases - i)
+        {
+            return false;
+        }
+        memset(partie->plateau + i, caractere, longueur);
+        i += longueur;
+    }
+
+    // Serpent reconstruit de la tête vers la queue, occupation recalculée
+    while (partie->serpent.taille > 0)
+    {
+        retirerQueue(&partie->serpent);
+    }
+    memset(partie->occupation, 0, cases);
+    if (!lireEntier(fichier, &taille) || !lireEntier(fichier, &x) || !lireEntier(fichier, &y) ||
+        taille == 0)
+    {
+        return false;
+    }
+    segment.x = (int)x;
+    segment.y = (int)y;
+    ajouterTete(&partie->serpent, segment);
+    OCCUPATION(partie, segment.x, segment.y)++;
+    for (uint64_t i = 1; i < taille; i++)
+    {
+        int code;
+
+        if (i % 2 == 1 && (codes = getc(fichier)) == EOF)
+        {
+            return false;
+        }
+        code = (codes >> (4 * ((i - 1) % 2))) & 0xF;
+        if (code != SEGMENT_SUPERPOSE)
+        {
+            segment = caseSuivante(partie, segment, DIRECTIONS[code & 3]);
+        }
+        ajouterQueue(&partie->serpent, segment);
+        OCCUPATION(partie, segment.x, segment.y)++;
+    }
+    if (!lirePaves(rejeu, partie, true) || !lireObjets(rejeu, partie, true))
+    {
+        return false;
+    }
+
+    partie->empreinte = calculerEmpreinte(partie);
+    if (partie->empreinte != empreinte)
+    {
+        rejeu->conforme = false;
+    }
+    rejeu->base = partie->tour;
+    rejeu->direction = partie->direction;
+    return true;
+}
+
+/**
+ * @brief Lit les pavés mobiles à la fin d'une image clé (rien si les pavés sont fixes).
+ *
+ * @param rejeu Le rejeu.
+ * @param partie La partie.
+ * @param restaurer true pour remplacer les pavés de la partie, false pour les sauter.
+ * @return false si le fichier est illisible.
+ */
+static bool lirePaves(Rejeu *rejeu, Partie *partie, bool restaurer)
+{
+    Obstacles *obstacles = &partie->obstacles;
+    uint64_t nombre, x, y, code;
+
+    if (obstacles->periode == 0)
+    {
+        return true;
+    }
+    if (!lireEntier(rejeu->fichier, &nombre) || nombre > (uint64_t)obstacles->capacite)
+    {
+        return false;
+    }
+    if (restaurer)
+    {
+        viderObstacles(obstacles);
+    }
+    for (uint64_t i = 0; i < nombre; i++)
+    {
+        if (!lireEntier(rejeu->fichier, &x) || !lireEntier(rejeu->fichier, &y) ||
+            !lireEntier(rejeu->fichier, &code) || code > 3)
+        {
+            return false;
+        }
+        if (restaurer)
+        {
+            ajouterObstacle(obstacles, (int)x, (int)y, DEPLACEMENTS[code][0], DEPLACEMENTS[code][1]);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Écrit les objets à la fin d'une image clé.
+ *
+ * Les pommes sont écrites dans l'ordre de la table, les bonus dans l'ordre de
+ * la file de disparition (entrées périmées sautées) : relus dans cet ordre,
+ * ils redonnent une file valable.
+ *
+ * @param fichier Le fichier.
+ * @param partie La partie.
+ */
+static void ecrireObjets(FILE *fichier, const Partie *partie)
+{
+    const Objets *objets = &partie->objets;
+
+    ecrireEntier(fichier, (uint64_t)objets->nombre);
+    for (int i = 0; i < objets->nombre; i++)
+    {
+        if (objets->objets[i].type == OBJET_POMME)
+        {
+            ecrireEntier(fichier, (uint64_t)objets->objets[i].position.x);
+            ecrireEntier(fichier, (uint64_t)objets->objets[i].position.y);
+            ecrireEntier(fichier, OBJET_POMME);
+        }
+    }
+    for (int i = 0; i < objets->longueur_file; i++)
+    {
+        const Objet *entree = &objets->file[(objets->debut_file + i) % objets->capacite_file];
+        int indice = chercherObjet(objets, entree->position);
+
+        if (indice >= 0 && objets->objets[indice].disparition == entree->disparition)
+        {
+            ecrireEntier(fichier, (uint64_t)entree->position.x);
+            ecrireEntier(fichier, (uint64_t)entree->position.y);
+            ecrireEntier(fichier, (uint64_t)objets->objets[indice].type);
+            ecrireEntier(fichier, (uint64_t)(entree->disparition - partie->tour));
+        }
+    }
+}
+
+/**
+ * @brief Lit les objets à la fin d'une image clé (rien pour une seule pomme sans bonus).
+ *
+ * Le plateau, déjà relu, contient les objets : seule leur table est refaite.
+ *
+ * @param rejeu Le rejeu.
+ * @param partie La partie (tour déjà restauré).
+ * @param restaurer true pour remplacer les objets de la partie, false pour les sauter.
+ * @return false si le fichier est illisible.
+ */
+static bool lireObjets(Rejeu *rejeu, Partie *partie, bool restaurer)
+{
+    Objets *objets = &partie->objets;
+    uint64_t nombre, x, y, type, restants = 0;
+
+    if (objets->capacite <= 1)
+    {
+        return true;
+    }
+    if (!lireEntier(rejeu->fichier, &nombre) || nombre > (uint64_t)objets->capacite)
+    {
+        return false;
+    }
+    if (restaurer)
+    {
+        viderObjets(objets);
+    }
+    for (uint64_t i = 0; i < nombre; i++)
+    {
+        if (!lireEntier(rejeu->fichier, &x) || !lireEntier(rejeu->fichier, &y) ||
+            !lireEntier(rejeu->fichier, &type) || type >= NOMBRE_TYPES_OBJETS ||
+            (type != OBJET_POMME && !lireEntier(rejeu->fichier, &restants)))
+        {
+            return false;
+        }
+        if (restaurer)
+        {
+            Segment position = {(int)x, (int)y};
+
+            ajouterObjet(objets, position, (int)type,
+                         (type == OBJET_POMME) ? -1 : partie->tour + (long)restants);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Lit le début de l'enregistrement suivant.
+ *
+ * Un événement est lu entièrement ; pour une image clé, seul son tour est
+ * lu (le reste est lu par lireImageCle()).
+ *
+ * @param rejeu Le rejeu.
+ * @return false si le fichier est illisible.
+ */
+static bool lireSuivant(Rejeu *rejeu)
+{
+    uint64_t valeur, tour;
+
+    if (!lireEntier(rejeu->fichier, &valeur))
+    {
+        return false;
+    }
+    if (valeur == ENREGISTREMENT_FIN)
+    {
+        rejeu->prochain = PROCHAIN_FIN;
+    }
+    else if (valeur == ENREGISTREMENT_IMAGE_CLE)
+    {
+        if (!lireEntier(rejeu->fichier, &tour))
+        {
+            return false;
+        }
+        rejeu->prochain = PROCHAIN_IMAGE_CLE;
+        rejeu->tour_prochain = (long)tour;
+        rejeu->base = (long)tour;
+    }
+    else if ((valeur & 1) == 0)
+    {
+        rejeu->prochain = PROCHAIN_EVENEMENT;
+        rejeu->tour_prochain = rejeu->base + (long)(valeur >> 3);
+        rejeu->direction_prochaine = DIRECTIONS[(valeur >> 1) & 3];
+        rejeu->base = rejeu->tour_prochain;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Valeurs des champs des règles, dans leur ordre de déclaration.
+ *
+ * @param regles Les règles.
+ * @param valeurs Reçoit les CHAMPS_REGLES valeurs.
+ */
+static void valeursRegles(const Regles *regles, int64_t valeurs[CHAMPS_REGLES])
+{
+    const int64_t champs[CHAMPS_REGLES] =
+    {
+        regles->vitesse_jeu, regles->acceleration, regles->objectif_pommes,
+        regles->largeur, regles->hauteur, regles->nombre_paves, regles->taille_pave,
+        regles->periode_paves, regles->pommes, regles->bonus, regles->duree_bonus,
+        regles->niveau, regles->densite, regles->touche_haut, regles->touche_bas,
+        regles->touche_gauche, regles->touche_droite, regles->touche_arret
+    };
+
+    memcpy(valeurs, champs, sizeof(champs));
+}
+
+/**
+ * @brief Écrit les règles, un entier variable par champ (toutes les valeurs sont positives).
+ *
+ * @param fichier Le fichier.
+ * @param regles Les règles.
+ */
+static void ecrireRegles(FILE *fichier, const Regles *regles)
+{
+    int64_t valeurs[CHAMPS_REGLES];
+
+    valeursRegles(regles, valeurs);
+    for (int i = 0; i < CHAMPS_REGLES; i++)
+    {
+        ecrireEntier(fichier, (uint64_t)valeurs[i]);
+    }
+}
+
+/**
+ * @brief Lit des règles écrites par ecrireRegles().
+ *
+ * @param fichier Le fichier.
+ * @param regles Reçoit les règles.
+ * @return false si le fichier est illisible.
+ */
+static bool lireReglesEnregistrees(FILE *fichier, Regles *regles)
+{
+    uint64_t valeurs[CHAMPS_REGLES];
+
+    for (int i = 0; i < CHAMPS_REGLES; i++)
+    {
+        if (!lireEntier(fichier, &valeurs[i]))
+        {
+            return false;
+        }
+    }
+    memset(regles, 0, sizeof(Regles));
+    regles->vitesse_jeu = (int32_t)valeurs[0];
+    regles->acceleration = (int32_t)valeurs[1];
+    regles->objectif_pommes = (int32_t)valeurs[2];
+    regles->largeur = (int16_t)valeurs[3];
+    regles->hauteur = (int16_t)valeurs[4];
+    regles->nombre_paves = (int16_t)valeurs[5];
+    regles->taille_pave = (int16_t)valeurs[6];
+    regles->periode_paves = (int16_t)valeurs[7];
+    regles->pommes = (int16_t)valeurs[8];
+    regles->bonus = (int16_t)valeurs[9];
+    regles->duree_bonus = (int16_t)valeurs[10];
+    regles->niveau = (int8_t)valeurs[11];
+    regles->densite = (int8_t)valeurs[12];
+    regles->touche_haut = (char)valeurs[13];
+    regles->touche_bas = (char)valeurs[14];
+    regles->touche_gauche = (char)valeurs[15];
+    regles->touche_droite = (char)valeurs[16];
+    regles->touche_arret = (char)valeurs[17];
+    return true;
+}
+
+/**
+ * @brief Compare deux jeux de règles champ par champ.
+ *
+ * @param premieres Premières règles.
+ * @param secondes Secondes règles.
+ * @return true si tous les champs sont égaux.
+ */
+static bool memesRegles(const Regles *premieres, const Regles *secondes)
+{
+    int64_t valeurs_premieres[CHAMPS_REGLES], valeurs_secondes[CHAMPS_REGLES];
+
+    valeursRegles(premieres, valeurs_premieres);
+    valeursRegles(secondes, valeurs_secondes);
+    return memcmp(valeurs_premieres, valeurs_secondes, sizeof(valeurs_premieres)) == 0;
+}
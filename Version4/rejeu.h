@@ -0,0 +1,85 @@
+/**
+ * @file rejeu.h
+ * @brief Enregistrement compact des parties et rejeu avec accès direct à un tour.
+ *
+ * Un fichier de rejeu contient les changements de direction (entiers
+ * variables, tours comptés depuis l'événement précédent) et, tous les
+ * « intervalle » tours, une image clé : l'état complet de la partie et ses
+ * règles (une image clé est aussi écrite quand les règles changent). Un
+ * index en fin de fichier donne la position de chaque image clé : aller à
+ * un tour ne rejoue que les tours qui suivent l'image clé précédente.
+ *
+ * L'enregistrement s'écrit au fil de la partie ; seule la table des images
+ * clés (deux entiers par image) reste en mémoire jusqu'à la fermeture.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef REJEU_H
+#define REJEU_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "jeu.h"
+
+#define INTERVALLE_IMAGES_CLES 4096     /**< Tours entre deux images clés, par défaut. */
+
+/** @brief Table des images clés : tour et position dans le fichier. */
+typedef struct
+{
+    long *tours;            /**< Tour de chaque image clé (croissant). */
+    off_t *positions;       /**< Position de chaque image clé dans le fichier. */
+    int nombre;             /**< Nombre d'images clés. */
+    int capacite;           /**< Taille allouée des deux tableaux. */
+} IndexRejeu;
+
+/** @brief Enregistrement en cours d'une partie. */
+typedef struct
+{
+    FILE *fichier;          /**< Fichier de rejeu. */
+    int intervalle;         /**< Tours entre deux images clés. */
+    long base;              /**< Tour du dernier événement ou de la dernière image clé. */
+    char direction;         /**< Dernière direction enregistrée. */
+    const Regles *regles;   /**< Règles de la partie à la dernière image clé. */
+    IndexRejeu index;       /**< Images clés écrites. */
+} Enregistreur;
+
+/** @brief Rejeu d'une partie enregistrée. */
+typedef struct
+{
+    FILE *fichier;          /**< Fichier de rejeu. */
+    uint32_t graine;        /**< Graine de la partie (pour creerPartie()). */
+    int largeur;            /**< Largeur du plateau. */
+    int hauteur;            /**< Hauteur du plateau. */
+    int intervalle;         /**< Tours entre deux images clés. */
+    int objectif_pommes;    /**< Pommes à manger pour gagner. */
+    Regles regles;          /**< Règles de la partie à son départ (à publier avant creerPartie()). */
+    long tours;             /**< Nombre de tours enregistrés. */
+    Issue issue;            /**< Issue de la partie à la fin de l'enregistrement. */
+    IndexRejeu index;       /**< Images clés du fichier. */
+    char direction;         /**< Direction jouée tant qu'aucun événement ne la change. */
+    long base;              /**< Tour du dernier événement ou de la dernière image clé lus. */
+    int prochain;           /**< Nature du prochain enregistrement lu (événement, image clé, fin). */
+    long tour_prochain;     /**< Tour du prochain enregistrement. */
+    char direction_prochaine;   /**< Direction du prochain événement. */
+    bool conforme;          /**< Toutes les images clés rencontrées correspondent à la partie rejouée. */
+} Rejeu;
+
+/* Déclaration des fonctions */
+bool ouvrirEnregistrement(Enregistreur *enregistreur, const char *chemin,
+                          const Partie *partie, uint32_t graine, int intervalle);
+bool enregistrerTour(Enregistreur *enregistreur, const Partie *partie, char direction);
+bool fermerEnregistrement(Enregistreur *enregistreur, const Partie *partie, Issue issue);
+
+bool ouvrirRejeu(Rejeu *rejeu, const char *chemin);
+bool allerAuTour(Rejeu *rejeu, Partie *partie, long tour);
+bool rejouerTour(Rejeu *rejeu, Partie *partie, Issue *issue);
+void fermerRejeu(Rejeu *rejeu);
+
+#endif
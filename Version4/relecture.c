@@ -0,0 +1,172 @@
+/**
+ * @file relecture.c
+ * @brief Relecture des fichiers de rejeu (voir rejeu.h).
+ *
+ * @details
+ * Utilisation : relecture [-t tour] fichier
+ * - Sans option : affiche les caractéristiques de l'enregistrement puis le
+ *   rejoue en entier, en comparant chaque image clé à la partie rejouée.
+ * - -t : va directement au tour demandé (image clé précédente puis quelques
+ *   tours rejoués) et affiche le plateau à ce tour.
+ * - Les règles sont celles de l'enregistrement (en-tête puis images clés
+ *   écrites à chaque rechargement) : regles.conf n'est pas lu.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "jeu.h"
+#include "rejeu.h"
+
+static void afficherPlateau(const Partie *partie);
+static double secondes(void);
+
+/**
+ * @brief Lit les options et relit l'enregistrement.
+ *
+ * @param argc Nombre d'arguments.
+ * @param argv Arguments.
+ * @return EXIT_SUCCESS, ou EXIT_FAILURE si le fichier est illisible ou non conforme.
+ */
+int main(int argc, char *argv[])
+{
+    Rejeu rejeu;
+    Partie partie;
+    long tour = -1;
+    int option;
+    struct stat informations;
+    double debut;
+    Issue issue = PARTIE_EN_COURS;
+    bool lisible;
+
+    while ((option = getopt(argc, argv, "t:")) != -1)
+    {
+        if (option == 't')
+        {
+            tour = atol(optarg);
+        }
+        else
+        {
+            fprintf(stderr, "Utilisation : %s [-t tour] fichier\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1)
+    {
+        fprintf(stderr, "Utilisation : %s [-t tour] fichier\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!ouvrirRejeu(&rejeu, argv[optind]))
+    {
+        return EXIT_FAILURE;
+    }
+    publierRegles(&rejeu.regles);
+    creerPartie(&partie, rejeu.graine);
+    partie.objectif_pommes = rejeu.objectif_pommes;
+    if (partie.largeur != rejeu.largeur || partie.hauteur != rejeu.hauteur)
+    {
+        fprintf(stderr, "%s : plateau de %dx%d dans l'en-tête, %dx%d dans les règles\n", argv[optind],
+                rejeu.largeur, rejeu.hauteur, partie.largeur, partie.hauteur);
+        return EXIT_FAILURE;
+    }
+
+    if (tour >= 0)
+    {
+        debut = secondes();
+        if (!allerAuTour(&rejeu, &partie, tour))
+        {
+            fprintf(stderr, "%s : tour %ld hors de l'enregistrement (0 à %ld)\n",
+                    argv[optind], tour, rejeu.tours);
+            return EXIT_FAILURE;
+        }
+        printf("Tour %ld atteint en %.3f ms : %d pommes, serpent de %ld segments\n",
+               partie.tour, (secondes() - debut) * 1e3, partie.pommes_mangees, partie.serpent.taille);
+        afficherPlateau(&partie);
+    }
+    else
+    {
+        stat(argv[optind], &informations);
+        printf("Graine %u, %ld tours, %d images clés (une tous les %d tours)\n",
+               rejeu.graine, rejeu.tours, rejeu.index.nombre, rejeu.intervalle);
+        printf("%lld octets, %.3f octets par tour\n", (long long)informations.st_size,
+               rejeu.tours > 0 ? (double)informations.st_size / rejeu.tours : 0.0);
+
+        debut = secondes();
+        lisible = allerAuTour(&rejeu, &partie, rejeu.index.tours[0]);
+        while (lisible && partie.tour < rejeu.tours)
+        {
+            lisible = rejouerTour(&rejeu, &partie, &issue);
+        }
+        printf("Rejeu de %ld tours en %.3f s : %d pommes, issue %s\n", partie.tour,
+               secondes() - debut, partie.pommes_mangees,
+               issue == PARTIE_GAGNEE ? "gagnée" : issue == PARTIE_PERDUE ? "perdue" : "en cours");
+        if (!lisible || !rejeu.conforme || issue != rejeu.issue)
+        {
+            printf("Rejeu NON conforme à l'enregistrement\n");
+            return EXIT_FAILURE;
+        }
+        printf("Rejeu conforme (toutes les images clés et l'issue correspondent)\n");
+    }
+
+    fermerRejeu(&rejeu);
+    detruirePartie(&partie);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Affiche le plateau et le serpent en texte.
+ *
+ * @param partie La partie.
+ */
+static void afficherPlateau(const Partie *partie)
+{
+    size_t cases = (size_t)partie->largeur * partie->hauteur;
+    char *image = malloc(cases);
+    Parcours parcours;
+    Segment segment;
+    bool premier = true;
+
+    if (image == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < cases; i++)
+    {
+        image[i] = partie->plateau[i];
+    }
+    debutParcours(&partie->serpent, &parcours);
+    while (segmentSuivant(&parcours, &segment))
+    {
+        image[(size_t)segment.y * partie->largeur + segment.x] = premier ? TETE : CORPS;
+        premier = false;
+    }
+    for (int y = 0; y < partie->hauteur; y++)
+    {
+        fwrite(image + (size_t)y * partie->largeur, 1, partie->largeur, stdout);
+        putchar('\n');
+    }
+    free(image);
+}
+
+/**
+ * @brief Horloge monotone en secondes.
+ *
+ * @return L'instant présent.
+ */
+static double secondes(void)
+{
+    struct timespec instant;
+
+    clock_gettime(CLOCK_MONOTONIC, &instant);
+    return instant.tv_sec + instant.tv_nsec / 1e9;
+}
@@ -0,0 +1,858 @@
+/**
+ * @file rendu.c
+ * @brief Thread de rendu du jeu Snake (triple tampon sans verrou).
+ *
+ * @details
+ * - Le thread de simulation écrit dans une image de composition qui lui est
+ *   propre, puis la recopie dans le tampon arrière et l'échange avec le tampon
+ *   du milieu par une seule opération atomique. Il ne touche jamais au terminal.
+ * - Le thread de rendu échange son tampon avant avec celui du milieu dès
+ *   qu'une nouvelle image y a été déposée : s'il a pris du retard, les images
+ *   intermédiaires sont simplement écrasées et il passe directement à la plus récente.
+ * - Seules les cases qui diffèrent de ce qui est déjà affiché sont envoyées.
+ * - La sortie n'est jamais bloquante : le terminal est rouvert en mode non
+ *   bloquant et une image en cours d'envoi est terminée dès qu'il accepte de
+ *   nouveau des octets. Tant que la file de sortie du terminal (TIOCOUTQ)
+ *   dépasse SEUIL_FILE_SORTIE, aucune nouvelle image n'est envoyée : sur une
+ *   liaison lente, les images intermédiaires sont sautées et la suivante part
+ *   en un seul delta, calculé par rapport à ce qui est réellement à l'écran. Les cases sont comparées par
+ *   identifiant de glyphe (voir glyphes.c), qui tient compte des murs voisins.
+ * - Une image peut être horodatée (touche lue, début du tour) : l'horodatage
+ *   est rangé par numéro d'image dans un anneau. Quand une image est écrite,
+ *   le thread de rendu termine la mesure de toutes les images publiées depuis
+ *   la précédente qu'il a écrite, y compris celles qu'il a sautées : leur
+ *   contenu est inclus dans l'image écrite.
+ * - Incrustation facultative : une ligne sous le plateau montre la latence
+ *   de la dernière touche et son découpage (voir latence.h).
+ * - Les images ne couvrent que la partie visible du plateau, dont l'origine
+ *   est fixée par placerCamera(). Quand elle change, le thread de rendu fait
+ *   défiler ce qui est déjà à l'écran (région de défilement pour les lignes,
+ *   suppression ou insertion de caractères pour les colonnes) : seules les
+ *   bandes découvertes restent à envoyer.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <signal.h>
+
+#include "rendu.h"
+#include "glyphes.h"
+#include "latence.h"
+#include "metriques.h"
+
+#define NOMBRE_TAMPONS 3        /**< Nombre de tampons d'image (triple tampon). */
+#define MASQUE_INDEX 3u         /**< Masque pour extraire l'indice d'un tampon. */
+#define NOUVELLE_IMAGE 4u       /**< Drapeau : le tampon du milieu n'a pas encore été lu. */
+#define TAILLE_POSITION 16      /**< Taille maximale d'une séquence de positionnement. */
+#define TAILLE_HORODATAGES 64   /**< Nombre d'horodatages conservés (images en retard). */
+#define TAILLE_INCRUSTATION 160 /**< Taille maximale de la ligne d'incrustation. */
+#define SEUIL_FILE_SORTIE 1024  /**< Octets en attente dans le terminal au-delà desquels il est en retard. */
+#define PAUSE_RETARD 2          /**< Attente (ms) avant de réinterroger un terminal en retard. */
+
+/** @brief Image complète du plateau et du serpent. */
+typedef struct
+{
+    char *cases;                /**< Caractères de l'image, ligne par ligne. */
+    unsigned long numero;       /**< Numéro de l'image (incrémenté à chaque publication). */
+    int origine_x;              /**< Colonne du plateau au bord gauche de l'image. */
+    int origine_y;              /**< Ligne du plateau au bord haut de l'image. */
+} Image;
+
+/** @brief Horodatage d'une image publiée après une touche. */
+typedef struct
+{
+    atomic_ulong numero;        /**< Numéro de l'image (0 : horodatage en cours d'écriture). */
+    uint64_t touche;            /**< Lecture de la touche. */
+    uint64_t debut_tour;        /**< Début du tour qui l'a appliquée. */
+    uint64_t publication;       /**< Publication de l'image. */
+} Horodatage;
+
+static int largeur_image;               /**< Largeur des images en cases. */
+static int hauteur_image;               /**< Hauteur des images en cases. */
+static char *composition;               /**< Image en cours de composition (thread de simulation). */
+static int origine_x;                   /**< Colonne du plateau au bord gauche de la composition. */
+static int origine_y;                   /**< Ligne du plateau au bord haut de la composition. */
+static int origine_affichee_x;          /**< Colonne du plateau au bord gauche de l'écran (thread de rendu). */
+static int origine_affichee_y;          /**< Ligne du plateau au bord haut de l'écran (thread de rendu). */
+static Image images[NOMBRE_TAMPONS];    /**< Les trois tampons d'image. */
+static unsigned int arriere;            /**< Tampon arrière (thread de simulation). */
+static unsigned int avant;              /**< Tampon avant (thread de rendu). */
+static atomic_uint milieu;              /**< Tampon du milieu et drapeau NOUVELLE_IMAGE. */
+static atomic_bool arret_demande;       /**< Demande d'arrêt du thread de rendu. */
+static atomic_bool tout_redessiner;     /**< L'écran doit être effacé et entièrement redessiné. */
+static unsigned long numero_image;      /**< Numéro de la dernière image publiée. */
+static sem_t signal_image;              /**< Réveille le thread de rendu. */
+static pthread_t thread_rendu;          /**< Thread de rendu. */
+static char *precedente;                /**< Cases de la dernière image dessinée (thread de rendu). */
+static uint16_t *affiche;               /**< Glyphes actuellement à l'écran (thread de rendu). */
+static unsigned char style_courant;     /**< Style (couleurs) courant du terminal (thread de rendu). */
+static char *sortie;                    /**< Tampon des octets à écrire (thread de rendu). */
+static size_t taille_sortie;            /**< Octets de l'image en cours d'envoi (thread de rendu). */
+static size_t deja_envoye;              /**< Octets de cette image déjà acceptés par le terminal. */
+static unsigned long numero_envoye;     /**< Numéro de l'image en cours d'envoi. */
+static int descripteur_sortie;          /**< Sortie du rendu (non bloquante pour un terminal). */
+static unsigned long images_sautees;    /**< Images publiées jamais envoyées (thread de rendu). */
+static Horodatage horodatages[TAILLE_HORODATAGES];  /**< Horodatages, rangés par numéro d'image. */
+static uint64_t touche_composee;        /**< Touche appliquée dans l'image composée (0 : aucune). */
+static uint64_t debut_tour_compose;     /**< Début du tour de l'image composée. */
+static unsigned long derniere_ecrite;   /**< Numéro de la dernière image écrite (thread de rendu). */
+static bool incrustation;               /**< Afficher la ligne de latence sous le plateau. */
+static Latences latences;               /**< Latences mesurées (thread de rendu). */
+
+static void allouerTampons(int largeur, int hauteur);
+static void libererTampons(void);
+static void lancerThread(void);
+static void attendreThread(void);
+static void *boucleRendu(void *argument);
+static void dessinerImage(const Image *image);
+static size_t defilerEcran(char *octets, int dx, int dy);
+static size_t ecrireDecimal(char *octets, unsigned int valeur);
+static size_t ecrireCommande(char *octets, unsigned int valeur, char commande);
+static size_t ecrirePosition(char *octets, int ligne, int colonne);
+static void decalerCases(void *cases, size_t taille_case, int dx, int dy, int remplissage);
+static bool envoyerSortie(void);
+static bool terminalEnRetard(void);
+static void mesurerLatences(unsigned long numero, uint64_t ecriture);
+static size_t ecrireIncrustation(char *octets);
+static void ecrireTout(const char *octets, size_t taille);
+
+/**
+ * @brief Alloue les tampons d'image et lance le thread de rendu.
+ *
+ * @param largeur Largeur des images en cases.
+ * @param hauteur Hauteur des images en cases.
+ * @param unicode true pour l'habillage Unicode en couleur, false pour l'ASCII d'origine.
+ * @param latence true pour afficher la latence des touches sous le plateau.
+ */
+void demarrerRendu(int largeur, int hauteur, bool unicode, bool latence)
+{
+    preparerGlyphes(unicode);
+    allouerTampons(largeur, hauteur);
+    origine_x = origine_y = 0;
+    origine_affichee_x = origine_affichee_y = 0;
+
+    atomic_store(&tout_redessiner, false);
+    numero_image = 0;
+    derniere_ecrite = 0;
+    images_sautees = 0;
+    // Nouvelle ouverture du terminal : O_NONBLOCK ne touche pas l'entrée standard, qui partage l'ancienne
+    descripteur_sortie = isatty(STDOUT_FILENO) ?
+                         open("/proc/self/fd/1", O_WRONLY | O_NONBLOCK | O_CLOEXEC) : -1;
+    if (descripteur_sortie < 0)
+    {
+        descripteur_sortie = STDOUT_FILENO;
+    }
+    touche_composee = 0;
+    incrustation = latence;
+    memset(&latences, 0, sizeof(latences));
+    for (int i = 0; i < TAILLE_HORODATAGES; i++)
+    {
+        atomic_store(&horodatages[i].numero, 0);
+    }
+    sem_init(&signal_image, 0, 0);
+    lancerThread();
+}
+
+/**
+ * @brief Change la taille des images, par exemple après un redimensionnement du terminal.
+ *
+ * Attend l'affichage de la dernière image publiée, puis repart d'une image
+ * vide qui sera dessinée en entier sur un écran effacé. L'origine de la
+ * caméra et les mesures de latence sont conservées.
+ *
+ * @param largeur Nouvelle largeur des images en cases.
+ * @param hauteur Nouvelle hauteur des images en cases.
+ */
+void redimensionnerRendu(int largeur, int hauteur)
+{
+    attendreThread();
+    libererTampons();
+    allouerTampons(largeur, hauteur);
+    origine_affichee_x = origine_x;
+    origine_affichee_y = origine_y;
+    atomic_store(&tout_redessiner, true);
+    lancerThread();
+}
+
+/**
+ * @brief Déplace la partie visible du plateau.
+ *
+ * Le contenu déjà composé suit le déplacement ; les bandes découvertes sont
+ * vides et doivent être recomposées avec ecrireCase() avant la publication.
+ *
+ * @param x Colonne du plateau à afficher au bord gauche.
+ * @param y Ligne du plateau à afficher au bord haut.
+ */
+void placerCamera(int x, int y)
+{
+    decalerCases(composition, 1, x - origine_x, y - origine_y, ' ');
+    origine_x = x;
+    origine_y = y;
+}
+
+/**
+ * @brief Écrit un caractère dans l'image en cours de composition.
+ *
+ * N'effectue aucune entrée-sortie : la case sera envoyée au terminal par le
+ * thread de rendu lors de la prochaine publication. Une case hors de la
+ * partie visible du plateau est ignorée.
+ *
+ * @param x Coordonnée en X (colonne du plateau).
+ * @param y Coordonnée en Y (ligne du plateau).
+ * @param c Le caractère à afficher.
+ */
+void ecrireCase(int x, int y, char c)
+{
+    x -= origine_x;
+    y -= origine_y;
+    if (x >= 0 && x < largeur_image && y >= 0 && y < hauteur_image)
+    {
+        composition[y * largeur_image + x] = c;
+    }
+}
+
+/**
+ * @brief Horodate l'image en cours de composition.
+ *
+ * À appeler avant publierImage() quand l'image montre l'effet d'une touche.
+ * Si plusieurs touches sont appliquées dans la même image, seule la plus
+ * ancienne est mesurée.
+ *
+ * @param touche Lecture de la touche (horloge de instantPresent()).
+ * @param debut_tour Début du tour qui a appliqué la touche.
+ */
+void horodaterImage(uint64_t touche, uint64_t debut_tour)
+{
+    if (touche_composee == 0)
+    {
+        touche_composee = touche;
+        debut_tour_compose = debut_tour;
+    }
+}
+
+/**
+ * @brief Publie l'image composée pour le thread de rendu.
+ *
+ * Recopie l'image dans le tampon arrière et l'échange avec le tampon du
+ * milieu. Ne bloque jamais, quel que soit l'état du terminal.
+ */
+void publierImage(void)
+{
+    Image *image = &images[arriere];
+
+    memcpy(image->cases, composition, (size_t)largeur_image * hauteur_image);
+    image->numero = ++numero_image;
+    image->origine_x = origine_x;
+    image->origine_y = origine_y;
+    if (touche_composee != 0)
+    {
+        Horodatage *horodatage = &horodatages[numero_image % TAILLE_HORODATAGES];
+
+        // Numéro nul pendant l'écriture : le thread de rendu ignore un horodatage incomplet
+        atomic_store(&horodatage->numero, 0);
+        horodatage->touche = touche_composee;
+        horodatage->debut_tour = debut_tour_compose;
+        horodatage->publication = instantPresent();
+        atomic_store(&horodatage->numero, numero_image);
+        touche_composee = 0;
+    }
+    arriere = atomic_exchange(&milieu, arriere | NOUVELLE_IMAGE) & MASQUE_INDEX;
+    sem_post(&signal_image);
+}
+
+/**
+ * @brief Demande que la prochaine image soit dessinée en entier.
+ *
+ * À utiliser lorsque le contenu du terminal n'est plus fiable, par exemple
+ * après un redimensionnement : l'écran est effacé avant le dessin.
+ */
+void redessinerTout(void)
+{
+    atomic_store(&tout_redessiner, true);
+}
+
+/**
+ * @brief Latences mesurées pendant la partie.
+ *
+ * À lire une fois le rendu arrêté (voir arreterRendu()).
+ *
+ * @return La distribution des latences.
+ */
+const Latences *latencesRendu(void)
+{
+    return &latences;
+}
+
+/**
+ * @brief Nombre d'images publiées qui n'ont jamais été envoyées au terminal.
+ *
+ * À lire une fois le rendu arrêté (voir arreterRendu()).
+ *
+ * @return Le nombre d'images sautées.
+ */
+unsigned long imagesSautees(void)
+{
+    return images_sautees;
+}
+
+/**
+ * @brief Arrête le thread de rendu après l'affichage de la dernière image publiée.
+ *
+ * Libère ensuite les tampons. La sortie standard peut de nouveau être
+ * utilisée directement au retour de cette fonction.
+ */
+void arreterRendu(void)
+{
+    attendreThread();
+    sem_destroy(&signal_image);
+    if (descripteur_sortie != STDOUT_FILENO)
+    {
+        close(descripteur_sortie);
+    }
+    libererTampons();
+}
+
+/**
+ * @brief Alloue les tampons d'image, vides, et remet le triple tampon à zéro.
+ *
+ * @param largeur Largeur des images en cases.
+ * @param hauteur Hauteur des images en cases.
+ */
+static void allouerTampons(int largeur, int hauteur)
+{
+    size_t taille = (size_t)largeur * hauteur;
+
+    largeur_image = largeur;
+    hauteur_image = hauteur;
+    composition = malloc(taille);
+    precedente = malloc(taille);
+    affiche = malloc(taille * sizeof(uint16_t));
+    // Défilement : au plus une séquence de région et deux par ligne
+    sortie = malloc(taille * (TAILLE_POSITION + GLYPHE_OCTETS_MAX) + (2 * (size_t)hauteur + 4) * TAILLE_POSITION +
+                    TAILLE_INCRUSTATION);
+    for (int i = 0; i < NOMBRE_TAMPONS; i++)
+    {
+        images[i].cases = malloc(taille);
+        images[i].numero = 0;
+    }
+    if (composition == NULL || precedente == NULL || affiche == NULL || sortie == NULL ||
+        images[0].cases == NULL || images[1].cases == NULL || images[2].cases == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(composition, ' ', taille);
+    // Aucune case d'image ne vaut 0 : la première image est dessinée en entier
+    memset(precedente, 0, taille);
+    // 0xFFFF n'est l'identifiant d'aucun glyphe : toutes les cases sont à redessiner
+    memset(affiche, 0xFF, taille * sizeof(uint16_t));
+    style_courant = STYLE_INCONNU;
+
+    arriere = 0;
+    atomic_store(&milieu, 1);
+    avant = 2;
+    taille_sortie = deja_envoye = 0;
+}
+
+/**
+ * @brief Libère les tampons d'image.
+ */
+static void libererTampons(void)
+{
+    for (int i = 0; i < NOMBRE_TAMPONS; i++)
+    {
+        free(images[i].cases);
+        images[i].cases = NULL;
+    }
+    free(composition);
+    free(precedente);
+    free(affiche);
+    free(sortie);
+    composition = precedente = sortie = NULL;
+    affiche = NULL;
+}
+
+/**
+ * @brief Lance le thread de rendu.
+ */
+static void lancerThread(void)
+{
+    atomic_store(&arret_demande, false);
+    if (pthread_create(&thread_rendu, NULL, boucleRendu, NULL) != 0)
+    {
+        perror("pthread_create");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief Arrête le thread de rendu après l'affichage de la dernière image publiée.
+ */
+static void attendreThread(void)
+{
+    atomic_store(&arret_demande, true);
+    sem_post(&signal_image);
+    pthread_join(thread_rendu, NULL);
+}
+
+/**
+ * @brief Boucle du thread de rendu.
+ *
+ * Termine d'abord l'envoi de l'image en cours, puis, si le terminal n'est
+ * pas en retard, récupère la plus récente image et prépare son envoi.
+ * Se termine lorsque l'arrêt est demandé, que tout a été envoyé et que plus
+ * aucune image n'est en attente.
+ *
+ * @param argument Inutilisé.
+ * @return NULL.
+ */
+static void *boucleRendu(void *argument)
+{
+    sigset_t signaux;
+
+    (void)argument;
+    // Les signaux (arrêt, suspension, redimensionnement) sont traités par le thread principal
+    sigfillset(&signaux);
+    pthread_sigmask(SIG_BLOCK, &signaux, NULL);
+
+    while (true)
+    {
+        if (taille_sortie > 0)
+        {
+            if (envoyerSortie())
+            {
+                mesurerLatences(numero_envoye, instantPresent());
+                compter(COMPTEUR_IMAGES, 1);
+                taille_sortie = 0;
+            }
+            else
+            {
+                struct pollfd terminal = {descripteur_sortie, POLLOUT, 0};
+                poll(&terminal, 1, -1);
+            }
+            continue;
+        }
+        if (atomic_load(&milieu) & NOUVELLE_IMAGE)
+        {
+            // Terminal en retard : l'image attend, et sera peut-être remplacée par une plus récente
+            if (!atomic_load(&arret_demande) && terminalEnRetard())
+            {
+                poll(NULL, 0, PAUSE_RETARD);
+                continue;
+            }
+            avant = atomic_exchange(&milieu, avant) & MASQUE_INDEX;
+            dessinerImage(&images[avant]);
+            continue;
+        }
+        if (atomic_load(&arret_demande))
+        {
+            break;
+        }
+
+        while (sem_wait(&signal_image) == -1 && errno == EINTR)
+        {
+        }
+        // Plusieurs publications ont pu avoir lieu : une seule image sera dessinée
+        while (sem_trywait(&signal_image) == 0)
+        {
+        }
+    }
+
+    // Le terminal retrouve ses couleurs par défaut
+    ecrireTout(sortie, terminerStyle(sortie, &style_courant));
+    return NULL;
+}
+
+/**
+ * @brief Prépare l'envoi des cases de l'image qui ont changé.
+ *
+ * Les cases sont comparées à ce qui est affiché, pas à l'image précédente
+ * publiée : après des images sautées, un seul delta remet l'écran à jour.
+ * Le glyphe d'une case ne dépend que des cases qui l'entourent : une ligne
+ * est ignorée si elle et ses deux voisines sont identiques à l'image
+ * précédente. Le curseur n'est repositionné que lorsque la case modifiée
+ * ne suit pas immédiatement la précédente. Si la caméra a bougé, l'écran
+ * défile d'abord (voir defilerEcran()).
+ *
+ * @param image Image à afficher.
+ */
+static void dessinerImage(const Image *image)
+{
+    size_t taille = 0;
+    size_t cases = (size_t)largeur_image * hauteur_image;
+    int curseur_x = -1, curseur_y = -1;
+    bool complet = atomic_exchange(&tout_redessiner, false);
+
+    if (complet)
+    {
+        memset(affiche, 0xFF, cases * sizeof(uint16_t));
+        taille += terminerStyle(sortie, &style_courant);
+        taille += sprintf(sortie + taille, "\033[2J");
+    }
+    else if (image->origine_x != origine_affichee_x || image->origine_y != origine_affichee_y)
+    {
+        taille += defilerEcran(sortie + taille, image->origine_x - origine_affichee_x,
+                               image->origine_y - origine_affichee_y);
+    }
+    origine_affichee_x = image->origine_x;
+    origine_affichee_y = image->origine_y;
+
+    for (int y = 0; y < hauteur_image; y++)
+    {
+        uint16_t *ligne_affichee = affiche + (size_t)y * largeur_image;
+        bool inchangee = !complet;
+
+        for (int v = y - 1; v <= y + 1 && inchangee; v++)
+        {
+            if (v >= 0 && v < hauteur_image)
+            {
+                size_t debut = (size_t)v * largeur_image;
+                inchangee = (memcmp(image->cases + debut, precedente + debut, largeur_image) == 0);
+            }
+        }
+        if (inchangee)
+        {
+            continue;
+        }
+
+        for (int x = 0; x < largeur_image; x++)
+        {
+            uint16_t glyphe = identifiantGlyphe(image->cases, largeur_image, hauteur_image, x, y);
+
+            if (glyphe != ligne_affichee[x])
+            {
+                if (x != curseur_x || y != curseur_y)
+                {
+                    taille += ecrirePosition(sortie + taille, y + 1, x + 1);
+                }
+                taille += ecrireGlyphe(sortie + taille, glyphe, &style_courant);
+                ligne_affichee[x] = glyphe;
+                curseur_x = x + 1;
+                curseur_y = y;
+            }
+        }
+    }
+    memcpy(precedente, image->cases, cases);
+    if (incrustation)
+    {
+        taille += ecrireIncrustation(sortie + taille);
+    }
+    if (derniere_ecrite != 0 && image->numero > derniere_ecrite + 1)
+    {
+        images_sautees += image->numero - derniere_ecrite - 1;
+        compter(COMPTEUR_IMAGES_SAUTEES, image->numero - derniere_ecrite - 1);
+    }
+    numero_envoye = image->numero;
+    taille_sortie = taille;
+    deja_envoye = 0;
+    if (taille == 0)
+    {
+        mesurerLatences(numero_envoye, instantPresent());
+    }
+}
+
+/**
+ * @brief Fait défiler l'écran après un déplacement de la caméra.
+ *
+ * Les lignes défilent dans une région limitée à l'image, qui épargne la
+ * ligne d'incrustation ; les colonnes sont décalées ligne par ligne en
+ * supprimant (DCH) ou en insérant (ICH) des caractères au bord gauche.
+ * Les cases découvertes sont ensuite redessinées comme des cases modifiées.
+ * Au-delà d'une image entière, rien ne défile : tout est redessiné.
+ *
+ * @param octets Tampon de sortie.
+ * @param dx Déplacement de la caméra en colonnes.
+ * @param dy Déplacement de la caméra en lignes.
+ * @return Le nombre d'octets écrits.
+ */
+static size_t defilerEcran(char *octets, int dx, int dy)
+{
+    size_t taille = 0;
+
+    if (abs(dx) < largeur_image && abs(dy) < hauteur_image)
+    {
+        // Les cases découvertes prennent la couleur de fond courante
+        taille += terminerStyle(octets, &style_courant);
+        if (dy != 0)
+        {
+            memcpy(octets + taille, "\033[1;", 4);
+            taille += 4;
+            taille += ecrireDecimal(octets + taille, (unsigned int)hauteur_image);
+            octets[taille++] = 'r';
+            taille += ecrireCommande(octets + taille, (unsigned int)abs(dy), (dy > 0) ? 'S' : 'T');
+            memcpy(octets + taille, "\033[r", 3);
+            taille += 3;
+        }
+        for (int y = 0; y < hauteur_image && dx != 0; y++)
+        {
+            taille += ecrirePosition(octets + taille, y + 1, 1);
+            taille += ecrireCommande(octets + taille, (unsigned int)abs(dx), (dx > 0) ? 'P' : '@');
+        }
+    }
+    decalerCases(affiche, sizeof(uint16_t), dx, dy, 0xFF);
+    decalerCases(precedente, 1, dx, dy, 0);
+    return taille;
+}
+
+/**
+ * @brief Écrit un entier en décimal, sans zéro de tête.
+ *
+ * Remplace sprintf() dans les séquences de positionnement, envoyées pour
+ * chaque groupe de cases modifiées : pas d'analyse de format ni de locale.
+ *
+ * @param octets Tampon de sortie.
+ * @param valeur Entier à écrire.
+ * @return Le nombre d'octets écrits.
+ */
+static size_t ecrireDecimal(char *octets, unsigned int valeur)
+{
+    char chiffres[10];
+    size_t nombre = 0;
+
+    do
+    {
+        chiffres[nombre++] = (char)('0' + valeur % 10);
+        valeur /= 10;
+    } while (valeur != 0);
+    for (size_t i = 0; i < nombre; i++)
+    {
+        octets[i] = chiffres[nombre - 1 - i];
+    }
+    return nombre;
+}
+
+/**
+ * @brief Écrit une commande à un paramètre (ESC [ valeur commande).
+ *
+ * @param octets Tampon de sortie.
+ * @param valeur Paramètre de la commande.
+ * @param commande Lettre finale de la commande.
+ * @return Le nombre d'octets écrits.
+ */
+static size_t ecrireCommande(char *octets, unsigned int valeur, char commande)
+{
+    size_t taille = 2;
+
+    octets[0] = '\033';
+    octets[1] = '[';
+    taille += ecrireDecimal(octets + taille, valeur);
+    octets[taille++] = commande;
+    return taille;
+}
+
+/**
+ * @brief Écrit une séquence de positionnement du curseur (ESC [ ligne ; colonne f).
+ *
+ * @param octets Tampon de sortie.
+ * @param ligne Ligne, à partir de 1.
+ * @param colonne Colonne, à partir de 1.
+ * @return Le nombre d'octets écrits.
+ */
+static size_t ecrirePosition(char *octets, int ligne, int colonne)
+{
+    size_t taille = 2;
+
+    octets[0] = '\033';
+    octets[1] = '[';
+    taille += ecrireDecimal(octets + taille, (unsigned int)ligne);
+    octets[taille++] = ';';
+    taille += ecrireDecimal(octets + taille, (unsigned int)colonne);
+    octets[taille++] = 'f';
+    return taille;
+}
+
+/**
+ * @brief Décale le contenu d'une image pour suivre la caméra.
+ *
+ * La case (x, y) reçoit l'ancienne case (x + dx, y + dy) ; les cases
+ * découvertes sont remplies octet par octet.
+ *
+ * @param cases Cases de l'image (largeur_image x hauteur_image).
+ * @param taille_case Taille d'une case en octets.
+ * @param dx Déplacement en colonnes.
+ * @param dy Déplacement en lignes.
+ * @param remplissage Octet des cases découvertes.
+ */
+static void decalerCases(void *cases, size_t taille_case, int dx, int dy, int remplissage)
+{
+    char *octets = cases;
+    size_t ligne = (size_t)largeur_image * taille_case;
+    size_t gardees = (abs(dx) < largeur_image) ? (size_t)(largeur_image - abs(dx)) * taille_case : 0;
+    size_t decouvertes = ligne - gardees;
+
+    if (dx == 0 && dy == 0)
+    {
+        return;
+    }
+    // Parcours dans le sens qui lit chaque ligne source avant qu'elle soit écrasée
+    for (int i = 0; i < hauteur_image; i++)
+    {
+        int y = (dy > 0) ? i : hauteur_image - 1 - i;
+        int source = y + dy;
+        char *destination = octets + (size_t)y * ligne;
+
+        if (source < 0 || source >= hauteur_image || gardees == 0)
+        {
+            memset(destination, remplissage, ligne);
+            continue;
+        }
+        if (dx >= 0)
+        {
+            memmove(destination, octets + (size_t)source * ligne + decouvertes, gardees);
+            memset(destination + gardees, remplissage, decouvertes);
+        }
+        else
+        {
+            memmove(destination + decouvertes, octets + (size_t)source * ligne, gardees);
+            memset(destination, remplissage, decouvertes);
+        }
+    }
+}
+
+/**
+ * @brief Envoie au terminal ce qu'il accepte de l'image en cours, sans bloquer.
+ *
+ * @return true si l'image est entièrement envoyée (ou si la sortie est inutilisable).
+ */
+static bool envoyerSortie(void)
+{
+    while (deja_envoye < taille_sortie)
+    {
+        ssize_t ecrits = write(descripteur_sortie, sortie + deja_envoye, taille_sortie - deja_envoye);
+        if (ecrits < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return errno != EAGAIN && errno != EWOULDBLOCK;
+        }
+        deja_envoye += (size_t)ecrits;
+        compter(COMPTEUR_OCTETS, (uint64_t)ecrits);
+    }
+    return true;
+}
+
+/**
+ * @brief Indique si le terminal a encore trop d'octets à transmettre.
+ *
+ * @return true si sa file de sortie dépasse SEUIL_FILE_SORTIE.
+ */
+static bool terminalEnRetard(void)
+{
+    int en_attente = 0;
+
+    return ioctl(descripteur_sortie, TIOCOUTQ, &en_attente) == 0 &&
+           en_attente > SEUIL_FILE_SORTIE;
+}
+
+/**
+ * @brief Termine la mesure des touches montrées par l'image écrite.
+ *
+ * Les images sautées depuis la dernière écriture sont comprises dans
+ * l'image écrite : leurs touches sont mesurées avec elle.
+ *
+ * @param numero Numéro de l'image écrite.
+ * @param ecriture Fin de son écriture dans le terminal.
+ */
+static void mesurerLatences(unsigned long numero, uint64_t ecriture)
+{
+    unsigned long premier = derniere_ecrite + 1;
+
+    if (numero - derniere_ecrite > TAILLE_HORODATAGES)
+    {
+        premier = numero - TAILLE_HORODATAGES + 1;
+    }
+    for (unsigned long n = premier; n <= numero && n != 0; n++)
+    {
+        Horodatage *horodatage = &horodatages[n % TAILLE_HORODATAGES];
+        uint64_t touche, debut_tour, publication;
+
+        if (atomic_load(&horodatage->numero) != n)
+        {
+            continue;
+        }
+        touche = horodatage->touche;
+        debut_tour = horodatage->debut_tour;
+        publication = horodatage->publication;
+        // Relu après coup : l'emplacement a pu être réutilisé pendant la lecture
+        if (atomic_load(&horodatage->numero) == n)
+        {
+            ajouterLatence(&latences, touche, debut_tour, publication, ecriture);
+        }
+    }
+    derniere_ecrite = numero;
+}
+
+/**
+ * @brief Écrit la ligne d'incrustation sous le plateau.
+ *
+ * @param octets Tampon de sortie (au moins TAILLE_INCRUSTATION octets libres).
+ * @return Le nombre d'octets écrits.
+ */
+static size_t ecrireIncrustation(char *octets)
+{
+    size_t taille = terminerStyle(octets, &style_courant);
+
+    if (latences.nombre == 0)
+    {
+        return taille;
+    }
+    taille += snprintf(octets + taille, TAILLE_INCRUSTATION - taille,
+                       "\033[%d;1flatence %6.1f ms (attente %5.1f, logique %4.1f, sortie %4.1f)"
+                       "  p99 < %6.1f ms\033[K",
+                       hauteur_image + 1,
+                       latences.derniere[PHASE_TOTAL] / 1e6,
+                       latences.derniere[PHASE_ATTENTE] / 1e6,
+                       latences.derniere[PHASE_LOGIQUE] / 1e6,
+                       latences.derniere[PHASE_SORTIE] / 1e6,
+                       centileLatence(&latences, PHASE_TOTAL, 99) / 1e6);
+    return taille;
+}
+
+/**
+ * @brief Écrit un tampon complet sur la sortie du rendu, en attendant si besoin.
+ *
+ * @param octets Octets à écrire.
+ * @param taille Nombre d'octets.
+ */
+static void ecrireTout(const char *octets, size_t taille)
+{
+    while (taille > 0)
+    {
+        ssize_t ecrits = write(descripteur_sortie, octets, taille);
+        if (ecrits < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                struct pollfd terminal = {descripteur_sortie, POLLOUT, 0};
+                poll(&terminal, 1, -1);
+                continue;
+            }
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return;
+        }
+        octets += ecrits;
+        taille -= (size_t)ecrits;
+    }
+}
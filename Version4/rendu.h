@@ -0,0 +1,40 @@
+/**
+ * @file rendu.h
+ * @brief Thread de rendu du jeu Snake.
+ *
+ * Le thread de simulation compose l'image du plateau et du serpent avec
+ * ecrireCase(), puis la publie avec publierImage(). Un thread dédié récupère
+ * la dernière image publiée à travers un triple tampon sans verrou et se
+ * charge seul de toutes les écritures dans le terminal. Il mesure aussi la
+ * latence des touches horodatées avec horodaterImage().
+ *
+ * Les images ne montrent qu'une fenêtre du plateau, placée par
+ * placerCamera() ; ecrireCase() prend des coordonnées du plateau.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef RENDU_H
+#define RENDU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "latence.h"
+
+/* Déclaration des fonctions */
+void demarrerRendu(int largeur, int hauteur, bool unicode, bool latence);
+void redimensionnerRendu(int largeur, int hauteur);
+void placerCamera(int x, int y);
+void ecrireCase(int x, int y, char c);
+void horodaterImage(uint64_t touche, uint64_t debut_tour);
+void publierImage(void);
+void redessinerTout(void);
+void arreterRendu(void);
+const Latences *latencesRendu(void);
+unsigned long imagesSautees(void);
+
+#endif
@@ -0,0 +1,347 @@
+/**
+ * @file reseau.c
+ * @brief Perception, calcul et enregistrement des réseaux du pilote « neurone ».
+ *
+ * @details
+ * - Entrées, pour chacune des trois directions relatives (devant, à gauche,
+ *   à droite) : danger immédiat, inverse de la distance du premier obstacle
+ *   sur PORTEE_RAYON cases, direction de la pomme la plus proche, cases libres
+ *   autour de la case d'arrivée ; puis la longueur du serpent.
+ * - Couche cachée ReLU, sortie linéaire : la plus forte des trois sorties
+ *   donne la direction.
+ * - Les poids de la couche cachée sont rangés entrée par entrée et ceux de la
+ *   sortie neurone par neurone : chaque étape ajoute un vecteur de poids
+ *   multiplié par un seul nombre, sans addition horizontale. Le calcul
+ *   s'écrit avec les vecteurs de GCC et Clang, que le compilateur traduit en
+ *   instructions SIMD de la machine cible (SSE par défaut, AVX avec -march=native).
+ * - Fichier de poids : en-tête (signature et topologie) suivi des génomes,
+ *   du meilleur au moins bon ; écrit sous un nom temporaire puis renommé.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "reseau.h"
+
+#define PORTEE_RAYON 16                 /**< Cases regardées au plus dans chaque direction. */
+#define FICHIER_RESEAU "reseau.poids"   /**< Fichier des poids (si $SNAKE_RESEAU est absent). */
+#define SIGNATURE_RESEAU "SNKNEU01"     /**< Début d'un fichier de poids. */
+#define BLOCS_CACHES (CACHEES_RESEAU / LARGEUR_VECTEUR)     /**< Vecteurs de la couche cachée. */
+
+/** @brief Vecteur de LARGEUR_VECTEUR flottants (extension vectorielle de GCC). */
+typedef float Vecteur __attribute__((vector_size(LARGEUR_VECTEUR * sizeof(float))));
+/** @brief Vecteur d'entiers de même taille (résultat d'une comparaison de vecteurs). */
+typedef int32_t VecteurEntier __attribute__((vector_size(LARGEUR_VECTEUR * sizeof(int32_t))));
+/** @brief Vecteur lu directement dans un tableau de flottants, sans contrainte d'alignement. */
+typedef float VecteurLu __attribute__((vector_size(LARGEUR_VECTEUR * sizeof(float)), aligned(4), may_alias));
+
+/** @brief Vecteur des LARGEUR_VECTEUR flottants qui commencent à une adresse. */
+#define CHARGER(flottants) (*(const VecteurLu *)(flottants))
+
+/** @brief En-tête d'un fichier de poids. */
+typedef struct
+{
+    char signature[8];      /**< SIGNATURE_RESEAU. */
+    int32_t entrees;        /**< ENTREES_RESEAU. */
+    int32_t cachees;        /**< CACHEES_RESEAU. */
+    int32_t poids;          /**< POIDS_RESEAU. */
+    int32_t nombre;         /**< Nombre de génomes. */
+} EnteteReseau;
+
+_Static_assert(ENTREES_RESEAU % LARGEUR_VECTEUR == 0 && CACHEES_RESEAU % LARGEUR_VECTEUR == 0,
+               "couches alignées sur les vecteurs");
+
+/** Les quatre directions dans le sens des aiguilles d'une montre. */
+static const char DIRECTIONS[4] = {HAUT, DROITE, BAS, GAUCHE};
+/** Déplacement en X de chaque direction. */
+static const int DEPLACEMENT_X[4] = {0, 1, 0, -1};
+/** Déplacement en Y de chaque direction. */
+static const int DEPLACEMENT_Y[4] = {-1, 0, 1, 0};
+
+static void sensRelatifs(char direction, int sens[SORTIES_RESEAU]);
+static bool estLibre(const Partie *partie, Segment position);
+static Segment pommeProche(const Partie *partie, Segment position);
+
+/**
+ * @brief Calcule les entrées du réseau pour la position courante.
+ *
+ * @param partie La partie.
+ * @param entrees Reçoit les ENTREES_RESEAU entrées (les dernières restent nulles).
+ */
+void percevoir(const Partie *partie, float entrees[ENTREES_RESEAU])
+{
+    Segment tete = teteSerpent(&partie->serpent);
+    Segment pomme = pommeProche(partie, tete);
+    int sens[SORTIES_RESEAU];
+
+    memset(entrees, 0, ENTREES_RESEAU * sizeof(float));
+    sensRelatifs(partie->direction, sens);
+    for (int s = 0; s < SORTIES_RESEAU; s++)
+    {
+        char direction = DIRECTIONS[sens[s]];
+        Segment position = tete;
+        int distance = 0;
+        int vers_pomme = (pomme.x - tete.x) * DEPLACEMENT_X[sens[s]] +
+                         (pomme.y - tete.y) * DEPLACEMENT_Y[sens[s]];
+
+        entrees[s] = deplacementSansDanger(partie, direction) ? 0.0f : 1.0f;
+        do {
+            position = caseSuivante(partie, position, direction);
+            distance++;
+        } while (distance < PORTEE_RAYON && estLibre(partie, position));
+        entrees[SORTIES_RESEAU + s] = estLibre(partie, position) ? 0.0f : 1.0f / distance;
+        // Proche de -1 ou 1 loin de la pomme, de 0 à sa hauteur
+        entrees[2 * SORTIES_RESEAU + s] = (float)vers_pomme / (float)(abs(vers_pomme) + 4);
+        if (entrees[s] == 0.0f)
+        {
+            Segment arrivee = caseSuivante(partie, tete, direction);
+            int libres = 0;
+
+            for (int i = 0; i < 4; i++)
+            {
+                libres += estLibre(partie, caseSuivante(partie, arrivee, DIRECTIONS[i]));
+            }
+            entrees[3 * SORTIES_RESEAU + s] = libres / 4.0f;
+        }
+    }
+    entrees[4 * SORTIES_RESEAU] = (float)partie->serpent.taille / ((float)partie->largeur * partie->hauteur);
+}
+
+/**
+ * @brief Calcule les sorties du réseau et choisit la plus forte.
+ *
+ * @param poids Les POIDS_RESEAU poids du réseau.
+ * @param entrees Les entrées (voir percevoir()).
+ * @return Indice de la sortie choisie : 0 devant, 1 à gauche, 2 à droite.
+ */
+int evaluerReseau(const float *poids, const float entrees[ENTREES_RESEAU])
+{
+    const float *couche_cachee = poids;
+    const float *biais_caches = couche_cachee + ENTREES_RESEAU * CACHEES_RESEAU;
+    const float *couche_sortie = biais_caches + CACHEES_RESEAU;
+    Vecteur cachee[BLOCS_CACHES];
+    Vecteur sortie = CHARGER(couche_sortie + CACHEES_RESEAU * LARGEUR_VECTEUR);
+    Vecteur nul = {0};
+    float activations[CACHEES_RESEAU];
+    int choix = 0;
+
+    for (int b = 0; b < BLOCS_CACHES; b++)
+    {
+        cachee[b] = CHARGER(biais_caches + b * LARGEUR_VECTEUR);
+    }
+    for (int i = 0; i < ENTREES_RESEAU; i++)
+    {
+        if (entrees[i] != 0.0f)
+        {
+            for (int b = 0; b < BLOCS_CACHES; b++)
+            {
+                cachee[b] += entrees[i] * CHARGER(couche_cachee + (i * BLOCS_CACHES + b) * LARGEUR_VECTEUR);
+            }
+        }
+    }
+    for (int b = 0; b < BLOCS_CACHES; b++)
+    {
+        // ReLU : le masque de la comparaison garde les activations positives
+        cachee[b] = (Vecteur)((VecteurEntier)cachee[b] & (cachee[b] > nul));
+    }
+    memcpy(activations, cachee, sizeof(activations));
+    for (int j = 0; j < CACHEES_RESEAU; j++)
+    {
+        if (activations[j] != 0.0f)
+        {
+            sortie += activations[j] * CHARGER(couche_sortie + j * LARGEUR_VECTEUR);
+        }
+    }
+    for (int k = 1; k < SORTIES_RESEAU; k++)
+    {
+        if (sortie[k] > sortie[choix])
+        {
+            choix = k;
+        }
+    }
+    return choix;
+}
+
+/**
+ * @brief Direction choisie par un réseau.
+ *
+ * @param poids Les POIDS_RESEAU poids du réseau.
+ * @param partie La partie.
+ * @return La direction (jamais un demi-tour).
+ */
+char deciderReseau(const float *poids, const Partie *partie)
+{
+    float entrees[ENTREES_RESEAU];
+    int sens[SORTIES_RESEAU];
+
+    percevoir(partie, entrees);
+    sensRelatifs(partie->direction, sens);
+    return DIRECTIONS[sens[evaluerReseau(poids, entrees)]];
+}
+
+/**
+ * @brief Lit les génomes d'un fichier de poids.
+ *
+ * @param chemin Fichier de poids.
+ * @param genomes Reçoit les génomes, à la suite (maximum * POIDS_RESEAU flottants).
+ * @param maximum Nombre maximal de génomes lus.
+ * @return Le nombre de génomes lus (0 si le fichier est absent ou d'une autre topologie).
+ */
+int lireReseaux(const char *chemin, float *genomes, int maximum)
+{
+    FILE *fichier = fopen(chemin, "rb");
+    EnteteReseau entete;
+    int nombre = 0;
+
+    if (fichier == NULL)
+    {
+        return 0;
+    }
+    if (fread(&entete, sizeof(entete), 1, fichier) == 1 &&
+        memcmp(entete.signature, SIGNATURE_RESEAU, sizeof(entete.signature)) == 0 &&
+        entete.entrees == ENTREES_RESEAU && entete.cachees == CACHEES_RESEAU &&
+        entete.poids == POIDS_RESEAU && entete.nombre > 0)
+    {
+        nombre = (entete.nombre < maximum) ? entete.nombre : maximum;
+        if (fread(genomes, POIDS_RESEAU * sizeof(float), (size_t)nombre, fichier) != (size_t)nombre)
+        {
+            nombre = 0;
+        }
+    }
+    fclose(fichier);
+    return nombre;
+}
+
+/**
+ * @brief Enregistre des génomes, du meilleur au moins bon.
+ *
+ * Le fichier est écrit sous un nom temporaire puis renommé : le jeu ne lit
+ * jamais un fichier à moitié écrit, même pendant un entraînement.
+ *
+ * @param chemin Fichier de poids.
+ * @param genomes Génomes, à la suite.
+ * @param nombre Nombre de génomes.
+ * @return false si le fichier n'a pas pu être écrit.
+ */
+bool ecrireReseaux(const char *chemin, const float *genomes, int nombre)
+{
+    EnteteReseau entete;
+    char temporaire[4096 + 16];
+    FILE *fichier;
+    int descripteur;
+    bool ecrit;
+
+    snprintf(temporaire, sizeof(temporaire), "%s.XXXXXX", chemin);
+    descripteur = mkstemp(temporaire);
+    if (descripteur < 0)
+    {
+        perror(temporaire);
+        return false;
+    }
+    fichier = fdopen(descripteur, "wb");
+    if (fichier == NULL)
+    {
+        perror(temporaire);
+        close(descripteur);
+        unlink(temporaire);
+        return false;
+    }
+
+    memset(&entete, 0, sizeof(entete));
+    memcpy(entete.signature, SIGNATURE_RESEAU, sizeof(entete.signature));
+    entete.entrees = ENTREES_RESEAU;
+    entete.cachees = CACHEES_RESEAU;
+    entete.poids = POIDS_RESEAU;
+    entete.nombre = nombre;
+    ecrit = fwrite(&entete, sizeof(entete), 1, fichier) == 1 &&
+            fwrite(genomes, POIDS_RESEAU * sizeof(float), (size_t)nombre, fichier) == (size_t)nombre;
+    if (fclose(fichier) != 0 || !ecrit || rename(temporaire, chemin) != 0)
+    {
+        perror(chemin);
+        unlink(temporaire);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Fichier de poids à utiliser : $SNAKE_RESEAU ou FICHIER_RESEAU.
+ *
+ * @return Le chemin du fichier.
+ */
+const char *cheminReseau(void)
+{
+    const char *chemin = getenv("SNAKE_RESEAU");
+
+    return (chemin != NULL && chemin[0] != '\0') ? chemin : FICHIER_RESEAU;
+}
+
+/**
+ * @brief Indices dans DIRECTIONS des directions devant, à gauche et à droite.
+ *
+ * @param direction Direction actuelle du serpent.
+ * @param sens Reçoit les trois indices.
+ */
+static void sensRelatifs(char direction, int sens[SORTIES_RESEAU])
+{
+    int devant = 1;
+
+    for (int i = 0; i < 4; i++)
+    {
+        if (DIRECTIONS[i] == direction)
+        {
+            devant = i;
+        }
+    }
+    sens[0] = devant;
+    sens[1] = (devant + 3) % 4;
+    sens[2] = (devant + 1) % 4;
+}
+
+/**
+ * @brief Indique si une case n'est ni un mur ni occupée par le serpent.
+ *
+ * @param partie La partie.
+ * @param position La case.
+ * @return true si la case est libre.
+ */
+static bool estLibre(const Partie *partie, Segment position)
+{
+    return CASE(partie, position.x, position.y) != COTE_BORDURE && OCCUPATION(partie, position.x, position.y) == 0;
+}
+
+/**
+ * @brief Pomme la plus proche d'une case (distance de Manhattan).
+ *
+ * @param partie La partie.
+ * @param position La case.
+ * @return La pomme, ou la dernière pomme placée s'il n'y en a plus.
+ */
+static Segment pommeProche(const Partie *partie, Segment position)
+{
+    const Objets *objets = &partie->objets;
+    Segment pomme = partie->pomme;
+    int distance = -1;
+
+    for (int i = 0; i < objets->nombre; i++)
+    {
+        const Objet *objet = &objets->objets[i];
+        int d = abs(position.x - objet->position.x) + abs(position.y - objet->position.y);
+
+        if (objet->type == OBJET_POMME && (distance < 0 || d < distance))
+        {
+            distance = d;
+            pomme = objet->position;
+        }
+    }
+    return pomme;
+}
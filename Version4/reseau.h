@@ -0,0 +1,41 @@
+/**
+ * @file reseau.h
+ * @brief Petit réseau de neurones qui conduit le serpent (pilote « neurone »).
+ *
+ * Perceptron à une couche cachée, de topologie fixe : les poids d'un réseau
+ * (son génome) sont POIDS_RESEAU flottants contigus, sans autre structure,
+ * que l'entraîneur (evolution.c) fait évoluer et enregistre. Le réseau voit
+ * la partie depuis la tête, relativement à sa direction (devant, à gauche,
+ * à droite), et choisit l'une de ces trois directions : il ne fait jamais
+ * demi-tour.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef RESEAU_H
+#define RESEAU_H
+
+#include <stdbool.h>
+
+#include "jeu.h"
+
+#define LARGEUR_VECTEUR 8       /**< Flottants traités ensemble par le calcul vectoriel. */
+#define ENTREES_RESEAU 16       /**< Entrées (multiple de LARGEUR_VECTEUR). */
+#define CACHEES_RESEAU 32       /**< Neurones cachés (multiple de LARGEUR_VECTEUR). */
+#define SORTIES_RESEAU 3        /**< Sorties utiles : devant, à gauche, à droite. */
+/** Nombre de poids d'un réseau : couche cachée, ses biais, sortie (complétée à un vecteur), ses biais. */
+#define POIDS_RESEAU (ENTREES_RESEAU * CACHEES_RESEAU + CACHEES_RESEAU + \
+                      CACHEES_RESEAU * LARGEUR_VECTEUR + LARGEUR_VECTEUR)
+
+/* Déclaration des fonctions */
+void percevoir(const Partie *partie, float entrees[ENTREES_RESEAU]);
+int evaluerReseau(const float *poids, const float entrees[ENTREES_RESEAU]);
+char deciderReseau(const float *poids, const Partie *partie);
+int lireReseaux(const char *chemin, float *genomes, int maximum);
+bool ecrireReseaux(const char *chemin, const float *genomes, int nombre);
+const char *cheminReseau(void);
+
+#endif
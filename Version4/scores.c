@@ -0,0 +1,505 @@
+/**
+ * @file scores.c
+ * @brief Journal des scores, classement en mémoire et fichier de classement.
+ *
+ * @details
+ * - Journal : enregistrements de 64 octets (signature, CRC-32, score). Un
+ *   écrivain prend le verrou du fichier (flock) et le verrou des threads du
+ *   processus, écrit un enregistrement complet à la fin puis le force sur
+ *   disque. Une fin de journal qui n'est pas un multiple de 64 octets (arrêt
+ *   au milieu d'une écriture) est coupée par l'écrivain suivant.
+ * - Lecture : la fin du journal est projetée en mémoire (mmap) par fenêtres ;
+ *   un enregistrement dont la somme de contrôle est fausse est ignoré, les
+ *   suivants restent lisibles.
+ * - Classement : tas binaire des TAILLE_CLASSEMENT meilleurs scores, le
+ *   moins bon à la racine. Le fichier de classement (écrit sous un nom
+ *   temporaire puis renommé) le conserve avec la taille du journal couverte.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "scores.h"
+
+#define SIGNATURE_SCORE 0x534B4E53u         /**< « SNKS » : début d'un enregistrement. */
+#define SIGNATURE_CLASSEMENT "SNKTOP01"     /**< Début d'un fichier de classement. */
+#define SUFFIXE_CLASSEMENT ".top"           /**< Suffixe du fichier de classement. */
+#define FICHIER_SCORES "scores.log"         /**< Journal par défaut (si $SNAKE_SCORES est absent). */
+#define FENETRE_LECTURE (64u << 20)         /**< Taille maximale d'une projection du journal. */
+
+/** @brief Enregistrement du journal. */
+typedef struct
+{
+    uint32_t signature;     /**< SIGNATURE_SCORE. */
+    uint32_t controle;      /**< CRC-32 du score. */
+    Score score;            /**< Le score. */
+} EnregistrementScore;
+
+_Static_assert(sizeof(EnregistrementScore) == 64, "un enregistrement de score fait 64 octets");
+
+static uint32_t table_crc[256];                             /**< Table du CRC-32. */
+static pthread_once_t table_crc_prete = PTHREAD_ONCE_INIT;  /**< Remplissage unique de la table. */
+
+/** @brief En-tête du fichier de classement. */
+typedef struct
+{
+    char signature[8];      /**< SIGNATURE_CLASSEMENT. */
+    uint64_t couvert;       /**< Taille du journal prise en compte. */
+    uint32_t nombre;        /**< Nombre de scores qui suivent. */
+    uint32_t controle;      /**< CRC-32 de couvert, nombre et des scores. */
+} EnteteClassement;
+
+static void remplirTableCrc(void);
+static uint32_t crc32(uint32_t crc, const void *octets, size_t taille);
+static bool meilleur(const Score *a, const Score *b);
+static void insererScore(Scores *scores, const Score *score);
+static void lireJournal(Scores *scores, off_t fin);
+static off_t tailleJournal(int descripteur);
+static void lireClassement(Scores *scores);
+static void ecrireClassement(const Scores *scores);
+static int comparerScores(const void *a, const void *b);
+
+/**
+ * @brief Ouvre (ou crée) un journal de scores et reconstruit le classement.
+ *
+ * @param scores Tableau à ouvrir.
+ * @param chemin Journal des scores.
+ * @return false si le journal ne peut pas être ouvert.
+ */
+bool ouvrirScores(Scores *scores, const char *chemin)
+{
+    off_t fin;
+
+    memset(scores, 0, sizeof(Scores));
+    scores->descripteur = open(chemin, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (scores->descripteur < 0)
+    {
+        perror(chemin);
+        return false;
+    }
+    scores->chemin_classement = malloc(strlen(chemin) + sizeof(SUFFIXE_CLASSEMENT));
+    if (scores->chemin_classement == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    strcpy(scores->chemin_classement, chemin);
+    strcat(scores->chemin_classement, SUFFIXE_CLASSEMENT);
+    pthread_mutex_init(&scores->verrou, NULL);
+
+    lireClassement(scores);
+    // Verrou partagé : aucun écrivain n'est au milieu d'un enregistrement
+    flock(scores->descripteur, LOCK_SH);
+    fin = tailleJournal(scores->descripteur);
+    flock(scores->descripteur, LOCK_UN);
+    if (scores->couvert > fin)
+    {
+        // Journal remplacé depuis l'écriture du classement : tout est relu
+        scores->nombre = 0;
+        scores->couvert = 0;
+    }
+    lireJournal(scores, fin);
+    return true;
+}
+
+/**
+ * @brief Ajoute un score à la fin du journal.
+ *
+ * Sûr entre threads et entre processus. Le score est sur disque au retour.
+ *
+ * @param scores Le tableau des scores.
+ * @param score Le score à ajouter.
+ * @return false si l'écriture a échoué.
+ */
+bool ajouterScore(Scores *scores, const Score *score)
+{
+    EnregistrementScore enregistrement;
+    off_t fin;
+    bool ecrit;
+
+    memset(&enregistrement, 0, sizeof(enregistrement));
+    enregistrement.signature = SIGNATURE_SCORE;
+    enregistrement.score = *score;
+    enregistrement.score.nom[TAILLE_NOM_SCORE - 1] = '\0';
+    enregistrement.controle = crc32(0, &enregistrement.score, sizeof(Score));
+
+    pthread_mutex_lock(&scores->verrou);
+    flock(scores->descripteur, LOCK_EX);
+    fin = tailleJournal(scores->descripteur);
+    if (lseek(scores->descripteur, 0, SEEK_END) != fin)
+    {
+        // Enregistrement incomplet laissé par un arrêt brutal
+        if (ftruncate(scores->descripteur, fin) != 0)
+        {
+            perror("ftruncate");
+        }
+    }
+    ecrit = pwrite(scores->descripteur, &enregistrement, sizeof(enregistrement), fin) ==
+            (ssize_t)sizeof(enregistrement) &&
+            fdatasync(scores->descripteur) == 0;
+    if (ecrit)
+    {
+        fin += sizeof(enregistrement);
+    }
+    flock(scores->descripteur, LOCK_UN);
+
+    // Les scores des autres écrivains depuis la dernière lecture sont pris au passage
+    lireJournal(scores, fin);
+    pthread_mutex_unlock(&scores->verrou);
+    return ecrit;
+}
+
+/**
+ * @brief Donne les meilleurs scores, du meilleur au moins bon.
+ *
+ * Seuls les scores ajoutés au journal depuis la dernière lecture sont lus.
+ *
+ * @param scores Le tableau des scores.
+ * @param classement Reçoit les scores (au moins « nombre » places).
+ * @param nombre Nombre de scores voulus (au plus TAILLE_CLASSEMENT).
+ * @return Le nombre de scores donnés.
+ */
+int meilleursScores(Scores *scores, Score *classement, int nombre)
+{
+    Score tries[TAILLE_CLASSEMENT];
+    off_t fin;
+    int total;
+
+    pthread_mutex_lock(&scores->verrou);
+    flock(scores->descripteur, LOCK_SH);
+    fin = tailleJournal(scores->descripteur);
+    flock(scores->descripteur, LOCK_UN);
+    lireJournal(scores, fin);
+    total = scores->nombre;
+    memcpy(tries, scores->meilleurs, total * sizeof(Score));
+    pthread_mutex_unlock(&scores->verrou);
+
+    qsort(tries, total, sizeof(Score), comparerScores);
+    if (nombre > total)
+    {
+        nombre = total;
+    }
+    memcpy(classement, tries, nombre * sizeof(Score));
+    return nombre;
+}
+
+/**
+ * @brief Enregistre le classement et ferme le journal.
+ *
+ * @param scores Le tableau des scores.
+ */
+void fermerScores(Scores *scores)
+{
+    ecrireClassement(scores);
+    close(scores->descripteur);
+    pthread_mutex_destroy(&scores->verrou);
+    free(scores->chemin_classement);
+    scores->chemin_classement = NULL;
+}
+
+/**
+ * @brief Journal des scores à utiliser : $SNAKE_SCORES ou FICHIER_SCORES.
+ *
+ * @return Le chemin du journal.
+ */
+const char *cheminScores(void)
+{
+    const char *chemin = getenv("SNAKE_SCORES");
+
+    return (chemin != NULL && chemin[0] != '\0') ? chemin : FICHIER_SCORES;
+}
+
+/**
+ * @brief Remplit la table du CRC-32 (polynôme 0xEDB88320).
+ */
+static void remplirTableCrc(void)
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t valeur = i;
+
+        for (int bit = 0; bit < 8; bit++)
+        {
+            valeur = (valeur & 1) ? (valeur >> 1) ^ 0xEDB88320u : valeur >> 1;
+        }
+        table_crc[i] = valeur;
+    }
+}
+
+/**
+ * @brief CRC-32, calculé par octet.
+ *
+ * @param crc CRC des octets précédents (0 au début).
+ * @param octets Octets à ajouter.
+ * @param taille Nombre d'octets.
+ * @return Le CRC mis à jour.
+ */
+static uint32_t crc32(uint32_t crc, const void *octets, size_t taille)
+{
+    const unsigned char *octet = octets;
+
+    // La table est remplie une seule fois, même si plusieurs threads arrivent ensemble
+    pthread_once(&table_crc_prete, remplirTableCrc);
+    crc = ~crc;
+    for (size_t i = 0; i < taille; i++)
+    {
+        crc = table_crc[(crc ^ octet[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Indique si un score est meilleur qu'un autre.
+ *
+ * Plus de pommes d'abord, puis moins de tours, puis le plus ancien.
+ *
+ * @param a Premier score.
+ * @param b Second score.
+ * @return true si a est meilleur que b.
+ */
+static bool meilleur(const Score *a, const Score *b)
+{
+    if (a->pommes != b->pommes)
+    {
+        return a->pommes > b->pommes;
+    }
+    if (a->tours != b->tours)
+    {
+        return a->tours < b->tours;
+    }
+    return a->date < b->date;
+}
+
+/**
+ * @brief Ajoute un score au classement s'il fait partie des meilleurs.
+ *
+ * @param scores Le tableau des scores.
+ * @param score Le score.
+ */
+static void insererScore(Scores *scores, const Score *score)
+{
+    Score *tas = scores->meilleurs;
+    int i;
+
+    if (scores->nombre < TAILLE_CLASSEMENT)
+    {
+        // Remontée depuis la dernière feuille
+        i = scores->nombre++;
+        while (i > 0 && meilleur(&tas[(i - 1) / 2], score))
+        {
+            tas[i] = tas[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        tas[i] = *score;
+        return;
+    }
+    if (!meilleur(score, &tas[0]))
+    {
+        return;
+    }
+
+    // Le moins bon (la racine) est remplacé, puis le nouveau score descend
+    i = 0;
+    while (true)
+    {
+        int enfant = 2 * i + 1;
+
+        if (enfant >= scores->nombre)
+        {
+            break;
+        }
+        if (enfant + 1 < scores->nombre && meilleur(&tas[enfant], &tas[enfant + 1]))
+        {
+            enfant++;
+        }
+        if (!meilleur(score, &tas[enfant]))
+        {
+            break;
+        }
+        tas[i] = tas[enfant];
+        i = enfant;
+    }
+    tas[i] = *score;
+}
+
+/**
+ * @brief Lit les enregistrements du journal entre la partie couverte et « fin ».
+ *
+ * @param scores Le tableau des scores (verrou des threads pris, ou ouverture).
+ * @param fin Taille du journal lue sous verrou (multiple de 64 octets).
+ */
+static void lireJournal(Scores *scores, off_t fin)
+{
+    long page = sysconf(_SC_PAGESIZE);
+
+    while (scores->couvert < fin)
+    {
+        off_t debut = scores->couvert - scores->couvert % page;
+        size_t longueur = (size_t)(fin - debut);
+        const unsigned char *projection;
+
+        if (longueur > FENETRE_LECTURE)
+        {
+            longueur = FENETRE_LECTURE;
+        }
+        projection = mmap(NULL, longueur, PROT_READ, MAP_SHARED, scores->descripteur, debut);
+        if (projection == MAP_FAILED)
+        {
+            perror("mmap");
+            return;
+        }
+        while (scores->couvert + (off_t)sizeof(EnregistrementScore) <= debut + (off_t)longueur)
+        {
+            const EnregistrementScore *enregistrement =
+                (const EnregistrementScore *)(projection + (scores->couvert - debut));
+
+            if (enregistrement->signature == SIGNATURE_SCORE &&
+                enregistrement->controle == crc32(0, &enregistrement->score, sizeof(Score)))
+            {
+                insererScore(scores, &enregistrement->score);
+            }
+            else
+            {
+                scores->ignores++;
+            }
+            scores->couvert += sizeof(EnregistrementScore);
+        }
+        munmap((void *)projection, longueur);
+    }
+}
+
+/**
+ * @brief Taille du journal en enregistrements complets.
+ *
+ * @param descripteur Le journal.
+ * @return La taille arrondie au multiple de 64 octets inférieur.
+ */
+static off_t tailleJournal(int descripteur)
+{
+    struct stat informations;
+
+    if (fstat(descripteur, &informations) != 0)
+    {
+        return 0;
+    }
+    return informations.st_size - informations.st_size % (off_t)sizeof(EnregistrementScore);
+}
+
+/**
+ * @brief Charge le fichier de classement, s'il existe et est intact.
+ *
+ * @param scores Le tableau des scores (vide).
+ */
+static void lireClassement(Scores *scores)
+{
+    EnteteClassement entete;
+    FILE *fichier = fopen(scores->chemin_classement, "rb");
+    uint32_t controle;
+
+    if (fichier == NULL)
+    {
+        return;
+    }
+    if (fread(&entete, sizeof(entete), 1, fichier) == 1 &&
+        memcmp(entete.signature, SIGNATURE_CLASSEMENT, sizeof(entete.signature)) == 0 &&
+        entete.nombre <= TAILLE_CLASSEMENT &&
+        fread(scores->meilleurs, sizeof(Score), entete.nombre, fichier) == entete.nombre)
+    {
+        controle = crc32(0, &entete.couvert, sizeof(entete.couvert));
+        controle = crc32(controle, &entete.nombre, sizeof(entete.nombre));
+        controle = crc32(controle, scores->meilleurs, entete.nombre * sizeof(Score));
+        if (controle == entete.controle && entete.couvert % sizeof(EnregistrementScore) == 0)
+        {
+            // Les scores du fichier ont été écrits sous forme de tas
+            scores->nombre = (int)entete.nombre;
+            scores->couvert = (off_t)entete.couvert;
+        }
+    }
+    fclose(fichier);
+}
+
+/**
+ * @brief Écrit le fichier de classement.
+ *
+ * Le fichier est écrit sous un nom temporaire puis renommé : un autre
+ * processus ne lit jamais un classement à moitié écrit. Une erreur est sans
+ * conséquence (le journal sera relu en entier à la prochaine ouverture).
+ *
+ * @param scores Le tableau des scores.
+ */
+static void ecrireClassement(const Scores *scores)
+{
+    EnteteClassement entete;
+    size_t longueur = strlen(scores->chemin_classement);
+    char *temporaire = malloc(longueur + 8);
+    FILE *fichier;
+    int descripteur;
+    bool ecrit;
+
+    if (temporaire == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(temporaire, scores->chemin_classement, longueur);
+    strcpy(temporaire + longueur, ".XXXXXX");
+    descripteur = mkstemp(temporaire);
+    if (descripteur >= 0)
+    {
+        // Mêmes droits que le journal (mkstemp crée le fichier en 0600)
+        fchmod(descripteur, 0644);
+    }
+    if (descripteur < 0 || (fichier = fdopen(descripteur, "wb")) == NULL)
+    {
+        if (descripteur >= 0)
+        {
+            close(descripteur);
+            unlink(temporaire);
+        }
+        free(temporaire);
+        return;
+    }
+
+    memset(&entete, 0, sizeof(entete));
+    memcpy(entete.signature, SIGNATURE_CLASSEMENT, sizeof(entete.signature));
+    entete.couvert = (uint64_t)scores->couvert;
+    entete.nombre = (uint32_t)scores->nombre;
+    entete.controle = crc32(0, &entete.couvert, sizeof(entete.couvert));
+    entete.controle = crc32(entete.controle, &entete.nombre, sizeof(entete.nombre));
+    entete.controle = crc32(entete.controle, scores->meilleurs, scores->nombre * sizeof(Score));
+    ecrit = fwrite(&entete, sizeof(entete), 1, fichier) == 1 &&
+            fwrite(scores->meilleurs, sizeof(Score), scores->nombre, fichier) == (size_t)scores->nombre;
+    if (fclose(fichier) != 0 || !ecrit || rename(temporaire, scores->chemin_classement) != 0)
+    {
+        unlink(temporaire);
+    }
+    free(temporaire);
+}
+
+/**
+ * @brief Ordre de qsort() : le meilleur score en premier.
+ *
+ * @param a Premier score.
+ * @param b Second score.
+ * @return Négatif si a passe avant b.
+ */
+static int comparerScores(const void *a, const void *b)
+{
+    if (meilleur(a, b))
+    {
+        return -1;
+    }
+    return meilleur(b, a) ? 1 : 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file scores.h
+ * @brief Tableau des scores persistant, partagé par plusieurs parties.
+ *
+ * Les scores sont ajoutés à la fin d'un journal d'enregistrements de taille
+ * fixe, chacun protégé par une somme de contrôle CRC-32 : un enregistrement
+ * à moitié écrit (arrêt brutal) est reconnu et ignoré. Plusieurs processus
+ * et plusieurs threads peuvent écrire dans le même journal.
+ *
+ * Les meilleurs scores sont gardés en mémoire. Un fichier de classement
+ * (journal + « .top ») mémorise ces meilleurs scores et la partie du journal
+ * qu'ils couvrent : à l'ouverture, seule la fin du journal est relue.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef SCORES_H
+#define SCORES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "jeu.h"
+
+#define TAILLE_CLASSEMENT 100   /**< Nombre de meilleurs scores gardés. */
+#define TAILLE_NOM_SCORE 28     /**< Taille du nom (joueur ou pilote), zéro final compris. */
+
+/** @brief Score d'une partie terminée. */
+typedef struct
+{
+    uint64_t date;                  /**< Fin de la partie (secondes depuis 1970). */
+    int64_t tours;                  /**< Tours joués. */
+    uint32_t graine;                /**< Graine de la partie. */
+    int32_t pommes;                 /**< Pommes mangées. */
+    int32_t issue;                  /**< Issue de la partie (Issue). */
+    char nom[TAILLE_NOM_SCORE];     /**< Joueur ou pilote. */
+} Score;
+
+/** @brief Tableau des scores ouvert. */
+typedef struct
+{
+    int descripteur;                /**< Journal des scores. */
+    char *chemin_classement;        /**< Fichier des meilleurs scores. */
+    pthread_mutex_t verrou;         /**< Exclusion entre les threads du processus. */
+    Score meilleurs[TAILLE_CLASSEMENT];     /**< Tas des meilleurs scores (le moins bon à la racine). */
+    int nombre;                     /**< Nombre de meilleurs scores connus. */
+    off_t couvert;                  /**< Taille du journal déjà prise en compte. */
+    long ignores;                   /**< Enregistrements invalides rencontrés. */
+} Scores;
+
+/* Déclaration des fonctions */
+bool ouvrirScores(Scores *scores, const char *chemin);
+bool ajouterScore(Scores *scores, const Score *score);
+int meilleursScores(Scores *scores, Score *classement, int nombre);
+void fermerScores(Scores *scores);
+const char *cheminScores(void);
+
+#endif
@@ -0,0 +1,488 @@
+/**
+ * @file serpent.c
+ * @brief Stockage des segments du serpent dans une arène par partie.
+ *
+ * @details
+ * - L'arène découpe de grandes zones mémoire par simple incrément de pointeur ;
+ *   elle ne libère rien avant libererArene(), qui rend toutes les zones d'un coup.
+ * - Le serpent avance en ajoutant une tête et en retirant la queue : aucun
+ *   segment n'est déplacé. Un tronçon vidé côté queue est recyclé pour la tête.
+ * - Il n'y a jamais de realloc : agrandir le serpent coûte au pire la prise
+ *   d'un nouveau tronçon dans l'arène.
+ * - Chaque segment a un rang, qui ne change pas tant qu'il reste dans le
+ *   serpent : une copie sait quels segments elle a ajoutés ou retirés depuis
+ *   copierSerpent(), et reprendreSerpent() ne recopie que ceux-là.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "serpent.h"
+
+#define TAILLE_ZONE_INITIALE ((size_t)256 * 1024)       /**< Taille de la première zone de l'arène. */
+#define TAILLE_ZONE_MAX ((size_t)16 * 1024 * 1024)      /**< Taille maximale d'une zone. */
+#define ALIGNEMENT (sizeof(max_align_t))                /**< Alignement des allocations. */
+
+static Troncon *prendreTroncon(Arene *arene);
+static void rendreTroncon(Arene *arene, Troncon *troncon);
+static void oublierRangs(Serpent *serpent);
+
+/**
+ * @brief Initialise une arène vide.
+ *
+ * @param arene Arène à initialiser.
+ */
+void initialiserArene(Arene *arene)
+{
+    arene->zones = NULL;
+    arene->courant = NULL;
+    arene->reste = 0;
+    arene->taille_zone = TAILLE_ZONE_INITIALE;
+    arene->recycles = NULL;
+}
+
+/**
+ * @brief Réserve un bloc de mémoire dans l'arène.
+ *
+ * Le bloc reste valide jusqu'à l'appel de libererArene(). Arrête le programme
+ * si la mémoire est épuisée.
+ *
+ * @param arene Arène dans laquelle allouer.
+ * @param taille Taille du bloc en octets.
+ * @return Adresse du bloc, alignée pour tout type.
+ */
+void *allouerDansArene(Arene *arene, size_t taille)
+{
+    void *bloc;
+
+    taille = (taille + ALIGNEMENT - 1) / ALIGNEMENT * ALIGNEMENT;
+    if (taille > arene->reste)
+    {
+        size_t entete = (sizeof(Zone) + ALIGNEMENT - 1) / ALIGNEMENT * ALIGNEMENT;
+        size_t taille_zone = arene->taille_zone;
+        Zone *zone;
+
+        if (taille_zone < taille + entete)
+        {
+            taille_zone = taille + entete;
+        }
+        zone = malloc(taille_zone);
+        if (zone == NULL)
+        {
+            perror("malloc");
+            exit(EXIT_FAILURE);
+        }
+        zone->suivante = arene->zones;
+        arene->zones = zone;
+        arene->courant = (char *)zone + entete;
+        arene->reste = taille_zone - entete;
+        if (arene->taille_zone < TAILLE_ZONE_MAX)
+        {
+            arene->taille_zone *= 2;
+        }
+    }
+
+    bloc = arene->courant;
+    arene->courant += taille;
+    arene->reste -= taille;
+    return bloc;
+}
+
+/**
+ * @brief Libère en bloc toute la mémoire de l'arène.
+ *
+ * Tout ce qui a été alloué dans l'arène (dont les serpents qui l'utilisent)
+ * devient invalide. L'arène peut être réutilisée ensuite.
+ *
+ * @param arene Arène à libérer.
+ */
+void libererArene(Arene *arene)
+{
+    Zone *zone = arene->zones;
+
+    while (zone != NULL)
+    {
+        Zone *suivante = zone->suivante;
+        free(zone);
+        zone = suivante;
+    }
+    initialiserArene(arene);
+}
+
+/**
+ * @brief Initialise un serpent vide.
+ *
+ * @param serpent Serpent à initialiser.
+ * @param arene Arène qui fournira les tronçons du serpent.
+ */
+void initialiserSerpent(Serpent *serpent, Arene *arene)
+{
+    serpent->arene = arene;
+    serpent->tete = NULL;
+    serpent->queue = NULL;
+    serpent->taille = 0;
+    oublierRangs(serpent);
+}
+
+/**
+ * @brief Ajoute un segment devant la tête du serpent.
+ *
+ * @param serpent Le serpent.
+ * @param segment Position de la nouvelle tête.
+ */
+void ajouterTete(Serpent *serpent, Segment segment)
+{
+    Troncon *tete = serpent->tete;
+
+    if (tete == NULL || tete->fin == SEGMENTS_PAR_TRONCON)
+    {
+        Troncon *nouveau = prendreTroncon(serpent->arene);
+        nouveau->debut = 0;
+        nouveau->fin = 0;
+        nouveau->vers_tete = NULL;
+        nouveau->vers_queue = tete;
+        if (tete == NULL)
+        {
+            serpent->queue = nouveau;
+        }
+        else
+        {
+            tete->vers_tete = nouveau;
+        }
+        serpent->tete = tete = nouveau;
+    }
+    tete->segments[tete->fin++] = segment;
+    serpent->taille++;
+}
+
+/**
+ * @brief Ajoute un segment derrière la queue du serpent.
+ *
+ * @param serpent Le serpent.
+ * @param segment Position de la nouvelle queue.
+ */
+void ajouterQueue(Serpent *serpent, Segment segment)
+{
+    Troncon *queue = serpent->queue;
+
+    if (queue == NULL || queue->debut == 0)
+    {
+        Troncon *nouveau = prendreTroncon(serpent->arene);
+        nouveau->debut = SEGMENTS_PAR_TRONCON;
+        nouveau->fin = SEGMENTS_PAR_TRONCON;
+        nouveau->vers_tete = queue;
+        nouveau->vers_queue = NULL;
+        if (queue == NULL)
+        {
+            serpent->tete = nouveau;
+        }
+        else
+        {
+            queue->vers_queue = nouveau;
+        }
+        serpent->queue = queue = nouveau;
+    }
+    queue->segments[--queue->debut] = segment;
+    serpent->taille++;
+    serpent->rang_queue--;
+}
+
+/**
+ * @brief Retire la tête du serpent.
+ *
+ * @param serpent Le serpent (non vide).
+ * @return Position de la tête retirée.
+ */
+Segment retirerTete(Serpent *serpent)
+{
+    Troncon *tete = serpent->tete;
+    Segment segment = tete->segments[--tete->fin];
+
+    serpent->taille--;
+    if (serpent->rang_queue + serpent->taille - 1 < serpent->rang_tete_min)
+    {
+        serpent->rang_tete_min = serpent->rang_queue + serpent->taille - 1;
+    }
+    if (tete->fin == tete->debut && tete != serpent->queue)
+    {
+        serpent->tete = tete->vers_queue;
+        serpent->tete->vers_tete = NULL;
+        rendreTroncon(serpent->arene, tete);
+    }
+    return segment;
+}
+
+/**
+ * @brief Retire la queue du serpent.
+ *
+ * @param serpent Le serpent (non vide).
+ * @return Position de la queue retirée.
+ */
+Segment retirerQueue(Serpent *serpent)
+{
+    Troncon *queue = serpent->queue;
+    Segment segment = queue->segments[queue->debut++];
+
+    serpent->taille--;
+    if (++serpent->rang_queue > serpent->rang_queue_max)
+    {
+        serpent->rang_queue_max = serpent->rang_queue;
+    }
+    if (queue->debut == queue->fin && queue != serpent->tete)
+    {
+        serpent->queue = queue->vers_tete;
+        serpent->queue->vers_queue = NULL;
+        rendreTroncon(serpent->arene, queue);
+    }
+    return segment;
+}
+
+/**
+ * @brief Donne la position de la tête.
+ *
+ * @param serpent Le serpent (non vide).
+ * @return Position de la tête.
+ */
+Segment teteSerpent(const Serpent *serpent)
+{
+    return serpent->tete->segments[serpent->tete->fin - 1];
+}
+
+/**
+ * @brief Donne la position de la queue.
+ *
+ * @param serpent Le serpent (non vide).
+ * @return Position de la queue.
+ */
+Segment queueSerpent(const Serpent *serpent)
+{
+    return serpent->queue->segments[serpent->queue->debut];
+}
+
+/**
+ * @brief Remplace les segments d'un serpent par ceux d'un autre.
+ *
+ * Les tronçons de la copie sont recyclés, puis les segments de la source
+ * sont recopiés tronçon par tronçon. Les deux serpents restent ensuite
+ * indépendants.
+ *
+ * @param copie Serpent qui reçoit la copie (dans sa propre arène).
+ * @param source Serpent à copier.
+ */
+void copierSerpent(Serpent *copie, const Serpent *source)
+{
+    viderSerpent(copie);
+    for (const Troncon *original = source->queue; original != NULL; original = original->vers_tete)
+    {
+        Troncon *nouveau = prendreTroncon(copie->arene);
+
+        nouveau->debut = original->debut;
+        nouveau->fin = original->fin;
+        memcpy(&nouveau->segments[original->debut], &original->segments[original->debut],
+               (size_t)(original->fin - original->debut) * sizeof(Segment));
+        nouveau->vers_tete = NULL;
+        nouveau->vers_queue = copie->tete;
+        if (copie->tete == NULL)
+        {
+            copie->queue = nouveau;
+        }
+        else
+        {
+            copie->tete->vers_tete = nouveau;
+        }
+        copie->tete = nouveau;
+    }
+    copie->taille = source->taille;
+    copie->rang_queue = source->rang_queue;
+    copie->rang_queue_max = copie->rang_queue;
+    copie->rang_tete_min = copie->rang_queue + copie->taille - 1;
+}
+
+/**
+ * @brief Redonne à une copie les segments de sa source, sans tout recopier.
+ *
+ * Les segments dont le rang est resté dans la copie depuis copierSerpent()
+ * sont ceux de la source : seuls les segments ajoutés ou retirés aux deux
+ * bouts sont repris, en temps proportionnel à leur nombre. Si la copie n'a
+ * gardé aucun segment de la source, elle est entièrement recopiée.
+ *
+ * @param copie Serpent copié de source par copierSerpent() (ou repris depuis).
+ * @param source Serpent copié, inchangé depuis.
+ */
+void reprendreSerpent(Serpent *copie, const Serpent *source)
+{
+    long rang_tete = source->rang_queue + source->taille - 1;
+    long premier = copie->rang_queue_max, dernier = copie->rang_tete_min;
+    const Troncon *troncon;
+    int indice;
+
+    if (premier > dernier || dernier > rang_tete || premier < source->rang_queue)
+    {
+        copierSerpent(copie, source);
+        return;
+    }
+
+    // Côté tête : segments ajoutés retirés, segments retirés repris de la source
+    while (copie->rang_queue + copie->taille - 1 > dernier)
+    {
+        retirerTete(copie);
+    }
+    troncon = source->tete;
+    indice = troncon->fin - 1;
+    for (long rang = rang_tete; rang > dernier + 1; rang--)
+    {
+        if (--indice < troncon->debut)
+        {
+            troncon = troncon->vers_queue;
+            indice = troncon->fin - 1;
+        }
+    }
+    for (long rang = dernier + 1; rang <= rang_tete; rang++)
+    {
+        ajouterTete(copie, troncon->segments[indice]);
+        if (++indice == troncon->fin && troncon->vers_tete != NULL)
+        {
+            troncon = troncon->vers_tete;
+            indice = troncon->debut;
+        }
+    }
+
+    // Côté queue, de même
+    while (copie->rang_queue < premier)
+    {
+        retirerQueue(copie);
+    }
+    troncon = source->queue;
+    indice = troncon->debut;
+    for (long rang = source->rang_queue; rang < premier - 1; rang++)
+    {
+        if (++indice == troncon->fin)
+        {
+            troncon = troncon->vers_tete;
+            indice = troncon->debut;
+        }
+    }
+    for (long rang = premier - 1; rang >= source->rang_queue; rang--)
+    {
+        ajouterQueue(copie, troncon->segments[indice]);
+        if (--indice < troncon->debut && troncon->vers_queue != NULL)
+        {
+            troncon = troncon->vers_queue;
+            indice = troncon->fin - 1;
+        }
+    }
+
+    copie->rang_queue_max = copie->rang_queue;
+    copie->rang_tete_min = rang_tete;
+}
+
+/**
+ * @brief Retire tous les segments du serpent.
+ *
+ * Les tronçons sont rendus à l'arène, qui les réutilise pour les prochains
+ * segments : le serpent peut repartir de zéro sans nouvelle allocation.
+ *
+ * @param serpent Le serpent.
+ */
+void viderSerpent(Serpent *serpent)
+{
+    Troncon *troncon = serpent->queue;
+
+    while (troncon != NULL)
+    {
+        Troncon *suivant = troncon->vers_tete;
+        rendreTroncon(serpent->arene, troncon);
+        troncon = suivant;
+    }
+    serpent->tete = NULL;
+    serpent->queue = NULL;
+    serpent->taille = 0;
+    oublierRangs(serpent);
+}
+
+/**
+ * @brief Prépare le parcours des segments, en commençant par la tête.
+ *
+ * @param serpent Le serpent à parcourir.
+ * @param parcours Parcours à initialiser.
+ */
+void debutParcours(const Serpent *serpent, Parcours *parcours)
+{
+    parcours->troncon = serpent->tete;
+    parcours->indice = (serpent->tete != NULL) ? serpent->tete->fin - 1 : 0;
+}
+
+/**
+ * @brief Donne le segment suivant du parcours.
+ *
+ * @param parcours Parcours en cours.
+ * @param segment Reçoit la position du segment.
+ * @return true si un segment a été donné, false à la fin du serpent.
+ */
+bool segmentSuivant(Parcours *parcours, Segment *segment)
+{
+    while (parcours->troncon != NULL && parcours->indice < parcours->troncon->debut)
+    {
+        parcours->troncon = parcours->troncon->vers_queue;
+        if (parcours->troncon != NULL)
+        {
+            parcours->indice = parcours->troncon->fin - 1;
+        }
+    }
+    if (parcours->troncon == NULL)
+    {
+        return false;
+    }
+    *segment = parcours->troncon->segments[parcours->indice--];
+    return true;
+}
+
+/**
+ * @brief Fournit un tronçon, recyclé si possible.
+ *
+ * @param arene Arène du serpent.
+ * @return Un tronçon non initialisé.
+ */
+static Troncon *prendreTroncon(Arene *arene)
+{
+    Troncon *troncon = arene->recycles;
+
+    if (troncon != NULL)
+    {
+        arene->recycles = troncon->vers_tete;
+        return troncon;
+    }
+    return allouerDansArene(arene, sizeof(Troncon));
+}
+
+/**
+ * @brief Rend un tronçon vide à l'arène pour qu'il soit réutilisé.
+ *
+ * @param arene Arène du serpent.
+ * @param troncon Tronçon vide.
+ */
+static void rendreTroncon(Arene *arene, Troncon *troncon)
+{
+    troncon->vers_tete = arene->recycles;
+    arene->recycles = troncon;
+}
+
+/**
+ * @brief Remet les rangs d'un serpent vide à zéro.
+ *
+ * @param serpent Le serpent.
+ */
+static void oublierRangs(Serpent *serpent)
+{
+    serpent->rang_queue = 0;
+    serpent->rang_queue_max = 0;
+    serpent->rang_tete_min = -1;
+}
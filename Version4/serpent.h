@@ -0,0 +1,95 @@
+/**
+ * @file serpent.h
+ * @brief Stockage des segments du serpent, sans limite de taille.
+ *
+ * Les segments sont rangés dans une file à double entrée faite de tronçons
+ * de taille fixe. Les tronçons sont pris dans une arène propre à la partie :
+ * le serpent peut atteindre des millions de segments sans aucune recopie, et
+ * toute la mémoire est rendue d'un coup à la fin de la partie.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef SERPENT_H
+#define SERPENT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#define SEGMENTS_PAR_TRONCON 4096   /**< Nombre de segments dans un tronçon. */
+
+/** @brief Position d'un segment du serpent. */
+typedef struct
+{
+    int x;      /**< Coordonnée en X (colonne). */
+    int y;      /**< Coordonnée en Y (ligne). */
+} Segment;
+
+/** @brief Tronçon de segments, chaîné à ses voisins côté tête et côté queue. */
+typedef struct Troncon
+{
+    struct Troncon *vers_tete;      /**< Tronçon suivant, du côté de la tête. */
+    struct Troncon *vers_queue;     /**< Tronçon précédent, du côté de la queue. */
+    int debut;                      /**< Indice du premier segment valide (côté queue). */
+    int fin;                        /**< Indice qui suit le dernier segment valide (côté tête). */
+    Segment segments[SEGMENTS_PAR_TRONCON];  /**< Segments, de la queue vers la tête. */
+} Troncon;
+
+/** @brief Zone de mémoire obtenue du système par l'arène. */
+typedef struct Zone
+{
+    struct Zone *suivante;  /**< Zone allouée précédemment. */
+} Zone;
+
+/** @brief Arène d'une partie : allocation par incrément, libération en bloc. */
+typedef struct
+{
+    Zone *zones;            /**< Zones allouées (libérées ensemble). */
+    char *courant;          /**< Prochain octet libre dans la zone courante. */
+    size_t reste;           /**< Octets restants dans la zone courante. */
+    size_t taille_zone;     /**< Taille de la prochaine zone à allouer. */
+    Troncon *recycles;      /**< Tronçons rendus, réutilisés avant toute nouvelle allocation. */
+} Arene;
+
+/** @brief Serpent : file à double entrée de segments. */
+typedef struct
+{
+    Arene *arene;           /**< Arène qui fournit les tronçons. */
+    Troncon *tete;          /**< Tronçon qui contient la tête. */
+    Troncon *queue;         /**< Tronçon qui contient la queue. */
+    long taille;            /**< Nombre de segments. */
+    long rang_queue;        /**< Rang de la queue : +1 par segment retiré côté queue, -1 par segment ajouté. */
+    long rang_queue_max;    /**< Plus grand rang de la queue depuis copierSerpent() (voir reprendreSerpent()). */
+    long rang_tete_min;     /**< Plus petit rang de la tête (rang_queue + taille - 1) depuis copierSerpent(). */
+} Serpent;
+
+/** @brief Parcours des segments de la tête vers la queue. */
+typedef struct
+{
+    const Troncon *troncon; /**< Tronçon en cours. */
+    int indice;             /**< Indice du prochain segment dans ce tronçon. */
+} Parcours;
+
+/* Déclaration des fonctions */
+void initialiserArene(Arene *arene);
+void *allouerDansArene(Arene *arene, size_t taille);
+void libererArene(Arene *arene);
+
+void initialiserSerpent(Serpent *serpent, Arene *arene);
+void ajouterTete(Serpent *serpent, Segment segment);
+void ajouterQueue(Serpent *serpent, Segment segment);
+Segment retirerTete(Serpent *serpent);
+Segment retirerQueue(Serpent *serpent);
+Segment teteSerpent(const Serpent *serpent);
+Segment queueSerpent(const Serpent *serpent);
+void copierSerpent(Serpent *copie, const Serpent *source);
+void reprendreSerpent(Serpent *copie, const Serpent *source);
+void viderSerpent(Serpent *serpent);
+
+void debutParcours(const Serpent *serpent, Parcours *parcours);
+bool segmentSuivant(Parcours *parcours, Segment *segment);
+
+#endif
@@ -0,0 +1,236 @@
+/**
+ * @file terminal.c
+ * @brief Ouverture et restauration de la session terminal.
+ *
+ * @details
+ * - Les attributs du terminal sont sauvegardés une fois, à l'ouverture ; la
+ *   restauration remet exactement ces attributs, écho compris.
+ * - Les gestionnaires de signaux n'utilisent que des fonctions autorisées
+ *   dans un gestionnaire (write, tcsetattr, signal, raise).
+ * - Après une suspension (SIGTSTP puis SIGCONT), la session est rouverte et
+ *   sessionReprise() le signale pour que le jeu redessine tout.
+ * - Sans terminal (sortie redirigée), rien n'est envoyé ni modifié.
+ * - La taille du terminal est relue à la demande (TIOCGWINSZ), par exemple
+ *   après un SIGWINCH reçu par le jeu.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <termios.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+
+#include "terminal.h"
+
+/** Écran alternatif, curseur caché, écran effacé, curseur en haut à gauche. */
+static const char SEQUENCE_ENTREE[] = "\033[?1049h\033[?25l\033[2J\033[H";
+/** Curseur visible, retour à l'écran normal. */
+static const char SEQUENCE_SORTIE[] = "\033[?25h\033[?1049l";
+
+static struct termios attributs_origine;            /**< Attributs du terminal avant le jeu. */
+static bool attributs_sauves = false;               /**< Les attributs d'origine ont été lus. */
+static bool sortie_terminal = false;                /**< La sortie standard est un terminal. */
+static volatile sig_atomic_t session_ouverte = 0;   /**< Le terminal est dans l'état du jeu. */
+static volatile sig_atomic_t session_reprise = 0;   /**< La session a été rouverte après une suspension. */
+
+static void entrerSession(void);
+static void quitterSession(void);
+static void gestionnaireArret(int numero_signal);
+static void gestionnaireSuspension(int numero_signal);
+static void gestionnaireReprise(int numero_signal);
+static void installerGestionnaire(int numero_signal, void (*gestionnaire)(int));
+
+/**
+ * @brief Prépare le terminal pour le jeu.
+ *
+ * Sauvegarde les attributs du terminal, installe les gestionnaires de
+ * signaux et la restauration à la sortie du programme, puis passe en mode jeu.
+ */
+void ouvrirSession(void)
+{
+    static bool restauration_installee = false;
+
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &attributs_origine) == 0)
+    {
+        attributs_sauves = true;
+    }
+    sortie_terminal = isatty(STDOUT_FILENO);
+    // Une touche à la fois : kbhit() interroge directement le descripteur
+    setvbuf(stdin, NULL, _IONBF, 0);
+
+    installerGestionnaire(SIGINT, gestionnaireArret);
+    installerGestionnaire(SIGTERM, gestionnaireArret);
+    installerGestionnaire(SIGTSTP, gestionnaireSuspension);
+    installerGestionnaire(SIGCONT, gestionnaireReprise);
+    if (!restauration_installee)
+    {
+        atexit(fermerSession);
+        restauration_installee = true;
+    }
+
+    entrerSession();
+}
+
+/**
+ * @brief Restaure le terminal dans son état d'origine.
+ *
+ * Peut être appelée plusieurs fois sans effet supplémentaire.
+ */
+void fermerSession(void)
+{
+    quitterSession();
+    signal(SIGINT, SIG_DFL);
+    signal(SIGTERM, SIG_DFL);
+    signal(SIGTSTP, SIG_DFL);
+    signal(SIGCONT, SIG_DFL);
+}
+
+/**
+ * @brief Indique si la session a été rouverte depuis le dernier appel.
+ *
+ * @return true après une reprise (SIGCONT) : l'écran doit être redessiné.
+ */
+bool sessionReprise(void)
+{
+    if (session_reprise)
+    {
+        session_reprise = 0;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Lit la taille du terminal.
+ *
+ * @param colonnes Reçoit le nombre de colonnes.
+ * @param lignes Reçoit le nombre de lignes.
+ * @return false si la sortie standard n'est pas un terminal de taille connue
+ *         (les paramètres ne sont alors pas modifiés).
+ */
+bool tailleTerminal(int *colonnes, int *lignes)
+{
+    struct winsize taille;
+
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &taille) != 0 || taille.ws_col == 0 || taille.ws_row == 0)
+    {
+        return false;
+    }
+    *colonnes = taille.ws_col;
+    *lignes = taille.ws_row;
+    return true;
+}
+
+/**
+ * @brief Passe le terminal en mode jeu, en une seule écriture.
+ */
+static void entrerSession(void)
+{
+    if (attributs_sauves)
+    {
+        struct termios brut = attributs_origine;
+
+        brut.c_lflag &= ~(ICANON | ECHO | IEXTEN);
+        brut.c_iflag &= ~(IXON | ICRNL);
+        brut.c_cc[VMIN] = 1;
+        brut.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &brut);
+    }
+    if (sortie_terminal)
+    {
+        ssize_t ignore = write(STDOUT_FILENO, SEQUENCE_ENTREE, sizeof(SEQUENCE_ENTREE) - 1);
+        (void)ignore;
+    }
+    session_ouverte = 1;
+}
+
+/**
+ * @brief Remet l'écran normal, le curseur et les attributs d'origine.
+ */
+static void quitterSession(void)
+{
+    if (!session_ouverte)
+    {
+        return;
+    }
+    if (sortie_terminal)
+    {
+        ssize_t ignore = write(STDOUT_FILENO, SEQUENCE_SORTIE, sizeof(SEQUENCE_SORTIE) - 1);
+        (void)ignore;
+    }
+    if (attributs_sauves)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &attributs_origine);
+    }
+    session_ouverte = 0;
+}
+
+/**
+ * @brief Gestionnaire de SIGINT et SIGTERM.
+ *
+ * Restaure le terminal puis laisse le signal terminer le programme.
+ *
+ * @param numero_signal Numéro du signal reçu.
+ */
+static void gestionnaireArret(int numero_signal)
+{
+    quitterSession();
+    signal(numero_signal, SIG_DFL);
+    raise(numero_signal);
+}
+
+/**
+ * @brief Gestionnaire de SIGTSTP (Ctrl-Z).
+ *
+ * Restaure le terminal puis suspend le programme.
+ *
+ * @param numero_signal Numéro du signal reçu.
+ */
+static void gestionnaireSuspension(int numero_signal)
+{
+    quitterSession();
+    signal(numero_signal, SIG_DFL);
+    // Le signal est bloqué pendant le gestionnaire : la suspension a lieu au retour
+    raise(numero_signal);
+}
+
+/**
+ * @brief Gestionnaire de SIGCONT.
+ *
+ * Rouvre la session après une suspension.
+ *
+ * @param numero_signal Numéro du signal reçu.
+ */
+static void gestionnaireReprise(int numero_signal)
+{
+    (void)numero_signal;
+    installerGestionnaire(SIGTSTP, gestionnaireSuspension);
+    if (!session_ouverte)
+    {
+        entrerSession();
+        session_reprise = 1;
+    }
+}
+
+/**
+ * @brief Installe un gestionnaire de signal sans interrompre les appels système.
+ *
+ * @param numero_signal Numéro du signal.
+ * @param gestionnaire Gestionnaire à installer.
+ */
+static void installerGestionnaire(int numero_signal, void (*gestionnaire)(int))
+{
+    struct sigaction action;
+
+    action.sa_handler = gestionnaire;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(numero_signal, &action, NULL);
+}
@@ -0,0 +1,27 @@
+/**
+ * @file terminal.h
+ * @brief Session terminal du jeu Snake.
+ *
+ * Prépare le terminal sans lancer de commande externe : écran alternatif,
+ * curseur caché, écran effacé (en une seule écriture) et mode brut sans écho.
+ * Tout est restauré à la fin du jeu, à la sortie du programme et sur
+ * SIGINT, SIGTERM ou SIGTSTP.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef TERMINAL_H
+#define TERMINAL_H
+
+#include <stdbool.h>
+
+/* Déclaration des fonctions */
+void ouvrirSession(void);
+void fermerSession(void);
+bool sessionReprise(void);
+bool tailleTerminal(int *colonnes, int *lignes);
+
+#endif
@@ -0,0 +1,467 @@
+/**
+ * @file tournoi.c
+ * @brief Tournoi de pilotes automatiques sur les règles de la version 4.
+ *
+ * Chaque pilote joue la même série de parties : la partie numéro i utilise la
+ * graine (graine de base + i), donc les mêmes pavés et la même suite de
+ * pommes pour tous les pilotes. Les parties sont réparties sur tous les cœurs ;
+ * une partie terminée est recommencée pour la suivante (voir vivier.h).
+ *
+ * @details
+ * Utilisation : tournoi [-p parties] [-g graine] [-j threads] [-m tours_max] [-o pommes] [-e dossier] [-s scores] [-x export] [pilote...]
+ * - -p : nombre de parties par pilote (100 par défaut).
+ * - -g : graine de la première partie (1 par défaut).
+ * - -j : nombre de threads (nombre de cœurs par défaut) ; le pilote « mcts » partage
+ *   alors les cœurs entre les parties en cours (voir limiterThreadsMcts()).
+ * - -m : nombre maximal de tours par partie (20000 par défaut).
+ * - -o : pommes à manger pour gagner (objectif des règles par défaut, 0 : jusqu'à la collision
+ *   ou au maximum de tours, pour les parties d'endurance).
+ * - -e : enregistre chaque partie dans le dossier (fichiers pilote-graine.rejeu,
+ *   voir rejeu.h et relecture.c).
+ * - -s : ajoute le score de chaque partie au journal des scores (voir scores.h) ;
+ *   les threads y écrivent en même temps, d'autres processus aussi.
+ * - -x : compteurs des parties exportés au format Prometheus pendant le tournoi
+ *   (socket Unix, ou fichier se terminant par .prom ; voir metriques.h).
+ * - Sans pilote nommé, tous les pilotes disponibles participent ; un pilote qui
+ *   ne peut pas être créé (« neurone » sans fichier de poids) arrête le
+ *   tournoi s'il est nommé, et en est retiré sinon.
+ * - Les règles sont lues dans regles.conf ou $SNAKE_REGLES (voir regles.h) ;
+ *   une modification du fichier s'applique aux parties en cours, entre deux tours.
+ *
+ * Pour chaque pilote : taux de victoire, pommes et tours par partie, temps
+ * de décision moyen, 99e centile et maximum.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "jeu.h"
+#include "bots.h"
+#include "rejeu.h"
+#include "scores.h"
+#include "metriques.h"
+#include "regles.h"
+#include "vivier.h"
+#include "latence.h"
+
+/** @brief Résultat d'une partie. */
+typedef struct
+{
+    Issue issue;                        /**< Issue de la partie (PARTIE_EN_COURS si le maximum de tours est atteint). */
+    int pommes;                         /**< Pommes mangées. */
+    long tours;                         /**< Tours survécus. */
+    uint64_t decisions;                 /**< Nombre de décisions prises. */
+    uint64_t latence_totale;            /**< Somme des temps de décision en ns. */
+    uint64_t latence_max;               /**< Plus long temps de décision en ns. */
+    uint64_t histogramme[NOMBRE_CLASSES_LATENCE];  /**< Temps de décision par classe. */
+} Resultat;
+
+/** @brief Paramètres partagés par les threads du tournoi. */
+typedef struct
+{
+    const Strategie **pilotes;  /**< Pilotes en compétition. */
+    int nombre_pilotes;         /**< Nombre de pilotes. */
+    int parties;                /**< Parties par pilote. */
+    uint32_t graine;            /**< Graine de la première partie. */
+    long tours_max;             /**< Nombre maximal de tours par partie. */
+    int objectif_pommes;        /**< Pommes à manger pour gagner (0 : sans fin, -1 : selon les règles). */
+    const char *dossier_rejeux; /**< Dossier des enregistrements (NULL : aucun). */
+    Scores *scores;             /**< Journal des scores (NULL : aucun). */
+    Resultat *resultats;        /**< Résultats, pilote par pilote puis partie par partie. */
+    Vivier vivier;              /**< Parties terminées, recommencées pour les suivantes. */
+    atomic_int prochaine;       /**< Prochaine partie à jouer. */
+} Tournoi;
+
+static bool verifierPilotes(Tournoi *tournoi, bool nommes);
+static void *travailleur(void *argument);
+static void jouerPartie(Vivier *vivier, const Strategie *pilote, uint32_t graine, long tours_max,
+                        int objectif_pommes, const char *dossier_rejeux, Resultat *resultat);
+static void afficherResultats(const Tournoi *tournoi);
+
+/**
+ * @brief Lit les options, lance le tournoi et affiche le classement.
+ *
+ * @param argc Nombre d'arguments.
+ * @param argv Arguments.
+ * @return EXIT_SUCCESS, ou EXIT_FAILURE si les arguments sont invalides.
+ */
+int main(int argc, char *argv[])
+{
+    Tournoi tournoi;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    pthread_t *travailleurs;
+    int option;
+    Scores scores;
+    const char *chemin_scores = NULL;
+    const char *export_metriques = NULL;
+    uint64_t debut;
+    double duree;
+
+    tournoi.parties = 100;
+    tournoi.graine = 1;
+    tournoi.tours_max = 20000;
+    tournoi.objectif_pommes = -1;
+    tournoi.dossier_rejeux = NULL;
+    tournoi.scores = NULL;
+
+    while ((option = getopt(argc, argv, "p:g:j:m:o:e:s:x:")) != -1)
+    {
+        switch (option)
+        {
+            case 'p':
+                tournoi.parties = atoi(optarg);
+                break;
+            case 'g':
+                tournoi.graine = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+            case 'j':
+                threads = atol(optarg);
+                break;
+            case 'm':
+                tournoi.tours_max = atol(optarg);
+                break;
+            case 'o':
+                tournoi.objectif_pommes = atoi(optarg);
+                if (tournoi.objectif_pommes < 0)
+                {
+                    fprintf(stderr, "%s : les nombres doivent être positifs\n", argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'e':
+                tournoi.dossier_rejeux = optarg;
+                break;
+            case 's':
+                chemin_scores = optarg;
+                break;
+            case 'x':
+                export_metriques = optarg;
+                break;
+            default:
+                fprintf(stderr, "Utilisation : %s [-p parties] [-g graine] [-j threads] [-m tours_max] [-o pommes] [-e dossier] [-s scores] [-x export] [pilote...]\n", argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+    if (tournoi.parties <= 0 || threads <= 0 || tournoi.tours_max <= 0)
+    {
+        fprintf(stderr, "%s : les nombres doivent être positifs\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Pilotes nommés sur la ligne de commande, ou tous les pilotes
+    tournoi.nombre_pilotes = (optind < argc) ? argc - optind : NOMBRE_STRATEGIES;
+    tournoi.pilotes = malloc(tournoi.nombre_pilotes * sizeof(Strategie *));
+    for (int i = 0; i < tournoi.nombre_pilotes; i++)
+    {
+        tournoi.pilotes[i] = (optind < argc) ? trouverStrategie(argv[optind + i]) : &STRATEGIES[i];
+        if (tournoi.pilotes[i] == NULL)
+        {
+            fprintf(stderr, "%s : pilote inconnu « %s »\n", argv[0], argv[optind + i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    tournoi.resultats = calloc((size_t)tournoi.nombre_pilotes * tournoi.parties, sizeof(Resultat));
+    travailleurs = malloc(threads * sizeof(pthread_t));
+    if (tournoi.resultats == NULL || travailleurs == NULL)
+    {
+        perror("malloc");
+        return EXIT_FAILURE;
+    }
+    atomic_init(&tournoi.prochaine, 0);
+    ouvrirVivier(&tournoi.vivier);
+    if (!chargerRegles(cheminRegles()) || !verifierPilotes(&tournoi, optind < argc))
+    {
+        return EXIT_FAILURE;
+    }
+    surveillerRegles(cheminRegles(), stderr);
+    if (export_metriques != NULL && !demarrerMetriques(export_metriques))
+    {
+        return EXIT_FAILURE;
+    }
+    if (chemin_scores != NULL)
+    {
+        if (!ouvrirScores(&scores, chemin_scores))
+        {
+            return EXIT_FAILURE;
+        }
+        tournoi.scores = &scores;
+    }
+
+    // Chaque partie en cours n'a que sa part des cœurs pour ses propres threads
+    limiterThreadsMcts((int)threads);
+    debut = instantPresent();
+    for (long i = 0; i < threads; i++)
+    {
+        pthread_create(&travailleurs[i], NULL, travailleur, &tournoi);
+    }
+    for (long i = 0; i < threads; i++)
+    {
+        pthread_join(travailleurs[i], NULL);
+    }
+    duree = (instantPresent() - debut) / 1e9;
+    arreterMetriques();
+    arreterSurveillance();
+
+    printf("%d parties par pilote, graines %u à %u, %ld threads\n",
+           tournoi.parties, tournoi.graine, tournoi.graine + tournoi.parties - 1, threads);
+    printf("%d parties en %.2f s (%.0f parties par seconde, %ld parties allouées)\n\n",
+           tournoi.nombre_pilotes * tournoi.parties, duree, tournoi.nombre_pilotes * tournoi.parties / duree,
+           tournoi.vivier.creees);
+    afficherResultats(&tournoi);
+    if (tournoi.scores != NULL)
+    {
+        Score meilleur;
+
+        if (meilleursScores(&scores, &meilleur, 1) == 1)
+        {
+            printf("\nMeilleur score de %s : %s, %d pommes en %ld tours (graine %u)\n", chemin_scores,
+                   meilleur.nom, meilleur.pommes, (long)meilleur.tours, meilleur.graine);
+        }
+        if (scores.ignores > 0)
+        {
+            printf("%ld enregistrements invalides ignorés\n", scores.ignores);
+        }
+        fermerScores(&scores);
+    }
+
+    fermerVivier(&tournoi.vivier);
+    free(travailleurs);
+    free(tournoi.resultats);
+    free(tournoi.pilotes);
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Crée chaque pilote une fois avant le tournoi.
+ *
+ * Un pilote qui ne peut pas être créé (par exemple « neurone » sans fichier
+ * de poids) arrête le tournoi s'il a été nommé, et en est retiré sinon.
+ *
+ * @param tournoi Le tournoi, dont la liste des pilotes peut être réduite.
+ * @param nommes true si les pilotes ont été nommés sur la ligne de commande.
+ * @return true si le tournoi peut commencer.
+ */
+static bool verifierPilotes(Tournoi *tournoi, bool nommes)
+{
+    Partie *partie = prendrePartie(&tournoi->vivier, tournoi->graine);
+    int retenus = 0;
+
+    for (int i = 0; i < tournoi->nombre_pilotes; i++)
+    {
+        const Strategie *pilote = tournoi->pilotes[i];
+        void *contexte = (pilote->creer != NULL) ? pilote->creer(partie) : NULL;
+
+        if (pilote->creer != NULL && contexte == NULL)
+        {
+            if (nommes)
+            {
+                rendrePartie(&tournoi->vivier, partie);
+                return false;
+            }
+            fprintf(stderr, "Pilote « %s » retiré du tournoi\n", pilote->nom);
+            continue;
+        }
+        if (pilote->detruire != NULL)
+        {
+            pilote->detruire(contexte);
+        }
+        tournoi->pilotes[retenus++] = pilote;
+    }
+    tournoi->nombre_pilotes = retenus;
+    rendrePartie(&tournoi->vivier, partie);
+    return true;
+}
+
+/**
+ * @brief Boucle d'un thread : prend les parties une à une jusqu'à la dernière.
+ *
+ * @param argument Le tournoi.
+ * @return NULL.
+ */
+static void *travailleur(void *argument)
+{
+    Tournoi *tournoi = argument;
+    int total = tournoi->nombre_pilotes * tournoi->parties;
+    int numero;
+
+    while ((numero = atomic_fetch_add(&tournoi->prochaine, 1)) < total)
+    {
+        int pilote = numero / tournoi->parties;
+        int partie = numero % tournoi->parties;
+
+        jouerPartie(&tournoi->vivier, tournoi->pilotes[pilote], tournoi->graine + partie, tournoi->tours_max,
+                    tournoi->objectif_pommes, tournoi->dossier_rejeux, &tournoi->resultats[numero]);
+        if (tournoi->scores != NULL)
+        {
+            Score score;
+
+            memset(&score, 0, sizeof(score));
+            score.date = (uint64_t)time(NULL);
+            score.tours = tournoi->resultats[numero].tours;
+            score.graine = tournoi->graine + partie;
+            score.pommes = tournoi->resultats[numero].pommes;
+            score.issue = tournoi->resultats[numero].issue;
+            snprintf(score.nom, sizeof(score.nom), "%s", tournoi->pilotes[pilote]->nom);
+            if (!ajouterScore(tournoi->scores, &score))
+            {
+                fprintf(stderr, "Score de la partie %u non enregistré\n", score.graine);
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Joue une partie complète avec un pilote.
+ *
+ * Les directions interdites (demi-tour) sont ignorées, comme au clavier.
+ *
+ * @param vivier Vivier d'où vient la partie et où elle retourne.
+ * @param pilote Le pilote.
+ * @param graine Graine de la partie.
+ * @param tours_max Nombre maximal de tours.
+ * @param objectif_pommes Pommes à manger pour gagner (0 : sans fin, -1 : selon les règles).
+ * @param dossier_rejeux Dossier où enregistrer la partie (NULL : aucun enregistrement).
+ * @param resultat Reçoit le résultat de la partie.
+ */
+static void jouerPartie(Vivier *vivier, const Strategie *pilote, uint32_t graine, long tours_max,
+                        int objectif_pommes, const char *dossier_rejeux, Resultat *resultat)
+{
+    Partie *partie = prendrePartie(vivier, graine);
+    Issue issue = PARTIE_EN_COURS;
+    bool pomme_mangee;
+    void *contexte;
+    Enregistreur enregistreur;
+    bool enregistrement = false;
+
+    if (objectif_pommes >= 0)
+    {
+        partie->objectif_pommes = objectif_pommes;
+    }
+    contexte = (pilote->creer != NULL) ? pilote->creer(partie) : NULL;
+    if (pilote->creer != NULL && contexte == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+    if (dossier_rejeux != NULL)
+    {
+        char chemin[4096];
+
+        snprintf(chemin, sizeof(chemin), "%s/%s-%u.rejeu", dossier_rejeux, pilote->nom, graine);
+        enregistrement = ouvrirEnregistrement(&enregistreur, chemin, partie, graine, 0);
+    }
+
+    while (issue == PARTIE_EN_COURS && partie->tour < tours_max)
+    {
+        const Regles *regles = reglesCourantes();
+        uint64_t debut;
+        char direction;
+        uint64_t latence;
+
+        // Règles rechargées depuis le tour précédent
+        if (regles != partie->regles)
+        {
+            appliquerRegles(partie, regles);
+        }
+        debut = instantPresent();
+        direction = pilote->choisir(partie, contexte);
+        latence = instantPresent() - debut;
+
+        resultat->decisions++;
+        resultat->latence_totale += latence;
+        if (latence > resultat->latence_max)
+        {
+            resultat->latence_max = latence;
+        }
+        resultat->histogramme[classeLatence(latence)]++;
+
+        if (!directionAutorisee(partie->direction, direction))
+        {
+            direction = partie->direction;
+        }
+        if (enregistrement && !enregistrerTour(&enregistreur, partie, direction))
+        {
+            fprintf(stderr, "Enregistrement de la partie %u interrompu\n", graine);
+            fermerEnregistrement(&enregistreur, partie, issue);
+            enregistrement = false;
+        }
+        issue = jouerTour(partie, direction, &pomme_mangee);
+        compterTour(partie, issue, pomme_mangee);
+    }
+    if (enregistrement)
+    {
+        fermerEnregistrement(&enregistreur, partie, issue);
+    }
+
+    resultat->issue = issue;
+    resultat->pommes = partie->pommes_mangees;
+    resultat->tours = partie->tour;
+
+    if (pilote->detruire != NULL)
+    {
+        pilote->detruire(contexte);
+    }
+    rendrePartie(vivier, partie);
+}
+
+/**
+ * @brief Agrège et affiche les résultats de chaque pilote.
+ *
+ * @param tournoi Le tournoi terminé.
+ */
+static void afficherResultats(const Tournoi *tournoi)
+{
+    printf("%-10s %10s %14s %14s %12s %12s %12s\n", "Pilote", "Victoires",
+           "Pommes/partie", "Tours/partie", "Décision", "p99 <", "max");
+
+    for (int p = 0; p < tournoi->nombre_pilotes; p++)
+    {
+        const Resultat *resultats = &tournoi->resultats[(size_t)p * tournoi->parties];
+        uint64_t histogramme[NOMBRE_CLASSES_LATENCE] = {0};
+        uint64_t decisions = 0, latence_totale = 0, latence_max = 0, cumul = 0;
+        long victoires = 0, pommes = 0, tours = 0;
+        int centile = 0;
+
+        for (int i = 0; i < tournoi->parties; i++)
+        {
+            victoires += (resultats[i].issue == PARTIE_GAGNEE);
+            pommes += resultats[i].pommes;
+            tours += resultats[i].tours;
+            decisions += resultats[i].decisions;
+            latence_totale += resultats[i].latence_totale;
+            if (resultats[i].latence_max > latence_max)
+            {
+                latence_max = resultats[i].latence_max;
+            }
+            for (int c = 0; c < NOMBRE_CLASSES_LATENCE; c++)
+            {
+                histogramme[c] += resultats[i].histogramme[c];
+            }
+        }
+        while (centile < NOMBRE_CLASSES_LATENCE - 1 && (cumul += histogramme[centile]) * 100 < decisions * 99)
+        {
+            centile++;
+        }
+
+        printf("%-10s %9.1f%% %14.2f %14.1f %9.2f µs %9.2f µs %9.2f µs\n",
+               tournoi->pilotes[p]->nom,
+               100.0 * victoires / tournoi->parties,
+               (double)pommes / tournoi->parties,
+               (double)tours / tournoi->parties,
+               decisions ? latence_totale / 1000.0 / decisions : 0.0,
+               (double)(2ull << centile) / 1000.0,
+               latence_max / 1000.0);
+    }
+}
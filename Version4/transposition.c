@@ -0,0 +1,128 @@
+/**
+ * @file transposition.c
+ * @brief Table de transposition sans verrou.
+ *
+ * @details
+ * - Une position est rangée dans l'entrée (empreinte & masque) ; une nouvelle
+ *   position remplace toujours l'ancienne.
+ * - Les lectures et écritures sont des accès atomiques relâchés de 64 bits :
+ *   aucun thread n'attend jamais un autre. La cohérence d'une entrée est
+ *   vérifiée par le contrôle (empreinte ^ donnée).
+ * - Une entrée vide (contrôle et donnée nuls) passerait pour la donnée 0 de
+ *   l'empreinte 0 : l'empreinte 0 est rangée sous une clé non nulle, qu'elle
+ *   partage avec l'empreinte égale à cette clé (une chance sur 2^64).
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdlib.h>
+
+#include "transposition.h"
+
+#define CLE_EMPREINTE_NULLE 0x9E3779B97F4A7C15ull   /**< Clé de l'empreinte 0 (voir cleTable()). */
+
+static uint64_t cleTable(uint64_t empreinte);
+
+/**
+ * @brief Alloue une table vide.
+ *
+ * @param table Table à créer.
+ * @param entrees Nombre d'entrées souhaité (arrondi à la puissance de 2 supérieure).
+ * @return true si l'allocation a réussi.
+ */
+bool creerTable(TableTransposition *table, size_t entrees)
+{
+    size_t taille = 1;
+
+    while (taille < entrees)
+    {
+        taille <<= 1;
+    }
+    table->entrees = calloc(taille, sizeof(EntreeTransposition));
+    table->masque = taille - 1;
+    return table->entrees != NULL;
+}
+
+/**
+ * @brief Libère la table.
+ *
+ * @param table Table à détruire.
+ */
+void detruireTable(TableTransposition *table)
+{
+    free(table->entrees);
+    table->entrees = NULL;
+    table->masque = 0;
+}
+
+/**
+ * @brief Efface toutes les entrées (aucune recherche ne doit être en cours).
+ *
+ * @param table La table.
+ */
+void viderTable(TableTransposition *table)
+{
+    for (size_t i = 0; i <= table->masque; i++)
+    {
+        atomic_store_explicit(&table->entrees[i].controle, 0, memory_order_relaxed);
+        atomic_store_explicit(&table->entrees[i].donnee, 0, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Enregistre la donnée d'une position.
+ *
+ * @param table La table.
+ * @param empreinte Empreinte de la position.
+ * @param donnee Donnée à enregistrer.
+ */
+void enregistrerPosition(TableTransposition *table, uint64_t empreinte, uint64_t donnee)
+{
+    EntreeTransposition *entree;
+
+    empreinte = cleTable(empreinte);
+    entree = &table->entrees[empreinte & table->masque];
+    atomic_store_explicit(&entree->controle, empreinte ^ donnee, memory_order_relaxed);
+    atomic_store_explicit(&entree->donnee, donnee, memory_order_relaxed);
+}
+
+/**
+ * @brief Cherche la donnée d'une position.
+ *
+ * @param table La table.
+ * @param empreinte Empreinte de la position.
+ * @param donnee Reçoit la donnée si la position est trouvée.
+ * @return true si la position est dans la table.
+ */
+bool lirePosition(TableTransposition *table, uint64_t empreinte, uint64_t *donnee)
+{
+    EntreeTransposition *entree;
+    uint64_t valeur, controle;
+
+    empreinte = cleTable(empreinte);
+    entree = &table->entrees[empreinte & table->masque];
+    valeur = atomic_load_explicit(&entree->donnee, memory_order_relaxed);
+    controle = atomic_load_explicit(&entree->controle, memory_order_relaxed);
+
+    if ((controle ^ valeur) != empreinte)
+    {
+        return false;
+    }
+    *donnee = valeur;
+    return true;
+}
+
+/**
+ * @brief Clé sous laquelle une empreinte est rangée : jamais nulle.
+ *
+ * @param empreinte Empreinte de la position.
+ * @return L'empreinte, ou CLE_EMPREINTE_NULLE pour l'empreinte 0.
+ */
+static uint64_t cleTable(uint64_t empreinte)
+{
+    return (empreinte != 0) ? empreinte : CLE_EMPREINTE_NULLE;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file transposition.h
+ * @brief Table de transposition sans verrou, indexée par l'empreinte de Zobrist.
+ *
+ * La table a une taille fixe (puissance de 2) et peut être partagée par
+ * plusieurs threads de recherche sans aucun verrou : chaque entrée garde la
+ * donnée et l'empreinte combinée à la donnée par un ou exclusif. Une entrée
+ * écrite à moitié par un autre thread ne correspond plus à l'empreinte et
+ * est simplement ignorée à la lecture.
+ *
+ * La donnée est un entier de 64 bits dont le sens est laissé à l'appelant
+ * (score, nombre de visites, meilleur coup...).
+ *
+ * L'empreinte de Zobrist d'une partie (voir calculerEmpreinte()) couvre le
+ * corps segment par segment, les objets, les murs et la direction, mais pas
+ * le générateur : deux parties de même empreinte peuvent voir apparaître des
+ * pommes différentes. Un appelant qui veut séparer des recherches sans vider
+ * la table combine l'empreinte à un sel par un ou exclusif.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef TRANSPOSITION_H
+#define TRANSPOSITION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+/** @brief Entrée de la table. */
+typedef struct
+{
+    _Atomic uint64_t controle;  /**< Empreinte ^ donnée. */
+    _Atomic uint64_t donnee;    /**< Donnée enregistrée. */
+} EntreeTransposition;
+
+/** @brief Table de transposition. */
+typedef struct
+{
+    EntreeTransposition *entrees;   /**< Entrées de la table. */
+    size_t masque;                  /**< Nombre d'entrées - 1. */
+} TableTransposition;
+
+/* Déclaration des fonctions */
+bool creerTable(TableTransposition *table, size_t entrees);
+void detruireTable(TableTransposition *table);
+void viderTable(TableTransposition *table);
+void enregistrerPosition(TableTransposition *table, uint64_t empreinte, uint64_t donnee);
+bool lirePosition(TableTransposition *table, uint64_t empreinte, uint64_t *donnee);
+
+#endif
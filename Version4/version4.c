@@ -9,9 +9,44 @@
  *
  * @details
  * - Déplacement avec les touches : 'z' (haut), 'q' (gauche), 's' (bas), 'd' (droite).
+ * - Option -u : habillage Unicode en couleur (bordures reliées, serpent et pomme colorés).
+ * - Option -l : latence de chaque touche jusqu'à l'écran, affichée sous le plateau
+ *   et résumée en fin de partie (attente du tour, logique, sortie ; voir latence.h).
+ * - Option -b pilote : le serpent est conduit par un pilote automatique (voir bots.h),
+ *   la touche 'a' arrête toujours le jeu. Le jeu ne démarre pas si le pilote ne
+ *   peut pas être créé (« neurone » sans fichier de poids).
+ * - Chaque partie terminée est ajoutée au journal des scores (voir scores.h),
+ *   au nom du joueur ($USER) ou du pilote. Option -c : affiche le classement et quitte.
+ * - Une partie perdue ou gagnée laisse son issue au milieu de l'écran : une touche
+ *   en recommence une autre (graine suivante) sans quitter le jeu, la touche
+ *   d'arrêt quitte. Seules les cases touchées sont remises à neuf (voir
+ *   recommencerPartie()) et seules celles qui diffèrent de l'écran sont
+ *   renvoyées au terminal. Option -r parties : enchaîne ce nombre de parties
+ *   sans attendre de touche, puis quitte (0 : sans fin), pour les essais
+ *   d'endurance ; la durée moyenne d'un recommencement est affichée à la fin.
+ * - Les règles (vitesse, accélération, objectif, plateau, pavés, touches) sont lues
+ *   dans regles.conf ou $SNAKE_REGLES (voir regles.h) ; une modification du fichier
+ *   pendant la partie est prise en compte au tour suivant. Les erreurs d'une
+ *   relecture sont gardées dans un fichier temporaire et affichées à la sortie du
+ *   jeu, une fois le terminal rendu.
+ * - Option -x chemin : compteurs du jeu (tours, pommes, collisions, images, retards)
+ *   exportés au format Prometheus sur une socket Unix ou dans un fichier .prom
+ *   (voir metriques.h).
+ * - Option -i nom : état de la partie publié après chaque tour dans le segment de
+ *   mémoire partagée POSIX « nom », lisible sans verrou par des outils externes
+ *   (voir instantane.h et observateur.c).
  * - Une pomme apparaît aléatoirement sur le plateau et accélère le jeu lorsqu'elle est mangée.
  * - Le jeu se termine lorsque le serpent heurte un mur, un obstacle, ou lui-même.
  * - Les bordures et des pavés (obstacles fixes) rendent le jeu plus difficile.
+ * - Les règles sont appliquées par le moteur (voir moteur.c), partagé avec le tournoi.
+ * - Le terminal est préparé et restauré sans commande externe (voir terminal.c).
+ * - Les tours suivent des échéances absolues : le temps passé en logique ou
+ *   en affichage ne ralentit pas le jeu.
+ * - L'affichage est confié à un thread de rendu (voir rendu.c) : la boucle de jeu
+ *   ne fait que composer et publier des images, sans jamais attendre le terminal.
+ * - Un plateau plus grand que le terminal est vu à travers une caméra qui suit la
+ *   tête : quand elle se déplace, l'écran défile et seules les bandes découvertes
+ *   sont redessinées. La taille du terminal est relue à chaque SIGWINCH.
  *
  * @author
  * Le Chevère Yannis
@@ -23,66 +58,61 @@
 /* Déclaration des fichiers inclus */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
-#include <fcntl.h>
-#include <termios.h>
+#include <poll.h>
 #include <stdbool.h>
 #include <time.h>
+#include <signal.h>
+#include <errno.h>
+
+#include "jeu.h"
+#include "bots.h"
+#include "rendu.h"
+#include "terminal.h"
+#include "scores.h"
+#include "metriques.h"
+#include "regles.h"
+#include "instantane.h"
+
+#define SCORES_AFFICHES 10      /**< Nombre de scores du classement affichés. */
+#define TAILLE_MESSAGE 80       /**< Taille maximale du message de fin de partie. */
+#define ATTENTE_REJOUER 100     /**< Intervalle (ms) de surveillance du terminal en fin de partie. */
+
+/** @brief Partie du plateau visible dans le terminal. */
+typedef struct
+{
+    int x;          /**< Colonne du plateau au bord gauche de l'écran. */
+    int y;          /**< Ligne du plateau au bord haut de l'écran. */
+    int largeur;    /**< Nombre de colonnes visibles. */
+    int hauteur;    /**< Nombre de lignes visibles. */
+} Camera;
 
-/*
- * @defgroup Constante du jeu
- * @{
- */
-#define TRUE  1             /**< Variable pour vrai. */
-#define FALSE  0            /**< Variable pour faut. */
-#define HAUT 'z'            /**< Touche pour déplacer le serpent vers le haut. */
-#define DROITE 'd'          /**< Touche pour déplacer le serpent à droite. */
-#define BAS 's'             /**< Touche pour déplacer le serpent vers le bas. */
-#define GAUCHE 'q'          /**< Touche pour déplacer le serpent à gauche. */
-#define TAILLE_SERPENT 10   /**< Taille du serpent. */
-#define TAILLE_MAX_SERPENT (TAILLE_SERPENT + OBJECTIF_POMMES)   /**< Définition du tableau plateau */
-#define LARGEUR_PLATEAU 80  /**< Largeur maximale du plateau. */ 
-#define HAUTEUR_PLATEAU 40  /**< Longueur maximale du plateau. */   
-
-/** Définitions des constantes */
-const char COTE_BORDURE = '#';          /**< Caractère utilisé pour afficher les bordures et pavés. */
-const char POMME = '6';                 /**< Caractère qui représente une pomme. */
-const int ACCELERATION = 15000;         /**< Vitesse pour diminuer l'acceleration. */
-const char STOP_JEU = 'a';              /**< Touche pour arrêter le jeu. */
-const char CORPS = 'X';                 /**< Caractère qui représente le corps du serpent. */
-const char TETE = 'O';                  /**< Caractère qui représente la tête du serpent. */
-const char VIDE = ' ';                  /**< Caractère qui représente une case vide. */
-const int COORD_DEPART_X_SERPENT = 40;  /**< Position de départ en X du serpent. */
-const int COORD_DEPART_Y_SERPENT = 20;  /**< Position de départ en Y du serpent. */
-const int VITESSE_JEU = 200000;         /**< Temporisation entre les déplacements en microsecondes. */
-const int NOMBRES_PAVES = 4;            /**< Nombre de pavés à placer sur le plateau. */
-const int TAILLE_PAVE = 5;              /**< Taille des pavés (carrés). */
-const int OBJECTIF_POMMES = 10;         /**< Nombre de pomme au total pour les manger. */
-/*! @} */
-
-// Variables globales
-int vitesse_actuelle;
-int taille_serpent;
-
-/** @typedef Plateau_de_jeu
-* @brief Définition du plateau de jeu comme une matrice de caractères.
-*/
-typedef char plateauGlobale[HAUTEUR_PLATEAU][LARGEUR_PLATEAU];
-plateauGlobale plateauJeu;
+/** Positionné par le signal SIGWINCH lorsque le terminal change de taille. */
+volatile sig_atomic_t terminal_redimensionne = FALSE;
+/** Partie du plateau affichée. */
+Camera camera;
 
 /* Déclaration des fonctions */
 void afficher(int x, int y, char c);
 void effacer(int x, int y);
-void dessinerSerpent(int lesX[], int lesY[]);
-void progresser(int lesX[], int lesY[], char direction, bool *collision, bool *pomme_mangee);
-void initPlateau(char plateau[HAUTEUR_PLATEAU][LARGEUR_PLATEAU]);
-void dessinerPlateau(char plateau[HAUTEUR_PLATEAU][LARGEUR_PLATEAU]);
-void placerPaves(char plateau[HAUTEUR_PLATEAU][LARGEUR_PLATEAU]);
-void ajouterPomme(char plateau[HAUTEUR_PLATEAU][LARGEUR_PLATEAU]);
-void gotoXY(int x, int y);
+void dessinerProgression(const Partie *partie, Segment ancienne_queue);
+void dessinerPaves(const Partie *partie);
+void dessinerObjets(const Partie *partie);
+void dessinerPlateau(const Partie *partie);
+void dessinerZone(const Partie *partie, int x_debut, int y_debut, int x_fin, int y_fin);
+void cadrerCamera(const Partie *partie, bool latence);
+void suivreTete(const Partie *partie);
+int suivreAxe(int origine, int visible, int taille, int position);
+void signalerRedimensionnement(int numero_signal);
+void attendreTour(uint64_t echeance, uint64_t *arrivee_touche);
 int kbhit();
-void disableEcho();
-void enableEcho();
+void afficherIssue(const Partie *partie, Issue issue);
+bool attendreRejouer(const Partie *partie, Issue issue, bool latence);
+void recommencer(Partie *partie, uint32_t graine, bool latence);
+void enregistrerScore(const Partie *partie, uint32_t graine, Issue issue, const char *nom);
+void afficherClassement(Scores *scores);
+void afficherErreursRegles(FILE *erreurs);
 
 /**
  * @brief Fonction principale du jeu.
@@ -91,112 +121,290 @@ void enableEcho();
  * et les conditions de fin de jeu. Met à jour le plateau et le serpent 
  * à chaque itération.
  *
+ * @param argc Nombre d'arguments.
+ * @param argv Arguments (options du jeu).
  * @return Retourne EXIT_SUCCESS après l'arrêt du jeu.
  */
-int main()
+int main(int argc, char *argv[])
 {
-    int lesX[TAILLE_MAX_SERPENT], lesY[TAILLE_MAX_SERPENT];
+    Partie partie;
+    bool unicode = false;
+    bool latence = false;
+    uint64_t touche_lue = 0;
+    uint64_t arrivee_touche = 0;
+    uint64_t prochain_tour;
+    const Strategie *pilote = NULL;
+    void *contexte_pilote = NULL;
+    int option;
+    Issue issue = PARTIE_EN_COURS;
     char direction = DROITE;
     int condition_arret = TRUE;
-    bool collision = false;
     bool pomme_mangee = false;
-    int pommes_mangees = 0;
-    
-    // Initialisation de la vitesse et de la taille
-    vitesse_actuelle = VITESSE_JEU;
-    taille_serpent = TAILLE_SERPENT;
-
-    // Initialisation du serpent
-    for (int i = 0; i < taille_serpent; i++)
+    uint32_t graine = (uint32_t)time(NULL);
+    Scores scores;
+    const char *export_metriques = NULL;
+    const char *instantane = NULL;
+    FILE *erreurs_regles;
+    long parties_enchainees = -1;
+    long parties = 1, parties_terminees = 0;
+    uint64_t duree_recommencements = 0;
+
+    while ((option = getopt(argc, argv, "ulcb:x:i:r:")) != -1)
+    {
+        if (option == 'u')
+        {
+            unicode = true;
+        }
+        else if (option == 'l')
+        {
+            latence = true;
+        }
+        else if (option == 'c')
+        {
+            if (!ouvrirScores(&scores, cheminScores()))
+            {
+                return EXIT_FAILURE;
+            }
+            afficherClassement(&scores);
+            fermerScores(&scores);
+            return EXIT_SUCCESS;
+        }
+        else if (option == 'b' && (pilote = trouverStrategie(optarg)) != NULL)
+        {
+            continue;
+        }
+        else if (option == 'x')
+        {
+            export_metriques = optarg;
+        }
+        else if (option == 'i')
+        {
+            instantane = optarg;
+        }
+        else if (option == 'r' && (parties_enchainees = atol(optarg)) >= 0)
+        {
+            continue;
+        }
+        else
+        {
+            fprintf(stderr, "Utilisation : %s [-u] [-l] [-c] [-b pilote] [-x export] [-i instantane] [-r parties]\n",
+                    argv[0]);
+            fprintf(stderr, "Pilotes :");
+            for (int i = 0; i < NOMBRE_STRATEGIES; i++)
+            {
+                fprintf(stderr, " %s", STRATEGIES[i].nom);
+            }
+            fprintf(stderr, "\n");
+            return EXIT_FAILURE;
+        }
+    }
+    if (!chargerRegles(cheminRegles()))
+    {
+        return EXIT_FAILURE;
+    }
+    if (export_metriques != NULL && !demarrerMetriques(export_metriques))
     {
-        lesX[i] = (COORD_DEPART_X_SERPENT - i);
-        lesY[i] = COORD_DEPART_Y_SERPENT;
+        return EXIT_FAILURE;
     }
     
-    system("clear");
-    disableEcho();
-    srand(time(NULL));
+    // Plateau, pavés, serpent et première pomme (la taille du plateau ne change qu'en recommençant)
+    creerPartie(&partie, graine);
+    if (instantane != NULL && !demarrerInstantane(instantane, &partie))
+    {
+        arreterMetriques();
+        return EXIT_FAILURE;
+    }
+    // Pilote créé avant de prendre le terminal : son erreur reste lisible
+    if (pilote != NULL && pilote->creer != NULL &&
+        (contexte_pilote = pilote->creer(&partie)) == NULL)
+    {
+        arreterInstantane();
+        arreterMetriques();
+        detruirePartie(&partie);
+        return EXIT_FAILURE;
+    }
+    // Le terminal appartient au rendu : les erreurs de relecture attendent la fin du jeu
+    erreurs_regles = tmpfile();
+    surveillerRegles(cheminRegles(), (erreurs_regles != NULL) ? erreurs_regles : stderr);
+    ouvrirSession();
+    cadrerCamera(&partie, latence);
+    demarrerRendu(camera.largeur, camera.hauteur, unicode, latence);
+    placerCamera(camera.x, camera.y);
+    signal(SIGWINCH, signalerRedimensionnement);
     
-    initPlateau(plateauJeu);
-    placerPaves(plateauJeu);
-    ajouterPomme(plateauJeu);
-    dessinerPlateau(plateauJeu);
-    dessinerSerpent(lesX, lesY);
+    dessinerPlateau(&partie);
+    publierImage();
+    prochain_tour = instantPresent();
 
     while (condition_arret == TRUE) {
+        const Regles *regles = reglesCourantes();
+
+        // Règles rechargées depuis le tour précédent
+        if (regles != partie.regles)
+        {
+            appliquerRegles(&partie, regles);
+        }
         if (kbhit() == TRUE)
         {
-            char touche_taper = getchar();
-            if (touche_taper == STOP_JEU)
+            char commande = commandeTouche(partie.regles, (char)getchar());
+            // Une touche arrivée pendant l'attente est datée de son arrivée
+            uint64_t instant_touche = (arrivee_touche != 0) ? arrivee_touche : instantPresent();
+
+            arrivee_touche = 0;
+            if (commande == STOP_JEU)
             {
                 condition_arret = FALSE;// Arrête le jeu
-                system("clear");
             }
             // Mise à jour de la direction selon l'entrée
-            else if ((touche_taper == HAUT) && (direction != BAS))
+            else if (commande != 0 && directionAutorisee(direction, commande))
             {
-                direction = HAUT;
+                direction = commande;
+                // La plus ancienne touche non encore jouée est mesurée
+                if (touche_lue == 0)
+                {
+                    touche_lue = instant_touche;
+                }
             }
-            else if ((touche_taper == DROITE) && (direction != GAUCHE))
+        }
+        if (condition_arret == FALSE)
+        {
+            break;
+        }
+        if (pilote != NULL)
+        {
+            direction = pilote->choisir(&partie, contexte_pilote);
+        }
+        
+        uint64_t debut_tour = instantPresent();
+        Segment queue = queueSerpent(&partie.serpent);
+        issue = jouerTour(&partie, direction, &pomme_mangee);
+        compterTour(&partie, issue, pomme_mangee);
+        publierInstantane(&partie, issue);
+
+        if (terminal_redimensionne || sessionReprise())
+        {
+            // Seuls cas, avec le démarrage, où tout est redessiné
+            if (terminal_redimensionne)
             {
-                direction = DROITE;
+                terminal_redimensionne = FALSE;
+                cadrerCamera(&partie, latence);
+                redimensionnerRendu(camera.largeur, camera.hauteur);
+                placerCamera(camera.x, camera.y);
             }
-            else if ((touche_taper == BAS) && (direction != HAUT))
+            dessinerPlateau(&partie);
+            redessinerTout();
+        }
+        else if (issue != PARTIE_PERDUE)
+        {
+            suivreTete(&partie);
+            dessinerProgression(&partie, queue);
+            dessinerPaves(&partie);
+            dessinerObjets(&partie);
+        }
+
+        if (touche_lue != 0)
+        {
+            horodaterImage(touche_lue, debut_tour);
+            touche_lue = 0;
+        }
+        publierImage();
+
+        if (issue != PARTIE_EN_COURS)
+        {
+            enregistrerScore(&partie, graine, issue, pilote != NULL ? pilote->nom : getenv("USER"));
+            parties_terminees++;
+            if (parties == parties_enchainees ||
+                (parties_enchainees < 0 && !attendreRejouer(&partie, issue, latence)))
             {
-                direction = BAS;
+                break;
             }
-            else if ((touche_taper == GAUCHE) && (direction != DROITE))
+            if (pilote != NULL && pilote->detruire != NULL)
             {
-                direction = GAUCHE;
+                pilote->detruire(contexte_pilote);
             }
-        }
-        
-        effacer(lesX[taille_serpent - 1], lesY[taille_serpent - 1]);
-        progresser(lesX, lesY, direction, &collision, &pomme_mangee);
-
-        if (pomme_mangee)
-        {
-            pommes_mangees++;
-            ajouterPomme(plateauJeu);
-            // Accélération du jeu et croissance du serpent
-            vitesse_actuelle = vitesse_actuelle - (pomme_mangee * ACCELERATION) ;
-            taille_serpent++;
-            
-            if (pommes_mangees >= OBJECTIF_POMMES)
+            uint64_t debut_recommencement = instantPresent();
+            recommencer(&partie, ++graine, latence);
+            duree_recommencements += instantPresent() - debut_recommencement;
+            parties++;
+            if (pilote != NULL && pilote->creer != NULL &&
+                (contexte_pilote = pilote->creer(&partie)) == NULL)
             {
-                system("clear");
-                printf("Félicitations ! Vous avez gagné en mangeant %d pommes !\n", pommes_mangees);
-                condition_arret = FALSE;
+                pilote = NULL;
+                break;
             }
+            direction = partie.direction;
+            issue = PARTIE_EN_COURS;
+            arrivee_touche = 0;
+            prochain_tour = instantPresent();
+            continue;
         }
-
-        if (collision) 
+        // Échéances absolues : ni la logique ni l'affichage ne ralentissent le jeu
+        prochain_tour += (uint64_t)partie.vitesse_actuelle * 1000u;
+        if (instantPresent() > prochain_tour)
         {
-            system("clear");
-            printf("Game Over ! Score final : %d pommes\n", pommes_mangees);
-            condition_arret = FALSE;
-        }  
-        
-        usleep(vitesse_actuelle);
+            compter(COMPTEUR_RETARDS, 1);
+        }
+        if (instantPresent() > prochain_tour + (uint64_t)partie.vitesse_actuelle * 1000u)
+        {
+            // Retard de plus d'un tour (suspension) : le jeu repart sans rattraper
+            prochain_tour = instantPresent();
+        }
+        attendreTour(prochain_tour, &arrivee_touche);
+    }
+
+    // Le terminal n'est de nouveau utilisé directement qu'une fois le rendu arrêté
+    arreterRendu();
+    arreterMetriques();
+    arreterInstantane();
+    arreterSurveillance();
+    fermerSession();
+    afficherErreursRegles(erreurs_regles);
+    if (issue == PARTIE_PERDUE)
+    {
+        printf("Game Over ! Score final : %d pommes\n", partie.pommes_mangees);
+    }
+    else if (issue == PARTIE_GAGNEE)
+    {
+        printf("Félicitations ! Vous avez gagné en mangeant %d pommes !\n", partie.pommes_mangees);
+    }
+    if (parties > 1)
+    {
+        printf("%ld parties jouées, recommencées en %.1f µs en moyenne\n", parties,
+               duree_recommencements / 1e3 / (parties - 1));
+    }
+    if (latence)
+    {
+        afficherLatences(latencesRendu(), stdout);
+        printf("Images sautées (terminal en retard) : %lu\n", imagesSautees());
+    }
+    if (parties_terminees > 0 && ouvrirScores(&scores, cheminScores()))
+    {
+        afficherClassement(&scores);
+        fermerScores(&scores);
     }
 
-    enableEcho();
-    gotoXY(0,0);
+    if (pilote != NULL && pilote->detruire != NULL)
+    {
+        pilote->detruire(contexte_pilote);
+    }
+    // Toute la mémoire de la partie est rendue d'un coup
+    detruirePartie(&partie);
     return EXIT_SUCCESS;
 }
 
 /**
  * @brief Affiche un caractère à une position donnée dans le terminal.
  *
+ * Le caractère est écrit dans l'image en cours de composition ; il sera
+ * envoyé au terminal par le thread de rendu à la prochaine publication.
+ *
  * @param x Coordonnée en X (colonne).
  * @param y Coordonnée en Y (ligne).
  * @param c Le caractère à afficher.
  */
 void afficher(int x, int y, char c)
 {
-    gotoXY(x, y);
-    printf("%c", c);
-    fflush(stdout);
+    ecrireCase(x, y, c);
 }
 
 /**
@@ -209,282 +417,476 @@ void afficher(int x, int y, char c)
  */
 void effacer(int x, int y)
 {
-    gotoXY(x, y);
-    printf("%c", ' ');
+    ecrireCase(x, y, VIDE);
+}
+
+/**
+ * @brief Dessine uniquement les cases modifiées par le dernier déplacement.
+ *
+ * Efface l'ancienne queue (sauf si le serpent vient de grandir et l'occupe
+ * encore), redessine l'ancienne tête en corps et dessine la nouvelle tête.
+ * Le coût ne dépend pas de la taille du serpent.
+ *
+ * @param partie La partie, après progresser().
+ * @param ancienne_queue Position de la queue avant progresser().
+ */
+void dessinerProgression(const Partie *partie, Segment ancienne_queue)
+{
+    Parcours parcours;
+    Segment tete, cou;
+
+    if (OCCUPATION(partie, ancienne_queue.x, ancienne_queue.y) == 0)
+    {
+        effacer(ancienne_queue.x, ancienne_queue.y);
+    }
+
+    debutParcours(&partie->serpent, &parcours);
+    segmentSuivant(&parcours, &tete);
+    if (segmentSuivant(&parcours, &cou) && cou.x > 0)
+    {
+        afficher(cou.x, cou.y, CORPS);
+    }
+    afficher(tete.x, tete.y, TETE);
 }
 
 /**
- * @brief Dessine le serpent sur le plateau.
+ * @brief Dessine les cases modifiées par les pavés mobiles au dernier tour.
  *
- * Affiche la tête et le corps du serpent selon leurs positions actuelles.
+ * @param partie La partie, après jouerTour().
+ */
+void dessinerPaves(const Partie *partie)
+{
+    const Obstacles *obstacles = &partie->obstacles;
+
+    for (int i = 0; i < obstacles->nombre_changees; i++)
+    {
+        Segment position = obstacles->changees[i];
+
+        afficher(position.x, position.y, CASE(partie, position.x, position.y));
+    }
+}
+
+/**
+ * @brief Dessine les cases où un objet est apparu ou a disparu au dernier tour.
  *
- * @param lesX Tableau contenant les coordonnées X des segments du serpent.
- * @param lesY Tableau contenant les coordonnées Y des segments du serpent.
+ * @param partie La partie, après jouerTour().
  */
-void dessinerSerpent(int lesX[], int lesY[])
+void dessinerObjets(const Partie *partie)
 {
-    for (int i = 0; i < taille_serpent; i++)
+    const Objets *objets = &partie->objets;
+
+    for (int i = 0; i < objets->nombre_changees; i++)
     {
-        if (i == 0)
+        Segment position = objets->changees[i];
+        char c = CASE(partie, position.x, position.y);
+
+        // Un bonus disparu sous le corps ne doit pas l'effacer
+        if (c != VIDE || OCCUPATION(partie, position.x, position.y) == 0)
         {
-            afficher(lesX[i], lesY[i], TETE);
+            afficher(position.x, position.y, c);
         }
-        else if (lesX[i] > 0)
+    }
+}
+
+/**
+ * @brief Affiche la partie visible du plateau de jeu, serpent compris.
+ *
+ * @param partie La partie dont le plateau est affiché.
+ */
+void dessinerPlateau(const Partie *partie)
+{
+    dessinerZone(partie, camera.x, camera.y, camera.x + camera.largeur, camera.y + camera.hauteur);
+}
+
+/**
+ * @brief Affiche un rectangle du plateau, serpent compris.
+ *
+ * Le serpent est retrouvé par la grille d'occupation : le coût ne dépend
+ * que de la taille du rectangle.
+ *
+ * @param partie La partie affichée.
+ * @param x_debut Première colonne.
+ * @param y_debut Première ligne.
+ * @param x_fin Colonne qui suit la dernière.
+ * @param y_fin Ligne qui suit la dernière.
+ */
+void dessinerZone(const Partie *partie, int x_debut, int y_debut, int x_fin, int y_fin)
+{
+    Segment tete = teteSerpent(&partie->serpent);
+
+    for (int i = y_debut; i < y_fin && i < partie->hauteur; i++)
+    {
+        for (int j = x_debut; j < x_fin && j < partie->largeur; j++)
         {
-            afficher(lesX[i], lesY[i], CORPS);
+            // Le corps n'est pas dessiné dans la colonne 0, comme avant
+            if (OCCUPATION(partie, j, i) > 0 && j > 0)
+            {
+                afficher(j, i, CORPS);
+            }
+            else
+            {
+                afficher(j, i, CASE(partie, j, i));
+            }
         }
     }
+    if (tete.x >= x_debut && tete.x < x_fin && tete.y >= y_debut && tete.y < y_fin)
+    {
+        afficher(tete.x, tete.y, TETE);
+    }
 }
 
 /**
- * @brief Met à jour la position du serpent en fonction de la direction.
+ * @brief Ajuste la caméra à la taille du terminal et la centre sur la tête.
  *
- * Gère les déplacements, détecte les collisions (obstacles, corps), et 
- * vérifie si une pomme a été mangée. Met à jour la position du plateau en conséquence.
+ * Sans terminal de taille connue, tout le plateau est visible. Avec
+ * l'incrustation de latence, la dernière ligne du terminal lui est laissée.
  *
- * @param lesX Tableau contenant les coordonnées X des segments du serpent.
- * @param lesY Tableau contenant les coordonnées Y des segments du serpent.
- * @param direction Direction actuelle du serpent ('z', 'q', 's', 'd').
- * @param collision Indicateur de collision (modifié si le serpent se heurte).
- * @param pomme_mangee Indicateur de pomme mangée (modifié si une pomme est mangée).
+ * @param partie La partie affichée.
+ * @param latence true si l'incrustation de latence est affichée.
  */
-void progresser(int lesX[], int lesY[], char direction, bool *collision, bool *pomme_mangee)
+void cadrerCamera(const Partie *partie, bool latence)
 {
-    *collision = false;
-    *pomme_mangee = false;
+    Segment tete = teteSerpent(&partie->serpent);
+    int colonnes = partie->largeur;
+    int lignes = partie->hauteur + (latence ? 1 : 0);
 
-    // Mise à jour des positions du corps
-    for (int i = taille_serpent - 1; i > 0; i--) 
+    tailleTerminal(&colonnes, &lignes);
+    if (latence)
     {
-        lesX[i] = lesX[i - 1];
-        lesY[i] = lesY[i - 1];
+        lignes--;
     }
-
-    // Mise à jour de la tête selon la direction
-    switch (direction)
+    camera.largeur = (colonnes < partie->largeur) ? colonnes : partie->largeur;
+    camera.hauteur = (lignes < partie->hauteur) ? lignes : partie->hauteur;
+    if (camera.hauteur < 1)
     {
-        case HAUT:
-            lesY[0]--; 
-            break;
-        case BAS:     
-            lesY[0]++; 
-            break;
-        case DROITE:  
-            lesX[0]++; 
-            break;
-        case GAUCHE:  
-            lesX[0]--; 
-            break;
+        camera.hauteur = 1;
     }
+    // Caméra centrée, puis ramenée dans le plateau
+    camera.x = suivreAxe(tete.x - camera.largeur / 2, camera.largeur, partie->largeur, tete.x);
+    camera.y = suivreAxe(tete.y - camera.hauteur / 2, camera.hauteur, partie->hauteur, tete.y);
+}
 
-    // Gestion des télétransportations
-    if (lesX[0] < 0) lesX[0] = LARGEUR_PLATEAU - 1;
-    if (lesX[0] >= LARGEUR_PLATEAU) lesX[0] = 0;
-    if (lesY[0] < 0) lesY[0] = HAUTEUR_PLATEAU - 1;
-    if (lesY[0] >= HAUTEUR_PLATEAU) lesY[0] = 0;
+/**
+ * @brief Déplace la caméra si la tête approche du bord de l'écran.
+ *
+ * L'écran défile (voir placerCamera()) et seules les bandes découvertes
+ * sont redessinées ; après un saut plus grand que l'écran (passage par une
+ * issue), tout l'écran l'est.
+ *
+ * @param partie La partie, après jouerTour().
+ */
+void suivreTete(const Partie *partie)
+{
+    Segment tete = teteSerpent(&partie->serpent);
+    int x = suivreAxe(camera.x, camera.largeur, partie->largeur, tete.x);
+    int y = suivreAxe(camera.y, camera.hauteur, partie->hauteur, tete.y);
+    int dx = x - camera.x, dy = y - camera.y;
 
-    // Collisions avec le corps
-    for (int i = 1; i < taille_serpent; i++) 
+    if (dx == 0 && dy == 0)
     {
-        if (lesX[0] == lesX[i] && lesY[0] == lesY[i]) 
-        {
-            *collision = true;
-            return;
-        }
+        return;
     }
-
-    // Collisions avec les obstacles
-    if (plateauJeu[lesY[0]][lesX[0]] == COTE_BORDURE) 
+    placerCamera(x, y);
+    camera.x = x;
+    camera.y = y;
+    if (abs(dx) >= camera.largeur || abs(dy) >= camera.hauteur)
     {
-        *collision = true;
+        dessinerPlateau(partie);
         return;
     }
+    if (dx != 0)
+    {
+        int debut = (dx > 0) ? x + camera.largeur - dx : x;
 
-    // Gestion des pommes
-    if (plateauJeu[lesY[0]][lesX[0]] == POMME)
+        dessinerZone(partie, debut, y, debut + abs(dx), y + camera.hauteur);
+    }
+    if (dy != 0)
     {
-        *pomme_mangee = true;
-        plateauJeu[lesY[0]][lesX[0]] = VIDE;
+        int debut = (dy > 0) ? y + camera.hauteur - dy : y;
+
+        dessinerZone(partie, x, debut, x + camera.largeur, debut + abs(dy));
+    }
+}
+
+/**
+ * @brief Origine de la caméra sur un axe pour garder une position visible.
+ *
+ * La position doit rester à au moins un quart de l'écran du bord, sauf
+ * contre les bords du plateau ; entre ces marges, la caméra ne bouge pas.
+ *
+ * @param origine Origine actuelle.
+ * @param visible Nombre de cases visibles sur l'axe.
+ * @param taille Taille du plateau sur l'axe.
+ * @param position Position à garder visible.
+ * @return La nouvelle origine.
+ */
+int suivreAxe(int origine, int visible, int taille, int position)
+{
+    int marge = visible / 4;
 
-        // Ajout d'un nouveau segment à la queue du serpent
-        lesX[taille_serpent] = lesX[taille_serpent - 1];
-        lesY[taille_serpent] = lesY[taille_serpent - 1];
+    if (position < origine + marge)
+    {
+        origine = position - marge;
+    }
+    else if (position >= origine + visible - marge)
+    {
+        origine = position - visible + marge + 1;
     }
+    if (origine > taille - visible)
+    {
+        origine = taille - visible;
+    }
+    return (origine > 0) ? origine : 0;
+}
 
-    dessinerSerpent(lesX, lesY);
+/**
+ * @brief Gestionnaire du signal SIGWINCH.
+ *
+ * Demande à la boucle principale de tout redessiner au prochain tour.
+ *
+ * @param numero_signal Numéro du signal reçu.
+ */
+void signalerRedimensionnement(int numero_signal)
+{
+    (void)numero_signal;
+    terminal_redimensionne = TRUE;
 }
 
 /**
- * @brief Initialise le plateau de jeu.
+ * @brief Attend la fin du tour en surveillant l'arrivée d'une touche.
  *
- * Remplit le plateau avec des bordures et des espaces vides. Ajoute des ouvertures aux bordures.
+ * La touche n'est pas lue (elle le sera au début du tour suivant, comme
+ * avant) : seul l'instant de son arrivée est noté, pour que la mesure de
+ * latence compte aussi le temps passé à attendre.
  *
- * @param plateau Tableau 2D représentant le plateau.
+ * @param echeance Fin du tour (horloge de instantPresent()).
+ * @param arrivee_touche Instant d'arrivée de la première touche en attente (0 : aucune), mis à jour.
  */
-void initPlateau(char plateau[HAUTEUR_PLATEAU][LARGEUR_PLATEAU])
+void attendreTour(uint64_t echeance, uint64_t *arrivee_touche)
 {
-    for (int i = 0; i < HAUTEUR_PLATEAU; i++) 
+    uint64_t present = instantPresent();
+    struct timespec fin = {(time_t)(echeance / 1000000000u), (long)(echeance % 1000000000u)};
+
+    if (*arrivee_touche == 0 && present < echeance)
     {
-        for (int j = 0; j < LARGEUR_PLATEAU; j++) 
+        struct pollfd entree = {STDIN_FILENO, POLLIN, 0};
+
+        if (poll(&entree, 1, (int)((echeance - present) / 1000000u)) > 0 && (entree.revents & POLLIN))
         {
-            if (i == 0 || i == HAUTEUR_PLATEAU - 1 || j == 0 || j == LARGEUR_PLATEAU - 1) 
-            {
-                plateau[i][j] = COTE_BORDURE;
-            } 
-            else 
-            {
-                plateau[i][j] = VIDE;
-            }
+            *arrivee_touche = instantPresent();
         }
     }
-    // Créer les issues au centre de chaque côté
-    plateau[0][LARGEUR_PLATEAU/2] = VIDE;
-    plateau[HAUTEUR_PLATEAU-1][LARGEUR_PLATEAU/2] = VIDE;
-    plateau[HAUTEUR_PLATEAU/2][0] = VIDE;
-    plateau[HAUTEUR_PLATEAU/2][LARGEUR_PLATEAU-1] = VIDE;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &fin, NULL) == EINTR)
+    {
+    }
 }
 
 /**
- * @brief Affiche le plateau de jeu.
+ * @brief Écrit l'issue de la partie au milieu de la partie visible du plateau.
  *
- * Parcourt le tableau 2D du plateau et affiche chaque case dans le terminal.
+ * Le message n'utilise aucun caractère du jeu (chiffres, 'O', 'X'...), qui
+ * prendraient leur glyphe dans l'habillage Unicode. Il est tronqué à la
+ * largeur de l'écran et effacé par le prochain dessinerPlateau().
  *
- * @param plateau Tableau 2D représentant le plateau.
+ * @param partie La partie terminée.
+ * @param issue Issue de la partie.
  */
-void dessinerPlateau(char plateau[HAUTEUR_PLATEAU][LARGEUR_PLATEAU])
+void afficherIssue(const Partie *partie, Issue issue)
 {
-    for (int i = 0; i < HAUTEUR_PLATEAU; i++) 
+    char message[TAILLE_MESSAGE];
+    int longueur = snprintf(message, sizeof(message), " %s - une touche pour rejouer, %c pour quitter ",
+                            (issue == PARTIE_GAGNEE) ? "victoire" : "perdu", partie->regles->touche_arret);
+    int x, y;
+
+    if (longueur > camera.largeur)
     {
-        for (int j = 0; j < LARGEUR_PLATEAU; j++) 
-        {
-            afficher(j, i, plateau[i][j]);
-        }
+        longueur = camera.largeur;
+    }
+    x = camera.x + (camera.largeur - longueur) / 2;
+    y = camera.y + camera.hauteur / 2;
+    for (int i = 0; i < longueur; i++)
+    {
+        afficher(x + i, y, message[i]);
     }
 }
 
 /**
- * @brief Place des pavés (obstacles fixes) sur le plateau.
+ * @brief Affiche l'issue de la partie et attend la décision du joueur.
  *
- * Les pavés sont placés aléatoirement, tout en respectant une distance 
- * minimale avec le serpent initial.
+ * Les touches tapées avant la fin de la partie sont ignorées. Pendant
+ * l'attente, un changement de taille du terminal ou une reprise de session
+ * redessine l'écran comme pendant la partie.
  *
- * @param plateau Tableau 2D représentant le plateau.
+ * @param partie La partie terminée.
+ * @param issue Issue de la partie.
+ * @param latence true si l'incrustation de latence est affichée.
+ * @return true pour rejouer (n'importe quelle touche), false pour quitter (touche d'arrêt, fin de l'entrée).
  */
-void placerPaves(char plateau[HAUTEUR_PLATEAU][LARGEUR_PLATEAU])
+bool attendreRejouer(const Partie *partie, Issue issue, bool latence)
 {
-    srand(time(NULL));
+    struct pollfd entree = {STDIN_FILENO, POLLIN, 0};
 
-    for (int p = 0; p < NOMBRES_PAVES; p++) 
+    while (kbhit() == TRUE)
+    {
+        if (getchar() == EOF)
+        {
+            return false;
+        }
+    }
+    afficherIssue(partie, issue);
+    publierImage();
+    while (true)
     {
-        int x, y;
-        do {
-            x = rand() % (LARGEUR_PLATEAU - 2 * TAILLE_PAVE -2) + 2;
-            y = rand() % (HAUTEUR_PLATEAU - 2 * TAILLE_PAVE -2) + 2;
-        } while (plateau[y][x] == COTE_BORDURE || 
-                ((x >= COORD_DEPART_X_SERPENT - 15) && 
-                 (x <= COORD_DEPART_X_SERPENT + 15) && 
-                 (y >= COORD_DEPART_Y_SERPENT - 15) && 
-                 (y <= COORD_DEPART_Y_SERPENT + 15)));
+        if (poll(&entree, 1, ATTENTE_REJOUER) > 0 && (entree.revents & (POLLIN | POLLHUP)))
+        {
+            int touche = getchar();
 
-        for (int i = 0; i < TAILLE_PAVE; i++)
+            return touche != EOF && commandeTouche(partie->regles, (char)touche) != STOP_JEU;
+        }
+        if (terminal_redimensionne || sessionReprise())
         {
-            for (int j = 0; j < TAILLE_PAVE; j++) 
+            if (terminal_redimensionne)
             {
-                plateau[y + i][x + j] = COTE_BORDURE;
+                terminal_redimensionne = FALSE;
+                cadrerCamera(partie, latence);
+                redimensionnerRendu(camera.largeur, camera.hauteur);
+                placerCamera(camera.x, camera.y);
             }
+            dessinerPlateau(partie);
+            afficherIssue(partie, issue);
+            redessinerTout();
+            publierImage();
         }
     }
 }
 
 /**
- * @brief Ajoute une pomme à une position aléatoire sur le plateau.
+ * @brief Remet la partie à son départ et l'affiche, sans quitter le jeu.
  *
- * La pomme est placée uniquement sur une case vide.
+ * Seules les cases touchées par la partie précédente sont remises à neuf
+ * (voir recommencerPartie()). L'image est recomposée en entier, mais le
+ * thread de rendu n'envoie que les cases qui diffèrent de l'écran : les
+ * bordures et les pavés restés en place ne repartent pas vers le terminal.
  *
- * @param plateau Tableau 2D représentant le plateau.
+ * @param partie Partie terminée, créée par creerPartie().
+ * @param graine Graine de la nouvelle partie.
+ * @param latence true si l'incrustation de latence est affichée.
  */
-void ajouterPomme(char plateau[HAUTEUR_PLATEAU][LARGEUR_PLATEAU])
+void recommencer(Partie *partie, uint32_t graine, bool latence)
 {
-    int x, y;
-    do {
-        x = rand() % (LARGEUR_PLATEAU - 2) + 1;
-        y = rand() % (HAUTEUR_PLATEAU - 2) + 1;
-    } while (plateau[y][x] != VIDE);
-    
-    plateau[y][x] = POMME;
-    afficher(x, y, POMME);
+    int largeur = camera.largeur, hauteur = camera.hauteur;
+
+    recommencerPartie(partie, graine);
+    compter(COMPTEUR_PARTIES, 1);
+    // Sans segment recréé (taille changée), la publication s'arrête
+    recommencerInstantane(partie);
+    cadrerCamera(partie, latence);
+    if (camera.largeur != largeur || camera.hauteur != hauteur)
+    {
+        redimensionnerRendu(camera.largeur, camera.hauteur);
+    }
+    placerCamera(camera.x, camera.y);
+    dessinerPlateau(partie);
+    publierImage();
 }
 
-/** 
-* Fonctions et procédures donner  
-*/
-
-void gotoXY(int x, int y)
+/**
+ * @brief Ajoute le score de la partie au journal.
+ *
+ * Le classement n'est affiché qu'en quittant le jeu : le terminal appartient
+ * encore au thread de rendu.
+ *
+ * @param partie La partie terminée.
+ * @param graine Graine de la partie.
+ * @param issue Issue de la partie.
+ * @param nom Joueur ou pilote (NULL : « joueur »).
+ */
+void enregistrerScore(const Partie *partie, uint32_t graine, Issue issue, const char *nom)
 {
-    printf("\033[%d;%df", y + 1, x + 1);
+    Scores scores;
+    Score score;
+
+    if (!ouvrirScores(&scores, cheminScores()))
+    {
+        return;
+    }
+    memset(&score, 0, sizeof(score));
+    score.date = (uint64_t)time(NULL);
+    score.tours = partie->tour;
+    score.graine = graine;
+    score.pommes = partie->pommes_mangees;
+    score.issue = issue;
+    snprintf(score.nom, sizeof(score.nom), "%s", nom != NULL ? nom : "joueur");
+    if (!ajouterScore(&scores, &score))
+    {
+        perror(cheminScores());
+    }
+    fermerScores(&scores);
 }
 
-int kbhit()
+/**
+ * @brief Affiche les SCORES_AFFICHES meilleurs scores.
+ *
+ * @param scores Le tableau des scores.
+ */
+void afficherClassement(Scores *scores)
 {
-    int unCaractere = 0;
-    struct termios oldt, newt;
-    int ch;
-    int oldf;
+    Score classement[SCORES_AFFICHES];
+    int nombre = meilleursScores(scores, classement, SCORES_AFFICHES);
+    char date[32];
 
-    tcgetattr(STDIN_FILENO, &oldt);
-    newt = oldt;
-    newt.c_lflag &= ~(ICANON | ECHO);
-    tcsetattr(STDIN_FILENO, TCSANOW, &newt);
-    oldf = fcntl(STDIN_FILENO, F_GETFL, 0);
-    fcntl(STDIN_FILENO, F_SETFL, oldf | O_NONBLOCK);
-
-    ch = getchar();
-
-    tcsetattr(STDIN_FILENO, TCSANOW, &oldt);
-    fcntl(STDIN_FILENO, F_SETFL, oldf);
+    printf("Meilleurs scores (%s) :\n", cheminScores());
+    for (int i = 0; i < nombre; i++)
+    {
+        time_t instant = (time_t)classement[i].date;
 
-    if ((ch != EOF))
+        strftime(date, sizeof(date), "%d/%m/%Y %H:%M", localtime(&instant));
+        printf("%3d. %-*s %4d pommes en %6ld tours  %s\n", i + 1, TAILLE_NOM_SCORE - 1,
+               classement[i].nom, classement[i].pommes, (long)classement[i].tours, date);
+    }
+    if (nombre == 0)
     {
-        ungetc(ch, stdin);
-        unCaractere = 1;
+        printf("  (aucun score)\n");
     }
-    return unCaractere;
 }
 
-void disableEcho()
+/**
+ * @brief Affiche les erreurs de relecture des règles gardées pendant le jeu.
+ *
+ * @param erreurs Fichier temporaire des erreurs (NULL : elles ont été écrites sur stderr), fermé ici.
+ */
+void afficherErreursRegles(FILE *erreurs)
 {
-    struct termios tty;
+    char ligne[256];
 
-    if (tcgetattr(STDIN_FILENO, &tty) == -1) 
+    if (erreurs == NULL)
     {
-        perror("tcgetattr");
-        exit(EXIT_FAILURE);
+        return;
     }
-    
-    tty.c_lflag &= ~ECHO;
-   
-    if (tcsetattr(STDIN_FILENO, TCSANOW, &tty) == -1) 
+    rewind(erreurs);
+    while (fgets(ligne, sizeof(ligne), erreurs) != NULL)
     {
-        perror("tcsetattr");
-        exit(EXIT_FAILURE);
+        fputs(ligne, stderr);
     }
+    fclose(erreurs);
 }
 
-void enableEcho() 
+/** 
+* Fonctions et procédures donner  
+*/
+
+/**
+ * @brief Indique si une touche attend d'être lue, sans bloquer.
+ *
+ * Le terminal est déjà en mode brut (voir terminal.c) : il suffit
+ * d'interroger l'entrée standard.
+ *
+ * @return 1 si une touche est disponible, 0 sinon.
+ */
+int kbhit()
 {
-    struct termios tty;
+    struct pollfd entree = {STDIN_FILENO, POLLIN, 0};
 
-    if (tcgetattr(STDIN_FILENO, &tty) == -1) 
-    {
-        perror("tcgetattr");
-        exit(EXIT_FAILURE);
-    }
+    return (poll(&entree, 1, 0) > 0 && (entree.revents & POLLIN)) ? 1 : 0;
+}
 
-    tty.c_lflag |= ECHO;
-    
-    if (tcsetattr(STDIN_FILENO, TCSANOW, &tty) == -1) 
-    {
-        perror("tcsetattr");
-        exit(EXIT_FAILURE);
-    }
-}
\ No newline at end of file
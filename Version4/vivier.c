@@ -0,0 +1,120 @@
+/**
+ * @file vivier.c
+ * @brief Réserve de parties réutilisées (voir vivier.h).
+ *
+ * @details
+ * - Les parties rendues forment une pile : la dernière rendue, dont la
+ *   mémoire est la plus susceptible d'être encore en cache, est reprise la
+ *   première.
+ * - Le verrou n'est tenu que pour empiler ou dépiler un pointeur : la
+ *   partie est recommencée (ou créée) hors du verrou.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+/* Déclaration des fichiers inclus */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "vivier.h"
+
+/**
+ * @brief Prépare un vivier vide.
+ *
+ * @param vivier Vivier à préparer.
+ */
+void ouvrirVivier(Vivier *vivier)
+{
+    pthread_mutex_init(&vivier->verrou, NULL);
+    vivier->libres = NULL;
+    vivier->nombre = 0;
+    vivier->capacite = 0;
+    vivier->creees = 0;
+}
+
+/**
+ * @brief Donne une partie au départ, recommencée si le vivier en a une.
+ *
+ * @param vivier Le vivier.
+ * @param graine Graine de la partie.
+ * @return La partie, à rendre par rendrePartie().
+ */
+Partie *prendrePartie(Vivier *vivier, uint32_t graine)
+{
+    Partie *partie = NULL;
+
+    pthread_mutex_lock(&vivier->verrou);
+    if (vivier->nombre > 0)
+    {
+        partie = vivier->libres[--vivier->nombre];
+    }
+    else
+    {
+        vivier->creees++;
+    }
+    pthread_mutex_unlock(&vivier->verrou);
+
+    if (partie != NULL)
+    {
+        recommencerPartie(partie, graine);
+        return partie;
+    }
+    partie = malloc(sizeof(Partie));
+    if (partie == NULL)
+    {
+        perror("malloc");
+        exit(EXIT_FAILURE);
+    }
+    creerPartie(partie, graine);
+    return partie;
+}
+
+/**
+ * @brief Rend une partie terminée au vivier.
+ *
+ * @param vivier Le vivier.
+ * @param partie Partie obtenue par prendrePartie().
+ */
+void rendrePartie(Vivier *vivier, Partie *partie)
+{
+    pthread_mutex_lock(&vivier->verrou);
+    if (vivier->nombre == vivier->capacite)
+    {
+        int capacite = (vivier->capacite > 0) ? 2 * vivier->capacite : 16;
+        Partie **libres = realloc(vivier->libres, (size_t)capacite * sizeof(Partie *));
+
+        if (libres == NULL)
+        {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+        vivier->libres = libres;
+        vivier->capacite = capacite;
+    }
+    vivier->libres[vivier->nombre++] = partie;
+    pthread_mutex_unlock(&vivier->verrou);
+}
+
+/**
+ * @brief Détruit les parties du vivier.
+ *
+ * Toutes les parties prises doivent avoir été rendues.
+ *
+ * @param vivier Le vivier.
+ */
+void fermerVivier(Vivier *vivier)
+{
+    for (int i = 0; i < vivier->nombre; i++)
+    {
+        detruirePartie(vivier->libres[i]);
+        free(vivier->libres[i]);
+    }
+    free(vivier->libres);
+    vivier->libres = NULL;
+    vivier->nombre = 0;
+    vivier->capacite = 0;
+    pthread_mutex_destroy(&vivier->verrou);
+}
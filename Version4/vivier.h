@@ -0,0 +1,40 @@
+/**
+ * @file vivier.h
+ * @brief Réserve de parties réutilisées d'une partie à la suivante.
+ *
+ * Un programme qui joue un grand nombre de parties (tournoi, entraînement)
+ * les prend dans le vivier et les y rend une fois terminées : une partie
+ * rendue garde son arène, son plateau et ses tables, et la suivante la
+ * recommence sur place (voir recommencerPartie()) au lieu de tout allouer
+ * et de réécrire chaque case. Plusieurs threads partagent le même vivier.
+ *
+ * @author
+ * Le Chevère Yannis
+ *
+ * @version 4.0
+ */
+
+#ifndef VIVIER_H
+#define VIVIER_H
+
+#include <pthread.h>
+
+#include "jeu.h"
+
+/** @brief Parties terminées, prêtes à être recommencées. */
+typedef struct
+{
+    pthread_mutex_t verrou;     /**< Exclusion entre les threads. */
+    Partie **libres;            /**< Pile des parties rendues. */
+    int nombre;                 /**< Nombre de parties rendues. */
+    int capacite;               /**< Taille du tableau libres. */
+    long creees;                /**< Parties créées (les autres ont été recommencées). */
+} Vivier;
+
+/* Déclaration des fonctions */
+void ouvrirVivier(Vivier *vivier);
+Partie *prendrePartie(Vivier *vivier, uint32_t graine);
+void rendrePartie(Vivier *vivier, Partie *partie);
+void fermerVivier(Vivier *vivier);
+
+#endif